@@ -1,47 +1,196 @@
+import asyncio
+import concurrent.futures
+import threading
+
 from ._zxc import (
+    Compressor,
+    ZxcCompressor as _ZxcCompressor,
+    ZxcDecompressor as _ZxcDecompressor,
     pyzxc_compress,
+    pyzxc_compress_typed,
     pyzxc_decompress,
+    pyzxc_compress_bound,
+    pyzxc_get_active_isa,
+    pyzxc_set_isa,
+    pyzxc_compress_into,
+    pyzxc_decompress_into,
+    pyzxc_compress_many,
     pyzxc_stream_compress,
     pyzxc_stream_decompress,
 )
 
 __all__ = [
+    "Compressor",
+    "ZxcCompressor",
+    "ZxcDecompressor",
     "compress",
+    "compress_typed",
     "decompress",
+    "compress_bound",
+    "get_active_isa",
+    "set_isa",
+    "compress_into",
+    "decompress_into",
+    "compress_many",
     "stream_compress",
     "stream_decompress"
 ]
 
-def compress(src, *, level = 3) -> bytes:
-    """Compress a bytes object"""
-    return pyzxc_compress(src, level)
+def compress(src, *, level = 3, checksum=False, block_size=0, stats=False) -> bytes:
+    """Compress a bytes object
 
-def decompress(src):
-    """Decompress a bytes object"""
-    return pyzxc_decompress(src)
+    block_size is optional: 0 keeps the default, otherwise 64 KB..4 MB in
+    4 KB steps. stats=True returns (frame, stats) instead, where stats is a
+    dict of the call's counters: bytes_in, bytes_out, times in nanoseconds
+    (wall_ns, work_ns, checksum_ns, and for streams read_ns, read_wait_ns,
+    work_wait_ns, write_ns, write_wait_ns) and, for each block type ("raw",
+    "glo", "ghi", "num"), {"blocks", "bytes", "compressed_bytes"}.
+    """
+    return pyzxc_compress(src, level, checksum, block_size, stats)
 
-def stream_compress(src, dst, n_threads=0, level=3, checksum=False):
-    """Compress data from src to dst (file-like objects)"""
-    if not hasattr(src, "fileno") or not hasattr(dst, "fileno"):
-        raise ValueError("src and dst must be open file-like objects")
-    
-    if not src.readable():
-        raise ValueError("Source file must be readable")
-    
-    if not dst.writable():
-        raise ValueError("Destination file must be writable")
-    
-    return pyzxc_stream_compress(src, dst, n_threads, level, checksum)
+def compress_typed(src, itemsize=None, *, level=3, checksum=False, block_size=0) -> bytes:
+    """Compress an array of fixed-size elements with byte shuffling
+
+    Byte k of every element is grouped with the same byte of the others
+    before compression, which suits numeric arrays (float tensors in
+    particular) and arrays of structs. itemsize defaults to the item size
+    reported by the buffer, so a numpy array uses its dtype.itemsize.
+    The result is decoded by decompress() like any other frame.
+    """
+    return pyzxc_compress_typed(src, itemsize or 0, level, checksum, block_size)
+
+def decompress(src, original_size=None, checksum=False, stats=False):
+    """Decompress a bytes object
+
+    original_size is optional: when omitted it is read from the frame.
+    stats=True returns (data, stats), see compress().
+    """
+    if original_size is None:
+        return pyzxc_decompress(src, checksum=checksum, stats=stats)
+    return pyzxc_decompress(src, original_size, checksum, stats)
+
+def compress_bound(size) -> int:
+    """Maximum compressed size of an input of the given size"""
+    return pyzxc_compress_bound(size)
+
+def get_active_isa() -> str:
+    """Code path of the block codecs: "generic", "avx2", "avx512" or "neon" """
+    return pyzxc_get_active_isa()
+
+def set_isa(name) -> None:
+    """Select the code path of the block codecs for the whole process
+
+    name is "auto" (the ZXC_ISA environment variable, else the best one the
+    CPU supports), "generic", "avx2", "avx512" or "neon". Raises ValueError
+    if this build or CPU does not have it. Every path writes the same frames.
+    """
+    pyzxc_set_isa(name)
+
+def compress_into(src, dst, *, level=3, checksum=False, block_size=0) -> int:
+    """Compress a bytes-like object into a writable buffer
+
+    dst is any writable contiguous buffer (bytearray, memoryview, numpy
+    array, mmap...). Returns the number of bytes written; a dst of
+    compress_bound(len(src)) bytes always fits.
+    """
+    return pyzxc_compress_into(src, dst, level, checksum, block_size)
+
+def decompress_into(src, dst, checksum=False) -> int:
+    """Decompress a bytes-like object into a writable buffer
+
+    dst is any writable contiguous buffer and must hold the whole
+    decompressed data. Returns the number of bytes written.
+    """
+    return pyzxc_decompress_into(src, dst, checksum)
+
+def compress_many(buffers, *, level=3, checksum=False, block_size=0, n_threads=0,
+                  stats=False) -> list:
+    """Compress a list of bytes-like objects, one frame each
+
+    All of them are compressed in a single call with the GIL released once:
+    large buffers are split into blocks and small ones spread over the
+    threads, so every core is kept busy whatever the mix of sizes. Each
+    frame is the same as compress() would return. n_threads=0 uses a thread
+    pool shared within the process, 1 the calling thread only. stats=True
+    returns (frames, stats) for the whole batch, see compress(). An empty
+    buffer raises ValueError, and a failure names the index of the buffer.
+    """
+    return pyzxc_compress_many(buffers, level, checksum, block_size, n_threads, stats)
 
-def stream_decompress(src, dst, n_threads=0, checksum=False):
-    """Decompress data from src to dst (file-like objects)"""
-    if not hasattr(src, "fileno") or not hasattr(dst, "fileno"):
+def _check_stream_ends(src, dst):
+    if not (hasattr(src, "readinto") or hasattr(src, "read")) or not hasattr(dst, "write"):
         raise ValueError("src and dst must be open file-like objects")
-    
-    if not src.readable():
+
+    if hasattr(src, "readable") and not src.readable():
         raise ValueError("Source file must be readable")
-    
-    if not dst.writable():
+
+    if hasattr(dst, "writable") and not dst.writable():
         raise ValueError("Destination file must be writable")
-    
-    return pyzxc_stream_decompress(src, dst, n_threads, checksum)
\ No newline at end of file
+
+def stream_compress(src, dst, n_threads=0, level=3, checksum=False, block_size=0,
+                    stats=False):
+    """Compress data from src to dst (file-like objects)
+
+    Real files are read and written through their descriptor. Objects without
+    one (io.BytesIO, socket files, custom readers) are driven through their
+    readinto()/read() and write() methods instead. stats=True returns the
+    stats dict of the call (see compress()) instead of None.
+    """
+    _check_stream_ends(src, dst)
+    return pyzxc_stream_compress(src, dst, n_threads, level, checksum, block_size, stats)
+
+def stream_decompress(src, dst, n_threads=0, checksum=False, stats=False):
+    """Decompress data from src to dst (file-like objects, see stream_compress)"""
+    _check_stream_ends(src, dst)
+    return pyzxc_stream_decompress(src, dst, n_threads, checksum, stats)
+
+_pool = None
+_pool_lock = threading.Lock()
+
+def _offload(executor, func, *args):
+    """Run func in executor (default: the module's thread pool) from a coroutine"""
+    global _pool
+    if executor is None:
+        with _pool_lock:
+            if _pool is None:
+                _pool = concurrent.futures.ThreadPoolExecutor(thread_name_prefix="zxc")
+        executor = _pool
+    return asyncio.get_running_loop().run_in_executor(executor, func, *args)
+
+class ZxcCompressor(_ZxcCompressor):
+    """Incremental compressor: compress(chunk) -> bytes, then flush()
+
+    The output of all the calls, concatenated, is a stream frame that
+    decompress() and stream_decompress() read. Input is buffered up to a
+    whole block (block_size, 256 KB by default) and each complete block is
+    compressed with the GIL released. flush() emits the buffered tail as a
+    short block; the frame stays valid and may be continued. end() also
+    closes the frame with an END block, and the next compress() starts a
+    new one: ZxcDecompressor reads such frames back to back.
+
+    acompress(), aflush() and aend() run the same work in a thread pool (the
+    module's own, or the given executor) so the event loop is not blocked.
+    Await them in order: the object is a single stream.
+    """
+
+    async def acompress(self, data, executor=None) -> bytes:
+        return await _offload(executor, self.compress, data)
+
+    async def aflush(self, executor=None) -> bytes:
+        return await _offload(executor, self.flush)
+
+    async def aend(self, executor=None) -> bytes:
+        return await _offload(executor, self.end)
+
+class ZxcDecompressor(_ZxcDecompressor):
+    """Incremental decompressor: decompress(chunk) -> bytes
+
+    Accepts frames in pieces of any size and returns the data of every
+    block completed so far. A frame closed by an END block (see
+    ZxcCompressor.end()) may be followed by another one. pending is the
+    number of bytes kept for an incomplete block. adecompress() runs in a
+    thread pool like ZxcCompressor.acompress().
+    """
+
+    async def adecompress(self, data, executor=None) -> bytes:
+        return await _offload(executor, self.decompress, data)
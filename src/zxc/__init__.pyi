@@ -1,15 +1,66 @@
-from typing import Protocol
+from concurrent.futures import Executor
+from typing import Any, Literal, Protocol, overload
 
-class FileLike(Protocol):
-    def fileno(self) -> int: ...
-    def readable(self) -> bool: ...
-    def writable(self) -> bool: ...
+class Source(Protocol):
+    def read(self, size: int = ..., /) -> bytes: ...
 
-def compress(data, level: int = 5, checksum: bool = False) -> bytes: ...
-def decompress(data, original_size: int, checksum: bool = False) -> bytes: ...
+class Sink(Protocol):
+    def write(self, data, /) -> int | None: ...
 
-def stream_compress(src: FileLike, dst: FileLike, 
-                    n_threads: int = 0, level: int = 3, checksum: bool = False) -> None: ...
+class Compressor:
+    def __init__(self, level: int = 3, checksum: bool = False, block_size: int = 0) -> None: ...
+    def compress(self, data) -> bytes: ...
+    def decompress(self, data, original_size: int | None = None) -> bytes: ...
 
-def stream_decompress(src: FileLike, dst: FileLike, 
-                      n_threads: int = 0, checksum: bool = False) -> None: ...
\ No newline at end of file
+class ZxcCompressor:
+    def __init__(self, level: int = 3, checksum: bool = False, block_size: int = 0) -> None: ...
+    def compress(self, data) -> bytes: ...
+    def flush(self) -> bytes: ...
+    def end(self) -> bytes: ...
+    async def acompress(self, data, executor: Executor | None = None) -> bytes: ...
+    async def aflush(self, executor: Executor | None = None) -> bytes: ...
+    async def aend(self, executor: Executor | None = None) -> bytes: ...
+
+class ZxcDecompressor:
+    def __init__(self, checksum: bool = False) -> None: ...
+    @property
+    def pending(self) -> int: ...
+    def decompress(self, data) -> bytes: ...
+    async def adecompress(self, data, executor: Executor | None = None) -> bytes: ...
+
+@overload
+def compress(data, *, level: int = 3, checksum: bool = False, block_size: int = 0,
+             stats: Literal[False] = False) -> bytes: ...
+@overload
+def compress(data, *, level: int = 3, checksum: bool = False, block_size: int = 0,
+             stats: Literal[True]) -> tuple[bytes, dict[str, Any]]: ...
+def compress_typed(data, itemsize: int | None = None, *, level: int = 3,
+                   checksum: bool = False, block_size: int = 0) -> bytes: ...
+@overload
+def decompress(data, original_size: int | None = None, checksum: bool = False,
+               stats: Literal[False] = False) -> bytes: ...
+@overload
+def decompress(data, original_size: int | None = None, checksum: bool = False, *,
+               stats: Literal[True]) -> tuple[bytes, dict[str, Any]]: ...
+def compress_bound(size: int) -> int: ...
+def get_active_isa() -> Literal["generic", "avx2", "avx512", "neon"]: ...
+def set_isa(name: Literal["auto", "generic", "avx2", "avx512", "neon"]) -> None: ...
+def compress_into(data, dst, *, level: int = 3, checksum: bool = False,
+                  block_size: int = 0) -> int: ...
+def decompress_into(data, dst, checksum: bool = False) -> int: ...
+@overload
+def compress_many(buffers, *, level: int = 3, checksum: bool = False,
+                  block_size: int = 0, n_threads: int = 0,
+                  stats: Literal[False] = False) -> list[bytes]: ...
+@overload
+def compress_many(buffers, *, level: int = 3, checksum: bool = False,
+                  block_size: int = 0, n_threads: int = 0,
+                  stats: Literal[True]) -> tuple[list[bytes], dict[str, Any]]: ...
+
+def stream_compress(src: Source, dst: Sink, 
+                    n_threads: int = 0, level: int = 3, checksum: bool = False,
+                    block_size: int = 0, stats: bool = False) -> dict[str, Any] | None: ...
+
+def stream_decompress(src: Source, dst: Sink, 
+                      n_threads: int = 0, checksum: bool = False,
+                      stats: bool = False) -> dict[str, Any] | None: ...
\ No newline at end of file
@@ -1,6 +1,7 @@
 #define PY_SSIZE_T_CLEAN
 
 #include "zxc.h"
+#include "zxc_sans_io.h"
 #include <Python.h>
 
 #define Py_Return_Errno(err)                                                   \
@@ -22,7 +23,7 @@ static inline int zxc_dup(int fd) {
 #ifdef _WIN32
     return _dup(fd);
 #else
-    return zxc_dup(fd);
+    return dup(fd);
 #endif
 }
 
@@ -43,6 +44,108 @@ static inline int zxc_close(int fd) {
 }
 
 
+// =============================================================================
+// Argument checks
+// =============================================================================
+
+// Checks a block_size argument: 0 (the default) or what the frame format
+// accepts. Returns 0, or -1 with ValueError set.
+static int pyzxc_check_block_size(Py_ssize_t block_size) {
+    if (block_size != 0 &&
+        (block_size < ZXC_BLOCK_SIZE_MIN || block_size > ZXC_BLOCK_SIZE_MAX ||
+         block_size % 4096 != 0)) {
+        PyErr_SetString(PyExc_ValueError,
+                        "block_size must be 0 or 64 KB..4 MB in 4 KB steps");
+        return -1;
+    }
+    return 0;
+}
+
+// Tells whether a frame holds no data: a file header directly followed by an
+// END block, as ZxcCompressor.end() writes before any input. The buffer API
+// reports 0 bytes for it, which is also its error value.
+static int pyzxc_is_empty_frame(const uint8_t *src, size_t src_size) {
+    int h_size = zxc_read_file_header(src, src_size, NULL);
+    if (h_size < 0)
+        return 0;
+    size_t blk = zxc_peek_block_size(src + h_size, src_size - (size_t)h_size);
+    return blk == src_size - (size_t)h_size &&
+           zxc_is_end_block(src + h_size, blk);
+}
+
+// =============================================================================
+// Performance counters
+// =============================================================================
+// stats=True collects the counters of the call (zxc_perf_capture() on the
+// thread that runs it, with the GIL released) and returns them as a dict.
+
+static int pyzxc_dict_set(PyObject *dict, const char *key, uint64_t value) {
+    PyObject *v = PyLong_FromUnsignedLongLong((unsigned long long)value);
+    if (!v)
+        return -1;
+    int res = PyDict_SetItemString(dict, key, v);
+    Py_DECREF(v);
+    return res;
+}
+
+static int pyzxc_dict_set_type(PyObject *dict, const char *key, uint64_t blocks,
+                               uint64_t bytes, uint64_t comp_bytes) {
+    PyObject *t = PyDict_New();
+    if (!t)
+        return -1;
+    int res = (pyzxc_dict_set(t, "blocks", blocks) < 0 ||
+               pyzxc_dict_set(t, "bytes", bytes) < 0 ||
+               pyzxc_dict_set(t, "compressed_bytes", comp_bytes) < 0)
+                  ? -1
+                  : PyDict_SetItemString(dict, key, t);
+    Py_DECREF(t);
+    return res;
+}
+
+// Builds the stats dict: totals, times in nanoseconds, one entry per block type.
+static PyObject *pyzxc_perf_dict(const zxc_perf_stats_t *p) {
+    const zxc_block_stats_t *b = &p->blocks;
+    PyObject *d = PyDict_New();
+    if (!d)
+        return NULL;
+    if (pyzxc_dict_set(d, "bytes_in", p->bytes_in) < 0 ||
+        pyzxc_dict_set(d, "bytes_out", p->bytes_out) < 0 ||
+        pyzxc_dict_set(d, "wall_ns", p->wall_ns) < 0 ||
+        pyzxc_dict_set(d, "read_ns", p->read_ns) < 0 ||
+        pyzxc_dict_set(d, "read_wait_ns", p->read_wait_ns) < 0 ||
+        pyzxc_dict_set(d, "work_ns", p->work_ns) < 0 ||
+        pyzxc_dict_set(d, "work_wait_ns", p->work_wait_ns) < 0 ||
+        pyzxc_dict_set(d, "write_ns", p->write_ns) < 0 ||
+        pyzxc_dict_set(d, "write_wait_ns", p->write_wait_ns) < 0 ||
+        pyzxc_dict_set(d, "checksum_ns", p->checksum_ns) < 0 ||
+        pyzxc_dict_set_type(d, "raw", b->raw_blocks, b->raw_bytes,
+                            b->raw_comp_bytes) < 0 ||
+        pyzxc_dict_set_type(d, "glo", b->glo_blocks, b->glo_bytes,
+                            b->glo_comp_bytes) < 0 ||
+        pyzxc_dict_set_type(d, "ghi", b->ghi_blocks, b->ghi_bytes,
+                            b->ghi_comp_bytes) < 0 ||
+        pyzxc_dict_set_type(d, "num", b->num_blocks, b->num_bytes,
+                            b->num_comp_bytes) < 0) {
+        Py_DECREF(d);
+        return NULL;
+    }
+    return d;
+}
+
+// Returns `result`, or (result, stats) when the counters were asked for.
+// Steals the reference to `result`.
+static PyObject *pyzxc_with_stats(PyObject *result, int want,
+                                  const zxc_perf_stats_t *p) {
+    if (!result || !want)
+        return result;
+    PyObject *d = pyzxc_perf_dict(p);
+    if (!d) {
+        Py_DECREF(result);
+        return NULL;
+    }
+    return Py_BuildValue("(NN)", result, d);
+}
+
 // =============================================================================
 // Wrapper functions
 // =============================================================================
@@ -51,11 +154,26 @@ static PyObject *pyzxc_compress(PyObject *self, PyObject *args,
                                 PyObject *kwargs);
 static PyObject *pyzxc_decompress(PyObject *self, PyObject *args,
                                   PyObject *kwargs);
+static PyObject *pyzxc_compress_typed(PyObject *self, PyObject *args,
+                                      PyObject *kwargs);
+static PyObject *pyzxc_compress_bound(PyObject *self, PyObject *arg);
+static PyObject *pyzxc_get_active_isa(PyObject *self, PyObject *unused);
+static PyObject *pyzxc_set_isa(PyObject *self, PyObject *arg);
+static PyObject *pyzxc_compress_into(PyObject *self, PyObject *args,
+                                     PyObject *kwargs);
+static PyObject *pyzxc_decompress_into(PyObject *self, PyObject *args,
+                                       PyObject *kwargs);
+static PyObject *pyzxc_compress_many(PyObject *self, PyObject *args,
+                                     PyObject *kwargs);
 static PyObject *pyzxc_stream_compress(PyObject *self, PyObject *args,
                                        PyObject *kwargs);
 static PyObject *pyzxc_stream_decompress(PyObject *self, PyObject *args,
                                          PyObject *kwargs);
 
+static PyTypeObject PyZxcCompressor_Type;
+static PyTypeObject PyZxcStreamCompressor_Type;
+static PyTypeObject PyZxcStreamDecompressor_Type;
+
 // =============================================================================
 // Initialize python module
 // =============================================================================
@@ -64,21 +182,66 @@ PyDoc_STRVAR(zxc_doc,
              "ZXC bindings.\n"
              "\n"
              "API:\n"
-             "  compress(data, level=5, checksum=False) -> bytes\n"
-             "  decompress(data, checksum=False) -> bytes\n"
-             "  stream_compress(src, dst, level=5, checksum=False) -> None\n"
-             "  stream_decompress(src, dst, checksum=False) -> None\n");
+             "  compress(data, *, level=3, checksum=False, block_size=0, stats=False) -> bytes\n"
+             "  compress_typed(data, itemsize=None, *, level=3, checksum=False, block_size=0) -> bytes\n"
+             "  decompress(data, original_size=None, checksum=False, stats=False) -> bytes\n"
+             "  compress_bound(size) -> int\n"
+             "  get_active_isa() -> str\n"
+             "  set_isa(name) -> None\n"
+             "  compress_into(data, dst, *, level=3, checksum=False, block_size=0) -> int\n"
+             "  decompress_into(data, dst, checksum=False) -> int\n"
+             "  compress_many(buffers, *, level=3, checksum=False, block_size=0, n_threads=0,\n"
+             "                stats=False) -> list\n"
+             "  stream_compress(src, dst, n_threads=0, level=3, checksum=False, block_size=0,\n"
+             "                  stats=False) -> dict | None\n"
+             "  stream_decompress(src, dst, n_threads=0, checksum=False, stats=False) -> dict | None\n"
+             "  Compressor(level=3, checksum=False, block_size=0)\n"
+             "  ZxcCompressor(level=3, checksum=False, block_size=0)\n"
+             "  ZxcDecompressor(checksum=False)\n");
 
 static PyMethodDef zxc_methods[] = {
     {"pyzxc_compress", (PyCFunction)pyzxc_compress, METH_VARARGS | METH_KEYWORDS, NULL},
+    {"pyzxc_compress_typed", (PyCFunction)pyzxc_compress_typed, METH_VARARGS | METH_KEYWORDS, NULL},
     {"pyzxc_decompress", (PyCFunction)pyzxc_decompress, METH_VARARGS | METH_KEYWORDS, NULL},
+    {"pyzxc_compress_bound", (PyCFunction)pyzxc_compress_bound, METH_O, NULL},
+    {"pyzxc_get_active_isa", (PyCFunction)pyzxc_get_active_isa, METH_NOARGS, NULL},
+    {"pyzxc_set_isa", (PyCFunction)pyzxc_set_isa, METH_O, NULL},
+    {"pyzxc_compress_into", (PyCFunction)pyzxc_compress_into, METH_VARARGS | METH_KEYWORDS, NULL},
+    {"pyzxc_decompress_into", (PyCFunction)pyzxc_decompress_into, METH_VARARGS | METH_KEYWORDS, NULL},
+    {"pyzxc_compress_many", (PyCFunction)pyzxc_compress_many, METH_VARARGS | METH_KEYWORDS, NULL},
     {"pyzxc_stream_compress", (PyCFunction)pyzxc_stream_compress, METH_VARARGS | METH_KEYWORDS, NULL},
     {"pyzxc_stream_decompress", (PyCFunction)pyzxc_stream_decompress, METH_VARARGS | METH_KEYWORDS, NULL},
     {NULL, NULL, 0, NULL}  // sentinel
 };
 
+static int zxc_add_type(PyObject *module, const char *name,
+                        PyTypeObject *type) {
+    if (PyType_Ready(type) < 0)
+        return -1;
+    Py_INCREF(type);
+    if (PyModule_AddObject(module, name, (PyObject *)type) < 0) {
+        Py_DECREF(type);
+        return -1;
+    }
+    return 0;
+}
+
+static int zxc_module_exec(PyObject *module) {
+    if (zxc_add_type(module, "Compressor", &PyZxcCompressor_Type) < 0 ||
+        zxc_add_type(module, "ZxcCompressor", &PyZxcStreamCompressor_Type) < 0 ||
+        zxc_add_type(module, "ZxcDecompressor",
+                     &PyZxcStreamDecompressor_Type) < 0)
+        return -1;
+    return 0;
+}
+
+static PyModuleDef_Slot zxc_slots[] = {
+    {Py_mod_exec, zxc_module_exec},
+    {0, NULL}  // sentinel
+};
+
 static struct PyModuleDef zxc_module = {PyModuleDef_HEAD_INIT, "_zxc", zxc_doc,
-                                        0, zxc_methods};
+                                        0, zxc_methods, zxc_slots};
 
 PyMODINIT_FUNC PyInit__zxc(void) { return PyModuleDef_Init(&zxc_module); }
 
@@ -91,11 +254,14 @@ static PyObject *pyzxc_compress(PyObject *self, PyObject *args,
     Py_buffer view;
     int level = ZXC_LEVEL_DEFAULT;
     int checksum = 0;
+    Py_ssize_t block_size = 0;
+    int stats = 0;
 
-    static char *kwlist[] = {"data", "level", "checksum", NULL};
+    static char *kwlist[] = {"data", "level", "checksum", "block_size", "stats",
+                             NULL};
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*|ip", kwlist, &view,
-                                     &level, &checksum)) {
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*|ipnp", kwlist, &view,
+                                     &level, &checksum, &block_size, &stats)) {
         return NULL;
     }
 
@@ -106,6 +272,11 @@ static PyObject *pyzxc_compress(PyObject *self, PyObject *args,
         return NULL;
     }
 
+    if (pyzxc_check_block_size(block_size) < 0) {
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
     size_t src_size = (size_t)view.len;
 
     size_t bound = zxc_compress_bound(src_size);
@@ -118,15 +289,18 @@ static PyObject *pyzxc_compress(PyObject *self, PyObject *args,
 
     char *dst = PyBytes_AsString(out); // Return a pointer to the contents
     size_t n_write;                    // The number of bytes written to dst
+    zxc_perf_stats_t perf = {0};
 
     Py_BEGIN_ALLOW_THREADS
-    n_write = zxc_compress(view.buf, // Source buffer
-                            src_size, // Source size
-                            dst,      // Destination buffer
-                            bound,    // Destination capacity
-                            level,    // Compression level
-                            checksum  // Checksum
+    zxc_compress_opts_t opts = {level, checksum, 0, (size_t)block_size};
+    zxc_perf_capture(stats ? &perf : NULL);
+    n_write = zxc_compress_ex(view.buf, // Source buffer
+                              src_size, // Source size
+                              dst,      // Destination buffer
+                              bound,    // Destination capacity
+                              &opts     // Level, checksum, block size
     );
+    zxc_perf_capture(NULL);
     Py_END_ALLOW_THREADS
 
     PyBuffer_Release(&view);
@@ -140,6 +314,79 @@ static PyObject *pyzxc_compress(PyObject *self, PyObject *args,
     if (_PyBytes_Resize(&out, (Py_ssize_t)n_write) < 0) // Realloc
         return NULL;                                 
 
+    return pyzxc_with_stats(out, stats, &perf);
+}
+
+static PyObject *pyzxc_compress_typed(PyObject *self, PyObject *args,
+                                      PyObject *kwargs) {
+    PyObject *obj;
+    Py_buffer view;
+    Py_ssize_t itemsize = 0;
+    int level = ZXC_LEVEL_DEFAULT;
+    int checksum = 0;
+    Py_ssize_t block_size = 0;
+
+    static char *kwlist[] = {"data", "itemsize", "level", "checksum",
+                             "block_size", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|nipn", kwlist, &obj,
+                                     &itemsize, &level, &checksum,
+                                     &block_size)) {
+        return NULL;
+    }
+
+    // A contiguous (ND) request makes the exporter report its real itemsize
+    // (e.g. numpy's dtype.itemsize) instead of a flat byte view.
+    if (PyObject_GetBuffer(obj, &view, PyBUF_C_CONTIGUOUS) < 0)
+        return NULL;
+
+    if (itemsize == 0)
+        itemsize = view.itemsize;
+    if (itemsize < 1 || itemsize > ZXC_ELEM_SIZE_MAX) {
+        PyBuffer_Release(&view);
+        Py_Return_Err(PyExc_ValueError, "itemsize must be in 1..256");
+    }
+    if (view.len % itemsize != 0) {
+        PyBuffer_Release(&view);
+        Py_Return_Err(PyExc_ValueError,
+                      "data size is not a multiple of itemsize");
+    }
+    if (pyzxc_check_block_size(block_size) < 0) {
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
+    size_t src_size = (size_t)view.len;
+    size_t bound = zxc_compress_bound(src_size);
+
+    PyObject *out = PyBytes_FromStringAndSize(NULL, (Py_ssize_t)bound);
+    if (!out) {
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
+    char *dst = PyBytes_AsString(out);
+    size_t n_write;
+
+    Py_BEGIN_ALLOW_THREADS
+    zxc_compress_opts_t opts = {level, checksum, 0, (size_t)block_size};
+    n_write = zxc_compress_typed(view.buf,                     // Source array
+                                 src_size / (size_t)itemsize,  // Elements
+                                 (size_t)itemsize,             // Element size
+                                 dst, bound, &opts);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&view);
+
+    if (n_write == 0) {
+        Py_DECREF(out);
+        PyErr_SetString(PyExc_RuntimeError, "zxc_compress_typed failed");
+        return NULL;
+    }
+
+    if (_PyBytes_Resize(&out, (Py_ssize_t)n_write) < 0)
+        return NULL;
+
     return out;
 }
 
@@ -148,11 +395,12 @@ static PyObject *pyzxc_decompress(PyObject *self, PyObject *args,
     Py_buffer view;
     int checksum = 0;
 
-    Py_ssize_t original_size;
-    static char *kwlist[] = {"data", "original_size", "checksum", NULL};
+    Py_ssize_t original_size = -1;
+    int stats = 0;
+    static char *kwlist[] = {"data", "original_size", "checksum", "stats", NULL};
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*n|p", kwlist, &view,
-                                     &original_size, &checksum)) {
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*|npp", kwlist, &view,
+                                     &original_size, &checksum, &stats)) {
         return NULL;
     }
 
@@ -165,6 +413,25 @@ static PyObject *pyzxc_decompress(PyObject *self, PyObject *args,
 
     size_t src_size = (size_t)view.len;
 
+    if (pyzxc_is_empty_frame(view.buf, src_size)) {
+        PyBuffer_Release(&view);
+        zxc_perf_stats_t none = {0};
+        return pyzxc_with_stats(PyBytes_FromStringAndSize(NULL, 0), stats,
+                                &none);
+    }
+
+    // No size given: read it from the frame, so the output is allocated once
+    if (original_size < 0) {
+        size_t content_size = zxc_get_decompressed_size(view.buf, src_size);
+        if (content_size == 0 || content_size > (size_t)PY_SSIZE_T_MAX) {
+            PyBuffer_Release(&view);
+            PyErr_SetString(PyExc_ValueError,
+                            "couldn't determine the decompressed size");
+            return NULL;
+        }
+        original_size = (Py_ssize_t)content_size;
+    }
+
     PyObject *out = PyBytes_FromStringAndSize(NULL, (Py_ssize_t)original_size);
     if (!out) {
         PyBuffer_Release(&view);
@@ -173,14 +440,17 @@ static PyObject *pyzxc_decompress(PyObject *self, PyObject *args,
 
     char *dst = PyBytes_AsString(out); // Return a pointer to the contents
     size_t nwritten;                   // The number of bytes written to dst
+    zxc_perf_stats_t perf = {0};
 
     Py_BEGIN_ALLOW_THREADS
+    zxc_perf_capture(stats ? &perf : NULL);
     nwritten = zxc_decompress(view.buf,      // Source buffer
                                 src_size,      // Source size
                                 dst,           // Destination buffer
                                 original_size, // Destination capacity
                                 checksum       // Verify checksum
     );
+    zxc_perf_capture(NULL);
     Py_END_ALLOW_THREADS
 
     PyBuffer_Release(&view);
@@ -191,7 +461,427 @@ static PyObject *pyzxc_decompress(PyObject *self, PyObject *args,
         return NULL;
     }
 
-    return out;
+    if (nwritten != (size_t)original_size &&
+        _PyBytes_Resize(&out, (Py_ssize_t)nwritten) < 0)
+        return NULL;
+
+    return pyzxc_with_stats(out, stats, &perf);
+}
+
+static PyObject *pyzxc_compress_bound(PyObject *self, PyObject *arg) {
+    Py_ssize_t size = PyLong_AsSsize_t(arg);
+    if (size == -1 && PyErr_Occurred())
+        return NULL;
+    if (size < 0)
+        Py_Return_Err(PyExc_ValueError, "size must be non-negative");
+    return PyLong_FromSize_t(zxc_compress_bound((size_t)size));
+}
+
+static PyObject *pyzxc_get_active_isa(PyObject *self, PyObject *unused) {
+    return PyUnicode_FromString(zxc_isa_name(zxc_get_active_isa()));
+}
+
+static PyObject *pyzxc_set_isa(PyObject *self, PyObject *arg) {
+    const char *name = PyUnicode_AsUTF8(arg);
+    if (!name)
+        return NULL;
+    int isa = zxc_isa_from_name(name);
+    if (isa < 0)
+        Py_Return_Err(PyExc_ValueError,
+                      "isa must be 'auto', 'generic', 'avx2', 'avx512' or 'neon'");
+    if (zxc_set_isa((zxc_isa_t)isa) != 0)
+        Py_Return_Err(PyExc_ValueError,
+                      "instruction set not available in this build or on this CPU");
+    Py_RETURN_NONE;
+}
+
+// Into-buffer variants: the caller owns the output (bytearray, memoryview,
+// numpy array, mmap, shared memory...), so nothing is allocated or copied here.
+// Any writable C-contiguous buffer is accepted, whatever its item type.
+
+static PyObject *pyzxc_compress_into(PyObject *self, PyObject *args,
+                                     PyObject *kwargs) {
+    Py_buffer view;
+    Py_buffer out;
+    int level = ZXC_LEVEL_DEFAULT;
+    int checksum = 0;
+    Py_ssize_t block_size = 0;
+
+    static char *kwlist[] = {"data", "dst", "level", "checksum", "block_size",
+                             NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*w*|ipn", kwlist, &view,
+                                     &out, &level, &checksum, &block_size)) {
+        return NULL;
+    }
+
+    if (view.itemsize != 1) {
+        PyBuffer_Release(&view);
+        PyBuffer_Release(&out);
+        PyErr_SetString(PyExc_TypeError,
+                        "expected a byte buffer (itemsize==1)");
+        return NULL;
+    }
+
+    if (pyzxc_check_block_size(block_size) < 0) {
+        PyBuffer_Release(&view);
+        PyBuffer_Release(&out);
+        return NULL;
+    }
+
+    size_t n_write;
+
+    Py_BEGIN_ALLOW_THREADS
+    zxc_compress_opts_t opts = {level, checksum, 0, (size_t)block_size};
+    n_write = zxc_compress_ex(view.buf, (size_t)view.len, out.buf,
+                              (size_t)out.len, &opts);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&view);
+    PyBuffer_Release(&out);
+
+    if (n_write == 0)
+        Py_Return_Err(PyExc_RuntimeError,
+                      "zxc_compress failed (destination too small?)");
+
+    return PyLong_FromSize_t(n_write);
+}
+
+static PyObject *pyzxc_decompress_into(PyObject *self, PyObject *args,
+                                       PyObject *kwargs) {
+    Py_buffer view;
+    Py_buffer out;
+    int checksum = 0;
+
+    static char *kwlist[] = {"data", "dst", "checksum", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*w*|p", kwlist, &view,
+                                     &out, &checksum)) {
+        return NULL;
+    }
+
+    if (view.itemsize != 1) {
+        PyBuffer_Release(&view);
+        PyBuffer_Release(&out);
+        PyErr_SetString(PyExc_TypeError,
+                        "expected a byte buffer (itemsize==1)");
+        return NULL;
+    }
+
+    size_t nwritten;
+
+    Py_BEGIN_ALLOW_THREADS
+    nwritten = zxc_decompress(view.buf, (size_t)view.len, out.buf,
+                              (size_t)out.len, checksum);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&view);
+    PyBuffer_Release(&out);
+
+    if (nwritten == 0)
+        Py_Return_Err(PyExc_RuntimeError,
+                      "zxc_decompress failed (destination too small?)");
+
+    return PyLong_FromSize_t(nwritten);
+}
+
+// =============================================================================
+// Batch compression
+// =============================================================================
+// compress_many() hands the whole list to zxc_compress_batch() in one call,
+// with the GIL released once. n_threads=0 runs on a pool shared by every call
+// of the process (created on first use, and again in a forked child, whose
+// copy of the parent's pool has no threads); n_threads=1 stays on the calling
+// thread; other values start a pool of that size for the call.
+
+static zxc_pool_t *pyzxc_shared_pool = NULL;
+#ifndef _WIN32
+static pid_t pyzxc_shared_pool_pid = 0;
+#endif
+
+// Returns the shared pool. Called with the GIL, which serializes creation.
+static zxc_pool_t *pyzxc_get_shared_pool(void) {
+#ifndef _WIN32
+    if (pyzxc_shared_pool && pyzxc_shared_pool_pid != getpid())
+        pyzxc_shared_pool = NULL;  // Inherited through fork(): unusable
+#endif
+    if (!pyzxc_shared_pool) {
+        pyzxc_shared_pool = zxc_pool_create(0);
+#ifndef _WIN32
+        pyzxc_shared_pool_pid = getpid();
+#endif
+    }
+    return pyzxc_shared_pool;
+}
+
+static PyObject *pyzxc_compress_many(PyObject *self, PyObject *args,
+                                     PyObject *kwargs) {
+    PyObject *buffers;
+    int level = ZXC_LEVEL_DEFAULT;
+    int checksum = 0;
+    Py_ssize_t block_size = 0;
+    int n_threads = 0;
+    int stats = 0;
+
+    static char *kwlist[] = {"buffers",   "level", "checksum", "block_size",
+                             "n_threads", "stats", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|ipnip", kwlist, &buffers,
+                                     &level, &checksum, &block_size,
+                                     &n_threads, &stats)) {
+        return NULL;
+    }
+
+    if (pyzxc_check_block_size(block_size) < 0)
+        return NULL;
+    if (n_threads < 0)
+        Py_Return_Err(PyExc_ValueError, "n_threads must be non-negative");
+
+    PyObject *seq = PySequence_Fast(buffers, "buffers must be a sequence");
+    if (!seq)
+        return NULL;
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+
+    Py_buffer *views = PyMem_Calloc((size_t)n + 1, sizeof(Py_buffer));
+    zxc_buf_t *in = PyMem_Calloc((size_t)n + 1, sizeof(zxc_buf_t));
+    zxc_buf_t *out = PyMem_Calloc((size_t)n + 1, sizeof(zxc_buf_t));
+    PyObject *result = PyList_New(n);
+    Py_ssize_t n_views = 0;
+    if (!views || !in || !out) {
+        PyErr_NoMemory();
+        goto cleanup;
+    }
+    if (!result)
+        goto cleanup;
+
+    // Views and outputs are set up with the GIL, the compression runs without.
+    for (; n_views < n; n_views++) {
+        Py_buffer *view = &views[n_views];
+        if (PyObject_GetBuffer(PySequence_Fast_GET_ITEM(seq, n_views), view,
+                               PyBUF_SIMPLE) < 0)
+            goto cleanup;
+        if (view->itemsize != 1) {
+            PyBuffer_Release(view);
+            PyErr_SetString(PyExc_TypeError,
+                            "expected byte buffers (itemsize==1)");
+            goto cleanup;
+        }
+        if (view->len == 0) {
+            // Like compress(): a frame holds at least one byte.
+            PyBuffer_Release(view);
+            PyErr_Format(PyExc_ValueError, "buffers[%zd] is empty", n_views);
+            goto cleanup;
+        }
+        size_t bound = zxc_compress_bound((size_t)view->len);
+        PyObject *frame = PyBytes_FromStringAndSize(NULL, (Py_ssize_t)bound);
+        if (!frame) {
+            PyBuffer_Release(view);
+            goto cleanup;
+        }
+        PyList_SET_ITEM(result, n_views, frame);
+        in[n_views].data = view->buf;
+        in[n_views].size = (size_t)view->len;
+        out[n_views].data = PyBytes_AsString(frame);
+        out[n_views].capacity = bound;
+    }
+
+    zxc_pool_t *pool = NULL;
+    if (n_threads == 0) {
+        pool = pyzxc_get_shared_pool();
+        if (!pool) {
+            PyErr_SetString(PyExc_RuntimeError, "cannot start the thread pool");
+            goto cleanup;
+        }
+    }
+    size_t done = 0;
+    int started = 1;
+    zxc_perf_stats_t perf = {0};
+
+    Py_BEGIN_ALLOW_THREADS
+    zxc_pool_t *own = n_threads > 1 ? zxc_pool_create(n_threads) : NULL;
+    zxc_compress_opts_t opts = {level, checksum, 0, (size_t)block_size};
+    zxc_perf_capture(stats ? &perf : NULL);
+    if (n_threads > 1 && !own)
+        started = 0;
+    else
+        done = zxc_compress_batch(own ? own : pool, in, out, (size_t)n, &opts);
+    zxc_perf_capture(NULL);
+    zxc_pool_free(own);
+    Py_END_ALLOW_THREADS
+
+    if (!started) {
+        PyErr_SetString(PyExc_RuntimeError, "cannot start the thread pool");
+        goto cleanup;
+    }
+    if (done != (size_t)n) {
+        // Failures are per input: report the first one.
+        Py_ssize_t i = 0;
+        while (i < n - 1 && out[i].size != 0)
+            i++;
+        PyErr_Format(PyExc_RuntimeError,
+                     "zxc_compress_batch failed on buffers[%zd]", i);
+        goto cleanup;
+    }
+    for (Py_ssize_t i = 0; i < n; i++) {
+        PyObject *frame = PyList_GET_ITEM(result, i);
+        if (_PyBytes_Resize(&frame, (Py_ssize_t)out[i].size) < 0) {
+            PyList_SET_ITEM(result, i, NULL);  // Released by the resize
+            goto cleanup;
+        }
+        PyList_SET_ITEM(result, i, frame);
+    }
+
+    for (Py_ssize_t i = 0; i < n_views; i++)
+        PyBuffer_Release(&views[i]);
+    PyMem_Free(views);
+    PyMem_Free(in);
+    PyMem_Free(out);
+    Py_DECREF(seq);
+    return pyzxc_with_stats(result, stats, &perf);
+
+cleanup:
+    for (Py_ssize_t i = 0; i < n_views; i++)
+        PyBuffer_Release(&views[i]);
+    PyMem_Free(views);
+    PyMem_Free(in);
+    PyMem_Free(out);
+    Py_XDECREF(result);
+    Py_DECREF(seq);
+    return NULL;
+}
+
+// =============================================================================
+// Callback I/O
+// =============================================================================
+// Fallback of stream_compress / stream_decompress for file objects without a
+// descriptor (io.BytesIO, sockets wrapped by makefile(), custom readers): the
+// engine calls back into Python through readinto()/read() and write(). The
+// reader runs on the calling thread and the writer on the engine's writer
+// thread, both with the GIL released around them, so each callback takes it.
+
+typedef struct {
+    PyObject *src;
+    PyObject *dst;
+    PyObject *exc_type, *exc_value, *exc_tb;  // First Python error raised
+} pyzxc_stream_io_t;
+
+// Records the pending Python exception (first one wins). Called with the GIL.
+static void pyzxc_io_fail(pyzxc_stream_io_t *io) {
+    if (!PyErr_Occurred())
+        PyErr_SetString(PyExc_OSError, "invalid result from file object");
+    if (io->exc_type) {
+        PyErr_Clear();
+        return;
+    }
+    PyErr_Fetch(&io->exc_type, &io->exc_value, &io->exc_tb);
+}
+
+// Releases a memoryview over engine memory so that Python cannot keep it past
+// the callback. A pending exception is preserved.
+static void pyzxc_view_release(PyObject *view) {
+    if (!view)
+        return;
+    PyObject *et, *ev, *tb;
+    PyErr_Fetch(&et, &ev, &tb);
+    PyObject *r = PyObject_CallMethod(view, "release", NULL);
+    if (r)
+        Py_DECREF(r);
+    else
+        PyErr_Clear();
+    PyErr_Restore(et, ev, tb);
+    Py_DECREF(view);
+}
+
+static int64_t pyzxc_io_read(void *opaque, void *buf, size_t len) {
+    pyzxc_stream_io_t *io = (pyzxc_stream_io_t *)opaque;
+    PyGILState_STATE gil = PyGILState_Ensure();
+    int64_t res = -1;
+    if (len > PY_SSIZE_T_MAX)
+        len = PY_SSIZE_T_MAX;
+
+    if (PyObject_HasAttrString(io->src, "readinto")) {
+        PyObject *view =
+            PyMemoryView_FromMemory((char *)buf, (Py_ssize_t)len, PyBUF_WRITE);
+        PyObject *r =
+            view ? PyObject_CallMethod(io->src, "readinto", "O", view) : NULL;
+        pyzxc_view_release(view);
+        if (r && r != Py_None) {
+            Py_ssize_t n = PyLong_AsSsize_t(r);
+            if (n >= 0 && (size_t)n <= len)
+                res = n;
+        }
+        Py_XDECREF(r);
+    } else {
+        PyObject *r = PyObject_CallMethod(io->src, "read", "n", (Py_ssize_t)len);
+        Py_buffer view;
+        if (r && PyObject_GetBuffer(r, &view, PyBUF_SIMPLE) == 0) {
+            if ((size_t)view.len <= len) {
+                memcpy(buf, view.buf, (size_t)view.len);
+                res = view.len;
+            }
+            PyBuffer_Release(&view);
+        }
+        Py_XDECREF(r);
+    }
+
+    if (res < 0)
+        pyzxc_io_fail(io);
+    PyGILState_Release(gil);
+    return res;
+}
+
+static int pyzxc_io_write(void *opaque, const void *buf, size_t len) {
+    pyzxc_stream_io_t *io = (pyzxc_stream_io_t *)opaque;
+    PyGILState_STATE gil = PyGILState_Ensure();
+    int res = 0;
+
+    // Raw files may write less than asked: keep going until all of it is out.
+    while (len > 0 && res == 0) {
+        Py_ssize_t chunk = len > PY_SSIZE_T_MAX ? PY_SSIZE_T_MAX : (Py_ssize_t)len;
+        PyObject *view = PyMemoryView_FromMemory((char *)buf, chunk, PyBUF_READ);
+        PyObject *r = view ? PyObject_CallMethod(io->dst, "write", "O", view) : NULL;
+        pyzxc_view_release(view);
+        Py_ssize_t n = chunk;
+        if (!r)
+            n = -1;
+        else if (r != Py_None)
+            n = PyLong_AsSsize_t(r);
+        Py_XDECREF(r);
+        if (n <= 0 || n > chunk) {
+            res = -1;
+            break;
+        }
+        buf = (const char *)buf + n;
+        len -= (size_t)n;
+    }
+
+    if (res != 0)
+        pyzxc_io_fail(io);
+    PyGILState_Release(gil);
+    return res;
+}
+
+// Tells whether both ends have a usable descriptor; clears the lookup error.
+static int pyzxc_have_fds(PyObject *src, PyObject *dst, int *src_fd,
+                          int *dst_fd) {
+    *src_fd = PyObject_AsFileDescriptor(src);
+    if (*src_fd != -1)
+        *dst_fd = PyObject_AsFileDescriptor(dst);
+    if (*src_fd == -1 || *dst_fd == -1) {
+        PyErr_Clear();
+        return 0;
+    }
+    return 1;
+}
+
+// Raises the error recorded by the callbacks, or a generic one.
+static PyObject *pyzxc_io_raise(pyzxc_stream_io_t *io, const char *msg) {
+    if (io->exc_type) {
+        PyErr_Restore(io->exc_type, io->exc_value, io->exc_tb);
+        return NULL;
+    }
+    PyErr_SetString(PyExc_RuntimeError, msg);
+    return NULL;
 }
 
 static PyObject *pyzxc_stream_compress(PyObject *self, PyObject *args,
@@ -200,20 +890,40 @@ static PyObject *pyzxc_stream_compress(PyObject *self, PyObject *args,
     int nthreads = 0;
     int level = ZXC_LEVEL_DEFAULT;
     int checksum = 0;
+    Py_ssize_t block_size = 0;
+    int stats = 0;
 
-    static char *kwlist[] = {"src",   "dst",      "n_threads",
-                             "level", "checksum", NULL};
+    static char *kwlist[] = {"src",      "dst",        "n_threads", "level",
+                             "checksum", "block_size", "stats",     NULL};
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|iip", kwlist, &src, &dst,
-                                     &nthreads, &level, &checksum)) {
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|iipnp", kwlist, &src,
+                                     &dst, &nthreads, &level, &checksum,
+                                     &block_size, &stats)) {
         return NULL;
     }
 
-    int src_fd = PyObject_AsFileDescriptor(src);
-    int dst_fd = PyObject_AsFileDescriptor(dst);
+    if (pyzxc_check_block_size(block_size) < 0)
+        return NULL;
 
-    if (src_fd == -1 || dst_fd == -1)
-        Py_Return_Err(PyExc_RuntimeError, "couldn't get file descriptor");
+    zxc_compress_opts_t opts = {level, checksum, 0, (size_t)block_size};
+    int64_t nwritten;
+    zxc_perf_stats_t perf = {0};
+
+    int src_fd, dst_fd;
+    if (!pyzxc_have_fds(src, dst, &src_fd, &dst_fd)) {
+        pyzxc_stream_io_t io = {src, dst, NULL, NULL, NULL};
+        Py_BEGIN_ALLOW_THREADS
+        zxc_perf_capture(stats ? &perf : NULL);
+        nwritten = zxc_stream_compress_cb(pyzxc_io_read, pyzxc_io_write, &io,
+                                          nthreads, &opts);
+        zxc_perf_capture(NULL);
+        Py_END_ALLOW_THREADS
+        if (nwritten < 0)
+            return pyzxc_io_raise(&io, "zxc_stream_compress failed");
+        if (stats)
+            return pyzxc_perf_dict(&perf);
+        Py_RETURN_NONE;
+    }
 
     int src_dup = zxc_dup(src_fd);
     if (src_dup == -1) {
@@ -239,10 +949,10 @@ static PyObject *pyzxc_stream_compress(PyObject *self, PyObject *args,
         Py_Return_Errno(PyExc_OSError);
     }
 
-    int nwritten;
-
     Py_BEGIN_ALLOW_THREADS 
-    nwritten = zxc_stream_compress(fsrc, fdst, nthreads, level, checksum);
+    zxc_perf_capture(stats ? &perf : NULL);
+    nwritten = zxc_stream_compress_ex(fsrc, fdst, nthreads, &opts);
+    zxc_perf_capture(NULL);
     Py_END_ALLOW_THREADS
 
     fclose(fdst);
@@ -251,6 +961,8 @@ static PyObject *pyzxc_stream_compress(PyObject *self, PyObject *args,
     if (nwritten < 0)
         Py_Return_Err(PyExc_RuntimeError, "zxc_stream_compress failed");
 
+    if (stats)
+        return pyzxc_perf_dict(&perf);
     Py_RETURN_NONE;
 }
 
@@ -259,19 +971,34 @@ static PyObject *pyzxc_stream_decompress(PyObject *self, PyObject *args,
     PyObject *src, *dst;
     int nthreads = 0;
     int checksum = 0;
+    int stats = 0;
 
-    static char *kwlist[] = {"src", "dst", "n_threads", "checksum", NULL};
+    static char *kwlist[] = {"src", "dst", "n_threads", "checksum", "stats",
+                             NULL};
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|ip", kwlist, &src, &dst,
-                                     &nthreads, &checksum)) {
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|ipp", kwlist, &src, &dst,
+                                     &nthreads, &checksum, &stats)) {
         return NULL;
     }
 
-    int src_fd = PyObject_AsFileDescriptor(src);
-    int dst_fd = PyObject_AsFileDescriptor(dst);
-
-    if (src_fd == -1 || dst_fd == -1)
-        Py_Return_Err(PyExc_RuntimeError, "couldn't get file descriptor");
+    int64_t nwritten;
+    zxc_perf_stats_t perf = {0};
+
+    int src_fd, dst_fd;
+    if (!pyzxc_have_fds(src, dst, &src_fd, &dst_fd)) {
+        pyzxc_stream_io_t io = {src, dst, NULL, NULL, NULL};
+        Py_BEGIN_ALLOW_THREADS
+        zxc_perf_capture(stats ? &perf : NULL);
+        nwritten = zxc_stream_decompress_cb(pyzxc_io_read, pyzxc_io_write, &io,
+                                            nthreads, checksum);
+        zxc_perf_capture(NULL);
+        Py_END_ALLOW_THREADS
+        if (nwritten < 0)
+            return pyzxc_io_raise(&io, "zxc_stream_decompress failed");
+        if (stats)
+            return pyzxc_perf_dict(&perf);
+        Py_RETURN_NONE;
+    }
 
     int src_dup = zxc_dup(src_fd);
     if (src_dup == -1) {
@@ -297,10 +1024,10 @@ static PyObject *pyzxc_stream_decompress(PyObject *self, PyObject *args,
         Py_Return_Errno(PyExc_OSError);
     }
 
-    int nwritten;
-
     Py_BEGIN_ALLOW_THREADS 
+    zxc_perf_capture(stats ? &perf : NULL);
     nwritten = zxc_stream_decompress(fsrc, fdst, nthreads, checksum);
+    zxc_perf_capture(NULL);
     Py_END_ALLOW_THREADS
 
     fclose(fdst);
@@ -309,5 +1036,602 @@ static PyObject *pyzxc_stream_decompress(PyObject *self, PyObject *args,
     if (nwritten < 0)
         Py_Return_Err(PyExc_RuntimeError, "zxc_stream_decompress failed");
 
+    if (stats)
+        return pyzxc_perf_dict(&perf);
     Py_RETURN_NONE;
 }
+
+// =============================================================================
+// Compressor object
+// =============================================================================
+// Keeps a zxc_cctx/zxc_dctx alive between calls so that many small buffers do
+// not pay for the context setup every time. The lock serializes calls made
+// concurrently from several Python threads (the GIL is released while working).
+
+typedef struct {
+    PyObject_HEAD
+    zxc_cctx *cctx;
+    zxc_dctx *dctx;
+    int level;
+    int checksum;
+    size_t block_size;
+    PyThread_type_lock lock;
+} PyZxcCompressor;
+
+static int PyZxcCompressor_init(PyZxcCompressor *self, PyObject *args,
+                                PyObject *kwargs) {
+    int level = ZXC_LEVEL_DEFAULT;
+    int checksum = 0;
+    Py_ssize_t block_size = 0;
+
+    static char *kwlist[] = {"level", "checksum", "block_size", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|ipn", kwlist, &level,
+                                     &checksum, &block_size)) {
+        return -1;
+    }
+    if (pyzxc_check_block_size(block_size) < 0)
+        return -1;
+
+    self->level = level;
+    self->checksum = checksum;
+    self->block_size = (size_t)block_size;
+
+    if (!self->lock) {
+        self->lock = PyThread_allocate_lock();
+        if (!self->lock) {
+            PyErr_NoMemory();
+            return -1;
+        }
+    }
+    if (!self->cctx && !(self->cctx = zxc_create_cctx())) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    if (!self->dctx && !(self->dctx = zxc_create_dctx())) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    return 0;
+}
+
+static void PyZxcCompressor_dealloc(PyZxcCompressor *self) {
+    zxc_free_cctx(self->cctx);
+    zxc_free_dctx(self->dctx);
+    if (self->lock)
+        PyThread_free_lock(self->lock);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *PyZxcCompressor_compress(PyZxcCompressor *self,
+                                          PyObject *args, PyObject *kwargs) {
+    Py_buffer view;
+
+    static char *kwlist[] = {"data", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*", kwlist, &view)) {
+        return NULL;
+    }
+
+    if (!self->cctx) {
+        PyBuffer_Release(&view);
+        Py_Return_Err(PyExc_RuntimeError, "Compressor is not initialized");
+    }
+
+    size_t src_size = (size_t)view.len;
+    size_t bound = zxc_compress_bound(src_size);
+
+    PyObject *out = PyBytes_FromStringAndSize(NULL, (Py_ssize_t)bound);
+    if (!out) {
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
+    char *dst = PyBytes_AsString(out);
+    size_t n_write;
+    zxc_compress_opts_t opts = {self->level, self->checksum, 0,
+                                self->block_size};
+
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(self->lock, WAIT_LOCK);
+    n_write = zxc_compress_cctx(self->cctx, view.buf, src_size, dst, bound,
+                                &opts);
+    PyThread_release_lock(self->lock);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&view);
+
+    if (n_write == 0) {
+        Py_DECREF(out);
+        Py_Return_Err(PyExc_RuntimeError, "zxc_compress_cctx failed");
+    }
+
+    if (_PyBytes_Resize(&out, (Py_ssize_t)n_write) < 0)
+        return NULL;
+
+    return out;
+}
+
+static PyObject *PyZxcCompressor_decompress(PyZxcCompressor *self,
+                                            PyObject *args, PyObject *kwargs) {
+    Py_buffer view;
+    Py_ssize_t original_size = -1;
+
+    static char *kwlist[] = {"data", "original_size", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*|n", kwlist, &view,
+                                     &original_size)) {
+        return NULL;
+    }
+
+    if (!self->dctx) {
+        PyBuffer_Release(&view);
+        Py_Return_Err(PyExc_RuntimeError, "Compressor is not initialized");
+    }
+
+    size_t src_size = (size_t)view.len;
+
+    if (pyzxc_is_empty_frame(view.buf, src_size)) {
+        PyBuffer_Release(&view);
+        return PyBytes_FromStringAndSize(NULL, 0);
+    }
+
+    if (original_size < 0) {
+        size_t content_size = zxc_get_decompressed_size(view.buf, src_size);
+        if (content_size == 0 || content_size > (size_t)PY_SSIZE_T_MAX) {
+            PyBuffer_Release(&view);
+            Py_Return_Err(PyExc_ValueError,
+                          "couldn't determine the decompressed size");
+        }
+        original_size = (Py_ssize_t)content_size;
+    }
+
+    PyObject *out = PyBytes_FromStringAndSize(NULL, original_size);
+    if (!out) {
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
+    char *dst = PyBytes_AsString(out);
+    size_t nwritten;
+
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(self->lock, WAIT_LOCK);
+    nwritten = zxc_decompress_dctx(self->dctx, view.buf, src_size, dst,
+                                   (size_t)original_size, self->checksum);
+    PyThread_release_lock(self->lock);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&view);
+
+    if (nwritten == 0) {
+        Py_DECREF(out);
+        Py_Return_Err(PyExc_RuntimeError, "zxc_decompress_dctx failed");
+    }
+
+    if (nwritten != (size_t)original_size &&
+        _PyBytes_Resize(&out, (Py_ssize_t)nwritten) < 0)
+        return NULL;
+
+    return out;
+}
+
+static PyMethodDef PyZxcCompressor_methods[] = {
+    {"compress", (PyCFunction)PyZxcCompressor_compress,
+     METH_VARARGS | METH_KEYWORDS,
+     "compress(data) -> bytes\n\nCompress data, reusing the context memory."},
+    {"decompress", (PyCFunction)PyZxcCompressor_decompress,
+     METH_VARARGS | METH_KEYWORDS,
+     "decompress(data, original_size=None) -> bytes\n\n"
+     "Decompress data, reusing the context memory."},
+    {NULL, NULL, 0, NULL}  // sentinel
+};
+
+PyDoc_STRVAR(PyZxcCompressor_doc,
+             "Compressor(level=3, checksum=False, block_size=0)\n"
+             "\n"
+             "Reusable compression context: keeps its working memory between\n"
+             "calls, which makes compressing many small buffers much cheaper.");
+
+static PyTypeObject PyZxcCompressor_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "zxc._zxc.Compressor",
+    .tp_basicsize = sizeof(PyZxcCompressor),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = PyZxcCompressor_doc,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)PyZxcCompressor_init,
+    .tp_dealloc = (destructor)PyZxcCompressor_dealloc,
+    .tp_methods = PyZxcCompressor_methods,
+};
+
+// =============================================================================
+// Incremental compressor / decompressor
+// =============================================================================
+// Produce and consume stream frames piece by piece, on top of the sans-I/O
+// incremental encoder and block primitives: input is buffered up to a whole
+// block, every complete block is coded with the GIL released, and the lock
+// serializes calls made concurrently on the same object. Nothing is ever read
+// from or written to a file descriptor, so chunks can come from sockets, HTTP
+// bodies or asyncio.
+
+typedef struct {
+    PyObject_HEAD
+    zxc_cstream_t cs;
+    int ready;
+    PyThread_type_lock lock;
+} PyZxcStreamCompressor;
+
+static int PyZxcStreamCompressor_init(PyZxcStreamCompressor *self,
+                                      PyObject *args, PyObject *kwargs) {
+    int level = ZXC_LEVEL_DEFAULT;
+    int checksum = 0;
+    Py_ssize_t block_size = 0;
+
+    static char *kwlist[] = {"level", "checksum", "block_size", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|ipn", kwlist, &level,
+                                     &checksum, &block_size)) {
+        return -1;
+    }
+    if (pyzxc_check_block_size(block_size) < 0)
+        return -1;
+
+    if (!self->lock && !(self->lock = PyThread_allocate_lock())) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    if (self->ready)
+        zxc_cstream_free(&self->cs);
+    self->ready = 0;
+    if (zxc_cstream_init(&self->cs, (size_t)block_size, level, checksum) != 0) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    self->ready = 1;
+    return 0;
+}
+
+static void PyZxcStreamCompressor_dealloc(PyZxcStreamCompressor *self) {
+    if (self->ready)
+        zxc_cstream_free(&self->cs);
+    if (self->lock)
+        PyThread_free_lock(self->lock);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+// Largest input handed to one zxc_cstream_compress() call, whose output size
+// must fit in an int.
+#define PYZXC_CSTREAM_STEP ((size_t)1 << 30)
+
+enum { PYZXC_CSTREAM_DATA, PYZXC_CSTREAM_FLUSH, PYZXC_CSTREAM_END };
+
+// Feeds src to the encoder, then flushes or ends the frame as asked, and
+// returns the output as a new bytes object. The lock is held by the caller.
+static PyObject *zxc_stream_compress_chunk(PyZxcStreamCompressor *self,
+                                           const uint8_t *src, size_t len,
+                                           int op) {
+    size_t cap = zxc_cstream_bound(self->cs.block_size, len);
+    if (cap == 0 || cap > (size_t)PY_SSIZE_T_MAX)
+        return PyErr_NoMemory();
+
+    PyObject *out = PyBytes_FromStringAndSize(NULL, (Py_ssize_t)cap);
+    if (!out)
+        return NULL;
+    uint8_t *dst = (uint8_t *)PyBytes_AsString(out);
+    size_t pos = 0;
+    int res = 0;
+
+    Py_BEGIN_ALLOW_THREADS
+    while (res >= 0 && len > 0) {
+        size_t take = len < PYZXC_CSTREAM_STEP ? len : PYZXC_CSTREAM_STEP;
+        res = zxc_cstream_compress(&self->cs, src, take, dst + pos, cap - pos);
+        if (res >= 0)
+            pos += (size_t)res;
+        src += take;
+        len -= take;
+    }
+    if (res >= 0 && op == PYZXC_CSTREAM_FLUSH)
+        res = zxc_cstream_flush(&self->cs, dst + pos, cap - pos);
+    else if (res >= 0 && op == PYZXC_CSTREAM_END)
+        res = zxc_cstream_end(&self->cs, dst + pos, cap - pos);
+    if (res >= 0 && op != PYZXC_CSTREAM_DATA)
+        pos += (size_t)res;
+    Py_END_ALLOW_THREADS
+
+    if (res < 0) {
+        Py_DECREF(out);
+        Py_Return_Err(PyExc_RuntimeError, "zxc_cstream_compress failed");
+    }
+    if (_PyBytes_Resize(&out, (Py_ssize_t)pos) < 0)
+        return NULL;
+    return out;
+}
+
+static PyObject *PyZxcStreamCompressor_compress(PyZxcStreamCompressor *self,
+                                                PyObject *args,
+                                                PyObject *kwargs) {
+    Py_buffer view;
+
+    static char *kwlist[] = {"data", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*", kwlist, &view)) {
+        return NULL;
+    }
+    if (!self->ready) {
+        PyBuffer_Release(&view);
+        Py_Return_Err(PyExc_RuntimeError, "ZxcCompressor is not initialized");
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(self->lock, WAIT_LOCK);
+    Py_END_ALLOW_THREADS
+    PyObject *out = zxc_stream_compress_chunk(self, view.buf, (size_t)view.len,
+                                              PYZXC_CSTREAM_DATA);
+    PyThread_release_lock(self->lock);
+
+    PyBuffer_Release(&view);
+    return out;
+}
+
+// flush() and end(): nothing to feed, then close the block or the frame.
+static PyObject *zxc_stream_compress_close(PyZxcStreamCompressor *self,
+                                           int op) {
+    if (!self->ready)
+        Py_Return_Err(PyExc_RuntimeError, "ZxcCompressor is not initialized");
+
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(self->lock, WAIT_LOCK);
+    Py_END_ALLOW_THREADS
+    PyObject *out = zxc_stream_compress_chunk(self, NULL, 0, op);
+    PyThread_release_lock(self->lock);
+    return out;
+}
+
+static PyObject *PyZxcStreamCompressor_flush(PyZxcStreamCompressor *self,
+                                             PyObject *unused) {
+    return zxc_stream_compress_close(self, PYZXC_CSTREAM_FLUSH);
+}
+
+static PyObject *PyZxcStreamCompressor_end(PyZxcStreamCompressor *self,
+                                           PyObject *unused) {
+    return zxc_stream_compress_close(self, PYZXC_CSTREAM_END);
+}
+
+static PyMethodDef PyZxcStreamCompressor_methods[] = {
+    {"compress", (PyCFunction)PyZxcStreamCompressor_compress,
+     METH_VARARGS | METH_KEYWORDS,
+     "compress(data) -> bytes\n\n"
+     "Feed data; returns the part of the frame completed so far (whole\n"
+     "blocks only, possibly empty)."},
+    {"flush", (PyCFunction)PyZxcStreamCompressor_flush, METH_NOARGS,
+     "flush() -> bytes\n\n"
+     "Encode the buffered data as a (short) block and return it. The frame\n"
+     "stays open: compress() may be called again, and the output so far\n"
+     "is a complete frame."},
+    {"end", (PyCFunction)PyZxcStreamCompressor_end, METH_NOARGS,
+     "end() -> bytes\n\n"
+     "Flush, then close the frame with an END block. The next compress()\n"
+     "starts a new frame; ZxcDecompressor reads such frames back to back."},
+    {NULL, NULL, 0, NULL}  // sentinel
+};
+
+PyDoc_STRVAR(PyZxcStreamCompressor_doc,
+             "ZxcCompressor(level=3, checksum=False, block_size=0)\n"
+             "\n"
+             "Incremental compressor producing a stream frame chunk by chunk.");
+
+static PyTypeObject PyZxcStreamCompressor_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "zxc._zxc.ZxcCompressor",
+    .tp_basicsize = sizeof(PyZxcStreamCompressor),
+    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+    .tp_doc = PyZxcStreamCompressor_doc,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)PyZxcStreamCompressor_init,
+    .tp_dealloc = (destructor)PyZxcStreamCompressor_dealloc,
+    .tp_methods = PyZxcStreamCompressor_methods,
+};
+
+typedef struct {
+    PyObject_HEAD
+    zxc_cctx_t dctx;
+    int ready;
+    uint8_t *buf;          // Input not decoded yet
+    size_t len;
+    size_t cap;
+    size_t block_size;     // Of the current frame (0 until its header is read)
+    int checksum;
+    PyThread_type_lock lock;
+} PyZxcStreamDecompressor;
+
+static int PyZxcStreamDecompressor_init(PyZxcStreamDecompressor *self,
+                                        PyObject *args, PyObject *kwargs) {
+    int checksum = 0;
+
+    static char *kwlist[] = {"checksum", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|p", kwlist, &checksum)) {
+        return -1;
+    }
+    if (!self->lock && !(self->lock = PyThread_allocate_lock())) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    if (self->ready)
+        zxc_cctx_free(&self->dctx);
+    self->ready = zxc_cctx_init(&self->dctx, 0, 0, 0, checksum) == 0;
+    self->len = 0;
+    self->block_size = 0;
+    self->checksum = checksum;
+    return 0;
+}
+
+static void PyZxcStreamDecompressor_dealloc(PyZxcStreamDecompressor *self) {
+    if (self->ready)
+        zxc_cctx_free(&self->dctx);
+    free(self->buf);
+    if (self->lock)
+        PyThread_free_lock(self->lock);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+// Appends src to the input and decodes every complete block into a new bytes
+// object. An END block closes the frame; the file header of the next frame
+// may follow it. The lock is held by the caller.
+static PyObject *zxc_stream_decompress_chunk(PyZxcStreamDecompressor *self,
+                                             const uint8_t *src, size_t len) {
+    if (self->len + len > self->cap) {
+        size_t cap = self->cap ? self->cap : 64 * 1024;
+        while (cap < self->len + len)
+            cap *= 2;
+        uint8_t *grown = realloc(self->buf, cap);
+        if (!grown)
+            return PyErr_NoMemory();
+        self->buf = grown;
+        self->cap = cap;
+    }
+    if (len > 0)
+        memcpy(self->buf + self->len, src, len);
+    self->len += len;
+
+    // Complete file headers and blocks available, and the room their output
+    // needs. block_size is 0 where a file header is expected.
+    size_t end = 0, out_size = 0;
+    size_t block_size = self->block_size;
+    for (;;) {
+        const uint8_t *p = self->buf + end;
+        const size_t avail = self->len - end;
+        if (block_size == 0) {
+            size_t h_size = zxc_peek_file_header_size(p, avail);
+            if (h_size == 0 || avail < h_size)
+                break;
+            zxc_file_header_t fh;
+            if (zxc_read_file_header(p, h_size, &fh) < 0)
+                Py_Return_Err(PyExc_ValueError, "not a ZXC frame");
+            block_size = fh.block_size;
+            end += h_size;
+            continue;
+        }
+        size_t blk = zxc_peek_block_size(p, avail);
+        if (blk == 0 || blk > avail)
+            break;
+        if (zxc_is_end_block(p, blk)) {
+            block_size = 0;
+            end += blk;
+            continue;
+        }
+        zxc_block_header_t bh;
+        zxc_read_block_header(p, avail, &bh);
+        if (bh.raw_size > block_size)
+            Py_Return_Err(PyExc_ValueError, "corrupted ZXC block header");
+        out_size += bh.raw_size;
+        end += blk;
+    }
+
+    PyObject *out = PyBytes_FromStringAndSize(NULL, (Py_ssize_t)out_size);
+    if (!out)
+        return NULL;
+    uint8_t *dst = (uint8_t *)PyBytes_AsString(out);
+    size_t pos = 0, op = 0;
+    int in_frame = self->block_size != 0;
+    int res = 0;
+
+    Py_BEGIN_ALLOW_THREADS
+    while (pos < end) {
+        const uint8_t *p = self->buf + pos;
+        if (!in_frame) {
+            pos += zxc_peek_file_header_size(p, end - pos);
+            in_frame = 1;
+            continue;
+        }
+        size_t blk = zxc_peek_block_size(p, end - pos);
+        if (zxc_is_end_block(p, blk)) {
+            in_frame = 0;
+            pos += blk;
+            continue;
+        }
+        res = zxc_decompress_block(&self->dctx, p, end - pos, dst + op,
+                                   out_size - op);
+        if (res < 0)
+            break;
+        op += (size_t)res;
+        pos += blk;
+    }
+    memmove(self->buf, self->buf + pos, self->len - pos);
+    self->len -= pos;
+    Py_END_ALLOW_THREADS
+
+    if (res < 0) {
+        Py_DECREF(out);
+        Py_Return_Err(PyExc_RuntimeError, "zxc_decompress_block failed");
+    }
+    self->block_size = block_size;
+    if (op != out_size && _PyBytes_Resize(&out, (Py_ssize_t)op) < 0)
+        return NULL;
+    return out;
+}
+
+static PyObject *PyZxcStreamDecompressor_decompress(
+    PyZxcStreamDecompressor *self, PyObject *args, PyObject *kwargs) {
+    Py_buffer view;
+
+    static char *kwlist[] = {"data", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*", kwlist, &view)) {
+        return NULL;
+    }
+    if (!self->ready) {
+        PyBuffer_Release(&view);
+        Py_Return_Err(PyExc_RuntimeError,
+                      "ZxcDecompressor is not initialized");
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(self->lock, WAIT_LOCK);
+    Py_END_ALLOW_THREADS
+    PyObject *out = zxc_stream_decompress_chunk(self, view.buf,
+                                                (size_t)view.len);
+    PyThread_release_lock(self->lock);
+
+    PyBuffer_Release(&view);
+    return out;
+}
+
+static PyObject *PyZxcStreamDecompressor_get_pending(
+    PyZxcStreamDecompressor *self, void *closure) {
+    return PyLong_FromSize_t(self->len);
+}
+
+static PyMethodDef PyZxcStreamDecompressor_methods[] = {
+    {"decompress", (PyCFunction)PyZxcStreamDecompressor_decompress,
+     METH_VARARGS | METH_KEYWORDS,
+     "decompress(data) -> bytes\n\n"
+     "Feed compressed data; returns the data of the blocks completed so far\n"
+     "(possibly empty)."},
+    {NULL, NULL, 0, NULL}  // sentinel
+};
+
+static PyGetSetDef PyZxcStreamDecompressor_getset[] = {
+    {"pending", (getter)PyZxcStreamDecompressor_get_pending, NULL,
+     "Bytes received but not decoded yet (0 between blocks).", NULL},
+    {NULL, NULL, NULL, NULL, NULL}  // sentinel
+};
+
+PyDoc_STRVAR(PyZxcStreamDecompressor_doc,
+             "ZxcDecompressor(checksum=False)\n"
+             "\n"
+             "Incremental decompressor consuming a frame chunk by chunk.");
+
+static PyTypeObject PyZxcStreamDecompressor_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "zxc._zxc.ZxcDecompressor",
+    .tp_basicsize = sizeof(PyZxcStreamDecompressor),
+    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+    .tp_doc = PyZxcStreamDecompressor_doc,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)PyZxcStreamDecompressor_init,
+    .tp_dealloc = (destructor)PyZxcStreamDecompressor_dealloc,
+    .tp_methods = PyZxcStreamDecompressor_methods,
+    .tp_getset = PyZxcStreamDecompressor_getset,
+};
@@ -10,6 +10,9 @@
 #define ZXC_BUFFER_H
 
 #include <stddef.h>
+#include <stdint.h>
+
+#include "zxc_constants.h"
 
 /*
  * ============================================================================
@@ -51,6 +54,49 @@ size_t zxc_compress_bound(size_t input_size);
 size_t zxc_compress(const void* src, size_t src_size, void* dst, size_t dst_capacity, int level,
                     int checksum_enabled);
 
+/**
+ * @brief Compresses a data buffer with explicit frame options.
+ *
+ * Same as zxc_compress(), but takes a zxc_compress_opts_t so optional frame
+ * features can be enabled. With `opts->seekable` set, a seek table is appended
+ * after the last block so zxc_decompress_range() can jump straight to any block;
+ * the output still fits in zxc_compress_bound(src_size) bytes.
+ *
+ * @param[in] src          Pointer to the source buffer.
+ * @param[in] src_size     Size of the source data in bytes.
+ * @param[out] dst          Pointer to the destination buffer.
+ * @param[in] dst_capacity Maximum capacity of the destination buffer.
+ * @param[in] opts         Frame options (NULL selects the defaults).
+ *
+ * @return The number of bytes written to dst, or 0 if the destination buffer
+ * is too small or an error occurred.
+ */
+size_t zxc_compress_ex(const void* src, size_t src_size, void* dst, size_t dst_capacity,
+                       const zxc_compress_opts_t* opts);
+
+/**
+ * @brief Compresses an array of fixed-size elements with byte shuffling.
+ *
+ * Same as zxc_compress_ex() with `opts->elem_size` set to @p elem_size: every
+ * block is byte-shuffled (byte k of each element gathered into plane k) before
+ * the LZ stage, which suits arrays of structs and float tensors. The frame is
+ * decoded by zxc_decompress() and the other decoders as usual; the transform
+ * is recorded per block. Other options (level, checksum, ...) are taken from
+ * @p opts.
+ *
+ * @param[in] src          Pointer to the source array.
+ * @param[in] n_elems      Number of elements.
+ * @param[in] elem_size    Element size in bytes (1 to ZXC_ELEM_SIZE_MAX; 1 disables shuffling).
+ * @param[out] dst          Pointer to the destination buffer.
+ * @param[in] dst_capacity Maximum capacity of the destination buffer.
+ * @param[in] opts         Frame options (NULL selects the defaults).
+ *
+ * @return The number of bytes written to dst, or 0 if the destination buffer
+ * is too small or an error occurred.
+ */
+size_t zxc_compress_typed(const void* src, size_t n_elems, size_t elem_size, void* dst,
+                          size_t dst_capacity, const zxc_compress_opts_t* opts);
+
 /**
  * @brief Decompresses a ZXC compressed buffer.
  *
@@ -71,4 +117,462 @@ size_t zxc_compress(const void* src, size_t src_size, void* dst, size_t dst_capa
 size_t zxc_decompress(const void* src, size_t src_size, void* dst, size_t dst_capacity,
                       int checksum_enabled);
 
+/**
+ * @brief Returns the decompressed size of a ZXC compressed buffer.
+ *
+ * Frames produced by the buffer API record their content size in the file
+ * header, so this is a constant-time read. For frames that do not (e.g. the
+ * output of zxc_stream_compress()), the block headers are walked and their raw
+ * sizes summed; no data is decoded.
+ *
+ * @param[in] src          Pointer to the buffer containing compressed data.
+ * @param[in] src_size     Size of the compressed data in bytes.
+ *
+ * @return The decompressed size in bytes, or 0 if the buffer is not a valid
+ * ZXC frame (or holds no data).
+ */
+size_t zxc_get_decompressed_size(const void* src, size_t src_size);
+
+/**
+ * @brief Compresses a data buffer using multiple threads.
+ *
+ * Produces exactly the same format as zxc_compress(). The input is split on
+ * block boundaries and the blocks are compressed in parallel into worst-case
+ * slots, then compacted behind the file header. If dst_capacity is at least
+ * zxc_compress_bound(src_size), the slots live inside dst and no extra memory
+ * is needed; otherwise a temporary scratch area of that size is allocated.
+ *
+ * @param[in] src          Pointer to the source buffer.
+ * @param[in] src_size     Size of the source data in bytes.
+ * @param[out] dst          Pointer to the destination buffer.
+ * @param[in] dst_capacity Maximum capacity of the destination buffer.
+ * @param[in] n_threads    Number of threads to use (0 = auto-detect number of CPU
+ * cores, 1 = same as zxc_compress()).
+ * @param[in] level        Compression level (e.g., ZXC_LEVEL_BALANCED).
+ * @param[in] checksum_enabled Flag indicating whether to compute the checksum of the
+ * data (1 to enable, 0 to disable).
+ *
+ * @return The number of bytes written to dst, or 0 if the destination buffer
+ * is too small or an error occurred.
+ */
+size_t zxc_compress_mt(const void* src, size_t src_size, void* dst, size_t dst_capacity,
+                       int n_threads, int level, int checksum_enabled);
+
+/**
+ * @brief Multithreaded variant of zxc_compress_ex().
+ *
+ * @param[in] src          Pointer to the source buffer.
+ * @param[in] src_size     Size of the source data in bytes.
+ * @param[out] dst          Pointer to the destination buffer.
+ * @param[in] dst_capacity Maximum capacity of the destination buffer.
+ * @param[in] n_threads    Number of threads to use (0 = auto-detect number of CPU
+ * cores, 1 = same as zxc_compress_ex()).
+ * @param[in] opts         Frame options (NULL selects the defaults).
+ *
+ * @return The number of bytes written to dst, or 0 if the destination buffer
+ * is too small or an error occurred.
+ */
+size_t zxc_compress_mt_ex(const void* src, size_t src_size, void* dst, size_t dst_capacity,
+                          int n_threads, const zxc_compress_opts_t* opts);
+
+/**
+ * @brief Decompresses a ZXC compressed buffer using multiple threads.
+ *
+ * Walks the block headers first to locate every block and its raw offset, then
+ * decodes the blocks in parallel directly into dst.
+ *
+ * @param[in] src          Pointer to the source buffer containing compressed data.
+ * @param[in] src_size      Size of the compressed data in bytes.
+ * @param[out] dst          Pointer to the destination buffer.
+ * @param[in] dst_capacity  Capacity of the destination buffer.
+ * @param[in] n_threads    Number of threads to use (0 = auto-detect number of CPU
+ * cores, 1 = same as zxc_decompress()).
+ * @param[in] checksum_enabled Flag indicating whether to verify the checksum of the
+ * data (1 to enable, 0 to disable).
+ *
+ * @return The number of bytes written to dst, or 0 if decompression fails
+ * (invalid header, corruption, or destination too small).
+ */
+size_t zxc_decompress_mt(const void* src, size_t src_size, void* dst, size_t dst_capacity,
+                         int n_threads, int checksum_enabled);
+
+/**
+ * @brief Decompresses only the bytes [raw_off, raw_off + len) of a ZXC buffer.
+ *
+ * Only the blocks overlapping the requested range are decoded. On a seekable
+ * frame (see zxc_compress_opts_t::seekable) the first block is found through
+ * the seek table; otherwise the block headers are walked without decoding the
+ * data in front of the range.
+ *
+ * @param[in] src          Pointer to the source buffer containing compressed data.
+ * @param[in] src_size     Size of the compressed data in bytes.
+ * @param[in] raw_off      Offset of the first requested byte in the decompressed data.
+ * @param[in] len          Number of bytes requested (dst must hold at least len bytes).
+ * @param[out] dst          Pointer to the destination buffer.
+ * @param[in] checksum_enabled Flag indicating whether to verify the checksum of the
+ * decoded blocks (1 to enable, 0 to disable).
+ *
+ * @return The number of bytes written to dst (less than len if the range runs
+ * past the end of the data), or 0 if decompression fails or raw_off is past the end.
+ */
+size_t zxc_decompress_range(const void* src, size_t src_size, size_t raw_off, size_t len,
+                            void* dst, int checksum_enabled);
+
+/*
+ * ============================================================================
+ * Reusable Contexts
+ * ============================================================================
+ * The one-shot functions above allocate and release their working memory
+ * (hash/chain tables and sequence buffers, several hundred KB) on every call.
+ * When compressing many small buffers, create a context once and reuse it:
+ * the memory is kept between calls and no table needs to be cleared.
+ *
+ * A context is not thread-safe: use one context per thread.
+ */
+
+/**
+ * @brief Opaque reusable compression context.
+ */
+typedef struct zxc_cctx_s zxc_cctx;
+
+/**
+ * @brief Opaque reusable decompression context.
+ */
+typedef struct zxc_dctx_s zxc_dctx;
+
+/**
+ * @brief Creates a compression context.
+ *
+ * Working memory is allocated lazily by the first zxc_compress_cctx() call.
+ *
+ * @return A new context, or NULL if allocation fails. Release with zxc_free_cctx().
+ */
+zxc_cctx* zxc_create_cctx(void);
+
+/**
+ * @brief Releases a compression context and its working memory.
+ *
+ * @param[in] cctx Context to release (NULL is a no-op).
+ */
+void zxc_free_cctx(zxc_cctx* cctx);
+
+/**
+ * @brief Compresses a data buffer, reusing the memory held by a context.
+ *
+ * Produces exactly the same output as zxc_compress_ex().
+ *
+ * @param[in,out] cctx     Compression context from zxc_create_cctx().
+ * @param[in] src          Pointer to the source buffer.
+ * @param[in] src_size     Size of the source data in bytes.
+ * @param[out] dst          Pointer to the destination buffer.
+ * @param[in] dst_capacity Maximum capacity of the destination buffer.
+ * @param[in] opts         Frame options (NULL selects the defaults).
+ *
+ * @return The number of bytes written to dst, or 0 if the destination buffer
+ * is too small or an error occurred.
+ */
+size_t zxc_compress_cctx(zxc_cctx* cctx, const void* src, size_t src_size, void* dst,
+                         size_t dst_capacity, const zxc_compress_opts_t* opts);
+
+/**
+ * @brief Creates a decompression context.
+ *
+ * @return A new context, or NULL if allocation fails. Release with zxc_free_dctx().
+ */
+zxc_dctx* zxc_create_dctx(void);
+
+/**
+ * @brief Releases a decompression context and its scratch memory.
+ *
+ * @param[in] dctx Context to release (NULL is a no-op).
+ */
+void zxc_free_dctx(zxc_dctx* dctx);
+
+/**
+ * @brief Decompresses a ZXC buffer, reusing the scratch memory held by a context.
+ *
+ * Same behavior as zxc_decompress().
+ *
+ * @param[in,out] dctx     Decompression context from zxc_create_dctx().
+ * @param[in] src          Pointer to the source buffer containing compressed data.
+ * @param[in] src_size      Size of the compressed data in bytes.
+ * @param[out] dst          Pointer to the destination buffer.
+ * @param[in] dst_capacity  Capacity of the destination buffer.
+ * @param[in] checksum_enabled Flag indicating whether to verify the checksum of the
+ * data (1 to enable, 0 to disable).
+ *
+ * @return The number of bytes written to dst, or 0 if decompression fails
+ * (invalid header, corruption, or destination too small).
+ */
+size_t zxc_decompress_dctx(zxc_dctx* dctx, const void* src, size_t src_size, void* dst,
+                           size_t dst_capacity, int checksum_enabled);
+
+/*
+ * ============================================================================
+ * Static Decompression Contexts and In-Place Decompression
+ * ============================================================================
+ * For targets without a heap (or where decompression must not allocate), a
+ * decompression context can live in caller-provided memory: a static array,
+ * or a buffer on the stack. It decodes frames whose blocks hold at most the
+ * block size it was sized for, and never allocates.
+ *
+ * In-place decompression decodes a frame stored at the tail of the output
+ * buffer, so loading an asset needs one buffer instead of two. The buffer
+ * must leave a margin past the decompressed size: see zxc_in_place_bound().
+ */
+
+/**
+ * @brief Fixed part of a static decompression context, in bytes.
+ */
+#define ZXC_STATIC_DCTX_OVERHEAD 1024
+
+/**
+ * @brief Workspace size of a static decompression context (usable in array sizes).
+ *
+ * @param max_block_size Largest block the context decodes (the block size of the
+ * frames, e.g. 262144 for the default).
+ */
+#define ZXC_STATIC_DCTX_SIZE(max_block_size) \
+    (ZXC_STATIC_DCTX_OVERHEAD + 3 * (size_t)(max_block_size))
+
+/**
+ * @brief Returns the workspace size of a static decompression context.
+ *
+ * @param[in] max_block_size Largest block the context decodes, in bytes.
+ * @return ZXC_STATIC_DCTX_SIZE(max_block_size), or 0 if @p max_block_size is 0
+ * or larger than ZXC_BLOCK_SIZE_MAX.
+ */
+size_t zxc_static_dctx_size(size_t max_block_size);
+
+/**
+ * @brief Creates a decompression context inside caller-provided memory.
+ *
+ * The context and all its scratch buffers are carved out of @p workspace, which
+ * must stay valid and untouched while the context is in use. Decoding never
+ * allocates; a frame with a block larger than @p max_block_size may fail to
+ * decode (returns 0). The context works with zxc_decompress_dctx(),
+ * zxc_decompress_dict() and zxc_decompress_in_place(); zxc_free_dctx() on it
+ * is a no-op, the caller owns the memory.
+ *
+ * @param[out] workspace     Memory for the context (any alignment).
+ * @param[in] workspace_size Size of @p workspace, at least
+ * zxc_static_dctx_size(max_block_size).
+ * @param[in] max_block_size Largest block the context decodes, in bytes.
+ * @return The context (inside @p workspace), or NULL if the workspace is too small.
+ */
+zxc_dctx* zxc_init_static_dctx(void* workspace, size_t workspace_size, size_t max_block_size);
+
+/**
+ * @brief Returns the buffer size needed to decompress a frame in place.
+ *
+ * The margin over @p decompressed_size covers one block, plus per block its
+ * header, checksum and seek entry, plus the frame header, seek table and
+ * digest framing. It holds for every frame of that content and block size,
+ * whatever the level or options.
+ *
+ * @param[in] decompressed_size Size of the decompressed data in bytes.
+ * @param[in] block_size Block size of the frame (0 selects the default).
+ * @return The buffer size, or 0 if @p block_size is invalid.
+ */
+size_t zxc_in_place_bound(size_t decompressed_size, size_t block_size);
+
+/**
+ * @brief Decompresses a frame stored at the end of its own output buffer.
+ *
+ * The compressed frame occupies the last @p src_size bytes of @p buf; the data
+ * is decoded to the start of @p buf, overwriting the frame as it goes. Each
+ * block is decoded only into the bytes before its own compressed data, so a
+ * buffer of zxc_in_place_bound() bytes always suffices; with a smaller one
+ * decompression may fail (it never writes past the frame's unread bytes).
+ * The buffer content is undefined after a failure.
+ *
+ * @param[in,out] dctx     Decompression context (zxc_create_dctx() or
+ * zxc_init_static_dctx()), or NULL to use temporary scratch memory.
+ * @param[in,out] buf      Buffer holding the frame at its end.
+ * @param[in] buf_capacity Size of @p buf in bytes.
+ * @param[in] src_size     Size of the compressed frame in bytes.
+ * @param[in] checksum_enabled Verify the checksums (1) or not (0).
+ *
+ * @return The number of bytes decoded to the start of @p buf, or 0 on error.
+ */
+size_t zxc_decompress_in_place(zxc_dctx* dctx, void* buf, size_t buf_capacity, size_t src_size,
+                               int checksum_enabled);
+
+/*
+ * ============================================================================
+ * Dictionaries
+ * ============================================================================
+ * Small records (JSON events, RPC messages, log lines) share most of their
+ * content with each other but little with themselves, so each one alone
+ * compresses poorly. A dictionary holds that shared content: every block of a
+ * dictionary frame may reference it as if it were the data right before the
+ * block. Blocks stay independent of each other.
+ *
+ * A dictionary is any buffer of up to ZXC_DICT_SIZE_MAX bytes (longer buffers
+ * keep their last ZXC_DICT_SIZE_MAX bytes): a preset (e.g. a typical record)
+ * or the output of zxc_train_dictionary(). zxc_create_dict() indexes it once;
+ * the prepared dictionary is read-only and can be shared by any number of
+ * contexts and threads.
+ *
+ * The frame header records the dictionary ID. Dictionary frames are decoded
+ * by zxc_decompress_dict() only; the other decoders reject them.
+ */
+
+/**
+ * @brief Opaque prepared dictionary.
+ */
+typedef struct zxc_dict_s zxc_dict;
+
+/**
+ * @brief Builds a dictionary from a set of sample records.
+ *
+ * Selects the segments of the samples whose substrings occur in the largest
+ * number of samples, most useful segments last. When all samples fit in the
+ * capacity, the dictionary is the concatenated samples.
+ *
+ * @param[out] dict_buf     Destination of the dictionary content.
+ * @param[in] dict_capacity Capacity of dict_buf (at most ZXC_DICT_SIZE_MAX bytes are used).
+ * @param[in] samples       Samples, concatenated back to back.
+ * @param[in] sample_sizes  Size of each sample in bytes.
+ * @param[in] n_samples     Number of samples.
+ *
+ * @return Size of the dictionary written to dict_buf, or 0 on error.
+ */
+size_t zxc_train_dictionary(void* dict_buf, size_t dict_capacity, const void* samples,
+                            const size_t* sample_sizes, size_t n_samples);
+
+/**
+ * @brief Prepares a dictionary for compression and decompression.
+ *
+ * Copies the content (so dict_buf can be released afterwards) and builds its
+ * match-finder index.
+ *
+ * @param[in] dict_buf  Dictionary content.
+ * @param[in] dict_size Size of the content in bytes.
+ *
+ * @return A new dictionary, or NULL on error. Release with zxc_free_dict().
+ */
+zxc_dict* zxc_create_dict(const void* dict_buf, size_t dict_size);
+
+/**
+ * @brief Releases a prepared dictionary.
+ *
+ * @param[in] dict Dictionary to release (NULL is a no-op).
+ */
+void zxc_free_dict(zxc_dict* dict);
+
+/**
+ * @brief Returns the identifier written into the frames compressed with a dictionary.
+ *
+ * The ID is derived from the dictionary content, so equal content gives equal IDs.
+ *
+ * @param[in] dict Prepared dictionary.
+ * @return The dictionary ID (never 0), or 0 if dict is NULL.
+ */
+uint32_t zxc_get_dict_id(const zxc_dict* dict);
+
+/**
+ * @brief Reads the dictionary ID of a compressed frame.
+ *
+ * @param[in] src      Compressed frame (at least its file header).
+ * @param[in] src_size Size of the available data in bytes.
+ * @return The ID of the dictionary the frame needs, or 0 if it needs none (or
+ * the header is invalid).
+ */
+uint32_t zxc_get_frame_dict_id(const void* src, size_t src_size);
+
+/**
+ * @brief Compresses a data buffer against a dictionary, reusing a context.
+ *
+ * With dict == NULL, identical to zxc_compress_cctx().
+ *
+ * @param[in,out] cctx     Compression context from zxc_create_cctx().
+ * @param[in] src          Pointer to the source buffer.
+ * @param[in] src_size     Size of the source data in bytes.
+ * @param[out] dst          Pointer to the destination buffer.
+ * @param[in] dst_capacity Maximum capacity of the destination buffer.
+ * @param[in] opts         Frame options (NULL selects the defaults).
+ * @param[in] dict         Prepared dictionary (NULL = none).
+ *
+ * @return The number of bytes written to dst, or 0 if the destination buffer
+ * is too small or an error occurred.
+ */
+size_t zxc_compress_dict(zxc_cctx* cctx, const void* src, size_t src_size, void* dst,
+                         size_t dst_capacity, const zxc_compress_opts_t* opts,
+                         const zxc_dict* dict);
+
+/**
+ * @brief Decompresses a ZXC buffer that may have been compressed with a dictionary.
+ *
+ * Frames without a dictionary ID are decoded as by zxc_decompress_dctx() and
+ * dict is ignored. A dictionary frame fails unless dict has the frame's ID.
+ *
+ * @param[in,out] dctx     Decompression context from zxc_create_dctx().
+ * @param[in] src          Pointer to the source buffer containing compressed data.
+ * @param[in] src_size      Size of the compressed data in bytes.
+ * @param[out] dst          Pointer to the destination buffer.
+ * @param[in] dst_capacity  Capacity of the destination buffer.
+ * @param[in] checksum_enabled Flag indicating whether to verify the checksum of the
+ * data (1 to enable, 0 to disable).
+ * @param[in] dict         Prepared dictionary (NULL = none).
+ *
+ * @return The number of bytes written to dst, or 0 if decompression fails
+ * (invalid header, corruption, wrong or missing dictionary, or destination too small).
+ */
+size_t zxc_decompress_dict(zxc_dctx* dctx, const void* src, size_t src_size, void* dst,
+                           size_t dst_capacity, int checksum_enabled, const zxc_dict* dict);
+
+/*
+ * ============================================================================
+ * Instruction Set Selection
+ * ============================================================================
+ * The block compressor and decompressor exist once per instruction set the
+ * library was built for, and every block of every call goes through the one
+ * selected for the process. By default that is the widest path the CPU
+ * supports; AVX-512 can lose to AVX2 overall on CPUs that lower their clock
+ * for it, and the generic path is a reference point. All paths produce the
+ * same frames.
+ *
+ * The `ZXC_ISA` environment variable (`auto`, `generic`, `avx2`, `avx512`,
+ * `neon`) selects the path without code changes. It is read whenever the
+ * choice is automatic: on the first call, and by zxc_set_isa(ZXC_ISA_AUTO).
+ * Values this build or CPU cannot honour are ignored.
+ */
+
+/**
+ * @brief Selects the instruction set of the block codecs for the whole process.
+ *
+ * Calls already running may finish some blocks on the previous path.
+ *
+ * @param[in] isa Path to use, or ZXC_ISA_AUTO for the one named by `ZXC_ISA`,
+ * else the best one the CPU supports.
+ * @return 0 on success, -1 if this build does not include @p isa or the CPU
+ * does not support it (the selection is then unchanged).
+ */
+int zxc_set_isa(zxc_isa_t isa);
+
+/**
+ * @brief Returns the instruction set the block codecs currently use.
+ *
+ * @return ZXC_ISA_GENERIC, ZXC_ISA_AVX2, ZXC_ISA_AVX512 or ZXC_ISA_NEON (never
+ * ZXC_ISA_AUTO).
+ */
+zxc_isa_t zxc_get_active_isa(void);
+
+/**
+ * @brief Returns the name of an instruction set, as accepted by `ZXC_ISA`.
+ *
+ * @param[in] isa Instruction set.
+ * @return "auto", "generic", "avx2", "avx512", "neon", or "unknown".
+ */
+const char* zxc_isa_name(zxc_isa_t isa);
+
+/**
+ * @brief Parses the name of an instruction set (case-insensitive).
+ *
+ * @param[in] name Name as returned by zxc_isa_name().
+ * @return The instruction set, or -1 if @p name is not one.
+ */
+int zxc_isa_from_name(const char* name);
+
 #endif  // ZXC_BUFFER_H
\ No newline at end of file
@@ -9,6 +9,9 @@
 #ifndef ZXC_CONSTANTS_H
 #define ZXC_CONSTANTS_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 /*
  * ============================================================================
  * ZXC Compression Library - Public Constants
@@ -41,7 +44,145 @@ typedef enum {
     ZXC_LEVEL_FAST = 2,      // Fast compression, good for real-time applications
     ZXC_LEVEL_DEFAULT = 3,   // Recommended: ratio > LZ4, decode speed > LZ4
     ZXC_LEVEL_BALANCED = 4,  // Good ratio, good decode speed
-    ZXC_LEVEL_COMPACT = 5    // High density. Best for storage/firmware/assets.
+    ZXC_LEVEL_COMPACT = 5,   // High density. Best for storage/firmware/assets.
+    ZXC_LEVEL_DENSE = 6,     // Entropy-coded (FSE) literals and tokens
+    ZXC_LEVEL_STRONG = 7,    // FSE + deeper match search
+    ZXC_LEVEL_ULTRA = 8,     // FSE + optimal parsing (much slower compression)
+    ZXC_LEVEL_ARCHIVE = 9    // Highest ratio (two-pass optimal parsing). Best for cold storage.
 } zxc_compression_level_t;
 
+/* =============================================================
+ * ZXC Block Sizes
+ * =============================================================
+ * Data is processed in independent blocks. Larger blocks give a slightly
+ * better ratio and fewer per-block overheads on big files; smaller blocks
+ * lower latency and memory use. Must be a multiple of 4KB.
+ */
+
+#define ZXC_BLOCK_SIZE_MIN (64 * 1024)        // Smallest selectable block size (64KB)
+#define ZXC_BLOCK_SIZE_DEFAULT (256 * 1024)   // Default block size (256KB)
+#define ZXC_BLOCK_SIZE_MAX (4 * 1024 * 1024)  // Largest selectable block size (4MB)
+
+/* =============================================================
+ * ZXC Dictionaries
+ * =============================================================
+ * A dictionary acts as shared history in front of every block, so it can
+ * not be larger than the reach of an LZ77 offset (16 bits).
+ */
+
+#define ZXC_DICT_SIZE_MAX (64 * 1024 - 1)  // Largest usable dictionary (64KB - 1)
+
+/* =============================================================
+ * ZXC Byte Shuffle
+ * =============================================================
+ * Arrays of fixed-size elements (structs, float tensors) can be byte-shuffled
+ * before compression: byte k of every element is gathered into plane k, which
+ * turns slowly varying high bytes into long repeats. The transform is recorded
+ * per block and undone by the decoder.
+ */
+
+#define ZXC_ELEM_SIZE_MAX 256  // Largest shuffle element size in bytes
+
+/* =============================================================
+ * ZXC Numeric Element Types
+ * =============================================================
+ * Declares the element type of a buffer of fixed-width little-endian numbers.
+ * Blocks whose size is a multiple of the element size are then encoded as NUM
+ * blocks with the matching transform (unless that does not pay off), instead
+ * of relying on the 32-bit integer probe.
+ */
+
+typedef enum {
+    ZXC_NUM_AUTO = 0,         // Probe each block for 32-bit integers (default)
+    ZXC_NUM_NONE = 1,         // Never use NUM blocks
+    ZXC_NUM_U16 = 2,          // 16-bit integers: delta + zigzag
+    ZXC_NUM_U32 = 3,          // 32-bit integers: delta + zigzag
+    ZXC_NUM_U64 = 4,          // 64-bit integers: delta + zigzag
+    ZXC_NUM_TIMESTAMP64 = 5,  // 64-bit timestamps: delta-of-delta + zigzag
+    ZXC_NUM_F32 = 6,          // float32: XOR with the previous value
+    ZXC_NUM_F64 = 7           // float64: XOR with the previous value
+} zxc_num_type_t;
+
+/* =============================================================
+ * ZXC Instruction Sets
+ * =============================================================
+ * Code paths of the block compressor and decompressor. Each one is built
+ * with its own compiler flags; the library picks the best one the CPU
+ * supports, see zxc_set_isa() to choose another.
+ */
+
+typedef enum {
+    ZXC_ISA_AUTO = 0,     // Best path the CPU supports (default)
+    ZXC_ISA_GENERIC = 1,  // Portable scalar code
+    ZXC_ISA_AVX2 = 2,     // x86-64 AVX2 + BMI2
+    ZXC_ISA_AVX512 = 3,   // x86-64 AVX-512 (F + BW)
+    ZXC_ISA_NEON = 4      // ARM NEON
+} zxc_isa_t;
+
+/* =============================================================
+ * ZXC Block Selection Statistics
+ * =============================================================
+ * Counts the block types the compressor chose and why. Before running
+ * LZ77 on a block it estimates the literal entropy and the match coverage
+ * of the data: blocks that look incompressible are stored RAW right away,
+ * and at levels 3-5 blocks with too few matches for GLO to pay off are
+ * encoded as GHI, which decodes faster.
+ */
+
+/**
+ * @brief Per-block decision counters, filled through zxc_compress_opts_t.
+ *
+ * The byte counters split the input and output of the frame by block type
+ * (seek tables excluded). The same structure describes the blocks met by
+ * the decompressor in zxc_perf_stats_t, where only the block and byte counts
+ * are set.
+ *
+ * The compressor adds to the counters, so the structure must be
+ * zero-initialized before the first call; it may be reused to accumulate
+ * several frames.
+ */
+typedef struct {
+    uint64_t raw_blocks;      // Blocks stored RAW (sum of the two causes below)
+    uint64_t glo_blocks;      // Blocks encoded as GLO
+    uint64_t ghi_blocks;      // Blocks encoded as GHI
+    uint64_t num_blocks;      // Blocks encoded as NUM
+    uint64_t raw_skipped;     // RAW: estimated incompressible, LZ77 never run
+    uint64_t raw_fallback;    // RAW: encoded, but the result did not shrink the block
+    uint64_t ghi_by_data;     // GHI chosen by the estimate at a level that defaults to GLO
+    uint64_t num_rejected;    // NUM encoded, then dropped for a poor ratio
+    uint64_t raw_bytes;       // Uncompressed bytes of the RAW blocks
+    uint64_t glo_bytes;       // Uncompressed bytes of the GLO blocks
+    uint64_t ghi_bytes;       // Uncompressed bytes of the GHI blocks
+    uint64_t num_bytes;       // Uncompressed bytes of the NUM blocks
+    uint64_t raw_comp_bytes;  // Size of the RAW blocks in the frame (header, checksum)
+    uint64_t glo_comp_bytes;  // Size of the GLO blocks in the frame
+    uint64_t ghi_comp_bytes;  // Size of the GHI blocks in the frame
+    uint64_t num_comp_bytes;  // Size of the NUM blocks in the frame
+} zxc_block_stats_t;
+
+/* =============================================================
+ * ZXC Compression Options
+ * =============================================================
+ */
+
+/**
+ * @brief Optional frame settings for the `_ex` compression entry points.
+ *
+ * A zero-initialized structure selects the defaults, so new fields can be
+ * added without touching existing callers.
+ */
+typedef struct {
+    int level;             // Compression level (0 = ZXC_LEVEL_DEFAULT)
+    int checksum_enabled;  // Store a checksum in every block
+    int seekable;          // Append a seek table to allow random-access decompression
+    size_t block_size;     // Block size in bytes (0 = ZXC_BLOCK_SIZE_DEFAULT)
+    int linked;            // Let each block reference the tail of the previous one
+    int num_type;          // Element type of numeric data (zxc_num_type_t, 0 = probe)
+    size_t elem_size;      // Byte-shuffle element size (0 or 1 = off, max ZXC_ELEM_SIZE_MAX)
+    zxc_block_stats_t* block_stats;  // Decision counters to add to (NULL = not collected)
+    int digest;            // Append a digest of the block checksums (implies checksum_enabled)
+    int level_max;         // Stream API: adapt the level per block in [level, level_max] (0 = off)
+    uint32_t target_mb_s;  // Adaptive: compression speed to hold (0 = keep the output busy)
+} zxc_compress_opts_t;
+
 #endif  // ZXC_CONSTANTS_H
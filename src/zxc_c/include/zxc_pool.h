@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2025-2026, Bertrand Lebonnois
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef ZXC_POOL_H
+#define ZXC_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "zxc_constants.h"
+#include "zxc_stream.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * ============================================================================
+ * ZXC Compression Library - Shared Thread Pool
+ * ============================================================================
+ * The `n_threads` entry points start their threads, allocate their buffers and
+ * build one context per thread on every call. A pool does that once: its
+ * threads stay up between calls, each keeps its context, and the ring buffers
+ * of finished stream calls are kept for the next ones.
+ *
+ * Any number of calls may use the same pool at the same time, from different
+ * threads. The pool threads then take blocks from all running calls in turn,
+ * one block at a time, so concurrent calls share the cores evenly and the
+ * total number of busy threads never exceeds the pool size plus the calling
+ * threads (which work on their own call while they would otherwise wait).
+ *
+ * With a pool, a stream call does its reading and writing on the calling
+ * thread, without a separate writer thread (and without io_uring).
+ */
+
+/** @brief Opaque thread pool, see zxc_pool_create(). */
+typedef struct zxc_pool_s zxc_pool_t;
+
+/**
+ * @brief Starts a thread pool.
+ *
+ * Worker threads are pinned when `ZXC_STREAM_PIN_THREADS` is set (see
+ * zxc_stream_set_flags()) at creation time.
+ *
+ * @param[in] n_threads Number of worker threads (0 = number of online CPUs).
+ * @return The pool, or NULL if it could not be created.
+ */
+zxc_pool_t* zxc_pool_create(int n_threads);
+
+/**
+ * @brief Stops the pool's threads and releases everything it holds.
+ *
+ * No call may be using the pool anymore.
+ *
+ * @param[in] pool Pool to free (NULL is ignored).
+ */
+void zxc_pool_free(zxc_pool_t* pool);
+
+/**
+ * @brief Returns the number of worker threads of a pool.
+ *
+ * @param[in] pool Pool.
+ * @return Number of threads.
+ */
+int zxc_pool_size(const zxc_pool_t* pool);
+
+/**
+ * @brief zxc_compress_mt_ex() on the threads of @p pool.
+ *
+ * @param[in]  pool         Thread pool.
+ * @param[in]  src          Source buffer.
+ * @param[in]  src_size     Size of the source data.
+ * @param[out] dst          Destination buffer.
+ * @param[in]  dst_capacity Capacity of the destination buffer.
+ * @param[in]  opts         Frame options (NULL selects the defaults).
+ * @return Number of bytes written to @p dst, or 0 on error.
+ */
+size_t zxc_compress_pool(zxc_pool_t* pool, const void* src, size_t src_size, void* dst,
+                         size_t dst_capacity, const zxc_compress_opts_t* opts);
+
+/**
+ * @brief zxc_decompress_mt() on the threads of @p pool.
+ *
+ * @param[in]  pool             Thread pool.
+ * @param[in]  src              Compressed frame.
+ * @param[in]  src_size         Size of the frame.
+ * @param[out] dst              Destination buffer.
+ * @param[in]  dst_capacity     Capacity of the destination buffer.
+ * @param[in]  checksum_enabled Verify block checksums.
+ * @return Number of decompressed bytes, or 0 on error.
+ */
+size_t zxc_decompress_pool(zxc_pool_t* pool, const void* src, size_t src_size, void* dst,
+                           size_t dst_capacity, int checksum_enabled);
+
+/**
+ * @brief zxc_stream_compress_ex() on the threads of @p pool.
+ *
+ * @param[in]  pool  Thread pool.
+ * @param[in]  f_in  Input file stream.
+ * @param[out] f_out Output file stream (NULL discards the output).
+ * @param[in]  opts  Frame options (NULL selects the defaults).
+ * @return Total compressed bytes written, or -1 if an error occurred.
+ */
+int64_t zxc_stream_compress_pool(zxc_pool_t* pool, FILE* f_in, FILE* f_out,
+                                 const zxc_compress_opts_t* opts);
+
+/**
+ * @brief zxc_stream_decompress() on the threads of @p pool.
+ *
+ * @param[in]  pool             Thread pool.
+ * @param[in]  f_in             Input file stream.
+ * @param[out] f_out            Output file stream (NULL discards the output).
+ * @param[in]  checksum_enabled Verify block checksums.
+ * @return Total decompressed bytes written, or -1 if an error occurred.
+ */
+int64_t zxc_stream_decompress_pool(zxc_pool_t* pool, FILE* f_in, FILE* f_out,
+                                   int checksum_enabled);
+
+/**
+ * @brief zxc_stream_compress_cb() on the threads of @p pool.
+ *
+ * Both callbacks are called from the calling thread.
+ *
+ * @param[in] pool     Thread pool.
+ * @param[in] read_fn  Source callback.
+ * @param[in] write_fn Sink callback (NULL discards the output).
+ * @param[in] opaque   User pointer passed to both callbacks.
+ * @param[in] opts     Frame options (NULL selects the defaults).
+ * @return Total compressed bytes written, or -1 if an error occurred.
+ */
+int64_t zxc_stream_compress_cb_pool(zxc_pool_t* pool, zxc_read_fn read_fn, zxc_write_fn write_fn,
+                                    void* opaque, const zxc_compress_opts_t* opts);
+
+/**
+ * @brief zxc_stream_decompress_cb() on the threads of @p pool.
+ *
+ * Both callbacks are called from the calling thread.
+ *
+ * @param[in] pool             Thread pool.
+ * @param[in] read_fn          Source callback.
+ * @param[in] write_fn         Sink callback (NULL discards the output).
+ * @param[in] opaque           User pointer passed to both callbacks.
+ * @param[in] checksum_enabled Verify block checksums.
+ * @return Total decompressed bytes written, or -1 if an error occurred.
+ */
+int64_t zxc_stream_decompress_cb_pool(zxc_pool_t* pool, zxc_read_fn read_fn,
+                                      zxc_write_fn write_fn, void* opaque, int checksum_enabled);
+
+/**
+ * @brief One buffer of a batch call.
+ *
+ * @var zxc_buf_t::data
+ *      Start of the buffer (only read for an input).
+ * @var zxc_buf_t::size
+ *      Input: number of bytes to compress. Output: set to the size of the
+ * frame, or 0 if this input failed.
+ * @var zxc_buf_t::capacity
+ *      Output only: bytes available at `data` (zxc_compress_bound() of the
+ * input size always fits).
+ */
+typedef struct {
+    void* data;
+    size_t size;
+    size_t capacity;
+} zxc_buf_t;
+
+/**
+ * @brief Compresses many independent buffers, each into its own frame.
+ *
+ * Inputs larger than one block are split into blocks compressed in parallel,
+ * as zxc_compress_pool() would; smaller ones are compressed whole, each by a
+ * single thread. The largest work is handed out first and small inputs go in
+ * groups, so the threads stay busy whatever the mix of sizes. Every frame is
+ * identical to what zxc_compress_ex() produces for that input.
+ *
+ * @param[in]     pool Thread pool, or NULL to compress everything on the
+ * calling thread.
+ * @param[in]     in   @p n input buffers.
+ * @param[in,out] out  @p n output buffers (`data` and `capacity` set by the
+ * caller; `size` receives the frame size).
+ * @param[in]     n    Number of buffers.
+ * @param[in]     opts Frame options for every input (NULL selects the
+ * defaults); `block_stats` receives the counters of the whole batch.
+ * @return Number of inputs compressed successfully (@p n when all went well).
+ */
+size_t zxc_compress_batch(zxc_pool_t* pool, const zxc_buf_t* in, zxc_buf_t* out, size_t n,
+                          const zxc_compress_opts_t* opts);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // ZXC_POOL_H
@@ -12,6 +12,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "zxc_constants.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -54,6 +56,22 @@ extern "C" {
  * @field lit_buffer_cap Current capacity of the literal scratch buffer.
  * @field checksum_enabled Flag indicating if checksums should be computed.
  * @field compression_level The configured compression level.
+ * @field hash_log Number of hash bits the hash table was allocated for.
+ * @field chunk_size Largest chunk the buffers were sized for (0 in decompression mode).
+ * @field dict Prepared dictionary the blocks may reference (NULL = none).
+ * @field link History of the next block in linked mode (NULL or empty = none).
+ * @field opt Optimal parser state of levels 8+ (NULL until the first such block).
+ * @field num_type Declared element type of numeric data (zxc_num_type_t, 0 = probe).
+ * @field elem_size Byte-shuffle element size of compressed blocks (0 or 1 = off).
+ * @field shuffle_buf Scratch holding a shuffled block (allocated on first use).
+ * @field shuffle_buf_cap Current capacity of the shuffle scratch buffer.
+ * @field stats Block counters of the blocks compressed (or decompressed) so far.
+ * @field timed Measure `checksum_ns` (set by the callers collecting
+ * zxc_perf_stats_t).
+ * @field checksum_ns Time spent on block checksums so far, when `timed`.
+ * @field fixed_scratch Decompression only: `lit_buffer`, `shuffle_buf` and
+ * `link` are caller-provided and never grown or freed (a block needing more
+ * scratch fails to decode).
  */
 typedef struct {
     // Hot zone: random access / high frequency
@@ -71,10 +89,23 @@ typedef struct {
     uint8_t* literals;        // Buffer for literal bytes
 
     // Cold zone: configuration / scratch / resizeable
-    uint8_t* lit_buffer;    // Buffer scratch for literals (RLE)
-    size_t lit_buffer_cap;  // Current capacity of this buffer
-    int checksum_enabled;   // Checksum enabled flag
-    int compression_level;  // Compression level
+    uint8_t* lit_buffer;            // Buffer scratch for literals (RLE)
+    size_t lit_buffer_cap;          // Current capacity of this buffer
+    int checksum_enabled;           // Checksum enabled flag
+    int compression_level;          // Compression level
+    uint32_t hash_log;              // Allocated hash table size (log2 of the bucket count)
+    size_t chunk_size;              // Capacity of the per-chunk buffers
+    const struct zxc_dict_s* dict;  // Attached dictionary (NULL = none)
+    struct zxc_dict_s* link;        // Previous block's tail in linked mode (owned)
+    struct zxc_opt_s* opt;          // Optimal parser state (levels 8+, allocated on first use)
+    int num_type;                   // Declared element type for NUM blocks (0 = probe)
+    size_t elem_size;               // Byte-shuffle element size (0 or 1 = off)
+    uint8_t* shuffle_buf;           // Shuffled block scratch (allocated on first use)
+    size_t shuffle_buf_cap;         // Current capacity of this buffer
+    zxc_block_stats_t stats;        // Block selection counters
+    int timed;                      // Measure checksum_ns
+    uint64_t checksum_ns;           // Time spent on checksums
+    int fixed_scratch;              // Scratch buffers are caller-owned (no heap use)
 } zxc_cctx_t;
 
 /**
@@ -84,8 +115,9 @@ typedef struct {
  * necessary buffers based on the chunk size and compression level.
  *
  * @param[out] ctx Pointer to the ZXC compression context structure to initialize.
- * @param[in] chunk_size The size of the data chunk to be compressed. This
- * determines the allocation size for various internal buffers.
+ * @param[in] chunk_size The size of the largest data chunk to be compressed. This
+ * determines the allocation size for various internal buffers, including the
+ * hash table, which is scaled down for chunks smaller than 8KB.
  * @param[in] mode The operation mode (1 for compression, 0 for decompression).
  * @param[in] level The desired compression level to be stored in the context.
  * @param[in] checksum_enabled
@@ -105,34 +137,64 @@ int zxc_cctx_init(zxc_cctx_t* ctx, size_t chunk_size, int mode, int level, int c
  */
 void zxc_cctx_free(zxc_cctx_t* ctx);
 
+/**
+ * @struct zxc_file_header_t
+ * @brief In-memory representation of the ZXC file header.
+ *
+ * @var zxc_file_header_t::block_size
+ * Block size used by the encoder (0 = default ZXC_BLOCK_SIZE when writing).
+ * @var zxc_file_header_t::flags
+ * Frame flags (ZXC_FILE_FLAG_SEEKABLE, ZXC_FILE_FLAG_CONTENT_SIZE, ...).
+ * @var zxc_file_header_t::content_size
+ * Total decompressed size of the frame. Only meaningful when `flags` contains
+ * ZXC_FILE_FLAG_CONTENT_SIZE, in which case it is stored right after the fixed
+ * 8-byte header.
+ * @var zxc_file_header_t::dict_id
+ * Identifier of the dictionary the frame was compressed with. Only meaningful
+ * when `flags` contains ZXC_FILE_FLAG_DICT_ID, in which case it follows the
+ * content size field.
+ */
+typedef struct {
+    size_t block_size;      // Block size in bytes
+    uint8_t flags;          // Optional frame features
+    uint64_t content_size;  // Total raw size (if ZXC_FILE_FLAG_CONTENT_SIZE)
+    uint32_t dict_id;       // Dictionary identifier (if ZXC_FILE_FLAG_DICT_ID)
+} zxc_file_header_t;
+
 /**
  * @brief Writes the standard ZXC file header to a destination buffer.
  *
- * This function stores the magic word (little-endian) and the version number
- * into the provided buffer. It ensures the buffer has sufficient capacity
- * before writing.
+ * This function stores the magic word (little-endian), the version number,
+ * the block size and the frame flags into the provided buffer, followed by the
+ * optional fields announced by the flags. It ensures the buffer has sufficient
+ * capacity before writing.
  *
  * @param[out] dst The destination buffer where the header will be written.
  * @param[in] dst_capacity The total capacity of the destination buffer in bytes.
- * @return The number of bytes written (ZXC_FILE_HEADER_SIZE) on success,
- *         or -1 if the destination capacity is insufficient.
+ * @param[in] fh Header fields to serialize.
+ * @return The number of bytes written (ZXC_FILE_HEADER_SIZE plus optional
+ *         fields) on success, or -1 if the destination capacity is insufficient.
  */
-int zxc_write_file_header(uint8_t* dst, size_t dst_capacity);
+int zxc_write_file_header(uint8_t* dst, size_t dst_capacity, const zxc_file_header_t* fh);
 
 /**
  * @brief Validates and reads the ZXC file header from a source buffer.
  *
  * This function checks if the provided source buffer is large enough to contain
- * a ZXC file header and verifies that the magic word and version number match
- * the expected ZXC format specifications.
+ * a ZXC file header (optional fields included) and verifies that the magic word
+ * and version number match the expected ZXC format specifications.
+ *
+ * A streaming driver can read the fixed ZXC_FILE_HEADER_SIZE bytes first: the
+ * flags byte (offset 6) tells how many optional bytes follow.
  *
  * @param[in] src Pointer to the source buffer containing the file data.
  * @param[in] src_size Size of the source buffer in bytes.
- * @param[out] out_block_size Optional pointer to receive the recommended block size
- * @return 0 if the header is valid, -1 otherwise (e.g., buffer too small,
- * invalid magic word, or incorrect version).
+ * @param[out] fh Optional pointer receiving the decoded header fields.
+ * @return The size of the header in bytes (where the first block starts) if the
+ * header is valid, -1 otherwise (e.g., buffer too small, invalid magic word, or
+ * incorrect version).
  */
-int zxc_read_file_header(const uint8_t* src, size_t src_size, size_t* out_block_size);
+int zxc_read_file_header(const uint8_t* src, size_t src_size, zxc_file_header_t* fh);
 
 /**
  * @struct zxc_block_header_t
@@ -144,8 +206,8 @@ int zxc_read_file_header(const uint8_t* src, size_t src_size, size_t* out_block_
  * The type of the block (see zxc_block_type_t).
  * @var zxc_block_header_t::block_flags
  * Bit flags indicating properties like checksum presence.
- * @var zxc_block_header_t::reserved
- * Reserved bytes for future protocol extensions.
+ * @var zxc_block_header_t::elem_size
+ * Shuffle element size when ZXC_BLOCK_FLAG_SHUFFLED is set, 0 otherwise.
  * @var zxc_block_header_t::comp_size
  * The size of the compressed data payload in bytes (excluding this header).
  * @var zxc_block_header_t::raw_size
@@ -154,7 +216,7 @@ int zxc_read_file_header(const uint8_t* src, size_t src_size, size_t* out_block_
 typedef struct {
     uint8_t block_type;   // Block type (e.g., RAW, GLO, GHI, NUM)
     uint8_t block_flags;  // Flags (e.g., checksum presence)
-    uint16_t reserved;    // Reserved for future use
+    uint16_t elem_size;   // Shuffle element size (if ZXC_BLOCK_FLAG_SHUFFLED)
     uint32_t comp_size;   // Compressed size excluding header
     uint32_t raw_size;    // Decompressed size
 } zxc_block_header_t;
@@ -195,6 +257,325 @@ int zxc_write_block_header(uint8_t* dst, size_t dst_capacity, const zxc_block_he
  */
 int zxc_read_block_header(const uint8_t* src, size_t src_size, zxc_block_header_t* bh);
 
+/**
+ * @brief Returns the size of the file header starting at @p src.
+ *
+ * Only the fixed part is inspected, so a streaming driver can tell how many
+ * bytes to gather before calling zxc_read_file_header().
+ *
+ * @param[in] src Start of the frame.
+ * @param[in] src_size Number of bytes available at src.
+ * @return The header size (optional fields included), or 0 if fewer than
+ * ZXC_FILE_HEADER_SIZE bytes are available.
+ */
+size_t zxc_peek_file_header_size(const uint8_t* src, size_t src_size);
+
+/**
+ * @brief Returns the encoded size of the block starting at @p src.
+ *
+ * @param[in] src Start of the block.
+ * @param[in] src_size Number of bytes available at src.
+ * @return The size of the whole block (header, optional checksum and payload),
+ * or 0 if fewer than ZXC_BLOCK_HEADER_SIZE bytes are available.
+ */
+size_t zxc_peek_block_size(const uint8_t* src, size_t src_size);
+
+/**
+ * @brief Returns the largest size zxc_compress_block() can produce.
+ *
+ * @param[in] src_size Size of the block to compress.
+ * @return The worst-case encoded size (a RAW block with its checksum).
+ */
+size_t zxc_block_bound(size_t src_size);
+
+/**
+ * @brief Compresses a single block.
+ *
+ * Writes one complete block (header, optional checksum and payload) using the
+ * level and checksum setting of the context. Blocks are independent, so a
+ * driver can compress them in any order, or on several contexts at once, and
+ * write them after a file header in their original order.
+ *
+ * @param[in,out] ctx Context initialized for compression with a chunk size of
+ * at least @p src_size.
+ * @param[in] src Data of the block.
+ * @param[in] src_size Size of the block (1 to the context chunk size).
+ * @param[out] dst Destination buffer.
+ * @param[in] dst_capacity Capacity of dst (zxc_block_bound() always fits).
+ * @return The number of bytes written, or -1 on error.
+ */
+int zxc_compress_block(zxc_cctx_t* ctx, const uint8_t* src, size_t src_size, uint8_t* dst,
+                       size_t dst_capacity);
+
+/**
+ * @brief Decompresses a single block.
+ *
+ * @param[in,out] ctx Context initialized for decompression. Its checksum
+ * setting selects checksum verification.
+ * @param[in] src Start of a complete block (see zxc_peek_block_size()).
+ * Linked blocks need the previous block's output and are rejected.
+ * @param[in] src_size Number of bytes available at src.
+ * @param[out] dst Destination buffer.
+ * @param[in] dst_capacity Capacity of dst (the raw size of the block fits).
+ * @return The number of decompressed bytes (0 for a seek table), or -1 on
+ * error.
+ */
+int zxc_decompress_block(zxc_cctx_t* ctx, const uint8_t* src, size_t src_size, uint8_t* dst,
+                         size_t dst_capacity);
+
+/**
+ * @struct zxc_seek_entry_t
+ * @brief One entry of the seek table stored at the end of a seekable frame.
+ *
+ * @var zxc_seek_entry_t::comp_offset
+ * Offset of the block header from the start of the frame (file header included).
+ * @var zxc_seek_entry_t::raw_offset
+ * Number of decompressed bytes produced by all the preceding blocks.
+ */
+typedef struct {
+    uint64_t comp_offset;  // Block position in the compressed frame
+    uint64_t raw_offset;   // Block position in the decompressed data
+} zxc_seek_entry_t;
+
+/**
+ * @brief Serializes a seek table as a SEK block.
+ *
+ * The block is made of a regular block header, `n_entries` little-endian entries and
+ * a fixed-size trailer (entry count, total table size, magic). It must be the last
+ * block of the frame so the trailer ends up in the final bytes of the file, and
+ * the file header must carry the ZXC_FILE_FLAG_SEEKABLE flag.
+ *
+ * @param[out] dst Destination buffer.
+ * @param[in] dst_capacity Capacity of the destination buffer in bytes.
+ * @param[in] entries Array of `n_entries` entries, in block order.
+ * @param[in] n_entries Number of data blocks in the frame.
+ * @return The number of bytes written on success, or -1 if the destination capacity
+ * is insufficient or the table is too large.
+ */
+int zxc_write_seek_table(uint8_t* dst, size_t dst_capacity, const zxc_seek_entry_t* entries,
+                         size_t n_entries);
+
+/**
+ * @brief Parses the seek table trailer found in the last bytes of a frame.
+ *
+ * Only the trailer is inspected, so a driver working on a file can read the
+ * last ZXC_SEEK_TRAILER_SIZE bytes first, then fetch the whole table at
+ * `frame_size - *out_table_size`.
+ *
+ * @param[in] src Pointer to the end of the frame: either the whole frame or just
+ * its tail. Only the last ZXC_SEEK_TRAILER_SIZE bytes are read.
+ * @param[in] src_size Number of bytes available at src.
+ * @param[out] out_n_entries Receives the number of entries in the table.
+ * @param[out] out_table_size Receives the size of the whole SEK block (header,
+ * entries and trailer).
+ * @return 0 if a well-formed trailer was found, -1 otherwise.
+ */
+int zxc_read_seek_trailer(const uint8_t* src, size_t src_size, size_t* out_n_entries,
+                          size_t* out_table_size);
+
+/**
+ * @struct zxc_digest_t
+ * @brief Running digest of the data blocks of a frame (see zxc_digest_update()).
+ *
+ * The digest combines the checksums stored in the blocks, not the data: once
+ * each block has been verified on its own, a reader checks the whole frame
+ * (no block missing, repeated or moved) from the block headers alone. Every
+ * block adds a term keyed by its position to `sum`, so digests of disjoint
+ * runs of blocks, e.g. one per thread, merge with zxc_digest_merge().
+ *
+ * Must be zero-initialized before the first block.
+ *
+ * @var zxc_digest_t::sum
+ * Sum (modulo 2^64) of the terms of the blocks added so far.
+ * @var zxc_digest_t::first_block
+ * Position in the frame of the first block of the run (0 for a whole frame).
+ * @var zxc_digest_t::next_block
+ * Position of the next block, i.e. the first block plus the blocks added.
+ */
+typedef struct {
+    uint64_t sum;          // Combined terms of the blocks seen
+    uint64_t first_block;  // Position of the first block of the run
+    uint64_t next_block;   // Position of the next block
+} zxc_digest_t;
+
+/**
+ * @brief Adds the next block of a frame to a digest.
+ *
+ * Seek tables and digest blocks carry no data and are ignored.
+ *
+ * @param[in,out] dg Digest of the preceding blocks.
+ * @param[in] block Start of the block (its header and checksum are read).
+ * @param[in] block_size Number of bytes available at block.
+ * @return 0 on success, -1 if the block is truncated or has no checksum.
+ */
+int zxc_digest_update(zxc_digest_t* dg, const uint8_t* block, size_t block_size);
+
+/**
+ * @brief Starts a digest at block @p first_block, so that runs of blocks can
+ * be digested independently and merged in order afterwards.
+ *
+ * @param[out] dg Digest to initialize.
+ * @param[in] first_block Position of the first block of the run in the frame.
+ */
+void zxc_digest_start(zxc_digest_t* dg, uint64_t first_block);
+
+/**
+ * @brief Appends the digest of the run of blocks that follows a digest.
+ *
+ * @param[in,out] dg Digest of the first blocks.
+ * @param[in] next Digest started (see zxc_digest_start()) at block
+ * `dg->next_block`.
+ * @return 0 on success, -1 if @p next does not start where @p dg ends.
+ */
+int zxc_digest_merge(zxc_digest_t* dg, const zxc_digest_t* next);
+
+/**
+ * @brief Serializes a digest as a DIG block.
+ *
+ * The block goes right after the last data block (before the seek table, if
+ * any), and the file header must carry the ZXC_FILE_FLAG_DIGEST flag.
+ *
+ * @param[out] dst Destination buffer.
+ * @param[in] dst_capacity Capacity of the destination buffer in bytes.
+ * @param[in] dg Digest of all the data blocks of the frame.
+ * @return The number of bytes written, or -1 if the destination is too small.
+ */
+int zxc_write_digest(uint8_t* dst, size_t dst_capacity, const zxc_digest_t* dg);
+
+/**
+ * @brief Checks a DIG block against the digest of the blocks read before it.
+ *
+ * @param[in] src Start of the DIG block.
+ * @param[in] src_size Number of bytes available at src.
+ * @param[in] dg Digest of all the data blocks of the frame.
+ * @return 0 if src holds a DIG block with the same digest, -1 otherwise.
+ */
+int zxc_check_digest(const uint8_t* src, size_t src_size, const zxc_digest_t* dg);
+
+/**
+ * @brief Writes an END block, the end-of-stream marker of a frame.
+ *
+ * The block is a bare header with no data. It goes last, after the digest if
+ * any, and never into a seekable frame (whose seek table must end the file).
+ * Frames without one end with their input, as before.
+ *
+ * @param[out] dst Destination buffer.
+ * @param[in] dst_capacity Capacity of the destination buffer in bytes.
+ * @return The number of bytes written (ZXC_BLOCK_HEADER_SIZE), or -1 if the
+ * destination is too small.
+ */
+int zxc_write_end_block(uint8_t* dst, size_t dst_capacity);
+
+/**
+ * @brief Tells whether the block starting at @p src is an END block.
+ *
+ * A driver reading a byte stream stops there: the frame is complete and the
+ * bytes that follow, if any, belong to the next frame.
+ *
+ * @param[in] src Start of a block.
+ * @param[in] src_size Number of bytes available at src.
+ * @return 1 for a well-formed END block, 0 otherwise.
+ */
+int zxc_is_end_block(const uint8_t* src, size_t src_size);
+
+/**
+ * @typedef zxc_cstream_t
+ * @brief Incremental frame encoder with explicit flush points.
+ *
+ * Input is buffered up to one block: full blocks are compressed as soon as
+ * they are complete, zxc_cstream_flush() closes the open block at whatever
+ * size it has, and zxc_cstream_end() flushes and writes the END block. After
+ * a flush, everything given so far can be decoded from the output alone, so a
+ * message can be sent right away. Blocks are independent and the file header
+ * is written before the first block, so the output is a regular frame.
+ *
+ * The context is reusable: after zxc_cstream_end() the next call starts a new
+ * frame, with the same buffers.
+ *
+ * @field cctx Block compressor.
+ * @field pending Input of the open block (block_size bytes).
+ * @field pending_size Number of bytes in `pending`.
+ * @field block_size Largest block of the frame (the file header value).
+ * @field header_done The file header of the current frame has been written.
+ */
+typedef struct {
+    zxc_cctx_t cctx;      // Block compressor
+    uint8_t* pending;     // Input of the open block
+    size_t pending_size;  // Bytes in the open block
+    size_t block_size;    // Largest block of the frame
+    int header_done;      // File header of the current frame written
+} zxc_cstream_t;
+
+/**
+ * @brief Initializes an incremental encoder.
+ *
+ * @param[out] cs Encoder to initialize.
+ * @param[in] block_size Largest block, ZXC_BLOCK_SIZE_MIN to ZXC_BLOCK_SIZE_MAX
+ * in 4KB steps (0 = default). Flushed blocks are smaller.
+ * @param[in] level Compression level (0 = ZXC_LEVEL_DEFAULT).
+ * @param[in] checksum_enabled Store a checksum in every block.
+ * @return 0 on success, -1 on invalid parameters or allocation failure.
+ */
+int zxc_cstream_init(zxc_cstream_t* cs, size_t block_size, int level, int checksum_enabled);
+
+/**
+ * @brief Releases the buffers of an incremental encoder (not the structure).
+ *
+ * @param[in,out] cs Encoder to clean up.
+ */
+void zxc_cstream_free(zxc_cstream_t* cs);
+
+/**
+ * @brief Returns an output capacity that always fits one zxc_cstream_compress()
+ * call of @p src_size bytes followed by zxc_cstream_end().
+ *
+ * @param[in] block_size Block size of the encoder (0 = default).
+ * @param[in] src_size Size of the input of the call.
+ * @return The worst-case output size, or 0 if block_size is invalid.
+ */
+size_t zxc_cstream_bound(size_t block_size, size_t src_size);
+
+/**
+ * @brief Feeds data to an incremental encoder.
+ *
+ * The whole input is taken: the file header (first call of a frame) and the
+ * blocks completed by this input are written to dst, the rest stays pending.
+ *
+ * @param[in,out] cs Initialized encoder.
+ * @param[in] src Input data.
+ * @param[in] src_size Size of the input (may be 0).
+ * @param[out] dst Destination buffer.
+ * @param[in] dst_capacity Capacity of dst (zxc_cstream_bound() always fits).
+ * @return The number of bytes written (possibly 0), or -1 on error. Nothing is
+ * taken nor written when dst is too small.
+ */
+int zxc_cstream_compress(zxc_cstream_t* cs, const uint8_t* src, size_t src_size, uint8_t* dst,
+                         size_t dst_capacity);
+
+/**
+ * @brief Closes the open block at its current size.
+ *
+ * @param[in,out] cs Initialized encoder.
+ * @param[out] dst Destination buffer.
+ * @param[in] dst_capacity Capacity of dst (zxc_cstream_bound() with a source
+ * size of 0 always fits).
+ * @return The number of bytes written (0 if nothing was pending and the header
+ * is already out), or -1 on error or if dst is too small.
+ */
+int zxc_cstream_flush(zxc_cstream_t* cs, uint8_t* dst, size_t dst_capacity);
+
+/**
+ * @brief Flushes the open block, then ends the frame with an END block.
+ *
+ * @param[in,out] cs Initialized encoder. The next zxc_cstream_compress()
+ * starts a new frame.
+ * @param[out] dst Destination buffer.
+ * @param[in] dst_capacity Capacity of dst (zxc_cstream_bound() with a source
+ * size of 0 always fits).
+ * @return The number of bytes written, or -1 on error or if dst is too small.
+ */
+int zxc_cstream_end(zxc_cstream_t* cs, uint8_t* dst, size_t dst_capacity);
+
 #ifdef __cplusplus
 }
 #endif
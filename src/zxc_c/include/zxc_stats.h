@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2025-2026, Bertrand Lebonnois
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef ZXC_STATS_H
+#define ZXC_STATS_H
+
+#include <stdint.h>
+
+#include "zxc_constants.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * ============================================================================
+ * ZXC Compression Library - Performance Counters and Tracing
+ * ============================================================================
+ * Where the time of a call goes: reading, writing, the codecs, and the waits
+ * between the stages of the stream pipeline. Counters are only collected
+ * while a thread has asked for them (zxc_perf_capture()) or a trace hook is
+ * installed; otherwise a call costs one thread-local check.
+ *
+ * Times are in nanoseconds of a monotonic clock. Thread times (`work_ns`,
+ * `work_wait_ns`, `checksum_ns`) are summed over every thread of the call, so
+ * they may exceed `wall_ns`.
+ */
+
+/**
+ * @brief Counters of one or more calls, see zxc_perf_capture().
+ *
+ * Counters are added to, so the structure must be zero-initialized before the
+ * first call; it may be reused to accumulate several calls.
+ */
+typedef struct {
+    zxc_block_stats_t blocks;  // Blocks written (compression) or read (decompression)
+    uint64_t calls;            // Calls counted
+    uint64_t bytes_in;         // Bytes consumed
+    uint64_t bytes_out;        // Bytes produced
+    uint64_t wall_ns;          // Elapsed time of the calls
+    uint64_t read_ns;          // Stream calls: reading the input
+    uint64_t read_wait_ns;     // Stream calls: reader blocked on a full ring
+    uint64_t work_ns;          // Compressing or decompressing blocks (all threads)
+    uint64_t work_wait_ns;     // Stream worker threads waiting for a block to process
+    uint64_t write_ns;         // Stream calls: writing the output
+    uint64_t write_wait_ns;    // Stream calls: writer waiting for the next block in order
+    uint64_t checksum_ns;      // Computing or verifying block checksums (part of work_ns)
+} zxc_perf_stats_t;
+
+/**
+ * @brief Adds the counters of the calling thread's next calls to @p stats.
+ *
+ * Every buffer, parallel, pool, batch and stream call made by this thread
+ * afterwards adds to @p stats, until zxc_perf_capture(NULL). Other threads
+ * are not affected. Calls made from inside a call (such as the fallback of a
+ * parallel call on a single block) are part of the outer one.
+ *
+ * @param[out] stats Counters to add to, or NULL to stop collecting.
+ */
+void zxc_perf_capture(zxc_perf_stats_t* stats);
+
+/**
+ * @brief Trace hook, called at the start and at the end of every top-level
+ * call (never per block).
+ *
+ * @param[in] opaque Pointer given to zxc_set_trace_hook().
+ * @param[in] call   Name of the call ("compress", "decompress", "compress_mt",
+ * "decompress_mt", "compress_batch", "stream_compress", "stream_decompress").
+ * @param[in] end    0 when the call starts, 1 when it returns.
+ * @param[in] stats  At the end, the counters of this call alone; NULL at the start.
+ */
+typedef void (*zxc_trace_fn)(void* opaque, const char* call, int end,
+                             const zxc_perf_stats_t* stats);
+
+/**
+ * @brief Installs a process-wide trace hook.
+ *
+ * Only available when the library is built with `-DZXC_ENABLE_TRACING`; it
+ * should be installed before calls start. Hooks run on the calling thread of
+ * each call, and must not call back into the library.
+ *
+ * @param[in] fn     Hook, or NULL to remove it.
+ * @param[in] opaque Pointer passed to @p fn.
+ * @return 0 on success, -1 if the library was built without tracing.
+ */
+int zxc_set_trace_hook(zxc_trace_fn fn, void* opaque);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // ZXC_STATS_H
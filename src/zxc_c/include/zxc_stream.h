@@ -12,6 +12,8 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include "zxc_constants.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -23,6 +25,13 @@ extern "C" {
  * This driver uses an asynchronous pipeline architecture (Producer-Consumer)
  * via a Ring Buffer to separate I/O operations from CPU-intensive compression
  * tasks.
+ *
+ * When `f_in` refers to a regular file (POSIX), the driver maps it read-only
+ * instead of reading it: workers consume blocks directly from the mapping,
+ * starting at the stream's current position, and the stream is left positioned
+ * after the consumed data on return. Pipes, terminals and Windows use plain
+ * `fread`. Truncating the input file while it is being processed may raise
+ * SIGBUS; build with `-DZXC_DISABLE_MMAP` to always use `fread`.
  */
 
 /**
@@ -46,10 +55,40 @@ extern "C" {
 int64_t zxc_stream_compress(FILE* f_in, FILE* f_out, int n_threads, int level,
                             int checksum_enabled);
 
+/**
+ * @brief Compresses a stream with explicit frame options.
+ *
+ * Same pipeline as zxc_stream_compress(). With `opts->seekable` set, the writer
+ * records the position of every block and appends a seek table after the last
+ * one, so the resulting file can be read with zxc_decompress_range().
+ *
+ * With `opts->level_max` above the level, the level becomes adaptive: each
+ * block is compressed at a level between the two, stepped down while the
+ * workers fall behind and up while they have time to spare. Without
+ * `opts->target_mb_s` the writer sets the pace (the level rises while blocks
+ * are ready before the output takes them); with it, the measured compression
+ * speed of the workers is held at or just above that many MB/s. Decoding is
+ * unaffected: the level is not part of the format.
+ *
+ * @param[in] f_in      Input file stream (must be opened in "rb" mode).
+ * @param[out] f_out     Output file stream (must be opened in "wb" mode).
+ * @param[in] n_threads Number of worker threads to spawn (0 = auto-detect number of
+ * CPU cores).
+ * @param[in] opts      Frame options (NULL selects the defaults).
+ *
+ * @return          Total compressed bytes written, or -1 if an error occurred.
+ */
+int64_t zxc_stream_compress_ex(FILE* f_in, FILE* f_out, int n_threads,
+                               const zxc_compress_opts_t* opts);
+
 /**
  * @brief Decompresses data from an input stream to an output stream.
  *
  * Uses the same pipeline architecture as compression to maximize throughput.
+ * When `f_in` is mapped (see above) and `f_out` is a regular file that is not
+ * in append mode, or NULL, the reader and the ordered writer are bypassed:
+ * workers take blocks from the seek table (or a header walk of the mapping)
+ * and write them directly at their offset in `f_out` with `pwrite`.
  *
  * @param[in] f_in      Input file stream (must be opened in "rb" mode).
  * @param[out] f_out     Output file stream (must be opened in "wb" mode).
@@ -63,6 +102,114 @@ int64_t zxc_stream_compress(FILE* f_in, FILE* f_out, int n_threads, int level,
  */
 int64_t zxc_stream_decompress(FILE* f_in, FILE* f_out, int n_threads, int checksum_enabled);
 
+/*
+ * ============================================================================
+ * Engine Flags
+ * ============================================================================
+ * Process-wide switches read by every stream call (and by the worker pools of
+ * the parallel buffer API for `ZXC_STREAM_PIN_THREADS`). Calls already running
+ * keep the flags they started with.
+ *
+ * On Linux, the ordered writer hands blocks bound for a regular file to
+ * io_uring, each at its final offset, so several writes are in flight while
+ * the workers keep compressing; the kernel or the sandbox refusing io_uring
+ * silently selects `fwrite` instead. Build with `-DZXC_DISABLE_URING` to
+ * leave it out entirely.
+ */
+
+/** @brief Always write through stdio, even where io_uring is available. */
+#define ZXC_STREAM_NO_URING 0x1u
+/** @brief Pin each worker thread to its own CPU (Linux only; a hint). */
+#define ZXC_STREAM_PIN_THREADS 0x2u
+
+/**
+ * @brief Sets the stream engine flags.
+ *
+ * @param[in] flags Bitwise OR of `ZXC_STREAM_*` flags (0 restores the defaults).
+ */
+void zxc_stream_set_flags(unsigned flags);
+
+/**
+ * @brief Returns the current stream engine flags.
+ *
+ * @return Bitwise OR of `ZXC_STREAM_*` flags.
+ */
+unsigned zxc_stream_get_flags(void);
+
+/*
+ * ============================================================================
+ * Callback I/O
+ * ============================================================================
+ * Same engine as above, with the two ends supplied as callbacks instead of
+ * `FILE*`: in-memory objects, sockets, or a custom storage layer. The reader
+ * callback is only ever called from the calling thread, the writer callback
+ * only from the engine's writer thread, one call at a time and in stream
+ * order. Neither end is mapped or written positionally.
+ */
+
+/**
+ * @brief Source callback of the callback stream API.
+ *
+ * Short reads are allowed: the engine calls again until it has a full block
+ * or the callback reports the end of the input.
+ *
+ * @param[in]  opaque User pointer given to the stream function.
+ * @param[out] buf    Destination of the read.
+ * @param[in]  len    Maximum number of bytes to read (never 0).
+ * @return Number of bytes read, 0 at the end of the input, or -1 on error.
+ */
+typedef int64_t (*zxc_read_fn)(void* opaque, void* buf, size_t len);
+
+/**
+ * @brief Sink callback of the callback stream API.
+ *
+ * `buf` points straight into the engine's block buffer (no intermediate copy):
+ * it can be handed to `writev`, a socket or an asynchronous submission, but it
+ * is only valid until the callback returns.
+ *
+ * @param[in] opaque User pointer given to the stream function.
+ * @param[in] buf    Bytes to write.
+ * @param[in] len    Number of bytes to write (never 0).
+ * @return 0 when all of `len` was consumed, -1 to abort the stream.
+ */
+typedef int (*zxc_write_fn)(void* opaque, const void* buf, size_t len);
+
+/**
+ * @brief Compresses a stream read and written through callbacks.
+ *
+ * Equivalent to zxc_stream_compress_ex() on the same data.
+ *
+ * @param[in] read_fn   Source callback.
+ * @param[in] write_fn  Sink callback (NULL discards the output, e.g. to measure
+ * the compressed size).
+ * @param[in] opaque    User pointer passed to both callbacks.
+ * @param[in] n_threads Number of worker threads to spawn (0 = auto-detect number of
+ * CPU cores).
+ * @param[in] opts      Frame options (NULL selects the defaults).
+ *
+ * @return          Total compressed bytes written, or -1 if an error occurred
+ * (including a callback returning -1).
+ */
+int64_t zxc_stream_compress_cb(zxc_read_fn read_fn, zxc_write_fn write_fn, void* opaque,
+                               int n_threads, const zxc_compress_opts_t* opts);
+
+/**
+ * @brief Decompresses a stream read and written through callbacks.
+ *
+ * @param[in] read_fn   Source callback.
+ * @param[in] write_fn  Sink callback (NULL discards the output).
+ * @param[in] opaque    User pointer passed to both callbacks.
+ * @param[in] n_threads Number of worker threads to spawn (0 = auto-detect number of
+ * CPU cores).
+ * @param[in] checksum_enabled  If non-zero, enables checksum verification for data
+ * integrity.
+ *
+ * @return          Total decompressed bytes written, or -1 if an error
+ * occurred (including a callback returning -1).
+ */
+int64_t zxc_stream_decompress_cb(zxc_read_fn read_fn, zxc_write_fn write_fn, void* opaque,
+                                 int n_threads, int checksum_enabled);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,740 @@
+/*
+ * Copyright (c) 2025-2026, Bertrand Lebonnois
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file main.c
+ * @brief Benchmark harness (zxc_bench).
+ *
+ * Times the buffer and stream APIs directly, in memory, over a corpus of files
+ * for every combination of levels, thread counts and block sizes. Threads come
+ * from a pool created once per thread count, so thread startup is not timed,
+ * and the stream path runs on in-memory callbacks, so no stdio is involved.
+ *
+ * Each configuration is run once untimed (round-trip check and block
+ * counters), then timed over a number of iterations: the median and p99
+ * latencies, the throughput at the median and the cycles per byte are
+ * reported, as a table and optionally as JSON.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/zxc_buffer.h"
+#include "../../include/zxc_constants.h"
+#include "../../include/zxc_pool.h"
+#include "../../include/zxc_stats.h"
+#include "../../include/zxc_stream.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define ZXC_BENCH_TSC 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+#ifdef _WIN32
+#include <windows.h>
+
+/**
+ * @brief Returns the current monotonic time in nanoseconds.
+ */
+static uint64_t bench_now_ns(void) {
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (uint64_t)((double)count.QuadPart * 1e9 / (double)freq.QuadPart);
+}
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#include <time.h>
+
+/**
+ * @brief Returns the current monotonic time in nanoseconds.
+ */
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+/**
+ * @brief Reads the cycle counter (the TSC on x86-64), or 0 where there is none.
+ */
+static uint64_t bench_cycles(void) {
+#ifdef ZXC_BENCH_TSC
+    return (uint64_t)__rdtsc();
+#else
+    return 0;
+#endif
+}
+
+#define BENCH_MAX_LIST 16
+#define BENCH_MODE_BUFFER 1
+#define BENCH_MODE_STREAM 2
+
+/**
+ * @brief Command line settings.
+ */
+typedef struct {
+    int levels[BENCH_MAX_LIST];  ///< Compression levels to run.
+    int n_levels;                ///< Number of entries in `levels`.
+    int threads[BENCH_MAX_LIST];  ///< Thread counts to run.
+    int n_threads;                ///< Number of entries in `threads`.
+    size_t blocks[BENCH_MAX_LIST];  ///< Block sizes to run (0 = default).
+    int n_blocks;                   ///< Number of entries in `blocks`.
+    int modes;                      ///< BENCH_MODE_* bits.
+    int iterations;                 ///< Timed runs per configuration.
+    int checksum;                   ///< Enable block checksums.
+    const char* json_path;          ///< JSON output ("-" = stdout), or NULL.
+} bench_opts_t;
+
+/**
+ * @brief One input of the corpus, loaded in memory.
+ */
+typedef struct {
+    char* path;     ///< Path as given or found in a directory.
+    uint8_t* data;  ///< Contents.
+    size_t size;    ///< Size of `data`.
+} bench_file_t;
+
+/**
+ * @brief Latency distribution of one direction of a configuration.
+ */
+typedef struct {
+    uint64_t median_ns;  ///< Median latency.
+    uint64_t p99_ns;     ///< 99th percentile latency (nearest rank).
+    double mb_s;         ///< Throughput at the median, in MB/s (10^6 bytes).
+    double cpb;          ///< Cycles per byte at the median (0 = no cycle counter).
+} bench_timing_t;
+
+/**
+ * @brief Result of one configuration.
+ */
+typedef struct {
+    const bench_file_t* file;  ///< Input.
+    int mode;                  ///< BENCH_MODE_BUFFER or BENCH_MODE_STREAM.
+    int level;                 ///< Compression level.
+    int threads;               ///< Thread count.
+    size_t block_size;         ///< Block size (0 = default).
+    size_t comp_size;          ///< Size of the compressed frame.
+    bench_timing_t comp;       ///< Compression timings.
+    bench_timing_t dec;        ///< Decompression timings.
+    zxc_block_stats_t blocks;  ///< Blocks written, per type.
+} bench_result_t;
+
+/**
+ * @brief In-memory source and sink of the stream path.
+ */
+typedef struct {
+    const uint8_t* src;  ///< Bytes to serve.
+    size_t src_size;     ///< Size of `src`.
+    size_t src_pos;      ///< Bytes already served.
+    uint8_t* dst;        ///< Output buffer.
+    size_t dst_cap;      ///< Capacity of `dst`.
+    size_t dst_len;      ///< Bytes written to `dst`.
+} bench_mem_t;
+
+/**
+ * @brief zxc_read_fn serving bytes from a bench_mem_t.
+ */
+static int64_t bench_mem_read(void* opaque, void* buf, size_t len) {
+    bench_mem_t* m = (bench_mem_t*)opaque;
+    size_t n = m->src_size - m->src_pos;
+    if (n > len) n = len;
+    memcpy(buf, m->src + m->src_pos, n);
+    m->src_pos += n;
+    return (int64_t)n;
+}
+
+/**
+ * @brief zxc_write_fn appending to a bench_mem_t.
+ */
+static int bench_mem_write(void* opaque, const void* buf, size_t len) {
+    bench_mem_t* m = (bench_mem_t*)opaque;
+    if (len > m->dst_cap - m->dst_len) return -1;
+    memcpy(m->dst + m->dst_len, buf, len);
+    m->dst_len += len;
+    return 0;
+}
+
+/**
+ * @brief Parses a size with an optional K/M suffix (powers of 1024).
+ *
+ * @param[in]  str Argument such as "65536", "64K" or "1M".
+ * @param[out] out Parsed size in bytes.
+ * @return 0 on success, -1 if the argument is not a valid size.
+ */
+static int bench_parse_size(const char* str, size_t* out) {
+    char* end = NULL;
+    errno = 0;
+    unsigned long long v = strtoull(str, &end, 10);
+    if (errno != 0 || end == str) return -1;
+    if (*end == 'k' || *end == 'K') {
+        v *= 1024ULL;
+        end++;
+    } else if (*end == 'm' || *end == 'M') {
+        v *= 1024ULL * 1024ULL;
+        end++;
+    }
+    if (*end != '\0') return -1;
+    *out = (size_t)v;
+    return 0;
+}
+
+/**
+ * @brief Parses a comma-separated list of integers or sizes.
+ *
+ * @param[in]  str   List such as "1,3,5" or "64K,1M".
+ * @param[out] ints  Receives the values as integers (NULL when parsing sizes).
+ * @param[out] sizes Receives the values as sizes (NULL when parsing integers).
+ * @return Number of values, or -1 if the list is invalid or too long.
+ */
+static int bench_parse_list(const char* str, int* ints, size_t* sizes) {
+    char buf[256];
+    if (strlen(str) >= sizeof(buf)) return -1;
+    strcpy(buf, str);
+    int n = 0;
+    for (char* tok = strtok(buf, ","); tok; tok = strtok(NULL, ",")) {
+        size_t v;
+        if (n == BENCH_MAX_LIST || bench_parse_size(tok, &v) != 0) return -1;
+        if (ints) {
+            if (v > 1024) return -1;
+            ints[n] = (int)v;
+        } else {
+            sizes[n] = v;
+        }
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @brief Loads a whole file in memory.
+ *
+ * @param[in]  path Path of the file.
+ * @param[out] f    Receives the file; `path` is copied.
+ * @return 0 on success, -1 on error (reported on stderr).
+ */
+static int bench_load(const char* path, bench_file_t* f) {
+    FILE* in = fopen(path, "rb");
+    if (!in) {
+        fprintf(stderr, "Error: cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    int ok = fseek(in, 0, SEEK_END) == 0;
+    long size = ok ? ftell(in) : -1;
+    ok = size > 0 && fseek(in, 0, SEEK_SET) == 0;
+    f->path = ok ? malloc(strlen(path) + 1) : NULL;
+    f->data = ok ? malloc((size_t)size) : NULL;
+    f->size = ok ? (size_t)size : 0;
+    ok = f->path && f->data && fread(f->data, 1, f->size, in) == f->size;
+    fclose(in);
+    if (!ok) {
+        fprintf(stderr, "Error: cannot read %s (empty or unreadable)\n", path);
+        free(f->path);
+        free(f->data);
+        return -1;
+    }
+    strcpy(f->path, path);
+    return 0;
+}
+
+/**
+ * @brief qsort() order of C strings.
+ */
+static int bench_cmp_str(const void* a, const void* b) {
+    return strcmp(*(const char* const*)a, *(const char* const*)b);
+}
+
+/**
+ * @brief Adds a file, or the regular files of a directory (sorted, not
+ * recursive), to the corpus.
+ *
+ * @param[in]     path   File or directory.
+ * @param[in,out] files  Corpus, grown as needed.
+ * @param[in,out] n      Number of files in the corpus.
+ * @param[in,out] cap    Capacity of `files`.
+ * @return 0 on success, -1 on error.
+ */
+static int bench_add_path(const char* path, bench_file_t** files, size_t* n, size_t* cap) {
+    char** names = NULL;
+    size_t n_names = 0;
+#ifdef _WIN32
+    DWORD attr = GetFileAttributesA(path);
+    if (attr != INVALID_FILE_ATTRIBUTES && (attr & FILE_ATTRIBUTE_DIRECTORY)) {
+        char pattern[MAX_PATH];
+        snprintf(pattern, sizeof(pattern), "%s\\*", path);
+        WIN32_FIND_DATAA fd;
+        HANDLE h = FindFirstFileA(pattern, &fd);
+        if (h == INVALID_HANDLE_VALUE) return -1;
+        do {
+            if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
+            char** grown = realloc(names, (n_names + 1) * sizeof(char*));
+            size_t len = strlen(path) + strlen(fd.cFileName) + 2;
+            if (!grown) break;
+            names = grown;
+            names[n_names] = malloc(len);
+            if (!names[n_names]) break;
+            snprintf(names[n_names++], len, "%s\\%s", path, fd.cFileName);
+        } while (FindNextFileA(h, &fd));
+        FindClose(h);
+    }
+#else
+    struct stat st;
+    if (stat(path, &st) == 0 && S_ISDIR(st.st_mode)) {
+        DIR* dir = opendir(path);
+        if (!dir) {
+            fprintf(stderr, "Error: cannot open %s: %s\n", path, strerror(errno));
+            return -1;
+        }
+        struct dirent* e;
+        while ((e = readdir(dir)) != NULL) {
+            size_t len = strlen(path) + strlen(e->d_name) + 2;
+            char* full = malloc(len);
+            if (!full) break;
+            snprintf(full, len, "%s/%s", path, e->d_name);
+            char** grown = NULL;
+            if (stat(full, &st) != 0 || !S_ISREG(st.st_mode) ||
+                !(grown = realloc(names, (n_names + 1) * sizeof(char*)))) {
+                free(full);
+                continue;
+            }
+            names = grown;
+            names[n_names++] = full;
+        }
+        closedir(dir);
+    }
+#endif
+    if (!names) {
+        names = malloc(sizeof(char*));
+        if (!names) return -1;
+        names[0] = malloc(strlen(path) + 1);
+        if (!names[0]) {
+            free(names);
+            return -1;
+        }
+        strcpy(names[0], path);
+        n_names = 1;
+    }
+    qsort(names, n_names, sizeof(char*), bench_cmp_str);
+
+    int res = 0;
+    for (size_t i = 0; i < n_names; i++) {
+        if (res == 0 && *n == *cap) {
+            size_t new_cap = *cap ? *cap * 2 : 16;
+            bench_file_t* grown = realloc(*files, new_cap * sizeof(bench_file_t));
+            if (!grown) res = -1;
+            if (grown) {
+                *files = grown;
+                *cap = new_cap;
+            }
+        }
+        if (res == 0 && bench_load(names[i], &(*files)[*n]) == 0) (*n)++;
+        free(names[i]);
+    }
+    free(names);
+    return res;
+}
+
+/**
+ * @brief qsort() order of latencies.
+ */
+static int bench_cmp_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Summarizes the latencies of the timed runs.
+ *
+ * @param[in,out] ns       Latency of each run (sorted in place).
+ * @param[in,out] cycles   Cycle count of each run (sorted in place).
+ * @param[in]     n        Number of runs.
+ * @param[in]     raw_size Uncompressed bytes handled per run.
+ * @param[out]    t        Summary.
+ */
+static void bench_summarize(uint64_t* ns, uint64_t* cycles, int n, size_t raw_size,
+                            bench_timing_t* t) {
+    qsort(ns, (size_t)n, sizeof(uint64_t), bench_cmp_u64);
+    qsort(cycles, (size_t)n, sizeof(uint64_t), bench_cmp_u64);
+    t->median_ns = ns[n / 2];
+    t->p99_ns = ns[(99 * n + 99) / 100 - 1];
+    t->mb_s = t->median_ns ? (double)raw_size * 1e3 / (double)t->median_ns : 0.0;
+    t->cpb = (double)cycles[n / 2] / (double)raw_size;
+}
+
+/**
+ * @brief Compresses @p f once with the configuration of @p r.
+ *
+ * @return Size of the frame, or 0 on error.
+ */
+static size_t bench_compress(zxc_pool_t* pool, const bench_result_t* r,
+                             const zxc_compress_opts_t* opts, uint8_t* dst, size_t cap) {
+    const bench_file_t* f = r->file;
+    if (r->mode == BENCH_MODE_BUFFER) {
+        return pool ? zxc_compress_pool(pool, f->data, f->size, dst, cap, opts)
+                    : zxc_compress_ex(f->data, f->size, dst, cap, opts);
+    }
+    bench_mem_t m = {f->data, f->size, 0, dst, cap, 0};
+    int64_t res = zxc_stream_compress_cb_pool(pool, bench_mem_read, bench_mem_write, &m, opts);
+    return res > 0 ? (size_t)res : 0;
+}
+
+/**
+ * @brief Decompresses the frame of @p r once.
+ *
+ * @return Number of decompressed bytes, or 0 on error.
+ */
+static size_t bench_decompress(zxc_pool_t* pool, const bench_result_t* r, const uint8_t* comp,
+                               uint8_t* dst, size_t cap, int checksum) {
+    if (r->mode == BENCH_MODE_BUFFER) {
+        return pool ? zxc_decompress_pool(pool, comp, r->comp_size, dst, cap, checksum)
+                    : zxc_decompress(comp, r->comp_size, dst, cap, checksum);
+    }
+    bench_mem_t m = {comp, r->comp_size, 0, dst, cap, 0};
+    int64_t res =
+        zxc_stream_decompress_cb_pool(pool, bench_mem_read, bench_mem_write, &m, checksum);
+    return res > 0 ? (size_t)res : 0;
+}
+
+/**
+ * @brief Runs one configuration: an untimed round trip, then the timed runs.
+ *
+ * @param[in]     o      Settings.
+ * @param[in]     pool   Pool of the thread count (NULL = calling thread only).
+ * @param[in,out] r      Configuration in, results out.
+ * @param[out]    comp   Room for a frame (zxc_compress_bound() of the input).
+ * @param[out]    out    Room for the decompressed input.
+ * @param[out]    ns     Room for `o->iterations` latencies.
+ * @param[out]    cycles Room for `o->iterations` cycle counts.
+ * @return 0 on success, -1 if a call failed or the round trip does not match.
+ */
+static int bench_run(const bench_opts_t* o, zxc_pool_t* pool, bench_result_t* r, uint8_t* comp,
+                     uint8_t* out, uint64_t* ns, uint64_t* cycles) {
+    const bench_file_t* f = r->file;
+    const size_t cap = zxc_compress_bound(f->size);
+    zxc_compress_opts_t opts;
+    memset(&opts, 0, sizeof(opts));
+    opts.level = r->level;
+    opts.checksum_enabled = o->checksum;
+    opts.block_size = r->block_size;
+
+    zxc_perf_stats_t perf;
+    memset(&perf, 0, sizeof(perf));
+    zxc_perf_capture(&perf);
+    r->comp_size = bench_compress(pool, r, &opts, comp, cap);
+    zxc_perf_capture(NULL);
+    r->blocks = perf.blocks;
+    if (r->comp_size == 0 || bench_decompress(pool, r, comp, out, f->size, o->checksum) !=
+                                 f->size ||
+        memcmp(out, f->data, f->size) != 0) {
+        fprintf(stderr, "Error: round trip failed for %s (level %d, %d threads)\n", f->path,
+                r->level, r->threads);
+        return -1;
+    }
+
+    for (int i = 0; i < o->iterations; i++) {
+        uint64_t c0 = bench_cycles(), t0 = bench_now_ns();
+        size_t res = bench_compress(pool, r, &opts, comp, cap);
+        ns[i] = bench_now_ns() - t0;
+        cycles[i] = bench_cycles() - c0;
+        if (res != r->comp_size) return -1;
+    }
+    bench_summarize(ns, cycles, o->iterations, f->size, &r->comp);
+
+    for (int i = 0; i < o->iterations; i++) {
+        uint64_t c0 = bench_cycles(), t0 = bench_now_ns();
+        size_t res = bench_decompress(pool, r, comp, out, f->size, o->checksum);
+        ns[i] = bench_now_ns() - t0;
+        cycles[i] = bench_cycles() - c0;
+        if (res != f->size) return -1;
+    }
+    bench_summarize(ns, cycles, o->iterations, f->size, &r->dec);
+    return 0;
+}
+
+/**
+ * @brief Writes @p s as a JSON string literal.
+ */
+static void bench_json_str(FILE* out, const char* s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\')
+            fprintf(out, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(out, "\\u%04x", c);
+        else
+            fputc(c, out);
+    }
+    fputc('"', out);
+}
+
+/**
+ * @brief Writes the timings of one direction as a JSON object.
+ */
+static void bench_json_timing(FILE* out, const char* name, const bench_timing_t* t) {
+    fprintf(out, "\"%s\": {\"median_ns\": %llu, \"p99_ns\": %llu, \"mb_s\": %.2f, ", name,
+            (unsigned long long)t->median_ns, (unsigned long long)t->p99_ns, t->mb_s);
+    if (t->cpb > 0)
+        fprintf(out, "\"cycles_per_byte\": %.3f}", t->cpb);
+    else
+        fprintf(out, "\"cycles_per_byte\": null}");
+}
+
+/**
+ * @brief Writes every result as one JSON document.
+ *
+ * @param[in] out Destination.
+ * @param[in] o   Settings.
+ * @param[in] res Results.
+ * @param[in] n   Number of results.
+ */
+static void bench_json(FILE* out, const bench_opts_t* o, const bench_result_t* res, size_t n) {
+    fprintf(out, "{\n  \"version\": \"%s\",\n  \"isa\": \"%s\",\n", ZXC_LIB_VERSION_STR,
+            zxc_isa_name(zxc_get_active_isa()));
+    fprintf(out, "  \"iterations\": %d,\n  \"checksum\": %s,\n", o->iterations,
+            o->checksum ? "true" : "false");
+    fprintf(out, "  \"cycle_counter\": %s,\n  \"results\": [",
+#ifdef ZXC_BENCH_TSC
+            "\"tsc\""
+#else
+            "null"
+#endif
+    );
+    for (size_t i = 0; i < n; i++) {
+        const bench_result_t* r = &res[i];
+        const zxc_block_stats_t* b = &r->blocks;
+        fprintf(out, "%s\n    {\"file\": ", i ? "," : "");
+        bench_json_str(out, r->file->path);
+        fprintf(out,
+                ", \"size\": %zu, \"api\": \"%s\", \"level\": %d, \"threads\": %d, "
+                "\"block_size\": %zu,\n     \"compressed_size\": %zu, \"ratio\": %.4f,\n     ",
+                r->file->size, r->mode == BENCH_MODE_BUFFER ? "buffer" : "stream", r->level,
+                r->threads, r->block_size ? r->block_size : (size_t)ZXC_BLOCK_SIZE_DEFAULT,
+                r->comp_size, (double)r->file->size / (double)r->comp_size);
+        bench_json_timing(out, "compress", &r->comp);
+        fprintf(out, ",\n     ");
+        bench_json_timing(out, "decompress", &r->dec);
+        const char* names[4] = {"raw", "glo", "ghi", "num"};
+        const uint64_t cnt[4] = {b->raw_blocks, b->glo_blocks, b->ghi_blocks, b->num_blocks};
+        const uint64_t raw[4] = {b->raw_bytes, b->glo_bytes, b->ghi_bytes, b->num_bytes};
+        const uint64_t comp[4] = {b->raw_comp_bytes, b->glo_comp_bytes, b->ghi_comp_bytes,
+                                  b->num_comp_bytes};
+        fprintf(out, ",\n     \"blocks\": {");
+        for (int t = 0; t < 4; t++)
+            fprintf(out,
+                    "%s\"%s\": {\"blocks\": %llu, \"bytes\": %llu, \"compressed_bytes\": %llu}",
+                    t ? ", " : "", names[t], (unsigned long long)cnt[t],
+                    (unsigned long long)raw[t], (unsigned long long)comp[t]);
+        fprintf(out, "}}");
+    }
+    fprintf(out, "\n  ]\n}\n");
+}
+
+/**
+ * @brief Prints one result as a table row.
+ */
+static void bench_print_row(FILE* out, const bench_result_t* r) {
+    const char* name = strrchr(r->file->path, '/');
+    name = name ? name + 1 : r->file->path;
+    const zxc_block_stats_t* b = &r->blocks;
+    fprintf(out,
+            "%-16.16s %-6s %2d %3d %5zuK %7.3f %9.1f %9.1f %7.2f %9.1f %9.1f %7.2f  "
+            "%llu/%llu/%llu/%llu\n",
+            name, r->mode == BENCH_MODE_BUFFER ? "buffer" : "stream", r->level, r->threads,
+            (r->block_size ? r->block_size : (size_t)ZXC_BLOCK_SIZE_DEFAULT) / 1024,
+            (double)r->file->size / (double)r->comp_size, r->comp.mb_s,
+            (double)r->comp.p99_ns / 1e3, r->comp.cpb, r->dec.mb_s, (double)r->dec.p99_ns / 1e3,
+            r->dec.cpb, (unsigned long long)b->raw_blocks, (unsigned long long)b->glo_blocks,
+            (unsigned long long)b->ghi_blocks, (unsigned long long)b->num_blocks);
+}
+
+/**
+ * @brief Prints the usage.
+ */
+static void bench_usage(const char* app) {
+    printf("Usage: %s [<options>] <file|directory>...\n\n", app);
+    printf(
+        "Times the buffer and stream APIs in memory over every file given (and every\n"
+        "regular file of the directories given), for each level, thread count and\n"
+        "block size.\n\n"
+        "Options:\n"
+        "  -l LIST   Compression levels {1,3,5}\n"
+        "  -T LIST   Thread counts {1}: size of the pool the calls run on (the calling\n"
+        "            thread works too); 1 runs the buffer API on the calling thread only\n"
+        "  -B LIST   Block sizes, 64K..4M in 4K steps {256K}\n"
+        "  -m MODE   buffer, stream or both {both}\n"
+        "  -i N      Timed runs per configuration {10}\n"
+        "  -C        Enable checksums\n"
+        "  -j FILE   Write the results as JSON to FILE (- = stdout, the table then goes\n"
+        "            to stderr)\n"
+        "  -h        Show this help\n\n"
+        "Throughput (MB/s, 10^6 bytes) is taken at the median latency; p99 is in us;\n"
+        "cycles per byte use the TSC on x86-64 and are 0 elsewhere. Blocks are counted\n"
+        "as RAW/GLO/GHI/NUM. Set ZXC_ISA (generic, avx2, avx512, neon) to time another\n"
+        "code path than the default one.\n");
+}
+
+int main(int argc, char** argv) {
+    bench_opts_t o;
+    memset(&o, 0, sizeof(o));
+    o.levels[0] = 1, o.levels[1] = 3, o.levels[2] = 5, o.n_levels = 3;
+    o.threads[0] = 1, o.n_threads = 1;
+    o.blocks[0] = 0, o.n_blocks = 1;
+    o.modes = BENCH_MODE_BUFFER | BENCH_MODE_STREAM;
+    o.iterations = 10;
+
+    int argi = 1;
+    for (; argi < argc && argv[argi][0] == '-' && argv[argi][1] != '\0'; argi++) {
+        const char* opt = argv[argi];
+        const char* val = (argi + 1 < argc) ? argv[argi + 1] : NULL;
+        int bad = 0;
+        if (strcmp(opt, "-h") == 0) {
+            bench_usage(argv[0]);
+            return 0;
+        } else if (strcmp(opt, "-C") == 0) {
+            o.checksum = 1;
+            continue;
+        }
+        if (!val) {
+            bad = 1;
+        } else if (strcmp(opt, "-l") == 0) {
+            o.n_levels = bench_parse_list(val, o.levels, NULL);
+            for (int i = 0; i < o.n_levels; i++)
+                if (o.levels[i] < ZXC_LEVEL_FASTEST || o.levels[i] > ZXC_LEVEL_ARCHIVE) bad = 1;
+            bad |= o.n_levels <= 0;
+        } else if (strcmp(opt, "-T") == 0) {
+            o.n_threads = bench_parse_list(val, o.threads, NULL);
+            for (int i = 0; i < o.n_threads; i++) bad |= o.threads[i] < 1;
+            bad |= o.n_threads <= 0;
+        } else if (strcmp(opt, "-B") == 0) {
+            o.n_blocks = bench_parse_list(val, NULL, o.blocks);
+            bad = o.n_blocks <= 0;
+        } else if (strcmp(opt, "-m") == 0) {
+            o.modes = strcmp(val, "buffer") == 0   ? BENCH_MODE_BUFFER
+                      : strcmp(val, "stream") == 0 ? BENCH_MODE_STREAM
+                      : strcmp(val, "both") == 0   ? BENCH_MODE_BUFFER | BENCH_MODE_STREAM
+                                                   : 0;
+            bad = o.modes == 0;
+        } else if (strcmp(opt, "-i") == 0) {
+            o.iterations = atoi(val);
+            bad = o.iterations < 1 || o.iterations > 100000;
+        } else if (strcmp(opt, "-j") == 0) {
+            o.json_path = val;
+        } else {
+            bad = 1;
+        }
+        if (bad) {
+            fprintf(stderr, "Error: invalid option %s %s (see -h)\n", opt, val ? val : "");
+            return 1;
+        }
+        argi++;
+    }
+    if (argi >= argc) {
+        bench_usage(argv[0]);
+        return 1;
+    }
+
+    bench_file_t* files = NULL;
+    size_t n_files = 0, files_cap = 0;
+    for (; argi < argc; argi++)
+        if (bench_add_path(argv[argi], &files, &n_files, &files_cap) != 0) break;
+    if (n_files == 0) {
+        fprintf(stderr, "Error: no input file\n");
+        free(files);
+        return 1;
+    }
+
+    size_t max_size = 0;
+    for (size_t i = 0; i < n_files; i++)
+        if (files[i].size > max_size) max_size = files[i].size;
+    const size_t n_res =
+        n_files * (size_t)(o.n_levels * o.n_threads * o.n_blocks) *
+        (size_t)(((o.modes & BENCH_MODE_BUFFER) ? 1 : 0) + ((o.modes & BENCH_MODE_STREAM) ? 1 : 0));
+    bench_result_t* res = calloc(n_res, sizeof(bench_result_t));
+    uint8_t* comp = malloc(zxc_compress_bound(max_size));
+    uint8_t* out = malloc(max_size);
+    uint64_t* ns = malloc((size_t)o.iterations * sizeof(uint64_t));
+    uint64_t* cycles = malloc((size_t)o.iterations * sizeof(uint64_t));
+    int ret = 1;
+    size_t done = 0;
+    if (!res || !comp || !out || !ns || !cycles) {
+        fprintf(stderr, "Error: out of memory\n");
+        goto cleanup;
+    }
+
+    FILE* table = (o.json_path && strcmp(o.json_path, "-") == 0) ? stderr : stdout;
+    fprintf(table, "%-16s %-6s %2s %3s %6s %7s %9s %9s %7s %9s %9s %7s  %s\n", "file", "api", "L",
+            "thr", "block", "ratio", "comp MB/s", "p99 us", "c/B", "dec MB/s", "p99 us", "c/B",
+            "raw/glo/ghi/num");
+    for (int t = 0; t < o.n_threads; t++) {
+        // Created once per thread count: thread startup is never timed.
+        zxc_pool_t* pool = zxc_pool_create(o.threads[t]);
+        if (!pool) {
+            fprintf(stderr, "Error: cannot start %d threads\n", o.threads[t]);
+            goto cleanup;
+        }
+        for (size_t f = 0; f < n_files; f++) {
+            for (int b = 0; b < o.n_blocks; b++) {
+                for (int l = 0; l < o.n_levels; l++) {
+                    for (int mode = BENCH_MODE_BUFFER; mode <= BENCH_MODE_STREAM; mode <<= 1) {
+                        if (!(o.modes & mode)) continue;
+                        bench_result_t* r = &res[done];
+                        r->file = &files[f];
+                        r->mode = mode;
+                        r->level = o.levels[l];
+                        r->threads = o.threads[t];
+                        r->block_size = o.blocks[b];
+                        zxc_pool_t* p =
+                            (mode == BENCH_MODE_BUFFER && o.threads[t] == 1) ? NULL : pool;
+                        if (bench_run(&o, p, r, comp, out, ns, cycles) != 0) {
+                            zxc_pool_free(pool);
+                            goto cleanup;
+                        }
+                        bench_print_row(table, r);
+                        fflush(table);
+                        done++;
+                    }
+                }
+            }
+        }
+        zxc_pool_free(pool);
+    }
+    ret = 0;
+
+cleanup:
+    if (o.json_path && done > 0) {
+        FILE* jf = strcmp(o.json_path, "-") == 0 ? stdout : fopen(o.json_path, "w");
+        if (jf) {
+            bench_json(jf, &o, res, done);
+            if (jf != stdout) fclose(jf);
+        } else {
+            fprintf(stderr, "Error: cannot write %s: %s\n", o.json_path, strerror(errno));
+            ret = 1;
+        }
+    }
+    for (size_t i = 0; i < n_files; i++) {
+        free(files[i].path);
+        free(files[i].data);
+    }
+    free(files);
+    free(res);
+    free(comp);
+    free(out);
+    free(ns);
+    free(cycles);
+    return ret;
+}
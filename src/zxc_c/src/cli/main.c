@@ -23,6 +23,7 @@
 
 #include "../../include/zxc_buffer.h"
 #include "../../include/zxc_constants.h"
+#include "../../include/zxc_stats.h"
 #include "../../include/zxc_stream.h"
 
 #if defined(_WIN32)
@@ -174,6 +175,42 @@ static double zxc_now(void) {
 }
 #endif
 
+/**
+ * @brief In-memory source and sink for the benchmark, driven through the
+ * callback stream API.
+ */
+typedef struct {
+    const uint8_t* src;  ///< Bytes to serve.
+    size_t src_size;     ///< Size of `src`.
+    size_t src_pos;      ///< Bytes already served.
+    uint8_t* dst;        ///< Output buffer, NULL to discard.
+    size_t dst_cap;      ///< Capacity of `dst`.
+    size_t dst_len;      ///< Bytes written to `dst`.
+} zxc_mem_io_t;
+
+/**
+ * @brief zxc_read_fn serving bytes from a zxc_mem_io_t.
+ */
+static int64_t zxc_mem_read(void* opaque, void* buf, size_t len) {
+    zxc_mem_io_t* m = (zxc_mem_io_t*)opaque;
+    size_t n = m->src_size - m->src_pos;
+    if (n > len) n = len;
+    memcpy(buf, m->src + m->src_pos, n);
+    m->src_pos += n;
+    return (int64_t)n;
+}
+
+/**
+ * @brief zxc_write_fn appending bytes to a zxc_mem_io_t.
+ */
+static int zxc_mem_write(void* opaque, const void* buf, size_t len) {
+    zxc_mem_io_t* m = (zxc_mem_io_t*)opaque;
+    if (len > m->dst_cap - m->dst_len) return -1;
+    memcpy(m->dst + m->dst_len, buf, len);
+    m->dst_len += len;
+    return 0;
+}
+
 /**
  * @brief Validates and resolves the input file path to prevent directory traversal
  * and ensure it is a regular file.
@@ -296,21 +333,85 @@ static void zxc_log_v(const char* fmt, ...) {
     va_end(args);
 }
 
+/**
+ * @brief Prints the performance counters of a stream call (verbose mode only).
+ *
+ * @param[in] p Counters collected with zxc_perf_capture().
+ */
+static void zxc_log_perf(const zxc_perf_stats_t* p) {
+    const double ms = 1e-6;
+    const zxc_block_stats_t* b = &p->blocks;
+    zxc_log_v("Stats: %llu bytes in, %llu bytes out, %.3f ms wall\n",
+              (unsigned long long)p->bytes_in, (unsigned long long)p->bytes_out,
+              (double)p->wall_ns * ms);
+    zxc_log_v("  read     %10.3f ms (blocked on a full ring %.3f ms)\n", (double)p->read_ns * ms,
+              (double)p->read_wait_ns * ms);
+    zxc_log_v("  work     %10.3f ms (checksums %.3f ms, idle workers %.3f ms)\n",
+              (double)p->work_ns * ms, (double)p->checksum_ns * ms,
+              (double)p->work_wait_ns * ms);
+    zxc_log_v("  write    %10.3f ms (waiting for the next block %.3f ms)\n",
+              (double)p->write_ns * ms, (double)p->write_wait_ns * ms);
+    const char* names[4] = {"RAW", "GLO", "GHI", "NUM"};
+    const uint64_t n[4] = {b->raw_blocks, b->glo_blocks, b->ghi_blocks, b->num_blocks};
+    const uint64_t raw[4] = {b->raw_bytes, b->glo_bytes, b->ghi_bytes, b->num_bytes};
+    const uint64_t comp[4] = {b->raw_comp_bytes, b->glo_comp_bytes, b->ghi_comp_bytes,
+                              b->num_comp_bytes};
+    for (int i = 0; i < 4; i++) {
+        if (n[i] == 0) continue;
+        zxc_log_v("  %s      %10llu blocks, %llu -> %llu bytes\n", names[i],
+                  (unsigned long long)n[i], (unsigned long long)raw[i],
+                  (unsigned long long)comp[i]);
+    }
+}
+
+/**
+ * @brief Parses a size argument with an optional K/M suffix (powers of 1024).
+ *
+ * @param[in] str Argument such as "65536", "64K" or "1M".
+ * @param[out] out Parsed size in bytes.
+ * @return 0 on success, -1 if the argument is not a valid size.
+ */
+static int zxc_parse_size(const char* str, size_t* out) {
+    char* end = NULL;
+    errno = 0;
+    unsigned long long v = strtoull(str, &end, 10);
+    if (errno != 0 || end == str) return -1;
+    if (*end == 'k' || *end == 'K') {
+        v *= 1024ULL;
+        end++;
+    } else if (*end == 'm' || *end == 'M') {
+        v *= 1024ULL * 1024ULL;
+        end++;
+    }
+    if (*end != '\0') return -1;
+    *out = (size_t)v;
+    return 0;
+}
+
 void print_help(const char* app) {
     printf("Usage: %s [<options>] [<argument>]...\n\n", app);
     printf(
         "Standard Modes:\n"
         "  -z, --compress    Compress FILE {default}\n"
         "  -d, --decompress  Decompress FILE (or stdin -> stdout)\n"
-        "  -b, --bench       Benchmark in-memory\n\n"
+        "  -b, --bench       Benchmark in-memory (see zxc_bench for corpora and matrices)\n\n"
         "Special Options:\n"
         "  -V, --version     Show version information\n"
         "  -h, --help        Show this help message\n\n"
         "Options:\n"
-        "  -1..-5            Compression level {3}\n"
+        "  -1..-9            Compression level {3} (6-9: entropy coded, slower)\n"
         "  -T, --threads N   Number of threads (0=auto)\n"
         "  -C, --checksum    Enable checksum\n"
         "  -N, --no-checksum Disable checksum\n"
+        "  -S, --seekable    Append a seek table (random access)\n"
+        "  -L, --linked      Let blocks reference the previous block (better ratio)\n"
+        "      --digest      Append a whole-file digest (implies -C; -C -d checks it)\n"
+        "      --adapt MAX   Adapt the level per block between -1..-9 and MAX to the load\n"
+        "      --target MB/S With --adapt: compression speed to hold {keep output busy}\n"
+        "  -B, --block-size N Block size, 64K..4M in 4K steps {256K}\n"
+        "      --pin         Pin worker threads to CPUs (Linux)\n"
+        "      --no-uring    Write through stdio instead of io_uring (Linux)\n"
+        "      --isa NAME    Code path: auto, generic, avx2, avx512, neon {auto}\n"
         "  -k, --keep        Keep input file\n"
         "  -f, --force       Force overwrite\n"
         "  -c, --stdout      Write to stdout\n"
@@ -332,11 +433,13 @@ void print_version(void) {
 #endif
     printf("zxc %s\n", ZXC_LIB_VERSION_STR);
     printf("(%s)\n", sys_info);
+    printf("ISA: %s\n", zxc_isa_name(zxc_get_active_isa()));
 }
 
 typedef enum { MODE_COMPRESS, MODE_DECOMPRESS, MODE_BENCHMARK } zxc_mode_t;
 
-enum { OPT_VERSION = 1000, OPT_HELP };
+enum { OPT_VERSION = 1000, OPT_HELP, OPT_PIN, OPT_NO_URING, OPT_ISA, OPT_DIGEST, OPT_ADAPT,
+       OPT_TARGET };
 
 /**
  * @brief Main entry point.
@@ -351,7 +454,14 @@ int main(int argc, char** argv) {
     int to_stdout = 0;
     int iterations = 5;
     int checksum = 0;
+    int seekable = 0;
+    int linked = 0;
+    int digest = 0;
+    int level_max = 0;
+    int target_mb_s = 0;
+    size_t block_size = 0;
     int level = 3;
+    unsigned stream_flags = 0;
 
     static const struct option long_options[] = {
         {"compress", no_argument, 0, 'z'},    {"decompress", no_argument, 0, 'd'},
@@ -359,11 +469,17 @@ int main(int argc, char** argv) {
         {"keep", no_argument, 0, 'k'},        {"force", no_argument, 0, 'f'},
         {"stdout", no_argument, 0, 'c'},      {"verbose", no_argument, 0, 'v'},
         {"quiet", no_argument, 0, 'q'},       {"checksum", no_argument, 0, 'C'},
-        {"no-checksum", no_argument, 0, 'N'}, {"version", no_argument, 0, 'V'},
-        {"help", no_argument, 0, 'h'},        {0, 0, 0, 0}};
+        {"no-checksum", no_argument, 0, 'N'}, {"seekable", no_argument, 0, 'S'},
+        {"version", no_argument, 0, 'V'},     {"help", no_argument, 0, 'h'},
+        {"block-size", required_argument, 0, 'B'}, {"linked", no_argument, 0, 'L'},
+        {"pin", no_argument, 0, OPT_PIN},     {"no-uring", no_argument, 0, OPT_NO_URING},
+        {"isa", required_argument, 0, OPT_ISA}, {"digest", no_argument, 0, OPT_DIGEST},
+        {"adapt", required_argument, 0, OPT_ADAPT}, {"target", required_argument, 0, OPT_TARGET},
+        {0, 0, 0, 0}};
 
     int opt;
-    while ((opt = getopt_long(argc, argv, "12345b::cCdfhkl:NqT:vVz", long_options, NULL)) != -1) {
+    while ((opt = getopt_long(argc, argv, "123456789b::B:cCdfhkl:LNqST:vVz", long_options,
+                              NULL)) != -1) {
         switch (opt) {
             case 'z':
                 mode = MODE_COMPRESS;
@@ -380,6 +496,10 @@ int main(int argc, char** argv) {
             case '3':
             case '4':
             case '5':
+            case '6':
+            case '7':
+            case '8':
+            case '9':
                 level = opt - '0';
                 break;
             case 'T':
@@ -406,6 +526,52 @@ int main(int argc, char** argv) {
             case 'N':
                 checksum = 0;
                 break;
+            case 'S':
+                seekable = 1;
+                break;
+            case 'L':
+                linked = 1;
+                break;
+            case 'B':
+                if (zxc_parse_size(optarg, &block_size) != 0 || block_size < ZXC_BLOCK_SIZE_MIN ||
+                    block_size > ZXC_BLOCK_SIZE_MAX || block_size % 4096 != 0) {
+                    zxc_log("Error: Invalid block size '%s' (64K..4M, multiple of 4K)\n", optarg);
+                    return 1;
+                }
+                break;
+            case OPT_DIGEST:
+                digest = 1;
+                checksum = 1;
+                break;
+            case OPT_ADAPT:
+                level_max = atoi(optarg);
+                if (level_max < 1 || level_max > 9) {
+                    zxc_log("Error: Invalid --adapt level '%s' (1..9)\n", optarg);
+                    return 1;
+                }
+                break;
+            case OPT_TARGET:
+                target_mb_s = atoi(optarg);
+                if (target_mb_s <= 0) {
+                    zxc_log("Error: Invalid --target speed '%s' (MB/s)\n", optarg);
+                    return 1;
+                }
+                break;
+            case OPT_PIN:
+                stream_flags |= ZXC_STREAM_PIN_THREADS;
+                break;
+            case OPT_NO_URING:
+                stream_flags |= ZXC_STREAM_NO_URING;
+                break;
+            case OPT_ISA: {
+                int isa = zxc_isa_from_name(optarg);
+                if (isa < 0 || zxc_set_isa((zxc_isa_t)isa) != 0) {
+                    zxc_log("Error: Instruction set '%s' is not available on this machine\n",
+                            optarg);
+                    return 1;
+                }
+                break;
+            }
             case '?':
             case 'V':
                 print_version();
@@ -418,6 +584,16 @@ int main(int argc, char** argv) {
         }
     }
 
+    if (seekable && linked) {
+        zxc_log("Error: --seekable and --linked cannot be combined\n");
+        return 1;
+    }
+    if (level_max && level_max < level) {
+        zxc_log("Error: --adapt %d is below the compression level %d\n", level_max, level);
+        return 1;
+    }
+    zxc_stream_set_flags(stream_flags);
+
     // Handle positional arguments for mode selection (e.g., "zxc z file")
     if (optind < argc && mode != MODE_BENCHMARK) {
         if (strcmp(argv[optind], "z") == 0) {
@@ -472,81 +648,31 @@ int main(int argc, char** argv) {
         printf("Input: %s (%zu bytes)\n", in_path, in_size);
         printf("Running %d iterations (Threads: %d)...\n", iterations, num_threads);
 
-#ifdef _WIN32
-        printf("Note: Using tmpfile on Windows (slower than fmemopen).\n");
-        FILE* fm = tmpfile();
-        if (fm) {
-            fwrite(ram, 1, in_size, fm);
-            rewind(fm);
-        }
-#else
-        FILE* fm = fmemopen(ram, in_size, "rb");
-#endif
-        if (!fm) goto bench_cleanup;
-
+        zxc_compress_opts_t b_opts = {level, checksum, 0, block_size, linked};
+        zxc_mem_io_t mem = {ram, in_size, 0, NULL, 0, 0};
         double t0 = zxc_now();
         for (int i = 0; i < iterations; i++) {
-            rewind(fm);
-            zxc_stream_compress(fm, NULL, num_threads, level, checksum);
+            mem.src_pos = 0;
+            zxc_stream_compress_cb(zxc_mem_read, NULL, &mem, num_threads, &b_opts);
         }
         double dt_c = zxc_now() - t0;
-        fclose(fm);
 
         size_t max_c = zxc_compress_bound(in_size);
         c_dat = malloc(max_c);
         if (!c_dat) goto bench_cleanup;
 
-#ifdef _WIN32
-        FILE* fm_in = tmpfile();
-        FILE* fm_out = tmpfile();
-        if (!fm_in || !fm_out) {
-            if (fm_in) fclose(fm_in);
-            if (fm_out) fclose(fm_out);
-            goto bench_cleanup;
-        }
-        fwrite(ram, 1, in_size, fm_in);
-        rewind(fm_in);
-#else
-        FILE* fm_in = fmemopen(ram, in_size, "rb");
-        FILE* fm_out = fmemopen(c_dat, max_c, "wb");
-        if (!fm_in || !fm_out) {
-            if (fm_in) fclose(fm_in);
-            if (fm_out) fclose(fm_out);
-            goto bench_cleanup;
-        }
-#endif
-
-        int64_t c_sz = zxc_stream_compress(fm_in, fm_out, num_threads, level, checksum);
-        if (c_sz < 0) {
-            fclose(fm_in);
-            fclose(fm_out);
-            goto bench_cleanup;
-        }
-
-#ifdef _WIN32
-        rewind(fm_out);
-        fread(c_dat, 1, (size_t)c_sz, fm_out);
-#endif
-        fclose(fm_in);
-        fclose(fm_out);
-
-#ifdef _WIN32
-        FILE* fc = tmpfile();
-        if (!fc) goto bench_cleanup;
-        fwrite(c_dat, 1, (size_t)c_sz, fc);
-        rewind(fc);
-#else
-        FILE* fc = fmemopen(c_dat, (size_t)c_sz, "rb");
-        if (!fc) goto bench_cleanup;
-#endif
+        mem = (zxc_mem_io_t){ram, in_size, 0, c_dat, max_c, 0};
+        int64_t c_sz =
+            zxc_stream_compress_cb(zxc_mem_read, zxc_mem_write, &mem, num_threads, &b_opts);
+        if (c_sz < 0) goto bench_cleanup;
 
+        mem = (zxc_mem_io_t){c_dat, (size_t)c_sz, 0, NULL, 0, 0};
         t0 = zxc_now();
         for (int i = 0; i < iterations; i++) {
-            rewind(fc);
-            zxc_stream_decompress(fc, NULL, num_threads, checksum);
+            mem.src_pos = 0;
+            zxc_stream_decompress_cb(zxc_mem_read, NULL, &mem, num_threads, checksum);
         }
         double dt_d = zxc_now() - t0;
-        fclose(fc);
 
         printf("Compressed: %lld bytes (ratio %.3f)\n", (long long)c_sz, (double)in_size / c_sz);
         printf("Avg Compress  : %.3f MiB/s\n",
@@ -697,11 +823,20 @@ int main(int argc, char** argv) {
     zxc_log_v("Starting... (Compression Level %d)\n", level);
     if (g_verbose) zxc_log("Checksum: %s\n", checksum ? "enabled" : "disabled");
 
+    zxc_compress_opts_t opts = {level, checksum, seekable, block_size, linked};
+    opts.digest = digest;
+    opts.level_max = level_max;
+    opts.target_mb_s = (uint32_t)target_mb_s;
+
+    zxc_perf_stats_t perf;
+    memset(&perf, 0, sizeof(perf));
+    if (g_verbose) zxc_perf_capture(&perf);
     double t0 = zxc_now();
     int64_t bytes = (mode == MODE_COMPRESS)
-                        ? zxc_stream_compress(f_in, f_out, num_threads, level, checksum)
+                        ? zxc_stream_compress_ex(f_in, f_out, num_threads, &opts)
                         : zxc_stream_decompress(f_in, f_out, num_threads, checksum);
     double dt = zxc_now() - t0;
+    zxc_perf_capture(NULL);
 
     if (!use_stdin)
         fclose(f_in);
@@ -720,6 +855,7 @@ int main(int argc, char** argv) {
 
     if (bytes >= 0) {
         zxc_log_v("Processed %lld bytes in %.3fs\n", (long long)bytes, dt);
+        zxc_log_perf(&perf);
         if (!use_stdin && !use_stdout && !keep_input) unlink(in_path);
     } else {
         zxc_log("Operation failed.\n");
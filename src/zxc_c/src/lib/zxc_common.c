@@ -10,6 +10,12 @@
 #include "../../include/zxc_sans_io.h"
 #include "zxc_internal.h"
 
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
 /*
  * ============================================================================
  * CONTEXT MANAGEMENT
@@ -36,18 +42,21 @@ void zxc_aligned_free(void* ptr) {
 
 int zxc_cctx_init(zxc_cctx_t* ctx, size_t chunk_size, int mode, int level, int checksum_enabled) {
     ZXC_MEMSET(ctx, 0, sizeof(zxc_cctx_t));
+    ctx->compression_level = level;
+    ctx->checksum_enabled = checksum_enabled;
 
     if (mode == 0) return 0;
 
+    uint32_t hash_log = zxc_lz_hash_log(chunk_size);
     size_t max_seq = chunk_size / sizeof(uint32_t) + 256;
-    size_t sz_hash = 2 * ZXC_LZ_HASH_SIZE * sizeof(uint32_t);
+    size_t sz_hash = 2 * ((size_t)1 << hash_log) * sizeof(uint32_t);
     size_t sz_chain = chunk_size * sizeof(uint16_t);
     size_t sz_sequences = max_seq * sizeof(uint32_t);
     size_t sz_tokens = max_seq * sizeof(uint8_t);
     size_t sz_offsets = max_seq * sizeof(uint16_t);
     size_t sz_extras =
         max_seq * 2 *
-        ZXC_VBYTE_ALLOC_LEN;  // Max 3 bytes per LL/ML VByte (sufficient for 256KB block)
+        ZXC_VBYTE_ALLOC_LEN;  // Max 4 bytes per LL/ML VByte (sufficient for 4MB blocks)
     size_t sz_lit = chunk_size + ZXC_PAD_SIZE;
 
     // Calculate sizes with alignment padding (64 bytes for cache line alignment)
@@ -80,14 +89,21 @@ int zxc_cctx_init(zxc_cctx_t* ctx, size_t chunk_size, int mode, int level, int c
     ctx->literals = (uint8_t*)(mem + off_lit);
 
     ctx->epoch = 1;
-    ctx->compression_level = level;
-    ctx->checksum_enabled = checksum_enabled;
+    ctx->hash_log = hash_log;
+    ctx->chunk_size = chunk_size;
 
     ZXC_MEMSET(ctx->hash_table, 0, sz_hash);
     return 0;
 }
 
 void zxc_cctx_free(zxc_cctx_t* ctx) {
+    if (ctx->fixed_scratch) {
+        // Caller-provided scratch: nothing was allocated.
+        ctx->lit_buffer = ctx->shuffle_buf = NULL;
+        ctx->link = NULL;
+        ctx->lit_buffer_cap = ctx->shuffle_buf_cap = 0;
+        return;
+    }
     if (ctx->memory_block) {
         zxc_aligned_free(ctx->memory_block);
         ctx->memory_block = NULL;
@@ -98,6 +114,19 @@ void zxc_cctx_free(zxc_cctx_t* ctx) {
         ctx->lit_buffer = NULL;
     }
 
+    free(ctx->opt);
+    ctx->opt = NULL;
+
+    free(ctx->shuffle_buf);
+    ctx->shuffle_buf = NULL;
+    ctx->shuffle_buf_cap = 0;
+
+    if (ctx->link) {
+        free(ctx->link->memory_block);
+        free(ctx->link);
+        ctx->link = NULL;
+    }
+
     ctx->hash_table = NULL;
     ctx->chain_table = NULL;
     ctx->buf_sequences = NULL;
@@ -109,6 +138,35 @@ void zxc_cctx_free(zxc_cctx_t* ctx) {
     ctx->lit_buffer_cap = 0;
 }
 
+uint8_t* zxc_cctx_shuffle_buf(zxc_cctx_t* ctx, size_t size) {
+    if (ctx->fixed_scratch) return ctx->shuffle_buf_cap >= size ? ctx->shuffle_buf : NULL;
+    if (ctx->shuffle_buf_cap < size) {
+        free(ctx->shuffle_buf);
+        ctx->shuffle_buf = (uint8_t*)malloc(size + ZXC_PAD_SIZE);
+        ctx->shuffle_buf_cap = ctx->shuffle_buf ? size : 0;
+    }
+    return ctx->shuffle_buf;
+}
+
+void zxc_block_stats_add(zxc_block_stats_t* dst, const zxc_block_stats_t* src) {
+    dst->raw_blocks += src->raw_blocks;
+    dst->glo_blocks += src->glo_blocks;
+    dst->ghi_blocks += src->ghi_blocks;
+    dst->num_blocks += src->num_blocks;
+    dst->raw_skipped += src->raw_skipped;
+    dst->raw_fallback += src->raw_fallback;
+    dst->ghi_by_data += src->ghi_by_data;
+    dst->num_rejected += src->num_rejected;
+    dst->raw_bytes += src->raw_bytes;
+    dst->glo_bytes += src->glo_bytes;
+    dst->ghi_bytes += src->ghi_bytes;
+    dst->num_bytes += src->num_bytes;
+    dst->raw_comp_bytes += src->raw_comp_bytes;
+    dst->glo_comp_bytes += src->glo_comp_bytes;
+    dst->ghi_comp_bytes += src->ghi_comp_bytes;
+    dst->num_comp_bytes += src->num_comp_bytes;
+}
+
 /*
  * ============================================================================
  * HEADER I/O
@@ -116,27 +174,53 @@ void zxc_cctx_free(zxc_cctx_t* ctx) {
  * Serialization and deserialization of file and block headers.
  */
 
-int zxc_write_file_header(uint8_t* dst, size_t dst_capacity) {
-    if (UNLIKELY(dst_capacity < ZXC_FILE_HEADER_SIZE)) return -1;
+int zxc_write_file_header(uint8_t* dst, size_t dst_capacity, const zxc_file_header_t* fh) {
+    size_t h_size = zxc_file_header_size(fh->flags);
+    if (UNLIKELY(dst_capacity < h_size)) return -1;
+
+    size_t block_size = fh->block_size ? fh->block_size : ZXC_BLOCK_SIZE;
+    if (UNLIKELY(block_size % ZXC_BLOCK_UNIT != 0 || block_size > ZXC_BLOCK_SIZE_MAX)) return -1;
 
     zxc_store_le32(dst, ZXC_MAGIC_WORD);
     dst[4] = ZXC_FILE_FORMAT_VERSION;
-    dst[5] = (uint8_t)(ZXC_BLOCK_SIZE / ZXC_BLOCK_UNIT);
-    dst[6] = 0;
-    dst[7] = 0;
-    return ZXC_FILE_HEADER_SIZE;
+    // Block size in 4KB units: low byte at [5], high byte at [7] (blocks > 1020KB)
+    size_t units = block_size / ZXC_BLOCK_UNIT;
+    dst[5] = (uint8_t)(units & 0xFF);
+    dst[6] = fh->flags;
+    dst[7] = (uint8_t)(units >> 8);
+    size_t pos = ZXC_FILE_HEADER_SIZE;
+    if (fh->flags & ZXC_FILE_FLAG_CONTENT_SIZE) {
+        zxc_store_le64(dst + pos, fh->content_size);
+        pos += ZXC_FILE_CONTENT_SIZE_SIZE;
+    }
+    if (fh->flags & ZXC_FILE_FLAG_DICT_ID) zxc_store_le32(dst + pos, fh->dict_id);
+    return (int)h_size;
 }
 
-int zxc_read_file_header(const uint8_t* src, size_t src_size, size_t* out_block_size) {
+int zxc_read_file_header(const uint8_t* src, size_t src_size, zxc_file_header_t* fh) {
     if (UNLIKELY(src_size < ZXC_FILE_HEADER_SIZE || zxc_le32(src) != ZXC_MAGIC_WORD ||
                  src[4] != ZXC_FILE_FORMAT_VERSION))
         return -1;
 
-    if (out_block_size) {
-        size_t units = src[5] ? src[5] : 64;  // Default to 64 block units (256KB)
-        *out_block_size = units * ZXC_BLOCK_UNIT;
+    uint8_t flags = src[6];
+    size_t h_size = zxc_file_header_size(flags);
+    if (UNLIKELY(src_size < h_size)) return -1;
+
+    size_t units = (size_t)src[5] | ((size_t)src[7] << 8);
+    if (units == 0) units = 64;  // Default to 64 block units (256KB)
+    if (UNLIKELY(units * ZXC_BLOCK_UNIT > ZXC_BLOCK_SIZE_MAX)) return -1;
+
+    if (fh) {
+        fh->block_size = units * ZXC_BLOCK_UNIT;
+        fh->flags = flags;
+        fh->content_size = (flags & ZXC_FILE_FLAG_CONTENT_SIZE)
+                               ? zxc_le64(src + ZXC_FILE_HEADER_SIZE)
+                               : 0;
+        fh->dict_id = (flags & ZXC_FILE_FLAG_DICT_ID)
+                          ? zxc_le32(src + h_size - ZXC_FILE_DICT_ID_SIZE)
+                          : 0;
     }
-    return 0;
+    return (int)h_size;
 }
 
 int zxc_write_block_header(uint8_t* dst, size_t dst_capacity, const zxc_block_header_t* bh) {
@@ -144,7 +228,7 @@ int zxc_write_block_header(uint8_t* dst, size_t dst_capacity, const zxc_block_he
 
     dst[0] = bh->block_type;
     dst[1] = bh->block_flags;
-    zxc_store_le16(dst + 2, bh->reserved);
+    zxc_store_le16(dst + 2, bh->elem_size);
     zxc_store_le32(dst + 4, bh->comp_size);
     zxc_store_le32(dst + 8, bh->raw_size);
     return ZXC_BLOCK_HEADER_SIZE;
@@ -155,18 +239,30 @@ int zxc_read_block_header(const uint8_t* src, size_t src_size, zxc_block_header_
 
     bh->block_type = src[0];
     bh->block_flags = src[1];
-    bh->reserved = zxc_le16(src + 2);
+    bh->elem_size = zxc_le16(src + 2);
     bh->comp_size = zxc_le32(src + 4);
     bh->raw_size = zxc_le32(src + 8);
     return 0;
 }
 
+size_t zxc_peek_file_header_size(const uint8_t* src, size_t src_size) {
+    if (UNLIKELY(src_size < ZXC_FILE_HEADER_SIZE)) return 0;
+    return zxc_file_header_size(src[6]);
+}
+
+size_t zxc_peek_block_size(const uint8_t* src, size_t src_size) {
+    if (UNLIKELY(src_size < ZXC_BLOCK_HEADER_SIZE)) return 0;
+    size_t checksum_sz = (src[1] & ZXC_BLOCK_FLAG_CHECKSUM) ? ZXC_BLOCK_CHECKSUM_SIZE : 0;
+    return ZXC_BLOCK_HEADER_SIZE + checksum_sz + zxc_le32(src + 4);
+}
+
 int zxc_write_num_header(uint8_t* dst, size_t rem, const zxc_num_header_t* nh) {
     if (UNLIKELY(rem < ZXC_NUM_HEADER_BINARY_SIZE)) return -1;
 
     zxc_store_le64(dst, nh->n_values);
     zxc_store_le16(dst + 8, nh->frame_size);
-    zxc_store_le16(dst + 10, 0);
+    dst[10] = nh->codec;
+    dst[11] = 0;
     zxc_store_le32(dst + 12, 0);
     return ZXC_NUM_HEADER_BINARY_SIZE;
 }
@@ -176,6 +272,7 @@ int zxc_read_num_header(const uint8_t* src, size_t src_size, zxc_num_header_t* n
 
     nh->n_values = zxc_le64(src);
     nh->frame_size = zxc_le16(src + 8);
+    nh->codec = src[10];
     return 0;
 }
 
@@ -273,6 +370,165 @@ int zxc_read_ghi_header_and_desc(const uint8_t* src, size_t len, zxc_gnr_header_
     return 0;
 }
 
+/*
+ * ============================================================================
+ * SEEK TABLE I/O
+ * ============================================================================
+ * The seek table is a SEK block appended after the last data block:
+ *   [Block Header][N x (Comp Offset u64, Raw Offset u64)][N u32][Size u32][Magic u32]
+ * The trailer sits in the very last bytes of the frame so it can be located
+ * from the end of the file without walking the blocks.
+ */
+
+int zxc_write_seek_table(uint8_t* dst, size_t dst_capacity, const zxc_seek_entry_t* entries,
+                         size_t n_entries) {
+    if (UNLIKELY(n_entries > (UINT32_MAX - ZXC_BLOCK_HEADER_SIZE - ZXC_SEEK_TRAILER_SIZE) /
+                                 ZXC_SEEK_ENTRY_SIZE))
+        return -1;
+
+    size_t payload = n_entries * ZXC_SEEK_ENTRY_SIZE + ZXC_SEEK_TRAILER_SIZE;
+    size_t total = ZXC_BLOCK_HEADER_SIZE + payload;
+    if (UNLIKELY(dst_capacity < total || total > INT32_MAX)) return -1;
+
+    zxc_block_header_t bh = {.block_type = ZXC_BLOCK_SEK,
+                             .block_flags = ZXC_BLOCK_FLAG_NONE,
+                             .elem_size = 0,
+                             .comp_size = (uint32_t)payload,
+                             .raw_size = 0};
+    uint8_t* p = dst + zxc_write_block_header(dst, dst_capacity, &bh);
+
+    for (size_t i = 0; i < n_entries; i++) {
+        zxc_store_le64(p, entries[i].comp_offset);
+        zxc_store_le64(p + 8, entries[i].raw_offset);
+        p += ZXC_SEEK_ENTRY_SIZE;
+    }
+
+    zxc_store_le32(p, (uint32_t)n_entries);
+    zxc_store_le32(p + 4, (uint32_t)total);
+    zxc_store_le32(p + 8, ZXC_SEEK_MAGIC);
+    return (int)total;
+}
+
+int zxc_read_seek_trailer(const uint8_t* src, size_t src_size, size_t* out_n_entries,
+                          size_t* out_table_size) {
+    if (UNLIKELY(src_size < ZXC_SEEK_TRAILER_SIZE)) return -1;
+
+    const uint8_t* t = src + src_size - ZXC_SEEK_TRAILER_SIZE;
+    if (zxc_le32(t + 8) != ZXC_SEEK_MAGIC) return -1;
+
+    size_t n = zxc_le32(t);
+    size_t table_size = zxc_le32(t + 4);
+    if (UNLIKELY(n > UINT32_MAX / ZXC_SEEK_ENTRY_SIZE ||
+                 table_size !=
+                 ZXC_BLOCK_HEADER_SIZE + n * ZXC_SEEK_ENTRY_SIZE + ZXC_SEEK_TRAILER_SIZE))
+        return -1;
+
+    if (out_n_entries) *out_n_entries = n;
+    if (out_table_size) *out_table_size = table_size;
+    return 0;
+}
+
+/*
+ * ============================================================================
+ * FRAME DIGEST
+ * ============================================================================
+ * The DIG block follows the last data block:
+ *   [Block Header][Digest u64]
+ * Block i contributes rapidhash(checksum_i, seed i) to a 64-bit sum, and the
+ * digest is rapidhash(sum, seed n_blocks). Sums of runs of blocks just add up,
+ * while the seeds keep a reordered, repeated or missing block from cancelling
+ * out.
+ */
+
+int zxc_digest_update(zxc_digest_t* dg, const uint8_t* block, size_t block_size) {
+    if (UNLIKELY(block_size < ZXC_BLOCK_HEADER_SIZE)) return -1;
+    if (block[0] == ZXC_BLOCK_SEK || block[0] == ZXC_BLOCK_DIG || block[0] == ZXC_BLOCK_END)
+        return 0;
+    if (UNLIKELY(!(block[1] & ZXC_BLOCK_FLAG_CHECKSUM) ||
+                 block_size < ZXC_BLOCK_HEADER_SIZE + ZXC_BLOCK_CHECKSUM_SIZE))
+        return -1;
+
+    dg->sum += rapidhash_withSeed(block + ZXC_BLOCK_HEADER_SIZE, ZXC_BLOCK_CHECKSUM_SIZE,
+                                  dg->next_block);
+    dg->next_block++;
+    return 0;
+}
+
+// cppcheck-suppress unusedFunction
+void zxc_digest_start(zxc_digest_t* dg, uint64_t first_block) {
+    dg->sum = 0;
+    dg->first_block = first_block;
+    dg->next_block = first_block;
+}
+
+// cppcheck-suppress unusedFunction
+int zxc_digest_merge(zxc_digest_t* dg, const zxc_digest_t* next) {
+    if (UNLIKELY(next->first_block != dg->next_block)) return -1;
+    dg->sum += next->sum;
+    dg->next_block = next->next_block;
+    return 0;
+}
+
+/**
+ * @brief Computes the value stored in the DIG block of a frame.
+ *
+ * @param[in] dg Digest of all the data blocks.
+ * @return The frame digest.
+ */
+static uint64_t zxc_digest_value(const zxc_digest_t* dg) {
+    uint8_t sum[sizeof(uint64_t)];
+    zxc_store_le64(sum, dg->sum);
+    return rapidhash_withSeed(sum, sizeof(sum), dg->next_block - dg->first_block);
+}
+
+int zxc_write_digest(uint8_t* dst, size_t dst_capacity, const zxc_digest_t* dg) {
+    if (UNLIKELY(dst_capacity < ZXC_DIGEST_BLOCK_SIZE)) return -1;
+
+    zxc_block_header_t bh = {.block_type = ZXC_BLOCK_DIG,
+                             .block_flags = ZXC_BLOCK_FLAG_NONE,
+                             .elem_size = 0,
+                             .comp_size = ZXC_DIGEST_SIZE,
+                             .raw_size = 0};
+    zxc_write_block_header(dst, dst_capacity, &bh);
+    zxc_store_le64(dst + ZXC_BLOCK_HEADER_SIZE, zxc_digest_value(dg));
+    return ZXC_DIGEST_BLOCK_SIZE;
+}
+
+int zxc_check_digest(const uint8_t* src, size_t src_size, const zxc_digest_t* dg) {
+    zxc_block_header_t bh;
+    if (zxc_read_block_header(src, src_size, &bh) != 0 || bh.block_type != ZXC_BLOCK_DIG ||
+        bh.comp_size != ZXC_DIGEST_SIZE || bh.raw_size != 0 || bh.block_flags != 0 ||
+        src_size < ZXC_DIGEST_BLOCK_SIZE)
+        return -1;
+    return zxc_le64(src + ZXC_BLOCK_HEADER_SIZE) == zxc_digest_value(dg) ? 0 : -1;
+}
+
+/*
+ * ============================================================================
+ * END OF STREAM
+ * ============================================================================
+ * The END block is a bare header closing the frame:
+ *   [Type END][Flags 0][Elem Size 0][Comp Size 0][Raw Size 0]
+ * Frames of the buffer and stream APIs end with the input instead, so the
+ * block is optional and decoders only require it to be the last one.
+ */
+
+int zxc_write_end_block(uint8_t* dst, size_t dst_capacity) {
+    zxc_block_header_t bh = {.block_type = ZXC_BLOCK_END,
+                             .block_flags = ZXC_BLOCK_FLAG_NONE,
+                             .elem_size = 0,
+                             .comp_size = 0,
+                             .raw_size = 0};
+    return zxc_write_block_header(dst, dst_capacity, &bh);
+}
+
+// cppcheck-suppress unusedFunction
+int zxc_is_end_block(const uint8_t* src, size_t src_size) {
+    zxc_block_header_t bh;
+    return zxc_read_block_header(src, src_size, &bh) == 0 && bh.block_type == ZXC_BLOCK_END &&
+           bh.block_flags == 0 && bh.elem_size == 0 && bh.comp_size == 0 && bh.raw_size == 0;
+}
+
 /*
  * ============================================================================
  * BITPACKING UTILITIES
@@ -315,6 +571,35 @@ int zxc_bitpack_stream_32(const uint32_t* RESTRICT src, size_t count, uint8_t* R
     return (int)out_bytes;
 }
 
+int zxc_bitpack_stream_64(const uint64_t* RESTRICT src, size_t count, uint8_t* RESTRICT dst,
+                          size_t dst_cap, uint8_t bits) {
+    size_t out_bytes = ((count * bits) + ZXC_BITS_PER_BYTE - 1) / ZXC_BITS_PER_BYTE;
+
+    if (UNLIKELY(dst_cap < out_bytes || bits > 64)) return -1;
+
+    // Each value goes in as two halves of at most 32 bits, flushed after each
+    // one, so the accumulator never holds more than 39 bits.
+    const unsigned half_bits[2] = {bits > 32 ? 32U : bits, bits > 32 ? bits - 32U : 0U};
+    const uint64_t half_mask[2] = {(1ULL << half_bits[0]) - 1, (1ULL << half_bits[1]) - 1};
+    uint64_t acc = 0;
+    unsigned n = 0;
+    uint8_t* o = dst;
+
+    for (size_t i = 0; i < count; i++) {
+        for (int h = 0; h < 2; h++) {
+            acc |= ((src[i] >> (32 * h)) & half_mask[h]) << n;
+            n += half_bits[h];
+            while (n >= ZXC_BITS_PER_BYTE) {
+                *o++ = (uint8_t)acc;
+                acc >>= ZXC_BITS_PER_BYTE;
+                n -= ZXC_BITS_PER_BYTE;
+            }
+        }
+    }
+    if (n > 0) *o++ = (uint8_t)acc;
+    return (int)out_bytes;
+}
+
 /*
  * ============================================================================
  * COMPRESS BOUND CALCULATION
@@ -323,8 +608,107 @@ int zxc_bitpack_stream_32(const uint32_t* RESTRICT src, size_t count, uint8_t* R
 size_t zxc_compress_bound(size_t input_size) {
     if (UNLIKELY(input_size > SIZE_MAX - (SIZE_MAX >> 10))) return 0;
 
-    size_t n = (input_size + ZXC_BLOCK_SIZE - 1) / ZXC_BLOCK_SIZE;
+    // Valid for every selectable block size: counts blocks of the smallest size,
+    // each with its header, checksum and seek entry, plus the seek table framing
+    // and the frame digest.
+    size_t n = (input_size + ZXC_BLOCK_SIZE_MIN - 1) / ZXC_BLOCK_SIZE_MIN;
     if (n == 0) n = 1;
-    return ZXC_FILE_HEADER_SIZE + (n * (ZXC_BLOCK_HEADER_SIZE + ZXC_BLOCK_CHECKSUM_SIZE + 64)) +
-           input_size;
+    return ZXC_FILE_HEADER_MAX_SIZE +
+           (n * (ZXC_BLOCK_HEADER_SIZE + ZXC_BLOCK_CHECKSUM_SIZE + ZXC_SEEK_ENTRY_SIZE + 64)) +
+           ZXC_BLOCK_HEADER_SIZE + ZXC_SEEK_TRAILER_SIZE + ZXC_DIGEST_BLOCK_SIZE + input_size;
+}
+
+/*
+ * ============================================================================
+ * PERFORMANCE COUNTERS
+ * ============================================================================
+ * The capture target and the call depth are per thread, so a call only
+ * pays for a thread-local read when nobody is collecting. The trace hook is
+ * compiled in with -DZXC_ENABLE_TRACING only.
+ */
+
+static ZXC_THREAD_LOCAL zxc_perf_stats_t* zxc_perf_target = NULL;
+static ZXC_THREAD_LOCAL int zxc_perf_depth = 0;
+
+#ifdef ZXC_ENABLE_TRACING
+static zxc_trace_fn zxc_trace_hook = NULL;
+static void* zxc_trace_opaque = NULL;
+#endif
+
+uint64_t zxc_perf_now(void) {
+#if defined(_WIN32)
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (uint64_t)((double)count.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+// cppcheck-suppress unusedFunction
+void zxc_perf_capture(zxc_perf_stats_t* stats) { zxc_perf_target = stats; }
+
+// cppcheck-suppress unusedFunction
+int zxc_set_trace_hook(zxc_trace_fn fn, void* opaque) {
+#ifdef ZXC_ENABLE_TRACING
+    zxc_trace_hook = fn;
+    zxc_trace_opaque = opaque;
+    return 0;
+#else
+    (void)fn;
+    (void)opaque;
+    return -1;
+#endif
+}
+
+void zxc_perf_enter_worker(void) { zxc_perf_depth = 1; }
+
+zxc_perf_stats_t* zxc_perf_begin(zxc_perf_call_t* call, const char* name) {
+    call->on = 0;
+    if (zxc_perf_depth++ > 0) return NULL;
+    call->dst = zxc_perf_target;
+#ifdef ZXC_ENABLE_TRACING
+    if (!call->dst && !zxc_trace_hook) return NULL;
+#else
+    if (LIKELY(!call->dst)) return NULL;
+#endif
+    call->on = 1;
+    call->name = name;
+    ZXC_MEMSET(&call->stats, 0, sizeof(call->stats));
+#ifdef ZXC_ENABLE_TRACING
+    if (zxc_trace_hook) zxc_trace_hook(zxc_trace_opaque, name, 0, NULL);
+#endif
+    call->t0 = zxc_perf_now();
+    return &call->stats;
+}
+
+void zxc_perf_end(zxc_perf_call_t* call, uint64_t bytes_in, uint64_t bytes_out) {
+    zxc_perf_depth--;
+    if (LIKELY(!call->on)) return;
+    call->stats.wall_ns = zxc_perf_now() - call->t0;
+    call->stats.calls = 1;
+    call->stats.bytes_in += bytes_in;
+    call->stats.bytes_out += bytes_out;
+    if (call->dst) zxc_perf_stats_add(call->dst, &call->stats);
+#ifdef ZXC_ENABLE_TRACING
+    if (zxc_trace_hook) zxc_trace_hook(zxc_trace_opaque, call->name, 1, &call->stats);
+#endif
+}
+
+void zxc_perf_stats_add(zxc_perf_stats_t* dst, const zxc_perf_stats_t* src) {
+    zxc_block_stats_add(&dst->blocks, &src->blocks);
+    dst->calls += src->calls;
+    dst->bytes_in += src->bytes_in;
+    dst->bytes_out += src->bytes_out;
+    dst->wall_ns += src->wall_ns;
+    dst->read_ns += src->read_ns;
+    dst->read_wait_ns += src->read_wait_ns;
+    dst->work_ns += src->work_ns;
+    dst->work_wait_ns += src->work_wait_ns;
+    dst->write_ns += src->write_ns;
+    dst->write_wait_ns += src->write_wait_ns;
+    dst->checksum_ns += src->checksum_ns;
 }
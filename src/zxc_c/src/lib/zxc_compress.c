@@ -22,28 +22,14 @@
 #define ZXC_NUM_FRAME_SIZE \
     128  // Maximum number of frames that can be processed in a single compression operation.
 #define ZXC_EPOCH_BITS \
-    14  // Number of bits reserved for epoch tracking in compressed pointers.
-        // Derived from chunk size: 2^18 = ZXC_BLOCK_SIZE => 32 - 18 = 14 bits.
+    10  // Number of bits reserved for epoch tracking in compressed pointers.
+        // Derived from the largest block: 2^22 = ZXC_BLOCK_SIZE_MAX => 32 - 22 = 10 bits.
 #define ZXC_OFFSET_MASK              \
     ((1U << (32 - ZXC_EPOCH_BITS)) - \
      1)  // Mask to extract the offset bits from a compressed pointer.
 #define ZXC_MAX_EPOCH \
     (1U << ZXC_EPOCH_BITS)  // Maximum number of epochs supported by the compression system.
 
-/**
- * @brief Computes a hash value optimized for LZ77 pattern matching speed.
- *
- * Knuth's multiplicative hash constant: 2654435761 (golden ratio * 2^32)
- * Returns upper bits which have the best avalanche properties
- * The caller applies the mask (& (ZXC_LZ_HASH_SIZE - 1))
- *
- * @param[in] val The 32-bit integer sequence (e.g., 4 bytes from the input stream).
- * @return uint32_t A hash value suitable for indexing the match table.
- */
-static ZXC_ALWAYS_INLINE uint32_t zxc_hash_func(uint32_t val) {
-    return (val * 2654435761U) >> (32 - ZXC_LZ_HASH_BITS);
-}
-
 #if defined(ZXC_USE_AVX2)
 /**
  * @brief Reduces a 256-bit integer vector to a single scalar by finding the maximum unsigned 32-bit
@@ -100,13 +86,74 @@ static ZXC_ALWAYS_INLINE size_t zxc_write_vbyte(uint8_t* dst, uint32_t val) {
  * @param ref       Pointer to the reference data where the match was found.
  * @param len       Length of the matching sequence in bytes.
  * @param backtrack Distance to backtrack from the current position to find the match.
+ * @param off       Offset to encode (distance from the backtracked position to the
+ * reference, measured through the dictionary when ref points into it).
  */
 typedef struct {
     const uint8_t* ref;
     uint32_t len;
     uint32_t backtrack;
+    uint32_t off;
 } zxc_match_t;
 
+/**
+ * @brief Searches the prepared dictionary for a match longer than the current best.
+ *
+ * The dictionary is virtually placed right before the block, so a dictionary
+ * position d_idx lies cur_pos + (dict->size - d_idx) bytes behind ip. A match
+ * that reaches the end of the dictionary carries on from the start of the
+ * block, as the decoder does (see zxc_copy_dict_match()): this is what lets a
+ * linked block continue a repeat that straddles the block boundary.
+ *
+ * @param[in] dict Prepared dictionary.
+ * @param[in] src Start of the block.
+ * @param[in] ip Current input position pointer.
+ * @param[in] iend Pointer to the end of the input buffer.
+ * @param[in] cur_pos Position of ip in the block.
+ * @param[in] cur_val The 4 bytes at ip.
+ * @param[in] best Best match found in the block so far.
+ * @param[in] p Search parameters of the level.
+ * @return best, or a longer match whose ref points into the dictionary.
+ */
+static ZXC_NOINLINE zxc_match_t zxc_lz77_probe_dict(const struct zxc_dict_s* dict,
+                                                    const uint8_t* src, const uint8_t* ip,
+                                                    const uint8_t* iend,
+                                                    uint32_t cur_pos, uint32_t cur_val,
+                                                    zxc_match_t best, zxc_lz77_params_t p) {
+    const uint8_t* d_end = dict->content + dict->size;
+    uint32_t d_idx = dict->hash_table[zxc_hash_func(cur_val, dict->hash_log)];
+    int attempts = p.search_depth;
+
+    while (d_idx > 0 && attempts-- >= 0) {
+        if (cur_pos + (dict->size - d_idx) > ZXC_LZ_MAX_DIST) break;
+        const uint8_t* ref = dict->content + d_idx;
+        if (zxc_le32(ref) == cur_val) {
+            size_t max_len = (size_t)(iend - ip);
+            size_t seg = (size_t)(d_end - ref);  // Part of the match the dictionary can hold
+            size_t lim = seg < max_len ? seg : max_len;
+            uint32_t mlen = 4;
+            while (mlen + 8 <= lim && zxc_le64(ip + mlen) == zxc_le64(ref + mlen)) mlen += 8;
+            while (mlen < lim && ip[mlen] == ref[mlen]) mlen++;
+            if (mlen == seg) {
+                const uint8_t* ip2 = ip + seg;  // Compared against the block start
+                size_t k = 0, rem = max_len - seg;
+                while (k + 8 <= rem && zxc_le64(ip2 + k) == zxc_le64(src + k)) k += 8;
+                while (k < rem && ip2[k] == src[k]) k++;
+                mlen += (uint32_t)k;
+            }
+            if (mlen > best.len) {
+                best.len = mlen;
+                best.ref = ref;
+                if (mlen >= (uint32_t)p.sufficient_len) break;
+            }
+        }
+        uint16_t delta = dict->chain_table[d_idx];
+        if (delta == 0) break;
+        d_idx -= delta;
+    }
+    return best;
+}
+
 /**
  * @brief Finds the best matching sequence for LZ77 compression
  *
@@ -122,6 +169,8 @@ typedef struct {
  * @param[in,out] hash_table Pointer to the hash table for match finding.
  * @param[in,out] chain_table Pointer to the chain table for collision handling.
  * @param[in] epoch_mark Current epoch marker for hash table invalidation.
+ * @param[in] hash_log Number of hash bits used for this block.
+ * @param[in] dict Prepared dictionary searched after the block's own chain (NULL = none).
  * @param[in] level Compression level (affects search depth and lazy matching).
  * @param[in] search_depth Maximum number of hash chain entries to search.
  * @param[in] sufficient_len Match length threshold to stop searching.
@@ -133,17 +182,17 @@ typedef struct {
 static ZXC_ALWAYS_INLINE zxc_match_t zxc_lz77_find_best_match(
     const uint8_t* src, const uint8_t* ip, const uint8_t* iend, const uint8_t* mflimit,
     const uint8_t* anchor, uint32_t* hash_table, uint16_t* chain_table, uint32_t epoch_mark,
-    int level, zxc_lz77_params_t p) {
+    uint32_t hash_log, const struct zxc_dict_s* dict, int level, zxc_lz77_params_t p) {
     // Track the best match found so far.
     //  ref is the pointer to the start of the match in the history buffer,
     //  len is the match length, and backtrack is the distance from ip to ref.
     //  Start with a sentinel length just below the minimum so any valid match will replace it.
-    zxc_match_t best = (zxc_match_t){NULL, ZXC_LZ_MIN_MATCH_LEN - 1, 0};
+    zxc_match_t best = (zxc_match_t){NULL, ZXC_LZ_MIN_MATCH_LEN - 1, 0, 0};
 
     // Load the 4-byte sequence at the current position and hash it.
     // The hash value h is used to index into the LZ77 hash table.
     uint32_t cur_val = zxc_le32(ip);
-    uint32_t h = zxc_hash_func(cur_val);
+    uint32_t h = zxc_hash_func(cur_val, hash_log);
 
     // Current position in the input buffer expressed as a 32-bit index.
     // This index is what we store in / retrieve from the hash/chain tables.
@@ -174,7 +223,7 @@ static ZXC_ALWAYS_INLINE zxc_match_t zxc_lz77_find_best_match(
                                ? (uint16_t)(cur_pos - match_idx)
                                : 0;
 
-    if (match_idx == 0) return best;
+    if (match_idx == 0 && !dict) return best;
 
     int attempts = p.search_depth;
     int is_first = 1;
@@ -291,22 +340,34 @@ static ZXC_ALWAYS_INLINE zxc_match_t zxc_lz77_find_best_match(
         is_first = 0;
     }
 
+    // Dictionary: probed out of line, so the block-only search keeps its code layout.
+    int from_dict = 0;
+    if (UNLIKELY(dict != NULL) && cur_pos < ZXC_LZ_MAX_DIST &&
+        best.len < (uint32_t)p.sufficient_len) {
+        const uint8_t* block_ref = best.ref;
+        best = zxc_lz77_probe_dict(dict, src, ip, iend, cur_pos, cur_val, best, p);
+        from_dict = best.ref != block_ref;
+    }
+
     if (best.ref) {
         // Backtrack to extend match backwards
         const uint8_t* b_ip = ip;
         const uint8_t* b_ref = best.ref;
-        while (b_ip > anchor && b_ref > src && b_ip[-1] == b_ref[-1]) {
+        const uint8_t* b_low = from_dict ? dict->content : src;
+        while (b_ip > anchor && b_ref > b_low && b_ip[-1] == b_ref[-1]) {
             b_ip--;
             b_ref--;
             best.len++;
             best.backtrack++;
         }
         best.ref = b_ref;
+        best.off = from_dict ? (uint32_t)(b_ip - src) + (uint32_t)(b_low + dict->size - b_ref)
+                             : (uint32_t)(b_ip - b_ref);
     }
 
     if (p.use_lazy && best.ref && best.len < 128 && ip + 1 < mflimit) {
         uint32_t next_val = zxc_le32(ip + 1);
-        uint32_t h2 = zxc_hash_func(next_val);
+        uint32_t h2 = zxc_hash_func(next_val, hash_log);
         uint32_t next_head = hash_table[2 * h2];
         uint32_t next_stored_tag = hash_table[2 * h2 + 1];
         uint32_t next_idx =
@@ -334,7 +395,7 @@ static ZXC_ALWAYS_INLINE zxc_match_t zxc_lz77_find_best_match(
             best.ref = NULL;
         } else if (level >= 4 && ip + 2 < mflimit) {
             uint32_t val3 = zxc_le32(ip + 2);
-            uint32_t h3 = zxc_hash_func(val3);
+            uint32_t h3 = zxc_hash_func(val3, hash_log);
             uint32_t head3 = hash_table[2 * h3];
             uint32_t tag3 = hash_table[2 * h3 + 1];
             uint32_t idx3 =
@@ -391,14 +452,12 @@ static ZXC_ALWAYS_INLINE zxc_match_t zxc_lz77_find_best_match(
  * @param[in] dst_cap Capacity of the destination buffer in bytes.
  * @param[out] out_sz Pointer to a variable where the total size of the compressed
  * output will be stored.
- * @param[in] crc_val The pre-calculated XXH3 value (if checksum is enabled).
  *
  * @return 0 on success, or -1 on failure (e.g., invalid input size, destination
  * buffer too small).
  */
 static int zxc_encode_block_num(const zxc_cctx_t* ctx, const uint8_t* RESTRICT src, size_t src_size,
-                                uint8_t* RESTRICT dst, size_t dst_cap, size_t* out_sz,
-                                uint64_t crc_val) {
+                                uint8_t* RESTRICT dst, size_t dst_cap, size_t* out_sz) {
     if (UNLIKELY(src_size % 4 != 0 || src_size == 0)) return -1;
     int chk = ctx->checksum_enabled;
 
@@ -563,11 +622,796 @@ static int zxc_encode_block_num(const zxc_cctx_t* ctx, const uint8_t* RESTRICT s
     bh.comp_size = p_sz;
     int hw = zxc_write_block_header(dst, dst_cap, &bh);
 
-    if (chk) zxc_store_le64(dst + hw, crc_val);
     *out_sz = hw + (chk ? ZXC_BLOCK_CHECKSUM_SIZE : 0) + p_sz;
     return 0;
 }
 
+/**
+ * @brief Encodes a block of 16/64-bit integers or floats as a NUM block.
+ *
+ * Uses the frame layout of zxc_encode_block_num() with the transform of the
+ * codec:
+ * - **Delta** (16 and 64-bit integers): zigzag of `value[i] - value[i-1]`.
+ * - **Delta-of-delta** (64-bit timestamps): zigzag of the change of the delta,
+ *   0 for a regular clock, so such frames shrink to their header.
+ * - **XOR** (floats): `bits[i] ^ bits[i-1]`. Close values share sign, exponent
+ *   and top mantissa bits, which cancel out; the trailing zero bits common to
+ *   the frame are dropped as well (short decimal mantissas).
+ *
+ * Each frame starts from its base, the value preceding it (the first value for
+ * the first frame); the delta of the delta-of-delta codec is carried.
+ *
+ * @param[in] ctx Compression context (checksum setting).
+ * @param[in] codec NUM codec (ZXC_NUM_CODEC_U16_DELTA .. ZXC_NUM_CODEC_F64_XOR).
+ * @param[in] src Pointer to the source values (little-endian).
+ * @param[in] src_size Size of the source buffer in bytes. Must be a non-zero
+ * multiple of the element size.
+ * @param[out] dst Pointer to the destination buffer.
+ * @param[in] dst_cap Capacity of the destination buffer in bytes.
+ * @param[out] out_sz Pointer to a variable receiving the size of the block.
+ *
+ * @return 0 on success, or -1 on failure (invalid size, destination too small).
+ */
+static int zxc_encode_block_num_typed(const zxc_cctx_t* ctx, int codec,
+                                      const uint8_t* RESTRICT src, size_t src_size,
+                                      uint8_t* RESTRICT dst, size_t dst_cap,
+                                      size_t* out_sz) {
+    const size_t elem = zxc_num_elem_size(codec);
+    if (UNLIKELY(src_size % elem != 0 || src_size == 0)) return -1;
+    int chk = ctx->checksum_enabled;
+
+    size_t count = src_size / elem;
+    size_t h_gap = ZXC_BLOCK_HEADER_SIZE + (chk ? ZXC_BLOCK_CHECKSUM_SIZE : 0);
+
+    if (UNLIKELY(dst_cap < h_gap + ZXC_NUM_HEADER_BINARY_SIZE)) return -1;
+
+    zxc_block_header_t bh = {.block_type = ZXC_BLOCK_NUM, .raw_size = (uint32_t)src_size};
+    uint8_t* p_curr = dst + h_gap;
+    size_t rem = dst_cap - h_gap;
+    zxc_num_header_t nh = {
+        .n_values = count, .frame_size = ZXC_NUM_FRAME_SIZE, .codec = (uint8_t)codec};
+
+    int hs = zxc_write_num_header(p_curr, rem, &nh);
+    if (UNLIKELY(hs < 0)) return -1;
+
+    p_curr += hs;
+    rem -= hs;
+
+    uint64_t vals[ZXC_NUM_FRAME_SIZE];
+    const uint8_t* in_ptr = src;
+    uint64_t prev = elem == 2 ? zxc_le16(src) : elem == 4 ? zxc_le32(src) : zxc_le64(src);
+    uint64_t prev_d = 0;
+
+    for (size_t i = 0; i < count; i += ZXC_NUM_FRAME_SIZE) {
+        size_t frames = (count - i < ZXC_NUM_FRAME_SIZE) ? (count - i) : ZXC_NUM_FRAME_SIZE;
+        uint64_t base = prev, max_v = 0, any = 0;
+
+        switch (codec) {
+            case ZXC_NUM_CODEC_U16_DELTA:
+                for (size_t j = 0; j < frames; j++) {
+                    uint64_t v = zxc_le16(in_ptr + j * 2);
+                    vals[j] = zxc_zigzag_encode((int32_t)(int16_t)(uint16_t)(v - prev));
+                    prev = v;
+                }
+                break;
+            case ZXC_NUM_CODEC_U64_DELTA:
+                for (size_t j = 0; j < frames; j++) {
+                    uint64_t v = zxc_le64(in_ptr + j * 8);
+                    vals[j] = zxc_zigzag_encode64((int64_t)(v - prev));
+                    prev = v;
+                }
+                break;
+            case ZXC_NUM_CODEC_U64_DOD:
+                for (size_t j = 0; j < frames; j++) {
+                    uint64_t v = zxc_le64(in_ptr + j * 8);
+                    uint64_t d = v - prev;
+                    vals[j] = zxc_zigzag_encode64((int64_t)(d - prev_d));
+                    prev_d = d;
+                    prev = v;
+                }
+                break;
+            case ZXC_NUM_CODEC_F32_XOR:
+                for (size_t j = 0; j < frames; j++) {
+                    uint64_t v = zxc_le32(in_ptr + j * 4);
+                    vals[j] = v ^ prev;
+                    prev = v;
+                }
+                break;
+            default:  // ZXC_NUM_CODEC_F64_XOR
+                for (size_t j = 0; j < frames; j++) {
+                    uint64_t v = zxc_le64(in_ptr + j * 8);
+                    vals[j] = v ^ prev;
+                    prev = v;
+                }
+                break;
+        }
+        in_ptr += frames * elem;
+
+        for (size_t j = 0; j < frames; j++) {
+            max_v = vals[j] > max_v ? vals[j] : max_v;
+            any |= vals[j];
+        }
+        uint8_t shift = 0;
+        if (codec >= ZXC_NUM_CODEC_F32_XOR && any != 0) {
+            shift = (uint8_t)zxc_ctz64(any);
+            for (size_t j = 0; j < frames; j++) vals[j] >>= shift;
+        }
+        uint8_t bits = (uint8_t)(zxc_highbit64(max_v) - (max_v ? shift : 0));
+        size_t packed = ((frames * bits) + ZXC_BITS_PER_BYTE - 1) / ZXC_BITS_PER_BYTE;
+        if (UNLIKELY(rem < 16 + packed)) return -1;
+
+        zxc_store_le16(p_curr, (uint16_t)frames);
+        zxc_store_le16(p_curr + 2, (uint16_t)(bits | (shift << ZXC_NUM_SHIFT_SHIFT)));
+        zxc_store_le64(p_curr + 4, base);
+        zxc_store_le32(p_curr + 12, (uint32_t)packed);
+
+        p_curr += 16;
+        rem -= 16;
+
+        int pb = zxc_bitpack_stream_64(vals, frames, p_curr, rem, bits);
+        if (UNLIKELY(pb < 0)) return -1;
+        p_curr += pb;
+        rem -= pb;
+    }
+
+    uint32_t p_sz = (uint32_t)(p_curr - (dst + h_gap));
+    if (chk) {
+        bh.block_flags |= ZXC_BLOCK_FLAG_CHECKSUM;
+        bh.block_flags |= (ZXC_CHECKSUM_RAPIDHASH & ZXC_CHECKSUM_TYPE_MASK);
+    }
+
+    bh.comp_size = p_sz;
+    int hw = zxc_write_block_header(dst, dst_cap, &bh);
+
+    *out_sz = hw + (chk ? ZXC_BLOCK_CHECKSUM_SIZE : 0) + p_sz;
+    return 0;
+}
+
+/*
+ * ============================================================================
+ * FSE (tANS) ENCODER
+ * ============================================================================
+ */
+
+/**
+ * @struct zxc_fse_sym_t
+ * @brief Encoder transform of one symbol (zstd-style tANS symbol table).
+ */
+typedef struct {
+    uint32_t delta_nb_bits;  // (max_bits << 16) - (count << max_bits)
+    int32_t delta_state;     // Start of the symbol's states in the state table - count
+} zxc_fse_sym_t;
+
+/**
+ * @brief Scales the histogram to counts summing to 2^log.
+ *
+ * Every present symbol keeps a count of at least 1. Rounding leftovers go to
+ * the most frequent symbol; an excess is taken from the largest counts.
+ */
+static void zxc_fse_normalize(const uint32_t* count, unsigned max_sym, size_t total, unsigned log,
+                              uint16_t* norm) {
+    const uint32_t size = 1U << log;
+    uint32_t sum = 0;
+    unsigned big = 0;
+
+    for (unsigned s = 0; s <= max_sym; s++) {
+        norm[s] = 0;
+        if (!count[s]) continue;
+        uint32_t v = (uint32_t)(((uint64_t)count[s] * size + total / 2) / total);
+        norm[s] = (uint16_t)(v ? v : 1);
+        sum += norm[s];
+        if (count[s] > count[big]) big = s;
+    }
+
+    if (sum < size) {
+        norm[big] += (uint16_t)(size - sum);
+        return;
+    }
+    while (sum > size) {
+        unsigned top = 0;
+        for (unsigned s = 1; s <= max_sym; s++)
+            if (norm[s] > norm[top]) top = s;
+        norm[top]--;
+        sum--;
+    }
+}
+
+/**
+ * @struct zxc_fse_ctable_t
+ * @brief Encoder tables built from the normalized counts.
+ */
+typedef struct {
+    uint16_t state_table[1U << ZXC_FSE_TABLE_LOG_MAX];
+    zxc_fse_sym_t tt[ZXC_FSE_SYMBOLS];
+    unsigned log;
+} zxc_fse_ctable_t;
+
+/**
+ * @brief Encodes one stream; returns its size or 0 if it goes past @p limit.
+ *
+ * @p limit is the last position an 8-byte store may start at.
+ */
+static size_t zxc_fse_encode_stream(const zxc_fse_ctable_t* RESTRICT ct,
+                                    const uint8_t* RESTRICT src, size_t n, uint8_t* RESTRICT dst,
+                                    const uint8_t* limit) {
+    const uint32_t size = 1U << ct->log;
+    const uint16_t* const state_table = ct->state_table;
+    const zxc_fse_sym_t* const tt = ct->tt;
+    uint8_t* op = dst;
+    uint64_t acc = 0;
+    unsigned bits = 0;
+    uint32_t st[ZXC_FSE_STATES] = {size, size, size, size};
+
+    if (UNLIKELY(op > limit)) return 0;
+
+#define ZXC_FSE_PUT(k, sym)                                            \
+    do {                                                               \
+        const zxc_fse_sym_t t_ = tt[(sym)];                            \
+        unsigned nb_ = (st[k] + t_.delta_nb_bits) >> 16;               \
+        acc |= (uint64_t)(st[k] & ((1U << nb_) - 1)) << bits;          \
+        bits += nb_;                                                   \
+        st[k] = state_table[(int32_t)(st[k] >> nb_) + t_.delta_state]; \
+    } while (0)
+
+#define ZXC_FSE_FLUSH()                        \
+    do {                                       \
+        zxc_store_le64(op, acc);               \
+        op += bits >> 3;                       \
+        acc >>= bits & ~7U;                    \
+        bits &= 7;                             \
+        if (UNLIKELY(op > limit)) return 0;    \
+    } while (0)
+
+    // The decoder starts at symbol 0, so the encoder walks backward; the
+    // trailing (n % 4) symbols go first so that the loop sees whole groups.
+    size_t i = n;
+    while (i & (ZXC_FSE_STATES - 1)) {
+        i--;
+        ZXC_FSE_PUT(i & (ZXC_FSE_STATES - 1), src[i]);
+    }
+    ZXC_FSE_FLUSH();
+    while (i > 0) {
+        i -= ZXC_FSE_STATES;
+        ZXC_FSE_PUT(3, src[i + 3]);
+        ZXC_FSE_PUT(2, src[i + 2]);
+        ZXC_FSE_PUT(1, src[i + 1]);
+        ZXC_FSE_PUT(0, src[i]);
+        ZXC_FSE_FLUSH();
+    }
+
+    // Final states (read first by the decoder, state 0 first), then the end marker.
+    for (int k = ZXC_FSE_STATES - 1; k >= 0; k--) {
+        acc |= (uint64_t)(st[k] & (size - 1)) << bits;
+        bits += ct->log;
+    }
+    acc |= (uint64_t)1 << bits;
+    bits++;
+    ZXC_FSE_FLUSH();
+    zxc_store_le64(op, acc);
+    op += (bits + 7) >> 3;
+
+#undef ZXC_FSE_PUT
+#undef ZXC_FSE_FLUSH
+
+    return (size_t)(op - dst);
+}
+
+/**
+ * @brief Entropy codes a byte stream with 2 x 4-state interleaved tANS (FSE).
+ *
+ * The normalized symbol counts are stored in front of the streams, so the
+ * section is self-describing (layout in zxc_internal.h).
+ *
+ * @param[in] src Bytes to encode.
+ * @param[in] n Number of bytes (at least ZXC_FSE_MIN_INPUT).
+ * @param[out] dst Destination buffer.
+ * @param[in] dst_cap Capacity of @p dst; the encoder gives up past it.
+ * @return Size of the encoded section, or 0 if the input is too small or the
+ * section does not fit in @p dst_cap.
+ */
+static size_t zxc_fse_encode(const uint8_t* RESTRICT src, size_t n, uint8_t* RESTRICT dst,
+                             size_t dst_cap) {
+    if (n < ZXC_FSE_MIN_INPUT || n > UINT32_MAX || dst_cap < 2 + sizeof(uint64_t)) return 0;
+
+    uint32_t count[ZXC_FSE_SYMBOLS] = {0};
+    for (size_t i = 0; i < n; i++) count[src[i]]++;
+
+    unsigned max_sym = ZXC_FSE_SYMBOLS - 1;
+    while (!count[max_sym]) max_sym--;
+    unsigned n_sym = 0;
+    for (unsigned s = 0; s <= max_sym; s++) n_sym += count[s] != 0;
+
+    // Small inputs get small tables; the table needs room for every symbol.
+    unsigned log = ZXC_FSE_TABLE_LOG_MAX;
+    unsigned log_fit = zxc_highbit32((uint32_t)(n - 1)) - 2;
+    unsigned log_min = zxc_highbit32(n_sym) + 1;
+    if (log > log_fit) log = log_fit;
+    if (log < log_min) log = log_min;
+    if (log < ZXC_FSE_TABLE_LOG_MIN) log = ZXC_FSE_TABLE_LOG_MIN;
+    const uint32_t size = 1U << log;
+
+    uint16_t norm[ZXC_FSE_SYMBOLS];
+    zxc_fse_normalize(count, max_sym, n, log, norm);
+
+    // --- Table header ---
+    uint8_t* op = dst;
+    const uint8_t* const limit = dst + dst_cap - sizeof(uint64_t);
+    *op++ = (uint8_t)log;
+    *op++ = (uint8_t)max_sym;
+
+    uint64_t acc = 0;
+    unsigned bits = 0;
+    for (unsigned s = 0; s <= max_sym; s++) {
+        // Elias-gamma of (count + 1): (len - 1) zeros, a one, then the low (len - 1) bits.
+        uint32_t v = (uint32_t)norm[s] + 1;
+        unsigned len = zxc_highbit32(v);
+        acc |= (uint64_t)1 << (bits + len - 1);
+        bits += len;
+        acc |= (uint64_t)(v & ((1U << (len - 1)) - 1)) << bits;
+        bits += len - 1;
+        if (bits >= 32) {
+            if (UNLIKELY(op > limit)) return 0;
+            zxc_store_le32(op, (uint32_t)acc);
+            op += 4;
+            acc >>= 32;
+            bits -= 32;
+        }
+    }
+    if (UNLIKELY(op > limit)) return 0;
+    zxc_store_le64(op, acc);
+    op += (bits + 7) >> 3;
+
+    // --- Encoder tables ---
+    zxc_fse_ctable_t ct;
+    uint8_t cells[1U << ZXC_FSE_TABLE_LOG_MAX];
+    uint32_t cumul[ZXC_FSE_SYMBOLS + 1];
+
+    ct.log = log;
+    zxc_fse_spread(norm, max_sym, log, cells);
+    cumul[0] = 0;
+    for (unsigned s = 0; s <= max_sym; s++) cumul[s + 1] = cumul[s] + norm[s];
+    for (uint32_t u = 0; u < size; u++) ct.state_table[cumul[cells[u]]++] = (uint16_t)(size + u);
+
+    uint32_t total = 0;
+    for (unsigned s = 0; s <= max_sym; s++) {
+        uint32_t c = norm[s];
+        if (!c) continue;
+        unsigned max_bits = log - (c > 1 ? zxc_highbit32(c - 1) - 1U : 0U);
+        ct.tt[s].delta_nb_bits = (max_bits << 16) - (c << max_bits);
+        ct.tt[s].delta_state = (int32_t)total - (int32_t)c;
+        total += c;
+    }
+
+    // --- Streams ---
+    size_t n_a = (n / 2) & ~(size_t)(ZXC_FSE_STATES - 1);
+    uint8_t* const sz_a = op;
+    op += sizeof(uint32_t);
+    size_t len_a = zxc_fse_encode_stream(&ct, src, n_a, op, limit);
+    if (!len_a) return 0;
+    op += len_a;
+    size_t len_b = zxc_fse_encode_stream(&ct, src + n_a, n - n_a, op, limit);
+    if (!len_b) return 0;
+    op += len_b;
+    zxc_store_le32(sz_a, (uint32_t)len_a);
+
+    return (size_t)(op - dst);
+}
+
+/*
+ * ============================================================================
+ * OPTIMAL PARSER (levels 8+)
+ * ============================================================================
+ * A binary-tree match finder returns, at every position, the closest match for
+ * each length. A forward dynamic program prices every literal and match path
+ * over a window of ZXC_OPT_NUM positions with the GLO layout costs (token
+ * byte, 16-bit offset, VByte extras) and order-0 estimates of the literal and
+ * token symbols, which are FSE coded at these levels. The cheapest path is then
+ * emitted as ordinary GLO sequences.
+ */
+
+#define ZXC_OPT_NUM 4096       // Positions priced per window
+#define ZXC_OPT_NICE_MAX 1024  // Longest length enumerated (longer matches are taken as is)
+#define ZXC_OPT_HASH_LOG 16    // Binary tree roots (4-byte hash)
+#define ZXC_OPT_BIT 16         // Price units per bit
+#define ZXC_OPT_INF 0xFFFFFFFFU
+
+/**
+ * @brief Match returned by the binary-tree finder: a length and its smallest offset.
+ */
+typedef struct {
+    uint32_t len;
+    uint32_t off;
+} zxc_opt_match_t;
+
+/**
+ * @brief Node of the parsing graph: cheapest known way to reach a position.
+ *
+ * @param price  Cost from the window start, in 1/ZXC_OPT_BIT bits.
+ * @param litlen Literals pending at this position (0 after a match).
+ * @param mlen   Length of the match ending here (0 = reached by a literal).
+ * @param off    Offset of that match.
+ */
+typedef struct {
+    uint32_t price;
+    uint32_t litlen;
+    uint16_t mlen;
+    uint16_t off;
+} zxc_opt_node_t;
+
+/**
+ * @brief Optimal parser state, allocated on the first block of levels 8+.
+ *
+ * Tree positions are stored biased by ZXC_LZ_WINDOW_SIZE, so 0 is always out
+ * of range and needs no clearing of the child links.
+ */
+struct zxc_opt_s {
+    uint32_t head[1U << ZXC_OPT_HASH_LOG];
+    uint32_t son[2 * ZXC_LZ_WINDOW_SIZE];
+    uint32_t lit_count[256];
+    uint32_t tok_count[256];
+    uint32_t lit_price[256];
+    uint32_t tok_price[256];
+    zxc_opt_node_t node[ZXC_OPT_NUM + ZXC_OPT_NICE_MAX + 1];
+    zxc_opt_match_t match[ZXC_OPT_NICE_MAX + 2];
+    uint32_t path[ZXC_OPT_NUM + ZXC_OPT_NICE_MAX + 1];
+};
+
+/**
+ * @brief Fixed-point base-2 logarithm.
+ *
+ * @param[in] x Value (>= 1).
+ * @return log2(x) in 1/ZXC_OPT_BIT bits.
+ */
+static uint32_t zxc_opt_log2(uint32_t x) {
+    static const uint8_t frac[16] = {0, 1, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 15};
+    uint32_t hb = (uint32_t)zxc_highbit32(x) - 1;
+    uint32_t m = hb >= 4 ? (x >> (hb - 4)) & 15 : (x << (4 - hb)) & 15;
+    return hb * ZXC_OPT_BIT + frac[m];
+}
+
+/**
+ * @brief Rebuilds a price table from symbol counts (-log2 of the smoothed frequency).
+ *
+ * @param[in] count Occurrences of each of the 256 symbols.
+ * @param[out] price Cost of each symbol in 1/ZXC_OPT_BIT bits.
+ */
+static void zxc_opt_set_prices(const uint32_t* count, uint32_t* price) {
+    uint32_t total = 256;
+    for (int i = 0; i < 256; i++) total += count[i];
+    uint32_t l_total = zxc_opt_log2(total);
+    for (int i = 0; i < 256; i++) price[i] = l_total - zxc_opt_log2(count[i] + 1);
+}
+
+/**
+ * @brief Size of the VByte extra for a literal or match length code, in price units.
+ *
+ * @param[in] v Length, already reduced by its token field maximum.
+ * @return Price of the VByte bytes.
+ */
+static ZXC_ALWAYS_INLINE uint32_t zxc_opt_vbyte_price(uint32_t v) {
+    uint32_t n = 1 + (v >= (1U << 7)) + (v >= (1U << 14)) + (v >= (1U << 21));
+    return n * 8 * ZXC_OPT_BIT;
+}
+
+/**
+ * @brief Price of the literal-length extras of a run of r literals.
+ */
+static ZXC_ALWAYS_INLINE uint32_t zxc_opt_ll_price(uint32_t r) {
+    return r < ZXC_TOKEN_LL_MASK ? 0 : zxc_opt_vbyte_price(r - ZXC_TOKEN_LL_MASK);
+}
+
+/**
+ * @brief Inserts a position into the binary tree and collects its matches.
+ *
+ * Walks the tree of the position's 4-byte hash, re-rooting it at the position
+ * (LZMA "bt4" style), and records every candidate that beats the longest match
+ * so far. The result has strictly increasing lengths, each with the smallest
+ * offset reaching it.
+ *
+ * @param[in,out] o   Parser state.
+ * @param[in] src     Start of the block.
+ * @param[in] pos     Position to insert.
+ * @param[in] lim     Longest length to verify (at most the bytes left in the block).
+ * @param[in] depth   Maximum number of tree nodes visited.
+ * @param[out] out    Matches found (lengths >= ZXC_LZ_MIN_MATCH_LEN).
+ * @return Number of matches written to out.
+ */
+static uint32_t zxc_opt_bt_insert(struct zxc_opt_s* RESTRICT o, const uint8_t* src, uint32_t pos,
+                                  uint32_t lim, int depth, zxc_opt_match_t* RESTRICT out) {
+    const uint8_t* ip = src + pos;
+    const uint32_t cur = pos + ZXC_LZ_WINDOW_SIZE;
+    const uint32_t h = zxc_hash_func(zxc_le32(ip), ZXC_OPT_HASH_LOG);
+    uint32_t m = o->head[h];
+    o->head[h] = cur;
+
+    uint32_t* son = o->son;
+    uint32_t* p_lo = son + 2 * (pos & ZXC_LZ_MAX_DIST);  // Subtree of smaller strings
+    uint32_t* p_hi = p_lo + 1;                           // Subtree of larger strings
+    uint32_t len_lo = 0, len_hi = 0, best = ZXC_LZ_MIN_MATCH_LEN - 1, n = 0;
+
+    for (;;) {
+        uint32_t delta = cur - m;
+        if (depth-- <= 0 || delta > ZXC_LZ_MAX_DIST) {
+            *p_lo = *p_hi = 0;
+            break;
+        }
+        uint32_t* pair = son + 2 * (m & ZXC_LZ_MAX_DIST);
+        const uint8_t* ref = ip - delta;
+        uint32_t len = len_lo < len_hi ? len_lo : len_hi;
+        if (ref[len] == ip[len]) {
+            len++;
+            while (len + 8 <= lim && zxc_le64(ip + len) == zxc_le64(ref + len)) len += 8;
+            while (len < lim && ip[len] == ref[len]) len++;
+            if (len > best) {
+                best = len;
+                out[n].len = len;
+                out[n].off = delta;
+                n++;
+            }
+            if (len >= lim) {  // Equal strings: the old node is replaced by the new one
+                *p_lo = pair[0];
+                *p_hi = pair[1];
+                break;
+            }
+        }
+        if (ref[len] < ip[len]) {
+            *p_lo = m;
+            p_lo = pair + 1;
+            m = *p_lo;
+            len_lo = len;
+        } else {
+            *p_hi = m;
+            p_hi = pair;
+            m = *p_hi;
+            len_hi = len;
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief Relaxes the edge reaching node k of the parsing graph.
+ */
+static ZXC_ALWAYS_INLINE void zxc_opt_relax(zxc_opt_node_t* node, uint32_t k, uint32_t price,
+                                            uint32_t litlen, uint32_t mlen, uint32_t off) {
+    if (price < node[k].price) {
+        node[k].price = price;
+        node[k].litlen = litlen;
+        node[k].mlen = (uint16_t)mlen;
+        node[k].off = (uint16_t)off;
+    }
+}
+
+/**
+ * @brief Appends one sequence (pending literals plus a match) to the GLO streams.
+ */
+static ZXC_ALWAYS_INLINE void zxc_opt_emit(zxc_cctx_t* ctx, struct zxc_opt_s* o,
+                                           const uint8_t* anchor, uint32_t ll, uint32_t len,
+                                           uint32_t off, uint32_t* seq_c, size_t* lit_c,
+                                           size_t* extras_sz, uint16_t* max_offset) {
+    uint32_t ml = len - ZXC_LZ_MIN_MATCH_LEN;
+    ZXC_MEMCPY(ctx->literals + *lit_c, anchor, ll);
+    for (uint32_t i = 0; i < ll; i++) o->lit_count[anchor[i]]++;
+    *lit_c += ll;
+
+    uint8_t ll_code = (ll >= ZXC_TOKEN_LL_MASK) ? ZXC_TOKEN_LL_MASK : (uint8_t)ll;
+    uint8_t ml_code = (ml >= ZXC_TOKEN_ML_MASK) ? ZXC_TOKEN_ML_MASK : (uint8_t)ml;
+    uint8_t tok = (uint8_t)((ll_code << ZXC_TOKEN_LIT_BITS) | ml_code);
+    ctx->buf_tokens[*seq_c] = tok;
+    o->tok_count[tok]++;
+    ctx->buf_offsets[*seq_c] = (uint16_t)off;
+    if (off > *max_offset) *max_offset = (uint16_t)off;
+    if (ll >= ZXC_TOKEN_LL_MASK)
+        *extras_sz += zxc_write_vbyte(ctx->buf_extras + *extras_sz, ll - ZXC_TOKEN_LL_MASK);
+    if (ml >= ZXC_TOKEN_ML_MASK)
+        *extras_sz += zxc_write_vbyte(ctx->buf_extras + *extras_sz, ml - ZXC_TOKEN_ML_MASK);
+    (*seq_c)++;
+}
+
+/**
+ * @brief One optimal parse of a block into the GLO sequence buffers.
+ *
+ * The symbol counts in o seed the prices and are updated with what each window
+ * emits, so the estimates follow the block as it is parsed.
+ *
+ * @param[in,out] ctx Compression context (sequence buffers, dictionary).
+ * @param[in,out] o Parser state.
+ * @param[in] src Block to parse.
+ * @param[in] src_size Size of the block.
+ * @param[in] depth Binary tree search depth.
+ * @param[in] nice Match length taken without enumerating (<= ZXC_OPT_NICE_MAX).
+ * @param[out] seq_c Number of sequences.
+ * @param[out] lit_c Number of literals (including the trailing ones).
+ * @param[out] extras_sz Size of the extras stream.
+ * @param[out] max_offset Largest offset used.
+ */
+static void zxc_opt_parse(zxc_cctx_t* ctx, struct zxc_opt_s* o, const uint8_t* src,
+                          size_t src_size, int depth, uint32_t nice, uint32_t* seq_c,
+                          size_t* lit_c, size_t* extras_sz, uint16_t* max_offset) {
+    const uint8_t *ip = src, *anchor = src, *iend = src + src_size, *mflimit = iend - 12;
+    const struct zxc_dict_s* dict = ctx->dict;
+    zxc_opt_node_t* node = o->node;
+    const uint32_t off_price = 16 * ZXC_OPT_BIT;
+    zxc_lz77_params_t dp = {depth, (int)nice, 0, 0, 1, 31};
+
+    *seq_c = 0;
+    *lit_c = 0;
+    *extras_sz = 0;
+    *max_offset = 0;
+    ZXC_MEMSET(o->head, 0, sizeof(o->head));
+
+    while (ip < mflimit) {
+        zxc_opt_set_prices(o->lit_count, o->lit_price);
+        zxc_opt_set_prices(o->tok_count, o->tok_price);
+
+        const size_t left = (size_t)(mflimit - ip);  // Positions where a match may start
+        const int tail = left <= ZXC_OPT_NUM;
+        const uint32_t limit = tail ? (uint32_t)left : ZXC_OPT_NUM;
+        const uint32_t span = tail ? (uint32_t)(iend - ip) : limit;
+        uint32_t last = 0;
+        uint32_t forced_len = 0, forced_off = 0;
+        uint32_t cur;
+
+        node[0].price = 0;
+        node[0].litlen = (uint32_t)(ip - anchor);
+        node[0].mlen = 0;
+
+        for (cur = 0; cur < limit; cur++) {
+            const zxc_opt_node_t nd = node[cur];
+            const uint32_t pos = (uint32_t)(ip + cur - src);
+            const uint32_t room = (uint32_t)(iend - ip - cur);
+            uint32_t lim = room < nice ? room : nice;
+            uint32_t n = zxc_opt_bt_insert(o, src, pos, lim, depth, o->match);
+
+            if (UNLIKELY(dict != NULL) && pos < ZXC_LZ_MAX_DIST &&
+                (n == 0 || o->match[n - 1].len < nice)) {
+                zxc_match_t best = {NULL, n ? o->match[n - 1].len : ZXC_LZ_MIN_MATCH_LEN - 1, 0,
+                                    0};
+                const uint8_t* p = ip + cur;
+                zxc_match_t dm =
+                    zxc_lz77_probe_dict(dict, src, p, iend, pos, zxc_le32(p), best, dp);
+                if (dm.ref) {
+                    o->match[n].len = dm.len;
+                    o->match[n].off = pos + (uint32_t)(dict->content + dict->size - dm.ref);
+                    n++;
+                }
+            }
+
+            if (n > 0 && o->match[n - 1].len >= nice) {  // Long match: take it as is
+                forced_len = o->match[n - 1].len;
+                forced_off = o->match[n - 1].off;
+                if (forced_off <= pos) {
+                    const uint8_t* p = ip + cur;
+                    const uint8_t* ref = p - forced_off;
+                    while (forced_len < room && p[forced_len] == ref[forced_len]) forced_len++;
+                }
+                break;
+            }
+
+            while (last < cur + 1 + (n ? o->match[n - 1].len : 0)) node[++last].price = ZXC_OPT_INF;
+
+            uint32_t r = nd.litlen;
+            uint32_t lit = nd.price + o->lit_price[ip[cur]] + zxc_opt_ll_price(r + 1) -
+                           zxc_opt_ll_price(r);
+            zxc_opt_relax(node, cur + 1, lit, r + 1, 0, 0);
+
+            uint32_t ll_code = r >= ZXC_TOKEN_LL_MASK ? ZXC_TOKEN_LL_MASK : r;
+            const uint32_t* tok = o->tok_price + (ll_code << ZXC_TOKEN_LIT_BITS);
+            uint32_t base = nd.price + off_price;
+            uint32_t len = ZXC_LZ_MIN_MATCH_LEN;
+            for (uint32_t j = 0; j < n; j++) {
+                const uint32_t off = o->match[j].off;
+                for (; len <= o->match[j].len; len++) {
+                    uint32_t ml = len - ZXC_LZ_MIN_MATCH_LEN;
+                    uint32_t price =
+                        base + (ml < ZXC_TOKEN_ML_MASK
+                                    ? tok[ml]
+                                    : tok[ZXC_TOKEN_ML_MASK] +
+                                          zxc_opt_vbyte_price(ml - ZXC_TOKEN_ML_MASK));
+                    zxc_opt_relax(node, cur + len, price, 0, len, off);
+                }
+            }
+        }
+
+        uint32_t end = cur;
+        if (!forced_len && tail) {  // Close the block: the last bytes can only be literals
+            while (last < span) node[++last].price = ZXC_OPT_INF;
+            for (; cur < span; cur++) {
+                uint32_t r = node[cur].litlen;
+                uint32_t lit = node[cur].price + o->lit_price[ip[cur]] +
+                               zxc_opt_ll_price(r + 1) - zxc_opt_ll_price(r);
+                zxc_opt_relax(node, cur + 1, lit, r + 1, 0, 0);
+            }
+            end = span;
+        }
+
+        // Walk the cheapest path back, then emit it forward.
+        uint32_t n_path = 0;
+        for (uint32_t k = end; k > 0;) {
+            if (node[k].mlen) {
+                o->path[n_path++] = k;
+                k -= node[k].mlen;
+            } else {
+                k--;
+            }
+        }
+        while (n_path > 0) {
+            uint32_t k = o->path[--n_path];
+            const uint8_t* m_start = ip + k - node[k].mlen;
+            zxc_opt_emit(ctx, o, anchor, (uint32_t)(m_start - anchor), node[k].mlen, node[k].off,
+                         seq_c, lit_c, extras_sz, max_offset);
+            anchor = ip + k;
+        }
+
+        if (forced_len) {
+            const uint8_t* m_start = ip + end;
+            zxc_opt_emit(ctx, o, anchor, (uint32_t)(m_start - anchor), forced_len, forced_off,
+                         seq_c, lit_c, extras_sz, max_offset);
+            anchor = m_start + forced_len;
+            // Keep the tree complete over the match (the search stops at once on repeats).
+            for (const uint8_t* p = m_start + 1; p < anchor && p < mflimit; p++) {
+                uint32_t room = (uint32_t)(iend - p);
+                (void)zxc_opt_bt_insert(o, src, (uint32_t)(p - src), room < nice ? room : nice,
+                                        depth, o->match);
+            }
+            ip = anchor;
+        } else {
+            ip += end;
+        }
+    }
+
+    size_t last_lits = (size_t)(iend - anchor);
+    ZXC_MEMCPY(ctx->literals + *lit_c, anchor, last_lits);
+    *lit_c += last_lits;
+}
+
+/**
+ * @brief Parses a block with the optimal parser (levels 8+).
+ *
+ * Literal prices start from the block's byte histogram and token prices from a
+ * uniform model. At ZXC_LEVEL_ARCHIVE the block is parsed a second time with
+ * the statistics of the first parse.
+ *
+ * @param[in,out] ctx Compression context; its parser state is allocated on first use.
+ * @param[in] src Block to parse.
+ * @param[in] src_size Size of the block.
+ * @param[in] p Level parameters (search_depth: tree depth, sufficient_len: nice length).
+ * @param[out] seq_c Number of sequences.
+ * @param[out] lit_c Number of literals.
+ * @param[out] extras_sz Size of the extras stream.
+ * @param[out] max_offset Largest offset used.
+ * @return 0 on success, -1 if the parser state cannot be allocated.
+ */
+static int zxc_lz77_parse_optimal(zxc_cctx_t* ctx, const uint8_t* src, size_t src_size,
+                                  zxc_lz77_params_t p, uint32_t* seq_c, size_t* lit_c,
+                                  size_t* extras_sz, uint16_t* max_offset) {
+    struct zxc_opt_s* o = ctx->opt;
+    if (UNLIKELY(!o)) {
+        o = (struct zxc_opt_s*)malloc(sizeof(struct zxc_opt_s));
+        if (UNLIKELY(!o)) return -1;
+        ctx->opt = o;
+    }
+    uint32_t nice = (uint32_t)p.sufficient_len;
+    if (nice > ZXC_OPT_NICE_MAX) nice = ZXC_OPT_NICE_MAX;
+
+    ZXC_MEMSET(o->lit_count, 0, sizeof(o->lit_count));
+    for (size_t i = 0; i < src_size; i++) o->lit_count[src[i]]++;
+    for (int i = 0; i < 256; i++) o->tok_count[i] = 1;
+
+    int passes = ctx->compression_level >= ZXC_LEVEL_ARCHIVE ? 2 : 1;
+    for (int pass = 0; pass < passes; pass++) {
+        if (pass > 0) {  // Restart from what the previous parse emitted
+            ZXC_MEMSET(o->lit_count, 0, sizeof(o->lit_count));
+            for (size_t i = 0; i < *lit_c; i++) o->lit_count[ctx->literals[i]]++;
+            ZXC_MEMSET(o->tok_count, 0, sizeof(o->tok_count));
+            for (uint32_t i = 0; i < *seq_c; i++) o->tok_count[ctx->buf_tokens[i]]++;
+        }
+        zxc_opt_parse(ctx, o, src, src_size, p.search_depth, nice, seq_c, lit_c, extras_sz,
+                      max_offset);
+    }
+    return 0;
+}
+
 /**
  * @brief Encodes a data block using the General (GLO) compression format.
  *
@@ -582,6 +1426,8 @@ static int zxc_encode_block_num(const zxc_cctx_t* ctx, const uint8_t* RESTRICT s
  * 2. **Lazy Matching:** If a match is found, we check the *next* byte to see if
  *    it produces a longer match. If so, we output a literal and take the better
  * match. This is enabled for levels >= 3.
+ *    Levels 8+ replace this search with the optimal parser
+ * (zxc_lz77_parse_optimal()).
  * 3. **Step Skipping:** For lower levels (1-3), we skip bytes when updating the
  *    hash table to increase speed (`step > 1`). For levels 4+, we process every
  * byte to maximize compression ratio.
@@ -600,7 +1446,8 @@ static int zxc_encode_block_num(const zxc_cctx_t* ctx, const uint8_t* RESTRICT s
  * 3. **Bitpacking & Serialization**: The sequences are analyzed to determine
  * optimal bit-widths. The function then writes the block header, encodes
  * literals (using Raw or RLE encoding), and bit-packs the sequence streams into
- * the destination buffer.
+ * the destination buffer. From level 6 on, the literal and token sections are
+ * entropy coded (FSE) when that saves space.
  *
  * @param[in,out] ctx       Pointer to the compression context containing hash tables
  * and configuration.
@@ -611,13 +1458,11 @@ static int zxc_encode_block_num(const zxc_cctx_t* ctx, const uint8_t* RESTRICT s
  * @param[in] dst_cap   Maximum capacity of the destination buffer.
  * @param[out] out_sz    [Out] Pointer to a variable that will receive the total size
  * of the compressed output.
- * @param[in] crc_val   The pre-calculated XXH3 value (if checksum is enabled).
  *
  * @return 0 on success, or -1 if an error occurs (e.g., buffer overflow).
  */
 static int zxc_encode_block_glo(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, size_t src_size,
-                                uint8_t* RESTRICT dst, size_t dst_cap, size_t* out_sz,
-                                uint64_t crc_val) {
+                                uint8_t* RESTRICT dst, size_t dst_cap, size_t* out_sz) {
     int level = ctx->compression_level;
     int chk = ctx->checksum_enabled;
 
@@ -625,14 +1470,18 @@ static int zxc_encode_block_glo(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
 
     ctx->epoch++;
     if (UNLIKELY(ctx->epoch >= ZXC_MAX_EPOCH)) {
-        ZXC_MEMSET(ctx->hash_table, 0, 2 * ZXC_LZ_HASH_SIZE * sizeof(uint32_t));
+        ZXC_MEMSET(ctx->hash_table, 0, 2 * ((size_t)1 << ctx->hash_log) * sizeof(uint32_t));
         ctx->epoch = 1;
     }
     const uint32_t epoch_mark = ctx->epoch << (32 - ZXC_EPOCH_BITS);
+    // Small blocks only use the front of the table: fewer cold cache lines touched.
+    uint32_t hash_log = zxc_lz_hash_log(src_size);
+    if (hash_log > ctx->hash_log) hash_log = ctx->hash_log;
     const uint8_t *ip = src, *iend = src + src_size, *anchor = ip, *mflimit = iend - 12;
 
     uint32_t* hash_table = ctx->hash_table;
     uint16_t* chain_table = ctx->chain_table;
+    const struct zxc_dict_s* dict = ctx->dict;
     uint8_t* literals = ctx->literals;
     uint8_t* buf_tokens = ctx->buf_tokens;
     uint16_t* buf_offsets = ctx->buf_offsets;
@@ -643,21 +1492,33 @@ static int zxc_encode_block_glo(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
     size_t extras_sz = 0;
     uint16_t max_offset = 0;  // Track max offset for 1-byte/2-byte mode decision
 
+    if (level >= ZXC_LEVEL_ULTRA) {
+        if (UNLIKELY(zxc_lz77_parse_optimal(ctx, src, src_size, lzp, &seq_c, &lit_c, &extras_sz,
+                                            &max_offset) != 0))
+            return -1;
+        ip = anchor = iend;  // Sequences and literals are already stored
+    }
+
     while (LIKELY(ip < mflimit)) {
+        // The step grows with the literal run up to a quarter window: in a large
+        // block a long incompressible run would otherwise push it to thousands of
+        // bytes and the parser would skip most matches of the data that follows.
         size_t dist = (size_t)(ip - anchor);
+        if (UNLIKELY(dist > ZXC_LZ_WINDOW_SIZE / 4)) dist = ZXC_LZ_WINDOW_SIZE / 4;
         size_t step = lzp.step_base + (dist >> lzp.step_shift);
         if (UNLIKELY(ip + step >= mflimit)) step = 1;
 
         ZXC_PREFETCH_READ(ip + step * 4 + ZXC_CACHE_LINE_SIZE);
 
         zxc_match_t m = zxc_lz77_find_best_match(src, ip, iend, mflimit, anchor, hash_table,
-                                                 chain_table, epoch_mark, level, lzp);
+                                                 chain_table, epoch_mark, hash_log, dict, level,
+                                                 lzp);
 
         if (m.ref) {
             ip -= m.backtrack;
             uint32_t ll = (uint32_t)(ip - anchor);
             uint32_t ml = (uint32_t)(m.len - ZXC_LZ_MIN_MATCH_LEN);
-            uint32_t off = (uint32_t)(ip - m.ref);
+            uint32_t off = m.off;
 
             if (ll > 0) {
                 if (ll <= 16)
@@ -688,7 +1549,7 @@ static int zxc_encode_block_glo(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
                 if (match_end < iend - 3) {
                     uint32_t pos_u = (uint32_t)((match_end - 2) - src);
                     uint32_t val_u = zxc_le32(match_end - 2);
-                    uint32_t h_u = zxc_hash_func(val_u);
+                    uint32_t h_u = zxc_hash_func(val_u, hash_log);
                     uint32_t prev_head = hash_table[2 * h_u];
                     uint32_t prev_idx = (prev_head & ~ZXC_OFFSET_MASK) == epoch_mark
                                             ? (prev_head & ZXC_OFFSET_MASK)
@@ -709,13 +1570,8 @@ static int zxc_encode_block_glo(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
 
     size_t last_lits = iend - anchor;
     if (last_lits > 0) {
-        if (last_lits <= 16) {
-            zxc_copy16(literals + lit_c, anchor);
-        } else if (last_lits <= 32) {
-            zxc_copy32(literals + lit_c, anchor);
-        } else {
-            ZXC_MEMCPY(literals + lit_c, anchor, last_lits);
-        }
+        // Exact copy: the tail ends at the input end, so wild copies would over-read.
+        ZXC_MEMCPY(literals + lit_c, anchor, last_lits);
         lit_c += last_lits;
     }
 
@@ -950,9 +1806,35 @@ static int zxc_encode_block_glo(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
                            .enc_mlen = 0,
                            .enc_off = (uint8_t)use_8bit_off};
 
+    // --- FSE (levels 6+) ---
+    // Sections are entropy coded in place (the header has a fixed size) and
+    // kept only if they save ~3% over the RAW/RLE form.
+    size_t sz_lit_best = use_rle ? rle_size : lit_c;
+    size_t sz_tok_best = seq_c;
+    if (level >= ZXC_LEVEL_DENSE) {
+        const size_t hdr_sz =
+            ZXC_GLO_HEADER_BINARY_SIZE + ZXC_GLO_SECTIONS * ZXC_SECTION_DESC_BINARY_SIZE;
+        uint8_t* const sec = p + hdr_sz;
+        size_t cap = rem > hdr_sz ? rem - hdr_sz : 0;
+        size_t lim = sz_lit_best - (sz_lit_best >> 5);
+
+        size_t fse_sz = zxc_fse_encode(literals, lit_c, sec, cap < lim ? cap : lim);
+        if (fse_sz > 0) {
+            gh.enc_lit = ZXC_SECTION_ENCODING_FSE;
+            sz_lit_best = fse_sz;
+        }
+        cap = cap > sz_lit_best ? cap - sz_lit_best : 0;
+        lim = sz_tok_best - (sz_tok_best >> 5);
+        fse_sz = zxc_fse_encode(buf_tokens, seq_c, sec + sz_lit_best, cap < lim ? cap : lim);
+        if (fse_sz > 0) {
+            gh.enc_litlen = ZXC_SECTION_ENCODING_FSE;
+            sz_tok_best = fse_sz;
+        }
+    }
+
     zxc_section_desc_t desc[4] = {0};
-    desc[0].sizes = (uint64_t)(use_rle ? rle_size : lit_c) | ((uint64_t)lit_c << 32);
-    desc[1].sizes = (uint64_t)seq_c | ((uint64_t)seq_c << 32);
+    desc[0].sizes = (uint64_t)sz_lit_best | ((uint64_t)lit_c << 32);
+    desc[1].sizes = (uint64_t)sz_tok_best | ((uint64_t)seq_c << 32);
     desc[2].sizes = (uint64_t)off_stream_size | ((uint64_t)off_stream_size << 32);
     desc[3].sizes = (uint64_t)extras_sz | ((uint64_t)extras_sz << 32);
 
@@ -970,7 +1852,9 @@ static int zxc_encode_block_glo(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
 
     if (UNLIKELY(rem < sz_lit)) return -1;
 
-    if (use_rle) {
+    if (gh.enc_lit == ZXC_SECTION_ENCODING_FSE) {
+        p_curr += sz_lit;  // Already in place
+    } else if (use_rle) {
         // Write RLE - optimized single-pass encoding
         const uint8_t* lit_ptr = literals;
         const uint8_t* const lit_end = literals + lit_c;
@@ -1031,8 +1915,8 @@ static int zxc_encode_block_glo(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
     rem -= sz_lit;
 
     if (UNLIKELY(rem < sz_tok)) return -1;
-    ZXC_MEMCPY(p_curr, buf_tokens, seq_c);
-    p_curr += seq_c;
+    if (gh.enc_litlen != ZXC_SECTION_ENCODING_FSE) ZXC_MEMCPY(p_curr, buf_tokens, seq_c);
+    p_curr += sz_tok;
     rem -= sz_tok;
 
     if (UNLIKELY(rem < sz_off)) return -1;
@@ -1076,7 +1960,6 @@ static int zxc_encode_block_glo(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
     bh.comp_size = p_sz;
     int hw = zxc_write_block_header(dst, dst_cap, &bh);
 
-    if (chk) zxc_store_le64(dst + hw, crc_val);
     *out_sz = hw + (chk ? ZXC_BLOCK_CHECKSUM_SIZE : 0) + p_sz;
     return 0;
 }
@@ -1106,13 +1989,11 @@ static int zxc_encode_block_glo(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
  * @param[in] dst_cap   Maximum capacity of the destination buffer.
  * @param[out] out_sz    [Out] Pointer to a variable that will receive the total size
  * of the compressed output.
- * @param[in] crc_val   The pre-calculated XXH3 value (if checksum is enabled).
  *
  * @return 0 on success, or -1 if an error occurs (e.g., buffer overflow).
  */
 static int zxc_encode_block_ghi(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, size_t src_size,
-                                uint8_t* RESTRICT dst, size_t dst_cap, size_t* out_sz,
-                                uint64_t crc_val) {
+                                uint8_t* RESTRICT dst, size_t dst_cap, size_t* out_sz) {
     int level = ctx->compression_level;
     int chk = ctx->checksum_enabled;
 
@@ -1120,15 +2001,19 @@ static int zxc_encode_block_ghi(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
 
     ctx->epoch++;
     if (UNLIKELY(ctx->epoch >= ZXC_MAX_EPOCH)) {
-        ZXC_MEMSET(ctx->hash_table, 0, 2 * ZXC_LZ_HASH_SIZE * sizeof(uint32_t));
+        ZXC_MEMSET(ctx->hash_table, 0, 2 * ((size_t)1 << ctx->hash_log) * sizeof(uint32_t));
         ctx->epoch = 1;
     }
     const uint32_t epoch_mark = ctx->epoch << (32 - ZXC_EPOCH_BITS);
+    // Small blocks only use the front of the table: fewer cold cache lines touched.
+    uint32_t hash_log = zxc_lz_hash_log(src_size);
+    if (hash_log > ctx->hash_log) hash_log = ctx->hash_log;
     const uint8_t *ip = src, *iend = src + src_size, *anchor = ip, *mflimit = iend - 12;
 
     uint32_t* hash_table = ctx->hash_table;
     uint8_t* buf_extras = ctx->buf_extras;
     uint16_t* chain_table = ctx->chain_table;
+    const struct zxc_dict_s* dict = ctx->dict;
     uint8_t* literals = ctx->literals;
 
     uint32_t seq_c = 0;
@@ -1138,21 +2023,33 @@ static int zxc_encode_block_ghi(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
 
     uint32_t* buf_sequences = ctx->buf_sequences;
 
+    // Probing stays one position at a time, also at levels 1-2. A batched pass (hash 8/16
+    // positions of the step schedule in one vector, gather heads and tags, stop at the first
+    // hit) keeps the output identical but does not pay here: on text more than half of the
+    // probes are tag hits, so a batch ends after less than one lane on average, and on sparse
+    // data the growing step already leaves few probes. Measured cost: 2x slower with gathers, noise
+    // level once limited to long literal runs. The time goes to the chain walk and the
+    // dependent loads behind each hit, not to hashing.
     while (LIKELY(ip < mflimit)) {
+        // The step grows with the literal run up to a quarter window: in a large
+        // block a long incompressible run would otherwise push it to thousands of
+        // bytes and the parser would skip most matches of the data that follows.
         size_t dist = (size_t)(ip - anchor);
+        if (UNLIKELY(dist > ZXC_LZ_WINDOW_SIZE / 4)) dist = ZXC_LZ_WINDOW_SIZE / 4;
         size_t step = lzp.step_base + (dist >> lzp.step_shift);
         if (UNLIKELY(ip + step >= mflimit)) step = 1;
 
         ZXC_PREFETCH_READ(ip + step * 4 + 64);
 
         zxc_match_t m = zxc_lz77_find_best_match(src, ip, iend, mflimit, anchor, hash_table,
-                                                 chain_table, epoch_mark, level, lzp);
+                                                 chain_table, epoch_mark, hash_log, dict, level,
+                                                 lzp);
 
         if (m.ref) {
             ip -= m.backtrack;
             uint32_t ll = (uint32_t)(ip - anchor);
             uint32_t ml = (uint32_t)(m.len - ZXC_LZ_MIN_MATCH_LEN);
-            uint32_t off = (uint32_t)(ip - m.ref);
+            uint32_t off = m.off;
 
             if (ll > 0) {
                 if (ll <= 16)
@@ -1184,7 +2081,7 @@ static int zxc_encode_block_ghi(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
                 if (match_end < iend - 3) {
                     uint32_t pos_u = (uint32_t)((match_end - 2) - src);
                     uint32_t val_u = zxc_le32(match_end - 2);
-                    uint32_t h_u = zxc_hash_func(val_u);
+                    uint32_t h_u = zxc_hash_func(val_u, hash_log);
                     uint32_t prev_head = hash_table[2 * h_u];
                     uint32_t prev_idx = (prev_head & ~ZXC_OFFSET_MASK) == epoch_mark
                                             ? (prev_head & ZXC_OFFSET_MASK)
@@ -1205,13 +2102,8 @@ static int zxc_encode_block_ghi(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
 
     size_t last_lits = iend - anchor;
     if (last_lits > 0) {
-        if (last_lits <= 16) {
-            zxc_copy16(literals + lit_c, anchor);
-        } else if (last_lits <= 32) {
-            zxc_copy32(literals + lit_c, anchor);
-        } else {
-            ZXC_MEMCPY(literals + lit_c, anchor, last_lits);
-        }
+        // Exact copy: the tail ends at the input end, so wild copies would over-read.
+        ZXC_MEMCPY(literals + lit_c, anchor, last_lits);
         lit_c += last_lits;
     }
 
@@ -1270,7 +2162,6 @@ static int zxc_encode_block_ghi(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
     bh.comp_size = p_sz;
     int hw = zxc_write_block_header(dst, dst_cap, &bh);
 
-    if (chk) zxc_store_le64(dst + hw, crc_val);
     *out_sz = hw + (chk ? ZXC_BLOCK_CHECKSUM_SIZE : 0) + p_sz;
     return 0;
 }
@@ -1289,14 +2180,14 @@ static int zxc_encode_block_ghi(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
  * @param[out] out_sz Pointer to a variable receiving the total written size
  * (header
  * + data + checksum).
- * @param[in] chk Boolean flag: if non-zero, a checksum is calculated and added.
- * @param[in] crc_val The pre-calculated XXH3 value (if checksum is enabled).
+ * @param[in] chk Boolean flag: if non-zero, room for the checksum is reserved (filled in by
+ * the caller).
  *
  * @return 0 on success, -1 if the destination buffer capacity is
  * insufficient.
  */
 static int zxc_encode_block_raw(const uint8_t* src, size_t src_sz, uint8_t* dst, size_t dst_cap,
-                                size_t* out_sz, int chk, uint64_t crc_val) {
+                                size_t* out_sz, int chk) {
     size_t chk_sz = chk ? ZXC_BLOCK_CHECKSUM_SIZE : 0;
     size_t h_gap = ZXC_BLOCK_HEADER_SIZE + chk_sz;
     size_t total = h_gap + src_sz;
@@ -1308,16 +2199,11 @@ static int zxc_encode_block_raw(const uint8_t* src, size_t src_sz, uint8_t* dst,
     bh.block_type = ZXC_BLOCK_RAW;
     bh.block_flags =
         chk ? (ZXC_BLOCK_FLAG_CHECKSUM | (ZXC_CHECKSUM_RAPIDHASH & ZXC_CHECKSUM_TYPE_MASK)) : 0;
-    bh.reserved = 0;
+    bh.elem_size = 0;
     bh.comp_size = (uint32_t)src_sz;
     bh.raw_size = (uint32_t)src_sz;
 
     zxc_write_block_header(dst, dst_cap, &bh);
-
-    if (chk) {
-        zxc_store_le64(dst + ZXC_BLOCK_HEADER_SIZE, crc_val);
-    }
-
     ZXC_MEMCPY(dst + h_gap, src, src_sz);
     *out_sz = total;
     return 0;
@@ -1389,38 +2275,297 @@ static int zxc_probe_is_numeric(const uint8_t* src, size_t size) {
     return 0;
 }
 
+/*
+ * ============================================================================
+ * BLOCK ESTIMATION
+ * ============================================================================
+ * A cheap pre-pass run before the LZ77 encoders: a sampled order-0 histogram
+ * for the literal entropy and a greedy 4-byte match search on evenly spread
+ * segments for the share of bytes matches would cover. It costs a few percent
+ * of a level 3 encode and lets the block type be chosen from the data.
+ */
+
+#define ZXC_EST_HIST_STEP 17    // Histogram sampling step (coprime with struct sizes)
+#define ZXC_EST_SEG_SIZE 256    // Bytes searched per segment
+#define ZXC_EST_SEG_STEP 4096   // Distance between two segments
+#define ZXC_EST_INSERT_STEP 8   // Indexing step outside the segments
+#define ZXC_EST_HASH_LOG 13     // Match search table size (8192 entries)
+#define ZXC_EST_HIST_MIN 4096   // Blocks below this size are not estimated
+#define ZXC_EST_RAW_ENTROPY (7 * ZXC_OPT_BIT + 3 * ZXC_OPT_BIT / 4)  // 7.75 bits per byte
+#define ZXC_EST_RAW_COVER 4     // Stored RAW below this match coverage (1/256)
+#define ZXC_EST_GHI_SHARE 64    // GHI when GLO saves less than 1/64 of the output
+
+/**
+ * @struct zxc_block_est_t
+ * @brief Result of zxc_estimate_block().
+ *
+ * @var zxc_block_est_t::entropy
+ *      Order-0 entropy of the block in 1/ZXC_OPT_BIT bits per byte.
+ * @var zxc_block_est_t::cover
+ *      Share of the searched bytes covered by matches, in 1/256.
+ * @var zxc_block_est_t::density
+ *      Matches found per KB searched.
+ */
+typedef struct {
+    uint32_t entropy;
+    uint32_t cover;
+    uint32_t density;
+} zxc_block_est_t;
+
+/**
+ * @brief Estimates the literal entropy and the match coverage of a block.
+ *
+ * @param[in] src Block data.
+ * @param[in] size Block size (at least ZXC_EST_HIST_MIN bytes).
+ * @param[out] est Estimate.
+ */
+static void zxc_estimate_block(const uint8_t* RESTRICT src, size_t size, zxc_block_est_t* est) {
+    uint32_t hist[256] = {0};
+    for (size_t i = 0; i < size; i += ZXC_EST_HIST_STEP) hist[src[i]]++;
+    const uint32_t total = (uint32_t)((size + ZXC_EST_HIST_STEP - 1) / ZXC_EST_HIST_STEP);
+    uint64_t bits = 0;
+    const uint32_t l_total = zxc_opt_log2(total);
+    for (int s = 0; s < 256; s++)
+        if (hist[s]) bits += (uint64_t)hist[s] * (l_total - zxc_opt_log2(hist[s]));
+    est->entropy = (uint32_t)(bits / total);
+
+    // Every ZXC_EST_INSERT_STEP-th position is indexed, every position of the
+    // segments is searched, so repeats of unsearched data are found as well.
+    uint32_t table[1 << ZXC_EST_HASH_LOG];
+    ZXC_MEMSET(table, 0, sizeof(table));
+    size_t searched = 0, covered = 0, matches = 0;
+    const size_t last = size - sizeof(uint32_t);
+    for (size_t seg = 0; seg < last; seg += ZXC_EST_SEG_STEP) {
+        const size_t seg_end = seg + ZXC_EST_SEG_SIZE < last ? seg + ZXC_EST_SEG_SIZE : last;
+        const size_t next = seg + ZXC_EST_SEG_STEP < last ? seg + ZXC_EST_SEG_STEP : last;
+        size_t i = seg;
+        while (i < seg_end) {
+            uint32_t v = zxc_le32(src + i);
+            uint32_t h = zxc_hash_func(v, ZXC_EST_HASH_LOG);
+            uint32_t ref = table[h];
+            table[h] = (uint32_t)i + 1;
+            size_t len = 1;
+            if (ref && i - (ref - 1) <= ZXC_LZ_MAX_DIST && zxc_le32(src + ref - 1) == v) {
+                len = sizeof(uint32_t);
+                while (i + len < seg_end && src[i + len] == src[ref - 1 + len]) len++;
+                if (len >= ZXC_LZ_MIN_MATCH_LEN) {
+                    covered += len;
+                    matches++;
+                }
+            }
+            i += len;
+        }
+        searched += seg_end - seg;
+        for (i = (seg_end + ZXC_EST_INSERT_STEP - 1) & ~(size_t)(ZXC_EST_INSERT_STEP - 1); i < next;
+             i += ZXC_EST_INSERT_STEP)
+            table[zxc_hash_func(zxc_le32(src + i), ZXC_EST_HASH_LOG)] = (uint32_t)i + 1;
+    }
+    est->cover = searched ? (uint32_t)(covered * 256 / searched) : 0;
+    est->density = searched ? (uint32_t)(matches * 1024 / searched) : 0;
+}
+
+/**
+ * @brief Byte-shuffles an array of fixed-size elements.
+ *
+ * Gathers byte `k` of every element into plane `k`:
+ * `dst[k * n + i] = src[i * elem + k]` with `n = size / elem`. Bytes past the
+ * last whole element are copied unchanged after the planes. Element sizes 2, 4
+ * and 8 use SIMD transposes (SSSE3 on x86, structured loads on NEON), 16
+ * elements at a time.
+ *
+ * @param[in] src Source array.
+ * @param[in] size Size of the source in bytes.
+ * @param[in] elem Element size in bytes (>= 2).
+ * @param[out] dst Destination, `size` bytes.
+ */
+static void zxc_shuffle(const uint8_t* RESTRICT src, size_t size, size_t elem,
+                        uint8_t* RESTRICT dst) {
+    const size_t n = size / elem;
+    size_t i = 0;
+#if defined(ZXC_USE_AVX2) || defined(ZXC_USE_AVX512)
+    if (elem == 2) {
+        const __m128i m = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+        for (; i + 16 <= n; i += 16) {
+            __m128i a = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + i * 2)), m);
+            __m128i b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + i * 2 + 16)), m);
+            _mm_storeu_si128((__m128i*)(dst + i), _mm_unpacklo_epi64(a, b));
+            _mm_storeu_si128((__m128i*)(dst + n + i), _mm_unpackhi_epi64(a, b));
+        }
+    } else if (elem == 4) {
+        const __m128i m = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+        for (; i + 16 <= n; i += 16) {
+            __m128i r[4];
+            for (int k = 0; k < 4; k++)
+                r[k] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + i * 4 + k * 16)), m);
+            zxc_transpose_4x4_epi32(r);
+            for (int k = 0; k < 4; k++) _mm_storeu_si128((__m128i*)(dst + k * n + i), r[k]);
+        }
+    } else if (elem == 8) {
+        const __m128i m = _mm_setr_epi8(0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15);
+        for (; i + 16 <= n; i += 16) {
+            __m128i r[8];
+            for (int k = 0; k < 8; k++)
+                r[k] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + i * 8 + k * 16)), m);
+            zxc_transpose_8x8_epi16(r);
+            for (int k = 0; k < 8; k++) _mm_storeu_si128((__m128i*)(dst + k * n + i), r[k]);
+        }
+    }
+#elif defined(ZXC_USE_NEON64) || defined(ZXC_USE_NEON32)
+    if (elem == 2) {
+        for (; i + 16 <= n; i += 16) {
+            uint8x16x2_t v = vld2q_u8(src + i * 2);
+            vst1q_u8(dst + i, v.val[0]);
+            vst1q_u8(dst + n + i, v.val[1]);
+        }
+    } else if (elem == 4) {
+        for (; i + 16 <= n; i += 16) {
+            uint8x16x4_t v = vld4q_u8(src + i * 4);
+            for (int k = 0; k < 4; k++) vst1q_u8(dst + k * n + i, v.val[k]);
+        }
+    } else if (elem == 8) {
+        for (; i + 16 <= n; i += 16) {
+            // Byte pairs of 8 + 8 elements, then split each pair into its two planes.
+            uint16x8x4_t a = vld4q_u16((const uint16_t*)(const void*)(src + i * 8));
+            uint16x8x4_t b = vld4q_u16((const uint16_t*)(const void*)(src + i * 8 + 64));
+            for (int k = 0; k < 4; k++) {
+                uint8x16x2_t p =
+                    vuzpq_u8(vreinterpretq_u8_u16(a.val[k]), vreinterpretq_u8_u16(b.val[k]));
+                vst1q_u8(dst + (2 * k) * n + i, p.val[0]);
+                vst1q_u8(dst + (2 * k + 1) * n + i, p.val[1]);
+            }
+        }
+    }
+#endif
+    for (size_t k = 0; k < elem; k++) {
+        uint8_t* RESTRICT plane = dst + k * n;
+        for (size_t j = i; j < n; j++) plane[j] = src[j * elem + k];
+    }
+    ZXC_MEMCPY(dst + n * elem, src + n * elem, size - n * elem);
+}
+
 // cppcheck-suppress unusedFunction
 int zxc_compress_chunk_wrapper(zxc_cctx_t* ctx, const uint8_t* chunk, size_t src_sz, uint8_t* dst,
                                size_t dst_cap) {
     int chk = ctx->checksum_enabled;
 
     size_t w = 0;
-    uint64_t crc = 0;
     int res = -1;
     int try_num = 0;
 
-    if (chk) crc = zxc_checksum(chunk, src_sz, ZXC_CHECKSUM_RAPIDHASH);
-
-    if (zxc_probe_is_numeric(chunk, src_sz)) try_num = 1;
+    // Linked mode: the previous block's tail stands in for the dictionary.
+    const struct zxc_dict_s* dict = ctx->dict;
+    int linked = ctx->link && ctx->link->size > 0;
+    if (linked) ctx->dict = ctx->link;
+
+    // NUM codec: declared by the caller, or found by the 32-bit integer probe.
+    // Indexed by zxc_num_type_t.
+    static const int8_t codec_of_type[] = {
+        -1, -1, ZXC_NUM_CODEC_U16_DELTA, ZXC_NUM_CODEC_U32_DELTA, ZXC_NUM_CODEC_U64_DELTA,
+        ZXC_NUM_CODEC_U64_DOD, ZXC_NUM_CODEC_F32_XOR, ZXC_NUM_CODEC_F64_XOR};
+    int codec = -1;
+    if (ctx->num_type == ZXC_NUM_AUTO) {
+        if (zxc_probe_is_numeric(chunk, src_sz)) codec = ZXC_NUM_CODEC_U32_DELTA;
+    } else if (ctx->num_type > ZXC_NUM_NONE && ctx->num_type <= ZXC_NUM_F64) {
+        codec = codec_of_type[ctx->num_type];
+        if (src_sz % zxc_num_elem_size(codec) != 0) codec = -1;
+    }
+    try_num = codec >= 0;
 
     if (try_num) {
-        res = zxc_encode_block_num(ctx, chunk, src_sz, dst, dst_cap, &w, crc);
-        if (res != 0 || w > (src_sz - (src_sz >> 2)))  // w > 75% of src_sz
+        if (codec == ZXC_NUM_CODEC_U32_DELTA)
+            res = zxc_encode_block_num(ctx, chunk, src_sz, dst, dst_cap, &w);
+        else
+            res = zxc_encode_block_num_typed(ctx, codec, chunk, src_sz, dst, dst_cap, &w);
+        if (res != 0 || w > (src_sz - (src_sz >> 2))) {  // w > 75% of src_sz
             try_num = 0;  // NUM didn't compress well, try GLO/GHI instead
+            ctx->stats.num_rejected++;
+        }
     }
 
+    int skipped = 0;
+    int ghi_by_data = 0;
+
     if (!try_num) {
-        if (ctx->compression_level <= 2) {
-            res = zxc_encode_block_ghi(ctx, chunk, src_sz, dst, dst_cap, &w, crc);
+        // Byte shuffle: the LZ stage sees the planes instead of the elements.
+        // Linked history is unshuffled data, so the two are never combined.
+        const uint8_t* data = chunk;
+        size_t elem = ctx->elem_size;
+        if (elem > 1 && !linked && src_sz >= 2 * elem) {
+            uint8_t* buf = zxc_cctx_shuffle_buf(ctx, src_sz);
+            if (UNLIKELY(!buf)) {
+                ctx->dict = dict;
+                return -1;
+            }
+            zxc_shuffle(chunk, src_sz, elem, buf);
+            data = buf;
+        }
+        // Pre-pass: incompressible data is stored RAW without running LZ77. At
+        // levels 3-5 GLO only wins on the match encoding (literals are not
+        // entropy coded yet), so blocks with few matches take the faster GHI.
+        // Levels 1-2 skip it: their match finder already gives up quickly on
+        // data without matches.
+        int ghi = ctx->compression_level <= 2;
+        if (!ghi && src_sz >= ZXC_EST_HIST_MIN) {
+            zxc_block_est_t est;
+            zxc_estimate_block(data, src_sz, &est);
+            // Output per KB of input: literals, plus ~3 bytes per match.
+            const uint32_t est_out = 1024 - est.cover * 4 + 3 * est.density;
+            if (est.entropy >= ZXC_EST_RAW_ENTROPY && est.cover < ZXC_EST_RAW_COVER) {
+                skipped = 1;
+            } else if (ctx->compression_level <= 5 &&
+                       est.density * ZXC_EST_GHI_SHARE < est_out) {
+                ghi = ghi_by_data = 1;
+            }
+        }
+        if (skipped) {
+            res = -1;
+        } else if (ghi) {
+            res = zxc_encode_block_ghi(ctx, data, src_sz, dst, dst_cap, &w);
         } else {
-            res = zxc_encode_block_glo(ctx, chunk, src_sz, dst, dst_cap, &w, crc);
+            res = zxc_encode_block_glo(ctx, data, src_sz, dst, dst_cap, &w);
+        }
+        // Only LZ blocks can reach into the history; NUM and RAW stay independent.
+        if (linked && res == 0) dst[1] |= ZXC_BLOCK_FLAG_LINKED;
+        if (data != chunk && res == 0) {
+            dst[1] |= ZXC_BLOCK_FLAG_SHUFFLED;
+            zxc_store_le16(dst + 2, (uint16_t)elem);
         }
     }
+    ctx->dict = dict;
 
     if (UNLIKELY(res != 0 || w >= src_sz)) {
-        res = zxc_encode_block_raw(chunk, src_sz, dst, dst_cap, &w, chk, crc);
+        res = zxc_encode_block_raw(chunk, src_sz, dst, dst_cap, &w, chk);
         if (UNLIKELY(res != 0)) return res;
+        ctx->stats.raw_blocks++;
+        ctx->stats.raw_bytes += src_sz;
+        ctx->stats.raw_comp_bytes += w;
+        if (skipped)
+            ctx->stats.raw_skipped++;
+        else
+            ctx->stats.raw_fallback++;
+    } else if (try_num) {
+        ctx->stats.num_blocks++;
+        ctx->stats.num_bytes += src_sz;
+        ctx->stats.num_comp_bytes += w;
+    } else if (dst[0] == ZXC_BLOCK_GHI) {
+        ctx->stats.ghi_blocks++;
+        ctx->stats.ghi_by_data += (uint64_t)ghi_by_data;
+        ctx->stats.ghi_bytes += src_sz;
+        ctx->stats.ghi_comp_bytes += w;
+    } else {
+        ctx->stats.glo_blocks++;
+        ctx->stats.glo_bytes += src_sz;
+        ctx->stats.glo_comp_bytes += w;
     }
 
+    // The encoders only reserve the checksum slot: hashing the block now, right
+    // after they have read it, runs on cached data instead of taking the misses
+    // of a first pass over input that was never touched.
+    if (chk) {
+        const uint64_t t0 = ctx->timed ? zxc_perf_now() : 0;
+        zxc_store_le64(dst + ZXC_BLOCK_HEADER_SIZE,
+                       zxc_checksum(chunk, src_sz, ZXC_CHECKSUM_RAPIDHASH));
+        if (ctx->timed) ctx->checksum_ns += zxc_perf_now() - t0;
+    }
     return (int)w;
 }
@@ -87,7 +87,7 @@ static ZXC_ALWAYS_INLINE uint32_t zxc_read_vbyte(const uint8_t** ptr, const uint
         return (b0 & ZXC_VBYTE_MASK) | (b1 << 7);
     }
 
-    // 3-byte path (last possible for ZXC_BLOCK_SIZE = 256KB)
+    // 3-byte path (covers lengths below 2MB)
     if (UNLIKELY(p + 2 >= end)) {
         *ptr = p + 2;
         return 0;
@@ -205,6 +205,39 @@ static ZXC_ALWAYS_INLINE void zxc_copy_overlap16(uint8_t* dst, uint32_t off) {
 #endif
 }
 
+/**
+ * @brief Copies a match whose reference starts before the block, in the dictionary.
+ *
+ * A block of a dictionary frame sees the dictionary as the bytes right before
+ * its first byte. Offsets reaching past the block start are only possible
+ * while fewer than 64KB have been written, i.e. in the validated (SAFE and
+ * tail) paths, which call this cold helper instead of failing. The match is
+ * copied exactly (no wild copy): the dictionary part first, then the part that
+ * continues into the start of the block.
+ *
+ * @param[in] ctx Decompression context (ctx->dict may be NULL).
+ * @param[out] d_ptr Current output position.
+ * @param[in] written Bytes already written in the block (d_ptr - block start).
+ * @param[in] off Match offset, greater than written.
+ * @param[in] ml Match length; d_ptr + ml must be inside the destination.
+ * @return 0 on success, -1 if there is no dictionary or the offset reaches past it.
+ */
+static int zxc_copy_dict_match(const zxc_cctx_t* ctx, uint8_t* d_ptr, size_t written, size_t off,
+                               size_t ml) {
+    const struct zxc_dict_s* dict = ctx->dict;
+    if (UNLIKELY(!dict || off > written + dict->size)) return -1;
+
+    size_t before = off - written;  // Bytes of the match inside the dictionary
+    size_t n = ml < before ? ml : before;
+    ZXC_MEMCPY(d_ptr, dict->content + dict->size - before, n);
+    // The rest starts at the beginning of the block and may overlap the output
+    if (off >= ml - n)
+        ZXC_MEMCPY(d_ptr + n, d_ptr + n - off, ml - n);
+    else
+        for (size_t i = n; i < ml; i++) d_ptr[i] = d_ptr[i - off];
+    return 0;
+}
+
 
 
 #if defined(ZXC_USE_NEON64) || defined(ZXC_USE_NEON32)
@@ -308,6 +341,356 @@ static ZXC_ALWAYS_INLINE __m512i zxc_mm512_prefix_sum_epi32(__m512i v) {
 }
 #endif
 
+#if defined(ZXC_USE_NEON64) || defined(ZXC_USE_NEON32)
+/**
+ * @brief Running XOR of a 128-bit vector of 32-bit lanes (zxc_neon_prefix_sum_u32() with XOR).
+ *
+ * @param[in] v The input vector containing four 32-bit unsigned integers.
+ * @return `[a, a^b, a^b^c, a^b^c^d]`.
+ */
+static ZXC_ALWAYS_INLINE uint32x4_t zxc_neon_prefix_xor_u32(uint32x4_t v) {
+    uint32x4_t zero = vdupq_n_u32(0);
+    v = veorq_u32(v, vreinterpretq_u32_u8(
+                         vextq_u8(vreinterpretq_u8_u32(zero), vreinterpretq_u8_u32(v), 12)));
+    v = veorq_u32(
+        v, vreinterpretq_u32_u8(vextq_u8(vreinterpretq_u8_u32(zero), vreinterpretq_u8_u32(v), 8)));
+    return v;
+}
+
+/**
+ * @brief Prefix sum of a 128-bit vector of two 64-bit lanes: `[a, a+b]`.
+ */
+static ZXC_ALWAYS_INLINE uint64x2_t zxc_neon_prefix_sum_u64(uint64x2_t v) {
+    return vaddq_u64(v, vextq_u64(vdupq_n_u64(0), v, 1));
+}
+
+/**
+ * @brief Running XOR of a 128-bit vector of two 64-bit lanes: `[a, a^b]`.
+ */
+static ZXC_ALWAYS_INLINE uint64x2_t zxc_neon_prefix_xor_u64(uint64x2_t v) {
+    return veorq_u64(v, vextq_u64(vdupq_n_u64(0), v, 1));
+}
+#endif
+
+#if defined(ZXC_USE_AVX2)
+/**
+ * @brief Running XOR of the eight 32-bit lanes of a 256-bit vector.
+ *
+ * Same lane bridging as zxc_mm256_prefix_sum_epi32(), with XOR instead of
+ * addition: out[i] = v[0] ^ ... ^ v[i].
+ *
+ * @param[in] v The input 256-bit vector containing eight 32-bit integers.
+ * @return A 256-bit vector containing the running XOR of the input elements.
+ */
+static ZXC_ALWAYS_INLINE __m256i zxc_mm256_prefix_xor_epi32(__m256i v) {
+    v = _mm256_xor_si256(v, _mm256_slli_si256(v, 4));
+    v = _mm256_xor_si256(v, _mm256_slli_si256(v, 8));
+    __m256i v_bridge = _mm256_permute2x128_si256(v, v, 0x00);
+    v_bridge = _mm256_shuffle_epi32(v_bridge, 0xFF);
+    v_bridge = _mm256_blend_epi32(_mm256_setzero_si256(), v_bridge, 0xF0);
+    return _mm256_xor_si256(v, v_bridge);
+}
+
+/**
+ * @brief Prefix sum of the four 64-bit lanes of a 256-bit vector.
+ *
+ * @param[in] v The input 256-bit vector containing four 64-bit integers.
+ * @return `[a, a+b, a+b+c, a+b+c+d]`.
+ */
+static ZXC_ALWAYS_INLINE __m256i zxc_mm256_prefix_sum_epi64(__m256i v) {
+    v = _mm256_add_epi64(v, _mm256_slli_si256(v, 8));  // [a, a+b | c, c+d]
+    __m256i v_bridge = _mm256_permute4x64_epi64(v, 0x55);  // Broadcast a+b
+    v_bridge = _mm256_blend_epi32(_mm256_setzero_si256(), v_bridge, 0xF0);
+    return _mm256_add_epi64(v, v_bridge);
+}
+
+/**
+ * @brief Running XOR of the four 64-bit lanes of a 256-bit vector.
+ *
+ * @param[in] v The input 256-bit vector containing four 64-bit integers.
+ * @return `[a, a^b, a^b^c, a^b^c^d]`.
+ */
+static ZXC_ALWAYS_INLINE __m256i zxc_mm256_prefix_xor_epi64(__m256i v) {
+    v = _mm256_xor_si256(v, _mm256_slli_si256(v, 8));
+    __m256i v_bridge = _mm256_permute4x64_epi64(v, 0x55);
+    v_bridge = _mm256_blend_epi32(_mm256_setzero_si256(), v_bridge, 0xF0);
+    return _mm256_xor_si256(v, v_bridge);
+}
+#endif
+
+#if defined(ZXC_USE_AVX512)
+/**
+ * @brief Running XOR of the sixteen 32-bit lanes of a 512-bit vector.
+ *
+ * Shifts by 1, 2, 4 and 8 lanes across the whole register (valignd against
+ * zero), so no per-128-bit-lane propagation is needed.
+ *
+ * @param[in] v The input 512-bit vector containing sixteen 32-bit integers.
+ * @return A 512-bit vector containing the running XOR of the input elements.
+ */
+static ZXC_ALWAYS_INLINE __m512i zxc_mm512_prefix_xor_epi32(__m512i v) {
+    const __m512i z = _mm512_setzero_si512();
+    v = _mm512_xor_si512(v, _mm512_alignr_epi32(v, z, 15));
+    v = _mm512_xor_si512(v, _mm512_alignr_epi32(v, z, 14));
+    v = _mm512_xor_si512(v, _mm512_alignr_epi32(v, z, 12));
+    return _mm512_xor_si512(v, _mm512_alignr_epi32(v, z, 8));
+}
+
+/**
+ * @brief Prefix sum of the eight 64-bit lanes of a 512-bit vector.
+ *
+ * @param[in] v The input 512-bit vector containing eight 64-bit integers.
+ * @return A 512-bit vector containing the prefix sums of the input elements.
+ */
+static ZXC_ALWAYS_INLINE __m512i zxc_mm512_prefix_sum_epi64(__m512i v) {
+    const __m512i z = _mm512_setzero_si512();
+    v = _mm512_add_epi64(v, _mm512_alignr_epi64(v, z, 7));
+    v = _mm512_add_epi64(v, _mm512_alignr_epi64(v, z, 6));
+    return _mm512_add_epi64(v, _mm512_alignr_epi64(v, z, 4));
+}
+
+/**
+ * @brief Running XOR of the eight 64-bit lanes of a 512-bit vector.
+ *
+ * @param[in] v The input 512-bit vector containing eight 64-bit integers.
+ * @return A 512-bit vector containing the running XOR of the input elements.
+ */
+static ZXC_ALWAYS_INLINE __m512i zxc_mm512_prefix_xor_epi64(__m512i v) {
+    const __m512i z = _mm512_setzero_si512();
+    v = _mm512_xor_si512(v, _mm512_alignr_epi64(v, z, 7));
+    v = _mm512_xor_si512(v, _mm512_alignr_epi64(v, z, 6));
+    return _mm512_xor_si512(v, _mm512_alignr_epi64(v, z, 4));
+}
+#endif
+
+/**
+ * @brief Integrates a batch of ZXC_DEC_BATCH 32-bit values in place.
+ *
+ * Turns deltas (running sum) or XOR residuals (running XOR) into values,
+ * starting from the value preceding the batch.
+ *
+ * @param[in,out] v Cache-line aligned batch: residuals in, values out.
+ * @param[in] run Value preceding the batch.
+ * @param[in] use_xor 1 for a running XOR, 0 for a running sum.
+ * @return The last value of the batch.
+ */
+static ZXC_ALWAYS_INLINE uint32_t zxc_num_scan32(uint32_t* RESTRICT v, uint32_t run,
+                                                 int use_xor) {
+#if defined(ZXC_USE_AVX512)
+    for (int k = 0; k < ZXC_DEC_BATCH; k += 16) {
+        __m512i x = _mm512_load_si512((void*)&v[k]);
+        __m512i r = _mm512_set1_epi32((int)run);
+        x = use_xor ? _mm512_xor_si512(zxc_mm512_prefix_xor_epi32(x), r)
+                    : _mm512_add_epi32(zxc_mm512_prefix_sum_epi32(x), r);
+        _mm512_store_si512((void*)&v[k], x);
+        run = v[k + 15];
+    }
+#elif defined(ZXC_USE_AVX2)
+    for (int k = 0; k < ZXC_DEC_BATCH; k += 8) {
+        __m256i x = _mm256_load_si256((const __m256i*)&v[k]);
+        __m256i r = _mm256_set1_epi32((int)run);
+        x = use_xor ? _mm256_xor_si256(zxc_mm256_prefix_xor_epi32(x), r)
+                    : _mm256_add_epi32(zxc_mm256_prefix_sum_epi32(x), r);
+        _mm256_store_si256((__m256i*)&v[k], x);
+        run = v[k + 7];
+    }
+#elif defined(ZXC_USE_NEON64) || defined(ZXC_USE_NEON32)
+    for (int k = 0; k < ZXC_DEC_BATCH; k += 4) {
+        uint32x4_t x = vld1q_u32(&v[k]);
+        uint32x4_t r = vdupq_n_u32(run);
+        x = use_xor ? veorq_u32(zxc_neon_prefix_xor_u32(x), r)
+                    : vaddq_u32(zxc_neon_prefix_sum_u32(x), r);
+        vst1q_u32(&v[k], x);
+        run = vgetq_lane_u32(x, 3);
+    }
+#else
+    for (int k = 0; k < ZXC_DEC_BATCH; k++) {
+        run = use_xor ? run ^ v[k] : run + v[k];
+        v[k] = run;
+    }
+#endif
+    return run;
+}
+
+/**
+ * @brief Integrates a batch of ZXC_DEC_BATCH 64-bit values in place.
+ *
+ * 64-bit counterpart of zxc_num_scan32().
+ *
+ * @param[in,out] v Cache-line aligned batch: residuals in, values out.
+ * @param[in] run Value preceding the batch.
+ * @param[in] use_xor 1 for a running XOR, 0 for a running sum.
+ * @return The last value of the batch.
+ */
+static ZXC_ALWAYS_INLINE uint64_t zxc_num_scan64(uint64_t* RESTRICT v, uint64_t run,
+                                                 int use_xor) {
+#if defined(ZXC_USE_AVX512)
+    for (int k = 0; k < ZXC_DEC_BATCH; k += 8) {
+        __m512i x = _mm512_load_si512((void*)&v[k]);
+        __m512i r = _mm512_set1_epi64((long long)run);
+        x = use_xor ? _mm512_xor_si512(zxc_mm512_prefix_xor_epi64(x), r)
+                    : _mm512_add_epi64(zxc_mm512_prefix_sum_epi64(x), r);
+        _mm512_store_si512((void*)&v[k], x);
+        run = v[k + 7];
+    }
+#elif defined(ZXC_USE_AVX2)
+    for (int k = 0; k < ZXC_DEC_BATCH; k += 4) {
+        __m256i x = _mm256_load_si256((const __m256i*)&v[k]);
+        __m256i r = _mm256_set1_epi64x((long long)run);
+        x = use_xor ? _mm256_xor_si256(zxc_mm256_prefix_xor_epi64(x), r)
+                    : _mm256_add_epi64(zxc_mm256_prefix_sum_epi64(x), r);
+        _mm256_store_si256((__m256i*)&v[k], x);
+        run = v[k + 3];
+    }
+#elif defined(ZXC_USE_NEON64) || defined(ZXC_USE_NEON32)
+    for (int k = 0; k < ZXC_DEC_BATCH; k += 2) {
+        uint64x2_t x = vld1q_u64(&v[k]);
+        uint64x2_t r = vdupq_n_u64(run);
+        x = use_xor ? veorq_u64(zxc_neon_prefix_xor_u64(x), r)
+                    : vaddq_u64(zxc_neon_prefix_sum_u64(x), r);
+        vst1q_u64(&v[k], x);
+        run = vgetq_lane_u64(x, 1);
+    }
+#else
+    for (int k = 0; k < ZXC_DEC_BATCH; k++) {
+        run = use_xor ? run ^ v[k] : run + v[k];
+        v[k] = run;
+    }
+#endif
+    return run;
+}
+
+/**
+ * @brief Reads one packed NUM value of up to 64 bits.
+ *
+ * @param[in,out] br Bit reader positioned on the value.
+ * @param[in] bits Width of the value (0..64).
+ * @return The value.
+ */
+static ZXC_ALWAYS_INLINE uint64_t zxc_num_read(zxc_bit_reader_t* br, unsigned bits) {
+    if (bits <= 32) {
+        zxc_br_ensure(br, (int)bits);
+        return zxc_br_consume_fast(br, (uint8_t)bits);
+    }
+    zxc_br_ensure(br, 32);
+    uint64_t lo = zxc_br_consume_fast(br, 32);
+    zxc_br_ensure(br, (int)bits - 32);
+    return lo | ((uint64_t)zxc_br_consume_fast(br, (uint8_t)(bits - 32)) << 32);
+}
+
+/**
+ * @brief Decodes the frames of a NUM block with a 16/64-bit or float codec.
+ *
+ * Inverse of zxc_encode_block_num_typed(): each frame is unpacked in batches,
+ * the residuals are mapped back (zigzag decode, or shift for the XOR codecs)
+ * and integrated with the SIMD scans, starting from the frame base.
+ *
+ * @param[in] nh NUM header of the block (codec != ZXC_NUM_CODEC_U32_DELTA).
+ * @param[in] p First frame.
+ * @param[in] p_end End of the block payload.
+ * @param[out] dst Destination buffer.
+ * @param[in] dst_capacity Capacity of the destination buffer in bytes.
+ *
+ * @return The number of bytes written to dst, or -1 if the block is malformed.
+ */
+static int zxc_decode_block_num_typed(const zxc_num_header_t* nh, const uint8_t* RESTRICT p,
+                                      const uint8_t* p_end, uint8_t* RESTRICT dst,
+                                      size_t dst_capacity) {
+    const int codec = nh->codec;
+    if (UNLIKELY(codec >= ZXC_NUM_CODEC_COUNT)) return -1;
+    const size_t elem = zxc_num_elem_size(codec);
+    const unsigned elem_bits = (unsigned)elem * ZXC_BITS_PER_BYTE;
+    const int is_xor = codec >= ZXC_NUM_CODEC_F32_XOR;
+    uint8_t* d_ptr = dst;
+    const uint8_t* const d_end = dst + dst_capacity;
+    uint64_t vals_remaining = nh->n_values;
+    uint64_t run_d = 0;  // Carried delta (delta-of-delta codec)
+
+    ZXC_ALIGN(ZXC_CACHE_LINE_SIZE)
+    uint64_t v64[ZXC_DEC_BATCH];
+    ZXC_ALIGN(ZXC_CACHE_LINE_SIZE)
+    uint32_t v32[ZXC_DEC_BATCH];
+
+    while (vals_remaining > 0) {
+        if (UNLIKELY(p_end - p < 16)) return -1;
+        uint16_t nvals = zxc_le16(p + 0);
+        uint16_t field = zxc_le16(p + 2);
+        uint64_t run = zxc_le64(p + 4);
+        uint32_t psize = zxc_le32(p + 12);
+        p += 16;
+        unsigned bits = field & 0xFF, shift = field >> ZXC_NUM_SHIFT_SHIFT;
+        if (UNLIKELY(psize > (size_t)(p_end - p) || nvals == 0 || nvals > vals_remaining ||
+                     (size_t)nvals * elem > (size_t)(d_end - d_ptr) || bits + shift > elem_bits ||
+                     shift >= elem_bits || (shift && !is_xor) ||
+                     psize < ((size_t)nvals * bits + ZXC_BITS_PER_BYTE - 1) / ZXC_BITS_PER_BYTE))
+            return -1;
+
+        zxc_bit_reader_t br;
+        zxc_br_init(&br, p, psize);
+        size_t i = 0;
+
+        for (; i + ZXC_DEC_BATCH <= nvals; i += ZXC_DEC_BATCH) {
+            if (elem_bits == 16) {
+                for (int k = 0; k < ZXC_DEC_BATCH; k++)
+                    v32[k] = (uint32_t)zxc_zigzag_decode((uint32_t)zxc_num_read(&br, bits));
+                run = zxc_num_scan32(v32, (uint32_t)run, 0);
+                for (int k = 0; k < ZXC_DEC_BATCH; k++)
+                    zxc_store_le16(d_ptr + k * 2, (uint16_t)v32[k]);
+            } else if (elem_bits == 32) {
+                for (int k = 0; k < ZXC_DEC_BATCH; k++)
+                    v32[k] = (uint32_t)zxc_num_read(&br, bits) << shift;
+                run = zxc_num_scan32(v32, (uint32_t)run, 1);
+                ZXC_MEMCPY(d_ptr, v32, sizeof(v32));
+            } else if (is_xor) {
+                for (int k = 0; k < ZXC_DEC_BATCH; k++) v64[k] = zxc_num_read(&br, bits) << shift;
+                run = zxc_num_scan64(v64, run, 1);
+                ZXC_MEMCPY(d_ptr, v64, sizeof(v64));
+            } else {
+                for (int k = 0; k < ZXC_DEC_BATCH; k++)
+                    v64[k] = (uint64_t)zxc_zigzag_decode64(zxc_num_read(&br, bits));
+                if (codec == ZXC_NUM_CODEC_U64_DOD) {
+                    run_d = zxc_num_scan64(v64, run_d, 0);  // Deltas of deltas -> deltas
+                }
+                run = zxc_num_scan64(v64, run, 0);
+                ZXC_MEMCPY(d_ptr, v64, sizeof(v64));
+            }
+            d_ptr += ZXC_DEC_BATCH * elem;
+        }
+
+        for (; i < nvals; i++) {
+            uint64_t x = zxc_num_read(&br, bits);
+            switch (codec) {
+                case ZXC_NUM_CODEC_U16_DELTA:
+                    run += (uint64_t)(int64_t)zxc_zigzag_decode((uint32_t)x);
+                    zxc_store_le16(d_ptr, (uint16_t)run);
+                    break;
+                case ZXC_NUM_CODEC_F32_XOR:
+                    run ^= x << shift;
+                    zxc_store_le32(d_ptr, (uint32_t)run);
+                    break;
+                case ZXC_NUM_CODEC_U64_DOD:
+                    run_d += (uint64_t)zxc_zigzag_decode64(x);
+                    run += run_d;
+                    zxc_store_le64(d_ptr, run);
+                    break;
+                case ZXC_NUM_CODEC_U64_DELTA:
+                    run += (uint64_t)zxc_zigzag_decode64(x);
+                    zxc_store_le64(d_ptr, run);
+                    break;
+                default:  // ZXC_NUM_CODEC_F64_XOR
+                    run ^= x << shift;
+                    zxc_store_le64(d_ptr, run);
+                    break;
+            }
+            d_ptr += elem;
+        }
+
+        p += psize;
+        vals_remaining -= nvals;
+    }
+    return (int)(d_ptr - dst);
+}
+
 /**
  * @brief Decodes a block of numerical data compressed with the ZXC format.
  *
@@ -344,6 +727,9 @@ static int zxc_decode_block_num(const uint8_t* RESTRICT src, size_t src_size, ui
 
     zxc_num_header_t nh;
     if (UNLIKELY(zxc_read_num_header(src, src_size, &nh) != 0)) return -1;
+    if (nh.codec != ZXC_NUM_CODEC_U32_DELTA)
+        return zxc_decode_block_num_typed(&nh, src + ZXC_NUM_HEADER_BINARY_SIZE, src + src_size,
+                                          dst, dst_capacity);
 
     const uint8_t* p = src + ZXC_NUM_HEADER_BINARY_SIZE;
     const uint8_t* p_end = src + src_size;
@@ -464,6 +850,280 @@ static int zxc_decode_block_num(const uint8_t* RESTRICT src, size_t src_size, ui
     return (int)(d_ptr - dst);
 }
 
+/*
+ * ============================================================================
+ * FSE (tANS) DECODER
+ * ============================================================================
+ */
+
+/**
+ * @struct zxc_fse_dentry_t
+ * @brief Decoder table entry: symbol of the state and how to reach the next one.
+ */
+typedef struct {
+    uint16_t new_state;  // Next state base (before adding the read bits)
+    uint8_t symbol;      // Decoded symbol
+    uint8_t nb_bits;     // Bits to read for the next state
+} zxc_fse_dentry_t;
+
+/**
+ * @struct zxc_fse_dstream_t
+ * @brief Backward bit reader over one tANS stream.
+ */
+typedef struct {
+    uint64_t bits;         // Window ending at ptr + 8
+    unsigned consumed;     // Bits of the window already read, from the top
+    const uint8_t* ptr;    // Start of the window
+    const uint8_t* start;  // Start of the stream
+} zxc_fse_dstream_t;
+
+/**
+ * @brief Reads @p n bits (0 to 32) from the top of the window.
+ */
+static ZXC_ALWAYS_INLINE uint32_t zxc_fse_read(zxc_fse_dstream_t* d, unsigned n) {
+    uint32_t v = (uint32_t)(((d->bits << (d->consumed & 63)) >> 1) >> (63 - n));
+    d->consumed += n;
+    return v;
+}
+
+/**
+ * @brief Slides the window back over the consumed bytes.
+ *
+ * Away from the stream start this leaves at least 57 unread bits, enough for
+ * four symbols of up to ZXC_FSE_TABLE_LOG_MAX bits.
+ */
+static ZXC_ALWAYS_INLINE void zxc_fse_reload(zxc_fse_dstream_t* d) {
+    if (UNLIKELY(d->ptr == d->start || d->consumed > 64)) return;
+    size_t nb = d->consumed >> 3;
+    size_t avail = (size_t)(d->ptr - d->start);
+    if (UNLIKELY(nb > avail)) nb = avail;
+    d->ptr -= nb;
+    d->consumed -= (unsigned)nb * 8;
+    d->bits = zxc_le64(d->ptr);
+}
+
+/**
+ * @brief Refill that assumes at least 6 bytes behind the window (no checks).
+ */
+static ZXC_ALWAYS_INLINE void zxc_fse_reload_fast(zxc_fse_dstream_t* d) {
+    d->ptr -= d->consumed >> 3;
+    d->consumed &= 7;
+    d->bits = zxc_le64(d->ptr);
+}
+
+/**
+ * @brief Emits the symbol of state @p st and moves to the next state.
+ */
+static ZXC_ALWAYS_INLINE uint32_t zxc_fse_step(const zxc_fse_dentry_t* RESTRICT dt, uint32_t st,
+                                               uint8_t* RESTRICT op, zxc_fse_dstream_t* d) {
+    const zxc_fse_dentry_t e = dt[st];
+    *op = e.symbol;
+    return e.new_state + zxc_fse_read(d, e.nb_bits);
+}
+
+/**
+ * @brief Opens a stream: skips the end marker and reads the four initial states.
+ *
+ * @return 0 on success, -1 if the stream is empty or has no end marker.
+ */
+static int zxc_fse_open(zxc_fse_dstream_t* d, const uint8_t* src, size_t size, unsigned log,
+                        uint32_t st[ZXC_FSE_STATES]) {
+    if (UNLIKELY(size == 0 || src[size - 1] == 0)) return -1;
+    d->start = src;
+    // The end marker and the zero bits above it are already consumed.
+    d->consumed = 8U - (zxc_highbit32(src[size - 1]) - 1U);
+    if (size >= sizeof(uint64_t)) {
+        d->ptr = src + size - sizeof(uint64_t);
+        d->bits = zxc_le64(d->ptr);
+    } else {
+        d->ptr = src;
+        d->bits = 0;
+        for (size_t k = 0; k < size; k++) d->bits |= (uint64_t)src[k] << (8 * k);
+        d->consumed += (unsigned)(sizeof(uint64_t) - size) * 8;
+    }
+    for (int k = 0; k < ZXC_FSE_STATES; k++) st[k] = zxc_fse_read(d, log);
+    return 0;
+}
+
+/**
+ * @brief Decodes the rest of a stream with checked refills.
+ *
+ * @return 0 if the stream ends exactly with the last symbol, -1 otherwise.
+ */
+static int zxc_fse_finish(const zxc_fse_dentry_t* RESTRICT dt, zxc_fse_dstream_t* d,
+                          uint32_t st[ZXC_FSE_STATES], uint8_t* RESTRICT op,
+                          const uint8_t* op_end) {
+    // Both streams hold a multiple of 4 symbols, except the tail of stream B.
+    while (op + ZXC_FSE_STATES <= op_end) {
+        zxc_fse_reload(d);
+        st[0] = zxc_fse_step(dt, st[0], op + 0, d);
+        st[1] = zxc_fse_step(dt, st[1], op + 1, d);
+        st[2] = zxc_fse_step(dt, st[2], op + 2, d);
+        st[3] = zxc_fse_step(dt, st[3], op + 3, d);
+        op += ZXC_FSE_STATES;
+    }
+    zxc_fse_reload(d);
+    for (int k = 0; op < op_end; k++) st[k] = zxc_fse_step(dt, st[k], op++, d);
+
+    // A valid stream is consumed exactly.
+    return (d->ptr == d->start && d->consumed == 64) ? 0 : -1;
+}
+
+/**
+ * @brief Decodes an FSE section produced by zxc_fse_encode().
+ *
+ * @param[in] src Encoded section.
+ * @param[in] src_size Exact size of the section.
+ * @param[out] dst Destination buffer (at least @p n bytes).
+ * @param[in] n Number of bytes to decode.
+ * @return 0 on success, -1 if the section is malformed or not consumed exactly.
+ */
+static int zxc_fse_decode(const uint8_t* RESTRICT src, size_t src_size, uint8_t* RESTRICT dst,
+                          size_t n) {
+    if (UNLIKELY(src_size < 3 || n < ZXC_FSE_STATES)) return -1;
+
+    const unsigned log = src[0];
+    const unsigned max_sym = src[1];
+    if (UNLIKELY(log < ZXC_FSE_TABLE_LOG_MIN || log > ZXC_FSE_TABLE_LOG_MAX)) return -1;
+    const uint32_t size = 1U << log;
+
+    // --- Table header ---
+    uint16_t norm[ZXC_FSE_SYMBOLS];
+    const uint8_t* ip = src + 2;
+    const uint8_t* const iend = src + src_size;
+    uint64_t acc = 0;
+    unsigned bits = 0;
+    uint32_t sum = 0;
+
+    for (unsigned s = 0; s <= max_sym; s++) {
+        // A code spans at most 2 * (ZXC_FSE_TABLE_LOG_MAX + 1) - 1 bits.
+        while (bits <= 56 && ip < iend) {
+            acc |= (uint64_t)(*ip++) << bits;
+            bits += 8;
+        }
+        if (UNLIKELY(acc == 0)) return -1;
+        unsigned len = (unsigned)zxc_ctz64(acc) + 1;
+        if (UNLIKELY(len > ZXC_FSE_TABLE_LOG_MAX + 1 || 2 * len - 1 > bits)) return -1;
+        acc >>= len;
+        uint32_t v = (1U << (len - 1)) | (uint32_t)(acc & ((1U << (len - 1)) - 1));
+        acc >>= len - 1;
+        bits -= 2 * len - 1;
+        norm[s] = (uint16_t)(v - 1);
+        sum += norm[s];
+        if (UNLIKELY(sum > size)) return -1;
+    }
+    if (UNLIKELY(sum != size)) return -1;
+    // Whole bytes left in the window were read ahead of the streams.
+    ip -= bits >> 3;
+
+    // --- Decoder table ---
+    zxc_fse_dentry_t dt[1U << ZXC_FSE_TABLE_LOG_MAX];
+    uint8_t cells[1U << ZXC_FSE_TABLE_LOG_MAX];
+    uint32_t next[ZXC_FSE_SYMBOLS];
+
+    zxc_fse_spread(norm, max_sym, log, cells);
+    for (unsigned s = 0; s <= max_sym; s++) next[s] = norm[s];
+    for (uint32_t u = 0; u < size; u++) {
+        uint8_t s = cells[u];
+        uint32_t x = next[s]++;
+        unsigned nb = log - (zxc_highbit32(x) - 1U);
+        dt[u].symbol = s;
+        dt[u].nb_bits = (uint8_t)nb;
+        dt[u].new_state = (uint16_t)((x << nb) - size);
+    }
+
+    // --- Streams ---
+    if (UNLIKELY((size_t)(iend - ip) < sizeof(uint32_t))) return -1;
+    size_t len_a = zxc_le32(ip);
+    ip += sizeof(uint32_t);
+    if (UNLIKELY(len_a > (size_t)(iend - ip))) return -1;
+
+    const size_t n_a = (n / 2) & ~(size_t)(ZXC_FSE_STATES - 1);
+    zxc_fse_dstream_t da, db;
+    uint32_t sa[ZXC_FSE_STATES], sb[ZXC_FSE_STATES];
+    if (UNLIKELY(zxc_fse_open(&da, ip, len_a, log, sa) != 0 ||
+                 zxc_fse_open(&db, ip + len_a, (size_t)(iend - ip) - len_a, log, sb) != 0))
+        return -1;
+
+    // Lockstep loop: 8 states in flight. A refill moves a window back by at
+    // most 6 bytes, so runs of (room / 6) groups need no refill checks.
+    uint8_t* op = dst;
+    uint8_t* const op_end = dst + n_a;
+    uint32_t a0 = sa[0], a1 = sa[1], a2 = sa[2], a3 = sa[3];
+    uint32_t b0 = sb[0], b1 = sb[1], b2 = sb[2], b3 = sb[3];
+    for (;;) {
+        size_t run = (size_t)(op_end - op) / ZXC_FSE_STATES;
+        size_t room_a = (size_t)(da.ptr - da.start) / 6;
+        size_t room_b = (size_t)(db.ptr - db.start) / 6;
+        if (run > room_a) run = room_a;
+        if (run > room_b) run = room_b;
+        if (run == 0) break;
+        do {
+            zxc_fse_reload_fast(&da);
+            zxc_fse_reload_fast(&db);
+            a0 = zxc_fse_step(dt, a0, op + 0, &da);
+            b0 = zxc_fse_step(dt, b0, op + n_a + 0, &db);
+            a1 = zxc_fse_step(dt, a1, op + 1, &da);
+            b1 = zxc_fse_step(dt, b1, op + n_a + 1, &db);
+            a2 = zxc_fse_step(dt, a2, op + 2, &da);
+            b2 = zxc_fse_step(dt, b2, op + n_a + 2, &db);
+            a3 = zxc_fse_step(dt, a3, op + 3, &da);
+            b3 = zxc_fse_step(dt, b3, op + n_a + 3, &db);
+            op += ZXC_FSE_STATES;
+        } while (--run);
+    }
+    sa[0] = a0, sa[1] = a1, sa[2] = a2, sa[3] = a3;
+    sb[0] = b0, sb[1] = b1, sb[2] = b2, sb[3] = b3;
+
+    if (UNLIKELY(zxc_fse_finish(dt, &da, sa, op, op_end) != 0 ||
+                 zxc_fse_finish(dt, &db, sb, op + n_a, dst + n) != 0))
+        return -1;
+    return 0;
+}
+
+/**
+ * @brief Makes sure the scratch buffer of a decompression context holds at
+ * least @p size bytes.
+ *
+ * @param[in,out] ctx Decompression context.
+ * @param[in] size Bytes needed (padding included).
+ * @return 0 on success, -1 if a caller-sized scratch buffer is too small or
+ * the allocation fails.
+ */
+static int zxc_dctx_scratch(zxc_cctx_t* ctx, size_t size) {
+    if (LIKELY(ctx->lit_buffer_cap >= size)) return 0;
+    if (UNLIKELY(ctx->fixed_scratch)) return -1;  // Caller-sized scratch: block too large
+    uint8_t* new_buf = (uint8_t*)realloc(ctx->lit_buffer, size);
+    if (UNLIKELY(!new_buf)) {
+        free(ctx->lit_buffer);
+        ctx->lit_buffer = NULL;
+        ctx->lit_buffer_cap = 0;
+        return -1;
+    }
+    ctx->lit_buffer = new_buf;
+    ctx->lit_buffer_cap = size;
+    return 0;
+}
+
+/**
+ * @brief Tells whether raw literals must be copied to the scratch buffer
+ * before being decoded.
+ *
+ * Literal wild copies read up to ZXC_PAD_SIZE bytes past the last literal.
+ * The sections that follow the literals normally absorb that, but a block
+ * whose literals end closer than that to its end may sit at the very end of
+ * the input (an exact-size buffer, or a frame decoded in place).
+ *
+ * @param[in] lit Start of the raw literals.
+ * @param[in] lit_size Size of the raw literals.
+ * @param[in] src_end End of the block.
+ * @return 1 if the literals must be read from a padded copy, 0 otherwise.
+ */
+static int zxc_literals_need_copy(const uint8_t* lit, size_t lit_size, const uint8_t* src_end) {
+    const size_t left = (size_t)(src_end - lit);
+    return lit_size <= left && left - lit_size < ZXC_PAD_SIZE;
+}
+
 /**
  * @brief Decompresses a "GLO" (General) encoded block of data.
  *
@@ -477,13 +1137,15 @@ static int zxc_decode_block_num(const uint8_t* RESTRICT src, size_t src_size, ui
  * @param[in] dst_capacity Maximum capacity of the destination buffer.
  * @param[in] expected_raw_size The expected size of the decompressed data (used for
  * validation and trailing literals).
+ * @param[in] hist Number of valid history bytes right before dst (linked block
+ * decoded after its predecessor); offsets may reach into them.
  *
  * @return The number of bytes written to the destination buffer on success, or
  * -1 on failure (e.g., invalid header, buffer overflow, or corrupted data).
  */
 static int zxc_decode_block_glo(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, size_t src_size,
                                 uint8_t* RESTRICT dst, size_t dst_capacity,
-                                uint32_t expected_raw_size) {
+                                uint32_t expected_raw_size, size_t hist) {
     zxc_gnr_header_t gh;
     zxc_section_desc_t desc[ZXC_GLO_SECTIONS];
 
@@ -501,24 +1163,36 @@ static int zxc_decode_block_glo(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
 
     size_t lit_stream_size = (size_t)(desc[0].sizes & ZXC_SECTION_SIZE_MASK);
 
-    if (gh.enc_lit == 1) {
-        size_t required_size = (size_t)(desc[0].sizes >> 32);
+    // Entropy-coded sections are decoded into the scratch buffer:
+    // [literals + pad][tokens + pad].
+    size_t scratch_lit = 0;
+    size_t scratch_tok = 0;
+    if (gh.enc_lit == ZXC_SECTION_ENCODING_RLE || gh.enc_lit == ZXC_SECTION_ENCODING_FSE)
+        scratch_lit = (size_t)(desc[0].sizes >> 32);
+    if (gh.enc_litlen == ZXC_SECTION_ENCODING_FSE) scratch_tok = (size_t)(desc[1].sizes >> 32);
+    if (UNLIKELY(gh.enc_lit > ZXC_SECTION_ENCODING_RLE && gh.enc_lit != ZXC_SECTION_ENCODING_FSE))
+        return -1;
+    // Raw literals at the end of the block are read from the scratch buffer.
+    const int lit_copy = gh.enc_lit == ZXC_SECTION_ENCODING_RAW &&
+                         zxc_literals_need_copy(p_curr, lit_stream_size, src + src_size);
+    if (lit_copy) scratch_lit = lit_stream_size;
+    if (UNLIKELY(scratch_lit > dst_capacity || scratch_tok > dst_capacity)) return -1;
+
+    size_t scratch_size = scratch_lit + scratch_tok + 2 * ZXC_PAD_SIZE;
+    if ((scratch_lit | scratch_tok | (size_t)lit_copy) &&
+        UNLIKELY(zxc_dctx_scratch(ctx, scratch_size) != 0))
+        return -1;
+
+    if (gh.enc_lit == ZXC_SECTION_ENCODING_FSE) {
+        if (UNLIKELY(lit_stream_size > (size_t)(src + src_size - p_curr) ||
+                     zxc_fse_decode(p_curr, lit_stream_size, ctx->lit_buffer, scratch_lit) != 0))
+            return -1;
+        l_ptr = ctx->lit_buffer;
+        l_end = ctx->lit_buffer + scratch_lit;
+    } else if (gh.enc_lit == ZXC_SECTION_ENCODING_RLE) {
+        size_t required_size = scratch_lit;
 
         if (required_size > 0) {
-            if (UNLIKELY(required_size > dst_capacity)) return -1;
-
-            if (ctx->lit_buffer_cap < required_size + ZXC_PAD_SIZE) {
-                uint8_t* new_buf = (uint8_t*)realloc(ctx->lit_buffer, required_size + ZXC_PAD_SIZE);
-                if (UNLIKELY(!new_buf)) {
-                    free(ctx->lit_buffer);
-                    ctx->lit_buffer = NULL;
-                    ctx->lit_buffer_cap = 0;
-                    return -1;
-                }
-                ctx->lit_buffer = new_buf;
-                ctx->lit_buffer_cap = required_size + ZXC_PAD_SIZE;
-            }
-
             rle_buf = ctx->lit_buffer;
             if (UNLIKELY(!rle_buf || lit_stream_size > (size_t)(src + src_size - p_curr)))
                 return -1;
@@ -579,6 +1253,10 @@ static int zxc_decode_block_glo(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
             l_ptr = p_curr;
             l_end = p_curr;
         }
+    } else if (lit_copy) {
+        ZXC_MEMCPY(ctx->lit_buffer, p_curr, lit_stream_size);
+        l_ptr = ctx->lit_buffer;
+        l_end = ctx->lit_buffer + lit_stream_size;
     } else {
         l_ptr = p_curr;
         l_end = p_curr + lit_stream_size;
@@ -595,10 +1273,19 @@ static int zxc_decode_block_glo(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
     size_t expected_off_size =
         (gh.enc_off == 1) ? (size_t)gh.n_sequences : (size_t)gh.n_sequences * 2;
 
-    if (UNLIKELY(sz_tokens < gh.n_sequences || sz_offsets < expected_off_size)) return -1;
+    if (UNLIKELY(sz_offsets < expected_off_size)) return -1;
 
     const uint8_t* t_ptr = p_curr;
-    const uint8_t* o_ptr = t_ptr + sz_tokens;
+    const uint8_t* o_ptr = p_curr + sz_tokens;
+    if (gh.enc_litlen == ZXC_SECTION_ENCODING_FSE) {
+        if (UNLIKELY(scratch_tok < gh.n_sequences || sz_tokens > (size_t)(src + src_size - p_curr)))
+            return -1;
+        uint8_t* tok_buf = ctx->lit_buffer + scratch_lit + ZXC_PAD_SIZE;
+        if (UNLIKELY(zxc_fse_decode(p_curr, sz_tokens, tok_buf, scratch_tok) != 0)) return -1;
+        t_ptr = tok_buf;
+    } else if (UNLIKELY(gh.enc_litlen != ZXC_SECTION_ENCODING_RAW || sz_tokens < gh.n_sequences)) {
+        return -1;
+    }
     const uint8_t* e_ptr = o_ptr + sz_offsets;
     const uint8_t* const e_end = e_ptr + sz_extras;  // For vbyte overflow detection
 
@@ -615,7 +1302,8 @@ static int zxc_decode_block_glo(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
     // For 1-byte offsets (enc_off==1): validate until 256 bytes written (max 8-bit offset)
     // For 2-byte offsets (enc_off==0): validate until 65536 bytes written (max 16-bit offset)
     // After threshold, all offsets are guaranteed valid (can't exceed written bytes)
-    size_t written = 0;
+    // Contiguous history counts as written: references into it are plain copies.
+    size_t written = hist;
 
 // Macro for copy literal + match (uses 32-byte wild copies)
 // SAFE version: validates offset against written bytes
@@ -642,7 +1330,13 @@ static int zxc_decode_block_glo(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
             written += ll;                                               \
         }                                                                \
         {                                                                \
-            if (UNLIKELY(off > written)) return -1;                      \
+            if (UNLIKELY(off > written)) {                               \
+                if (zxc_copy_dict_match(ctx, d_ptr, written, off, ml))   \
+                    return -1;                                           \
+                d_ptr += ml;                                             \
+                written += ml;                                           \
+                break;                                                   \
+            }                                                            \
             const uint8_t* match_src = d_ptr - off;                      \
             if (LIKELY(off >= ZXC_PAD_SIZE)) {                           \
                 zxc_copy32(d_ptr, match_src);                            \
@@ -766,6 +1460,9 @@ static int zxc_decode_block_glo(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
     size_t bounds_threshold = (gh.enc_off == 1) ? (1U << 8) : (1U << 16);
 
     while (n_seq >= 4 && d_ptr < d_end_safe && written < bounds_threshold) {
+        const uint8_t* t_save = t_ptr;
+        const uint8_t* o_save = o_ptr;
+        const uint8_t* e_save = e_ptr;
         uint32_t tokens = zxc_le32(t_ptr);
         t_ptr += 4;
 
@@ -796,31 +1493,38 @@ static int zxc_decode_block_glo(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
         if (UNLIKELY(ll1 == ZXC_TOKEN_LL_MASK)) ll1 += zxc_read_vbyte(&e_ptr, e_end);
         if (UNLIKELY(ml1 == ZXC_TOKEN_ML_MASK)) ml1 += zxc_read_vbyte(&e_ptr, e_end);
         ml1 += ZXC_LZ_MIN_MATCH_LEN;
-        if (UNLIKELY(d_ptr + ll1 + ml1 > d_end)) return -1;
-        DECODE_SEQ_SAFE(ll1, ml1, off1);
 
         uint32_t ll2 = (tokens & 0x0F000) >> 12;
         uint32_t ml2 = (tokens & 0x00F00) >> 8;
         if (UNLIKELY(ll2 == ZXC_TOKEN_LL_MASK)) ll2 += zxc_read_vbyte(&e_ptr, e_end);
         if (UNLIKELY(ml2 == ZXC_TOKEN_ML_MASK)) ml2 += zxc_read_vbyte(&e_ptr, e_end);
         ml2 += ZXC_LZ_MIN_MATCH_LEN;
-        if (UNLIKELY(d_ptr + ll2 + ml2 > d_end)) return -1;
-        DECODE_SEQ_SAFE(ll2, ml2, off2);
 
         uint32_t ll3 = (tokens & 0x0F00000) >> 20;
         uint32_t ml3 = (tokens & 0x00F0000) >> 16;
         if (UNLIKELY(ll3 == ZXC_TOKEN_LL_MASK)) ll3 += zxc_read_vbyte(&e_ptr, e_end);
         if (UNLIKELY(ml3 == ZXC_TOKEN_ML_MASK)) ml3 += zxc_read_vbyte(&e_ptr, e_end);
         ml3 += ZXC_LZ_MIN_MATCH_LEN;
-        if (UNLIKELY(d_ptr + ll3 + ml3 > d_end)) return -1;
-        DECODE_SEQ_SAFE(ll3, ml3, off3);
 
         uint32_t ll4 = (tokens >> 28);
         uint32_t ml4 = (tokens >> 24) & 0x0F;
         if (UNLIKELY(ll4 == ZXC_TOKEN_LL_MASK)) ll4 += zxc_read_vbyte(&e_ptr, e_end);
         if (UNLIKELY(ml4 == ZXC_TOKEN_ML_MASK)) ml4 += zxc_read_vbyte(&e_ptr, e_end);
         ml4 += ZXC_LZ_MIN_MATCH_LEN;
-        if (UNLIKELY(d_ptr + ll4 + ml4 > d_end)) return -1;
+
+        // Wild copies run up to ZXC_PAD_SIZE bytes past each sequence: a group that
+        // ends too close to d_end is left to the exact tail loops below.
+        if (UNLIKELY((size_t)(d_end - d_ptr) < (size_t)ll1 + ml1 + ll2 + ml2 + ll3 + ml3 + ll4 +
+                                                    ml4 + ZXC_PAD_SIZE)) {
+            t_ptr = t_save;
+            o_ptr = o_save;
+            e_ptr = e_save;
+            break;
+        }
+
+        DECODE_SEQ_SAFE(ll1, ml1, off1);
+        DECODE_SEQ_SAFE(ll2, ml2, off2);
+        DECODE_SEQ_SAFE(ll3, ml3, off3);
         DECODE_SEQ_SAFE(ll4, ml4, off4);
 
         n_seq -= 4;
@@ -828,6 +1532,9 @@ static int zxc_decode_block_glo(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
 
     // --- FAST Loop: After threshold, no offset validation needed (4x unroll) ---
     while (n_seq >= 4 && d_ptr < d_end_safe) {
+        const uint8_t* t_save = t_ptr;
+        const uint8_t* o_save = o_ptr;
+        const uint8_t* e_save = e_ptr;
         uint32_t tokens = zxc_le32(t_ptr);
         t_ptr += 4;
 
@@ -855,31 +1562,38 @@ static int zxc_decode_block_glo(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
         if (UNLIKELY(ll1 == ZXC_TOKEN_LL_MASK)) ll1 += zxc_read_vbyte(&e_ptr, e_end);
         if (UNLIKELY(ml1 == ZXC_TOKEN_ML_MASK)) ml1 += zxc_read_vbyte(&e_ptr, e_end);
         ml1 += ZXC_LZ_MIN_MATCH_LEN;
-        if (UNLIKELY(d_ptr + ll1 + ml1 > d_end)) return -1;
-        DECODE_SEQ_FAST(ll1, ml1, off1);
 
         uint32_t ll2 = (tokens & 0x0F000) >> 12;
         uint32_t ml2 = (tokens & 0x00F00) >> 8;
         if (UNLIKELY(ll2 == ZXC_TOKEN_LL_MASK)) ll2 += zxc_read_vbyte(&e_ptr, e_end);
         if (UNLIKELY(ml2 == ZXC_TOKEN_ML_MASK)) ml2 += zxc_read_vbyte(&e_ptr, e_end);
         ml2 += ZXC_LZ_MIN_MATCH_LEN;
-        if (UNLIKELY(d_ptr + ll2 + ml2 > d_end)) return -1;
-        DECODE_SEQ_FAST(ll2, ml2, off2);
 
         uint32_t ll3 = (tokens & 0x0F00000) >> 20;
         uint32_t ml3 = (tokens & 0x00F0000) >> 16;
         if (UNLIKELY(ll3 == ZXC_TOKEN_LL_MASK)) ll3 += zxc_read_vbyte(&e_ptr, e_end);
         if (UNLIKELY(ml3 == ZXC_TOKEN_ML_MASK)) ml3 += zxc_read_vbyte(&e_ptr, e_end);
         ml3 += ZXC_LZ_MIN_MATCH_LEN;
-        if (UNLIKELY(d_ptr + ll3 + ml3 > d_end)) return -1;
-        DECODE_SEQ_FAST(ll3, ml3, off3);
 
         uint32_t ll4 = (tokens >> 28);
         uint32_t ml4 = (tokens >> 24) & 0x0F;
         if (UNLIKELY(ll4 == ZXC_TOKEN_LL_MASK)) ll4 += zxc_read_vbyte(&e_ptr, e_end);
         if (UNLIKELY(ml4 == ZXC_TOKEN_ML_MASK)) ml4 += zxc_read_vbyte(&e_ptr, e_end);
         ml4 += ZXC_LZ_MIN_MATCH_LEN;
-        if (UNLIKELY(d_ptr + ll4 + ml4 > d_end)) return -1;
+
+        // Wild copies run up to ZXC_PAD_SIZE bytes past each sequence: a group that
+        // ends too close to d_end is left to the exact tail loops below.
+        if (UNLIKELY((size_t)(d_end - d_ptr) < (size_t)ll1 + ml1 + ll2 + ml2 + ll3 + ml3 + ll4 +
+                                                    ml4 + ZXC_PAD_SIZE)) {
+            t_ptr = t_save;
+            o_ptr = o_save;
+            e_ptr = e_save;
+            break;
+        }
+
+        DECODE_SEQ_FAST(ll1, ml1, off1);
+        DECODE_SEQ_FAST(ll2, ml2, off2);
+        DECODE_SEQ_FAST(ll3, ml3, off3);
         DECODE_SEQ_FAST(ll4, ml4, off4);
 
         n_seq -= 4;
@@ -945,8 +1659,14 @@ static int zxc_decode_block_glo(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
 
         {
             // Skip check if written >= bounds_threshold (256 for 8-bit, 65536 for 16-bit)
-            if (UNLIKELY(written < bounds_threshold && (offset == 0 || offset > written)))
-                return -1;
+            if (UNLIKELY(written < bounds_threshold && (offset == 0 || offset > written))) {
+                if (offset == 0 || zxc_copy_dict_match(ctx, d_ptr, written, offset, ml))
+                    return -1;
+                d_ptr += ml;
+                written += ml;
+                n_seq--;
+                continue;
+            }
 
             const uint8_t* match_src = d_ptr - offset;
             if (LIKELY(offset >= ZXC_PAD_SIZE)) {
@@ -1000,8 +1720,15 @@ static int zxc_decode_block_glo(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
         l_ptr += ll;
         d_ptr += ll;
 
+        if (UNLIKELY(d_ptr + ml > d_end)) return -1;
+        if (UNLIKELY(offset > (size_t)(d_ptr - dst) + hist)) {
+            if (zxc_copy_dict_match(ctx, d_ptr, (size_t)(d_ptr - dst) + hist, offset, ml))
+                return -1;
+            d_ptr += ml;
+            n_seq--;
+            continue;
+        }
         const uint8_t* match_src = d_ptr - offset;
-        if (UNLIKELY(match_src < dst || d_ptr + ml > d_end)) return -1;
 
         if (offset < ml) {
             for (size_t i = 0; i < ml; i++) d_ptr[i] = match_src[i];
@@ -1033,18 +1760,19 @@ static int zxc_decode_block_glo(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
  * This function handles the decoding of a compressed block formatted with the
  * internal GHI structure.
  *
- * @param[in] ctx Pointer to the decompression context (unused in current implementation).
+ * @param[in] ctx Pointer to the decompression context (provides the attached dictionary).
  * @param[in] src Pointer to the source buffer containing compressed data.
  * @param[in] src_size Size of the source buffer in bytes.
  * @param[out] dst Pointer to the destination buffer for decompressed data.
  * @param[in] dst_capacity Capacity of the destination buffer in bytes.
  * @param[in] expected_raw_size Expected size of the decompressed data in bytes.
+ * @param[in] hist Number of valid history bytes right before dst (see
+ * zxc_decode_block_glo()).
  * @return int Returns 0 on success, or a negative error code on failure.
  */
 static int zxc_decode_block_ghi(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, size_t src_size,
                                 uint8_t* RESTRICT dst, size_t dst_capacity,
-                                uint32_t expected_raw_size) {
-    (void)ctx;
+                                uint32_t expected_raw_size, size_t hist) {
     zxc_gnr_header_t gh;
     zxc_section_desc_t desc[ZXC_GHI_SECTIONS];
 
@@ -1069,6 +1797,14 @@ static int zxc_decode_block_ghi(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
     // Validate streams don't overflow source buffer
     if (UNLIKELY(extras_end != src + src_size)) return -1;
 
+    // Literals at the end of the block are read from the scratch buffer.
+    if (zxc_literals_need_copy(l_ptr, sz_lit, src + src_size)) {
+        if (UNLIKELY(zxc_dctx_scratch(ctx, sz_lit + ZXC_PAD_SIZE) != 0)) return -1;
+        ZXC_MEMCPY(ctx->lit_buffer, l_ptr, sz_lit);
+        l_ptr = ctx->lit_buffer;
+        l_end = ctx->lit_buffer + sz_lit;
+    }
+
     uint8_t* d_ptr = dst;
     const uint8_t* const d_end = dst + dst_capacity;
     const uint8_t* const d_end_safe = d_end - (ZXC_PAD_SIZE * 4);  // 128
@@ -1082,7 +1818,8 @@ static int zxc_decode_block_ghi(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
     // For 1-byte offsets (enc_off==1): validate until 256 bytes written (max 8-bit offset)
     // For 2-byte offsets (enc_off==0): validate until 65536 bytes written (max 16-bit offset)
     // After threshold, all offsets are guaranteed valid (can't exceed written bytes)
-    size_t written = 0;
+    // Contiguous history counts as written: references into it are plain copies.
+    size_t written = hist;
 
 // Macro for copy literal + match (uses 32-byte wild copies)
 // SAFE version: validates offset against written bytes
@@ -1109,7 +1846,13 @@ static int zxc_decode_block_ghi(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
             written += ll;                                               \
         }                                                                \
         {                                                                \
-            if (UNLIKELY(off > written)) return -1;                      \
+            if (UNLIKELY(off > written)) {                               \
+                if (zxc_copy_dict_match(ctx, d_ptr, written, off, ml))   \
+                    return -1;                                           \
+                d_ptr += ml;                                             \
+                written += ml;                                           \
+                break;                                                   \
+            }                                                            \
             const uint8_t* match_src = d_ptr - off;                      \
             if (LIKELY(off >= ZXC_PAD_SIZE)) {                           \
                 zxc_copy32(d_ptr, match_src);                            \
@@ -1255,14 +1998,14 @@ static int zxc_decode_block_ghi(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
             d_ptr += ll;
             written += ll;
 
-            if (UNLIKELY(offset == 0 || offset > written)) return -1;
-            const uint8_t* match_src = d_ptr - offset;
-            if (UNLIKELY(match_src < dst || d_ptr + ml > d_end)) return -1;  // Bounds check
-
-            if (offset < ml) {
+            if (UNLIKELY(offset == 0 || d_ptr + ml > d_end)) return -1;  // Bounds check
+            if (UNLIKELY(offset > written)) {
+                if (zxc_copy_dict_match(ctx, d_ptr, written, offset, ml)) return -1;
+            } else if (offset < ml) {
+                const uint8_t* match_src = d_ptr - offset;
                 for (size_t i = 0; i < ml; i++) d_ptr[i] = match_src[i];
             } else {
-                ZXC_MEMCPY(d_ptr, match_src, ml);
+                ZXC_MEMCPY(d_ptr, d_ptr - offset, ml);
             }
             d_ptr += ml;
             written += ml;
@@ -1276,6 +2019,8 @@ static int zxc_decode_block_ghi(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
 
     // --- FAST Loop: After threshold, check large margin to avoid individual bounds checks ---
     while (n_seq >= 4 && d_ptr < d_end_fast) {
+        const uint8_t* seq_save = seq_ptr;
+        const uint8_t* extras_save = extras_ptr;
         uint32_t s1 = zxc_le32(seq_ptr);
         uint32_t s2 = zxc_le32(seq_ptr + 4);
         uint32_t s3 = zxc_le32(seq_ptr + 8);
@@ -1283,63 +2028,46 @@ static int zxc_decode_block_ghi(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
         seq_ptr += 16;
 
         uint32_t ll1 = (uint32_t)(s1 >> 24);
-        if (UNLIKELY(ll1 == ZXC_SEQ_LL_MASK)) {
-            ll1 += zxc_read_vbyte(&extras_ptr, extras_end);
-            if (UNLIKELY(d_ptr + ll1 > d_end)) return -1;
-        }
+        if (UNLIKELY(ll1 == ZXC_SEQ_LL_MASK)) ll1 += zxc_read_vbyte(&extras_ptr, extras_end);
         uint32_t m1b = (uint32_t)((s1 >> 16) & 0xFF);
         uint32_t ml1 = m1b + ZXC_LZ_MIN_MATCH_LEN;
-        if (UNLIKELY(m1b == ZXC_SEQ_ML_MASK)) {
-            ml1 += zxc_read_vbyte(&extras_ptr, extras_end);
-            if (UNLIKELY(d_ptr + ll1 + ml1 > d_end)) return -1;
-        }
+        if (UNLIKELY(m1b == ZXC_SEQ_ML_MASK)) ml1 += zxc_read_vbyte(&extras_ptr, extras_end);
         uint32_t of1 = (uint32_t)(s1 & 0xFFFF);
-        if (UNLIKELY(l_ptr + ll1 > l_end || d_ptr + ll1 + ml1 > d_end)) return -1;
-        DECODE_SEQ_FAST(ll1, ml1, of1);
 
         uint32_t ll2 = (uint32_t)(s2 >> 24);
-        if (UNLIKELY(ll2 == ZXC_SEQ_LL_MASK)) {
-            ll2 += zxc_read_vbyte(&extras_ptr, extras_end);
-            if (UNLIKELY(d_ptr + ll2 > d_end)) return -1;
-        }
+        if (UNLIKELY(ll2 == ZXC_SEQ_LL_MASK)) ll2 += zxc_read_vbyte(&extras_ptr, extras_end);
         uint32_t m2b = (uint32_t)((s2 >> 16) & 0xFF);
         uint32_t ml2 = m2b + ZXC_LZ_MIN_MATCH_LEN;
-        if (UNLIKELY(m2b == ZXC_SEQ_ML_MASK)) {
-            ml2 += zxc_read_vbyte(&extras_ptr, extras_end);
-            if (UNLIKELY(d_ptr + ll2 + ml2 > d_end)) return -1;
-        }
+        if (UNLIKELY(m2b == ZXC_SEQ_ML_MASK)) ml2 += zxc_read_vbyte(&extras_ptr, extras_end);
         uint32_t of2 = (uint32_t)(s2 & 0xFFFF);
-        if (UNLIKELY(l_ptr + ll2 > l_end || d_ptr + ll2 + ml2 > d_end)) return -1;
-        DECODE_SEQ_FAST(ll2, ml2, of2);
 
         uint32_t ll3 = (uint32_t)(s3 >> 24);
-        if (UNLIKELY(ll3 == ZXC_SEQ_LL_MASK)) {
-            ll3 += zxc_read_vbyte(&extras_ptr, extras_end);
-            if (UNLIKELY(d_ptr + ll3 > d_end)) return -1;
-        }
+        if (UNLIKELY(ll3 == ZXC_SEQ_LL_MASK)) ll3 += zxc_read_vbyte(&extras_ptr, extras_end);
         uint32_t m3b = (uint32_t)((s3 >> 16) & 0xFF);
         uint32_t ml3 = m3b + ZXC_LZ_MIN_MATCH_LEN;
-        if (UNLIKELY(m3b == ZXC_SEQ_ML_MASK)) {
-            ml3 += zxc_read_vbyte(&extras_ptr, extras_end);
-            if (UNLIKELY(d_ptr + ll3 + ml3 > d_end)) return -1;
-        }
+        if (UNLIKELY(m3b == ZXC_SEQ_ML_MASK)) ml3 += zxc_read_vbyte(&extras_ptr, extras_end);
         uint32_t of3 = (uint32_t)(s3 & 0xFFFF);
-        if (UNLIKELY(l_ptr + ll3 > l_end || d_ptr + ll3 + ml3 > d_end)) return -1;
-        DECODE_SEQ_FAST(ll3, ml3, of3);
 
         uint32_t ll4 = (uint32_t)(s4 >> 24);
-        if (UNLIKELY(ll4 == ZXC_SEQ_LL_MASK)) {
-            ll4 += zxc_read_vbyte(&extras_ptr, extras_end);
-            if (UNLIKELY(d_ptr + ll4 > d_end)) return -1;
-        }
+        if (UNLIKELY(ll4 == ZXC_SEQ_LL_MASK)) ll4 += zxc_read_vbyte(&extras_ptr, extras_end);
         uint32_t m4b = (uint32_t)((s4 >> 16) & 0xFF);
         uint32_t ml4 = m4b + ZXC_LZ_MIN_MATCH_LEN;
-        if (UNLIKELY(m4b == ZXC_SEQ_ML_MASK)) {
-            ml4 += zxc_read_vbyte(&extras_ptr, extras_end);
-            if (UNLIKELY(d_ptr + ll4 + ml4 > d_end)) return -1;
-        }
+        if (UNLIKELY(m4b == ZXC_SEQ_ML_MASK)) ml4 += zxc_read_vbyte(&extras_ptr, extras_end);
         uint32_t of4 = (uint32_t)(s4 & 0xFFFF);
-        if (UNLIKELY(l_ptr + ll4 > l_end || d_ptr + ll4 + ml4 > d_end)) return -1;
+
+        // Same overshoot rule as in the GLO decoder: hand a group that ends too
+        // close to d_end (or runs out of literals) to the exact tail loops.
+        size_t n_lit = (size_t)ll1 + ll2 + ll3 + ll4;
+        if (UNLIKELY((size_t)(l_end - l_ptr) < n_lit ||
+                     (size_t)(d_end - d_ptr) < n_lit + ml1 + ml2 + ml3 + ml4 + ZXC_PAD_SIZE)) {
+            seq_ptr = seq_save;
+            extras_ptr = extras_save;
+            break;
+        }
+
+        DECODE_SEQ_FAST(ll1, ml1, of1);
+        DECODE_SEQ_FAST(ll2, ml2, of2);
+        DECODE_SEQ_FAST(ll3, ml3, of3);
         DECODE_SEQ_FAST(ll4, ml4, of4);
 
         n_seq -= 4;
@@ -1396,8 +2124,14 @@ static int zxc_decode_block_ghi(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
 
         {
             // Skip check if written >= bounds_threshold (256 for 8-bit, 65536 for 16-bit)
-            if (UNLIKELY(written < bounds_threshold && (offset == 0 || offset > written)))
-                return -1;
+            if (UNLIKELY(written < bounds_threshold && (offset == 0 || offset > written))) {
+                if (offset == 0 || zxc_copy_dict_match(ctx, d_ptr, written, offset, ml))
+                    return -1;
+                d_ptr += ml;
+                written += ml;
+                n_seq--;
+                continue;
+            }
 
             const uint8_t* match_src = d_ptr - offset;
             if (LIKELY(offset >= ZXC_PAD_SIZE)) {
@@ -1447,8 +2181,15 @@ static int zxc_decode_block_ghi(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
         l_ptr += ll;
         d_ptr += ll;
 
+        if (UNLIKELY(offset == 0 || d_ptr + ml > d_end)) return -1;
+        if (UNLIKELY(offset > (size_t)(d_ptr - dst) + hist)) {
+            if (zxc_copy_dict_match(ctx, d_ptr, (size_t)(d_ptr - dst) + hist, offset, ml))
+                return -1;
+            d_ptr += ml;
+            n_seq--;
+            continue;
+        }
         const uint8_t* match_src = d_ptr - offset;
-        if (UNLIKELY(offset == 0 || match_src < dst || d_ptr + ml > d_end)) return -1;
 
         if (offset < ml) {
             for (size_t i = 0; i < ml; i++) d_ptr[i] = match_src[i];
@@ -1474,6 +2215,82 @@ static int zxc_decode_block_ghi(zxc_cctx_t* ctx, const uint8_t* RESTRICT src, si
     return (int)(d_ptr - dst);
 }
 
+/**
+ * @brief Reverses zxc_shuffle(): scatters the byte planes back into elements.
+ *
+ * `dst[i * elem + k] = src[k * n + i]` with `n = size / elem`; the trailing
+ * bytes past the last whole element are copied unchanged.
+ *
+ * @param[in] src Shuffled data.
+ * @param[in] size Size of the data in bytes.
+ * @param[in] elem Element size in bytes (>= 2).
+ * @param[out] dst Destination, `size` bytes.
+ */
+static void zxc_unshuffle(const uint8_t* RESTRICT src, size_t size, size_t elem,
+                          uint8_t* RESTRICT dst) {
+    const size_t n = size / elem;
+    size_t i = 0;
+#if defined(ZXC_USE_AVX2) || defined(ZXC_USE_AVX512)
+    if (elem == 2) {
+        for (; i + 16 <= n; i += 16) {
+            __m128i p0 = _mm_loadu_si128((const __m128i*)(src + i));
+            __m128i p1 = _mm_loadu_si128((const __m128i*)(src + n + i));
+            _mm_storeu_si128((__m128i*)(dst + i * 2), _mm_unpacklo_epi8(p0, p1));
+            _mm_storeu_si128((__m128i*)(dst + i * 2 + 16), _mm_unpackhi_epi8(p0, p1));
+        }
+    } else if (elem == 4) {
+        const __m128i m = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+        for (; i + 16 <= n; i += 16) {
+            __m128i r[4];
+            for (int k = 0; k < 4; k++) r[k] = _mm_loadu_si128((const __m128i*)(src + k * n + i));
+            zxc_transpose_4x4_epi32(r);
+            for (int k = 0; k < 4; k++)
+                _mm_storeu_si128((__m128i*)(dst + i * 4 + k * 16), _mm_shuffle_epi8(r[k], m));
+        }
+    } else if (elem == 8) {
+        const __m128i m = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+        for (; i + 16 <= n; i += 16) {
+            __m128i r[8];
+            for (int k = 0; k < 8; k++) r[k] = _mm_loadu_si128((const __m128i*)(src + k * n + i));
+            zxc_transpose_8x8_epi16(r);
+            for (int k = 0; k < 8; k++)
+                _mm_storeu_si128((__m128i*)(dst + i * 8 + k * 16), _mm_shuffle_epi8(r[k], m));
+        }
+    }
+#elif defined(ZXC_USE_NEON64) || defined(ZXC_USE_NEON32)
+    if (elem == 2) {
+        for (; i + 16 <= n; i += 16) {
+            uint8x16x2_t v = {{vld1q_u8(src + i), vld1q_u8(src + n + i)}};
+            vst2q_u8(dst + i * 2, v);
+        }
+    } else if (elem == 4) {
+        for (; i + 16 <= n; i += 16) {
+            uint8x16x4_t v;
+            for (int k = 0; k < 4; k++) v.val[k] = vld1q_u8(src + k * n + i);
+            vst4q_u8(dst + i * 4, v);
+        }
+    } else if (elem == 8) {
+        for (; i + 16 <= n; i += 16) {
+            // Re-pair the planes, then interleave the pairs of 8 + 8 elements.
+            uint16x8x4_t a, b;
+            for (int k = 0; k < 4; k++) {
+                uint8x16x2_t p =
+                    vzipq_u8(vld1q_u8(src + (2 * k) * n + i), vld1q_u8(src + (2 * k + 1) * n + i));
+                a.val[k] = vreinterpretq_u16_u8(p.val[0]);
+                b.val[k] = vreinterpretq_u16_u8(p.val[1]);
+            }
+            vst4q_u16((uint16_t*)(void*)(dst + i * 8), a);
+            vst4q_u16((uint16_t*)(void*)(dst + i * 8 + 64), b);
+        }
+    }
+#endif
+    for (size_t k = 0; k < elem; k++) {
+        const uint8_t* RESTRICT plane = src + k * n;
+        for (size_t j = i; j < n; j++) dst[j * elem + k] = plane[j];
+    }
+    ZXC_MEMCPY(dst + n * elem, src + n * elem, size - n * elem);
+}
+
 // cppcheck-suppress unusedFunction
 int zxc_decompress_chunk_wrapper(zxc_cctx_t* ctx, const uint8_t* src, size_t src_sz, uint8_t* dst,
                                  size_t dst_cap) {
@@ -1492,13 +2309,48 @@ int zxc_decompress_chunk_wrapper(zxc_cctx_t* ctx, const uint8_t* src, size_t src
     const uint8_t* data = src + header_len;
     int decoded_sz = -1;
 
+    // Linked block: offsets past its start land in the previous block's tail.
+    // Decoded right after it (the usual case), that tail is simply the output
+    // in front of dst; otherwise the offsets are resolved like dictionary ones.
+    const struct zxc_dict_s* dict = ctx->dict;
+    size_t hist = 0;
+    if (flags & ZXC_BLOCK_FLAG_LINKED) {
+        if (UNLIKELY(!ctx->link || ctx->link->size == 0)) return -1;
+        if (ctx->link->content + ctx->link->size == dst) {
+            hist = ctx->link->size;
+            dict = NULL;
+        } else {
+            dict = ctx->link;
+        }
+    }
+
+    // Shuffled block: decoded into the scratch buffer, then unshuffled into dst.
+    size_t elem = 0;
+    uint8_t* out = dst;
+    size_t out_cap = dst_cap;
+    if (flags & ZXC_BLOCK_FLAG_SHUFFLED) {
+        elem = zxc_le16(src + 2);
+        if (UNLIKELY(elem < 2 || elem > ZXC_ELEM_SIZE_MAX || (flags & ZXC_BLOCK_FLAG_LINKED) ||
+                     (type != ZXC_BLOCK_GLO && type != ZXC_BLOCK_GHI) || raw_sz > dst_cap))
+            return -1;
+        out = zxc_cctx_shuffle_buf(ctx, raw_sz);
+        if (UNLIKELY(!out)) return -1;
+        out_cap = raw_sz;
+    }
+
     switch (type) {
         case ZXC_BLOCK_GLO:
-            decoded_sz = zxc_decode_block_glo(ctx, data, comp_sz, dst, dst_cap, raw_sz);
-            break;
-        case ZXC_BLOCK_GHI:
-            decoded_sz = zxc_decode_block_ghi(ctx, data, comp_sz, dst, dst_cap, raw_sz);
+        case ZXC_BLOCK_GHI: {
+            const struct zxc_dict_s* saved = ctx->dict;
+            ctx->dict = dict;
+            if (type == ZXC_BLOCK_GLO)
+                decoded_sz = zxc_decode_block_glo(ctx, data, comp_sz, out, out_cap, raw_sz, hist);
+            else
+                decoded_sz = zxc_decode_block_ghi(ctx, data, comp_sz, out, out_cap, raw_sz, hist);
+            ctx->dict = saved;
+            if (elem && decoded_sz >= 0) zxc_unshuffle(out, (size_t)decoded_sz, elem, dst);
             break;
+        }
         case ZXC_BLOCK_RAW:
             if (UNLIKELY(raw_sz > dst_cap || raw_sz > comp_sz)) return -1;
             ZXC_MEMCPY(dst, data, raw_sz);
@@ -1507,6 +2359,13 @@ int zxc_decompress_chunk_wrapper(zxc_cctx_t* ctx, const uint8_t* src, size_t src
         case ZXC_BLOCK_NUM:
             decoded_sz = zxc_decode_block_num(data, comp_sz, dst, dst_cap, raw_sz);
             break;
+        case ZXC_BLOCK_SEK:
+        case ZXC_BLOCK_DIG:
+        case ZXC_BLOCK_END:
+            // Seek table, frame digest or end of stream: handled by the frame drivers.
+            if (UNLIKELY(raw_sz != 0)) return -1;
+            decoded_sz = 0;
+            break;
         default:
             return -1;
     }
@@ -1514,10 +2373,40 @@ int zxc_decompress_chunk_wrapper(zxc_cctx_t* ctx, const uint8_t* src, size_t src
     if (decoded_sz >= 0 && has_crc && ctx->checksum_enabled) {
         uint8_t algo = flags & ZXC_CHECKSUM_TYPE_MASK;
         uint64_t stored = zxc_le64(src + ZXC_BLOCK_HEADER_SIZE);
+        const uint64_t t0 = ctx->timed ? zxc_perf_now() : 0;
         uint64_t calc = zxc_checksum(dst, (size_t)decoded_sz, algo);
+        if (ctx->timed) ctx->checksum_ns += zxc_perf_now() - t0;
 
         if (UNLIKELY(stored != calc)) return -1;
     }
 
+    if (LIKELY(decoded_sz >= 0)) {
+        const uint64_t block_sz = header_len + comp_sz;
+        switch (type) {
+            case ZXC_BLOCK_GLO:
+                ctx->stats.glo_blocks++;
+                ctx->stats.glo_bytes += (uint64_t)decoded_sz;
+                ctx->stats.glo_comp_bytes += block_sz;
+                break;
+            case ZXC_BLOCK_GHI:
+                ctx->stats.ghi_blocks++;
+                ctx->stats.ghi_bytes += (uint64_t)decoded_sz;
+                ctx->stats.ghi_comp_bytes += block_sz;
+                break;
+            case ZXC_BLOCK_RAW:
+                ctx->stats.raw_blocks++;
+                ctx->stats.raw_bytes += (uint64_t)decoded_sz;
+                ctx->stats.raw_comp_bytes += block_sz;
+                break;
+            case ZXC_BLOCK_NUM:
+                ctx->stats.num_blocks++;
+                ctx->stats.num_bytes += (uint64_t)decoded_sz;
+                ctx->stats.num_comp_bytes += block_sz;
+                break;
+            default:
+                break;
+        }
+    }
+
     return decoded_sz;
 }
@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2025-2026, Bertrand Lebonnois
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "../../include/zxc_buffer.h"
+#include "zxc_internal.h"
+
+/*
+ * ============================================================================
+ * PREPARED DICTIONARIES
+ * ============================================================================
+ * A dictionary is indexed once (hash heads + 16-bit chain deltas, the same
+ * layout as the per-block LZ77 tables) and then shared read-only by any number
+ * of contexts and threads.
+ */
+
+/**
+ * @brief Fills the (zeroed) hash and chain tables of @p dict from its content.
+ *
+ * Every position that has 4 readable bytes is indexed; position 0 marks an
+ * empty bucket and is left out.
+ */
+static void zxc_dict_index(zxc_dict* dict) {
+    for (uint32_t i = 1; i + 4 <= dict->size; i++) {
+        uint32_t h = zxc_hash_func(zxc_le32(dict->content + i), dict->hash_log);
+        uint32_t prev = dict->hash_table[h];
+        dict->chain_table[i] = prev ? (uint16_t)(i - prev) : 0;
+        dict->hash_table[h] = i;
+    }
+}
+
+// cppcheck-suppress unusedFunction
+zxc_dict* zxc_create_dict(const void* dict_buf, size_t dict_size) {
+    if (UNLIKELY(!dict_buf || dict_size == 0)) return NULL;
+
+    // Only the last ZXC_DICT_SIZE_MAX bytes are reachable from a block.
+    const uint8_t* content = (const uint8_t*)dict_buf;
+    if (dict_size > ZXC_DICT_SIZE_MAX) {
+        content += dict_size - ZXC_DICT_SIZE_MAX;
+        dict_size = ZXC_DICT_SIZE_MAX;
+    }
+
+    uint32_t hash_log = zxc_lz_hash_log(dict_size);
+    size_t sz_content = (dict_size + ZXC_PAD_SIZE + ZXC_ALIGNMENT_MASK) & ~ZXC_ALIGNMENT_MASK;
+    size_t sz_hash = ((size_t)1 << hash_log) * sizeof(uint32_t);
+    size_t sz_chain = dict_size * sizeof(uint16_t);
+
+    zxc_dict* dict = calloc(1, sizeof(zxc_dict));
+    if (UNLIKELY(!dict)) return NULL;
+    uint8_t* mem = calloc(1, sz_content + sz_hash + sz_chain);
+    if (UNLIKELY(!mem)) {
+        free(dict);
+        return NULL;
+    }
+
+    dict->memory_block = mem;
+    dict->content = mem;
+    dict->hash_table = (uint32_t*)(mem + sz_content);
+    dict->chain_table = (uint16_t*)(mem + sz_content + sz_hash);
+    dict->size = (uint32_t)dict_size;
+    dict->hash_log = hash_log;
+    ZXC_MEMCPY(dict->content, content, dict_size);
+
+    // Identifier: content hash, never 0 (0 means "no dictionary").
+    uint32_t id = (uint32_t)zxc_checksum(dict->content, dict_size, ZXC_CHECKSUM_RAPIDHASH);
+    dict->id = id ? id : 1;
+
+    zxc_dict_index(dict);
+    return dict;
+}
+
+// cppcheck-suppress unusedFunction
+void zxc_free_dict(zxc_dict* dict) {
+    if (!dict) return;
+    free(dict->memory_block);
+    free(dict);
+}
+
+// cppcheck-suppress unusedFunction
+uint32_t zxc_get_dict_id(const zxc_dict* dict) { return dict ? dict->id : 0; }
+
+// cppcheck-suppress unusedFunction
+uint32_t zxc_get_frame_dict_id(const void* src, size_t src_size) {
+    if (UNLIKELY(!src)) return 0;
+    zxc_file_header_t fh;
+    if (zxc_read_file_header((const uint8_t*)src, src_size, &fh) < 0) return 0;
+    return (fh.flags & ZXC_FILE_FLAG_DICT_ID) ? fh.dict_id : 0;
+}
+
+/*
+ * ============================================================================
+ * LINKED BLOCKS
+ * ============================================================================
+ * In linked mode the tail of the previous block plays the role of a
+ * dictionary. The context owns one zxc_dict_s whose content is a view into the
+ * caller's memory, so only the index is rebuilt per block (and only when
+ * compressing: the decoder needs nothing but the bytes).
+ */
+
+int zxc_cctx_link(zxc_cctx_t* ctx, const uint8_t* prev, size_t prev_len, int index) {
+    if (prev_len > ZXC_DICT_SIZE_MAX) {
+        prev += prev_len - ZXC_DICT_SIZE_MAX;
+        prev_len = ZXC_DICT_SIZE_MAX;
+    }
+    if (prev_len == 0) {
+        if (ctx->link) ctx->link->size = 0;
+        return 0;
+    }
+
+    uint32_t max_log = zxc_lz_hash_log(ZXC_DICT_SIZE_MAX);
+    if (!ctx->link) {
+        zxc_dict* link = calloc(1, sizeof(zxc_dict));
+        if (UNLIKELY(!link)) return -1;
+        ctx->link = link;
+    }
+    zxc_dict* link = ctx->link;
+    if (index && !link->memory_block) {
+        size_t sz_hash = ((size_t)1 << max_log) * sizeof(uint32_t);
+        uint8_t* mem = malloc(sz_hash + ZXC_DICT_SIZE_MAX * sizeof(uint16_t));
+        if (UNLIKELY(!mem)) return -1;
+        link->memory_block = mem;
+        link->hash_table = (uint32_t*)mem;
+        link->chain_table = (uint16_t*)(mem + sz_hash);
+    }
+
+    link->content = (uint8_t*)prev;  // Read-only: never written through
+    link->size = (uint32_t)prev_len;
+    link->hash_log = zxc_lz_hash_log(prev_len);
+    if (index) {
+        ZXC_MEMSET(link->hash_table, 0, ((size_t)1 << link->hash_log) * sizeof(uint32_t));
+        zxc_dict_index(link);
+    }
+    return 0;
+}
+
+/*
+ * ============================================================================
+ * DICTIONARY TRAINING
+ * ============================================================================
+ * Segment selection in the spirit of zstd's COVER: substrings are scored by the
+ * number of samples they occur in, the sample data is split into one epoch per
+ * output segment, and each epoch contributes its best scoring segment. Picked
+ * substrings stop scoring, so later segments cover new content.
+ */
+
+#define ZXC_TRAIN_KMER 8       // Length of the counted substrings
+#define ZXC_TRAIN_SEGMENT 64   // Length of the segments copied into the dictionary
+#define ZXC_TRAIN_HASH_LOG 18  // Substring frequency table size (log2)
+
+typedef struct {
+    size_t pos;      // Segment start in the concatenated samples
+    uint64_t score;  // Sum of the substring weights of the segment
+} zxc_train_segment_t;
+
+static ZXC_ALWAYS_INLINE uint32_t zxc_train_hash(const uint8_t* p) {
+    return (uint32_t)((zxc_le64(p) * 0x9E3779B97F4A7C15ULL) >> (64 - ZXC_TRAIN_HASH_LOG));
+}
+
+// Substrings seen in a single sample do not help: weight = samples containing it - 1.
+static ZXC_ALWAYS_INLINE uint64_t zxc_train_weight(const uint32_t* counts, const uint8_t* p) {
+    uint32_t c = counts[zxc_train_hash(p)];
+    return c > 1 ? c - 1 : 0;
+}
+
+static int zxc_train_cmp(const void* a, const void* b) {
+    const zxc_train_segment_t* x = (const zxc_train_segment_t*)a;
+    const zxc_train_segment_t* y = (const zxc_train_segment_t*)b;
+    if (x->score != y->score) return x->score < y->score ? -1 : 1;
+    return x->pos < y->pos ? -1 : (x->pos > y->pos);
+}
+
+// cppcheck-suppress unusedFunction
+size_t zxc_train_dictionary(void* dict_buf, size_t dict_capacity, const void* samples,
+                            const size_t* sample_sizes, size_t n_samples) {
+    if (UNLIKELY(!dict_buf || !samples || !sample_sizes || n_samples == 0 ||
+                 dict_capacity < ZXC_TRAIN_KMER))
+        return 0;
+
+    const uint8_t* src = (const uint8_t*)samples;
+    uint8_t* out = (uint8_t*)dict_buf;
+    size_t cap = dict_capacity < ZXC_DICT_SIZE_MAX ? dict_capacity : ZXC_DICT_SIZE_MAX;
+    size_t total = 0;
+    for (size_t i = 0; i < n_samples; i++) total += sample_sizes[i];
+    if (UNLIKELY(total == 0)) return 0;
+
+    // Everything fits: the samples themselves are the best dictionary.
+    if (total <= cap) {
+        ZXC_MEMCPY(out, src, total);
+        return total;
+    }
+
+    size_t seg_len = cap < ZXC_TRAIN_SEGMENT ? cap : ZXC_TRAIN_SEGMENT;
+    size_t n_epochs = cap / seg_len;
+    size_t epoch_len = total / n_epochs;
+    size_t span = seg_len - ZXC_TRAIN_KMER + 1;  // Substrings starting inside a segment
+
+    uint32_t* counts = calloc((size_t)1 << ZXC_TRAIN_HASH_LOG, sizeof(uint32_t));
+    uint32_t* last = calloc((size_t)1 << ZXC_TRAIN_HASH_LOG, sizeof(uint32_t));
+    zxc_train_segment_t* segs = malloc(n_epochs * sizeof(zxc_train_segment_t));
+    if (UNLIKELY(!counts || !last || !segs)) {
+        free(counts);
+        free(last);
+        free(segs);
+        return 0;
+    }
+
+    // 1. Count, for each substring, the number of samples containing it.
+    size_t base = 0;
+    for (size_t s = 0; s < n_samples; s++) {
+        const uint8_t* p = src + base;
+        for (size_t i = 0; i + ZXC_TRAIN_KMER <= sample_sizes[s]; i++) {
+            uint32_t h = zxc_train_hash(p + i);
+            if (last[h] != (uint32_t)(s + 1)) {
+                last[h] = (uint32_t)(s + 1);
+                counts[h]++;
+            }
+        }
+        base += sample_sizes[s];
+    }
+
+    // 2. Best segment of each epoch (sliding sum of substring weights).
+    size_t n_segs = 0;
+    for (size_t e = 0; e < n_epochs; e++) {
+        size_t lo = e * epoch_len;
+        size_t hi = (e + 1 == n_epochs) ? total : lo + epoch_len;
+        if (hi - lo < seg_len) continue;
+
+        uint64_t sum = 0;
+        for (size_t q = lo; q < lo + span; q++) sum += zxc_train_weight(counts, src + q);
+        uint64_t best = sum;
+        size_t best_pos = lo;
+        for (size_t p = lo + 1; p + seg_len <= hi; p++) {
+            sum += zxc_train_weight(counts, src + p + span - 1);
+            sum -= zxc_train_weight(counts, src + p - 1);
+            if (sum > best) {
+                best = sum;
+                best_pos = p;
+            }
+        }
+        if (best == 0) continue;
+
+        segs[n_segs].pos = best_pos;
+        segs[n_segs].score = best;
+        n_segs++;
+        for (size_t q = best_pos; q < best_pos + span; q++) counts[zxc_train_hash(src + q)] = 0;
+    }
+
+    // 3. Most useful segments last: they end up closest to the data (short offsets).
+    size_t size = 0;
+    if (n_segs > 0) {
+        qsort(segs, n_segs, sizeof(zxc_train_segment_t), zxc_train_cmp);
+        for (size_t i = 0; i < n_segs; i++) {
+            ZXC_MEMCPY(out + size, src + segs[i].pos, seg_len);
+            size += seg_len;
+        }
+    } else {
+        // Nothing repeats across samples: fall back to the most recent bytes.
+        ZXC_MEMCPY(out, src + total - cap, cap);
+        size = cap;
+    }
+
+    free(counts);
+    free(last);
+    free(segs);
+    return size;
+}
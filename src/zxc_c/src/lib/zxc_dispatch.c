@@ -6,6 +6,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include "../../include/zxc_buffer.h"
 #include "zxc_internal.h"
 #if defined(_MSC_VER)
 #include <intrin.h>
@@ -136,7 +137,9 @@ static zxc_cpu_feature_t zxc_detect_cpu_features(void) {
  * ============================================================================
  * DISPATCHERS
  * ============================================================================
- * We use a function pointer initialized on first use (lazy initialization).
+ * We use function pointers initialized on first use (lazy initialization),
+ * from the `ZXC_ISA` environment variable or the CPU features, and replaced
+ * by zxc_set_isa(). Both pointers always belong to the same instruction set.
  */
 
 typedef int (*zxc_decompress_func_t)(zxc_cctx_t*, const uint8_t*, size_t, uint8_t*, size_t);
@@ -144,79 +147,123 @@ typedef int (*zxc_compress_func_t)(zxc_cctx_t*, const uint8_t*, size_t, uint8_t*
 
 static ZXC_ATOMIC zxc_decompress_func_t zxc_decompress_ptr = NULL;
 static ZXC_ATOMIC zxc_compress_func_t zxc_compress_ptr = NULL;
+static ZXC_ATOMIC int zxc_isa_active = ZXC_ISA_AUTO;  // AUTO until the first selection
 
-// Initializer for Decompression
-static int zxc_decompress_dispatch_init(zxc_cctx_t* ctx, const uint8_t* src, size_t src_sz,
-                                        uint8_t* dst, size_t dst_cap) {
-    zxc_cpu_feature_t cpu = zxc_detect_cpu_features();
-    zxc_decompress_func_t zxc_decompress_ptr_local = NULL;
+static const char* const zxc_isa_names[] = {"auto", "generic", "avx2", "avx512", "neon"};
 
-#ifndef ZXC_ONLY_DEFAULT
+// Whether this build has the code path of isa and the CPU can run it
+static int zxc_isa_supported(int isa) {
+    if (isa == ZXC_ISA_GENERIC) return 1;
+    // Always GENERIC with ZXC_ONLY_DEFAULT
+    zxc_cpu_feature_t cpu = zxc_detect_cpu_features();
 #if defined(__x86_64__) || defined(_M_X64)
-    if (cpu == ZXC_CPU_AVX512)
-        zxc_decompress_ptr_local = zxc_decompress_chunk_wrapper_avx512;
-    else if (cpu == ZXC_CPU_AVX2)
-        zxc_decompress_ptr_local = zxc_decompress_chunk_wrapper_avx2;
-    else
-        zxc_decompress_ptr_local = zxc_decompress_chunk_wrapper_default;
+    if (isa == ZXC_ISA_AVX512) return cpu == ZXC_CPU_AVX512;
+    if (isa == ZXC_ISA_AVX2) return cpu == ZXC_CPU_AVX512 || cpu == ZXC_CPU_AVX2;
 #elif defined(__aarch64__) || defined(_M_ARM64) || defined(__arm__) || defined(_M_ARM)
     // cppcheck-suppress knownConditionTrueFalse
-    if (cpu == ZXC_CPU_NEON)
-        zxc_decompress_ptr_local = zxc_decompress_chunk_wrapper_neon;
-    else
-        zxc_decompress_ptr_local = zxc_decompress_chunk_wrapper_default;
+    if (isa == ZXC_ISA_NEON) return cpu == ZXC_CPU_NEON;
 #else
     (void)cpu;
-    zxc_decompress_ptr_local = zxc_decompress_chunk_wrapper_default;
-#endif
-#else
-    (void)cpu;
-    zxc_decompress_ptr_local = zxc_decompress_chunk_wrapper_default;
 #endif
+    return 0;
+}
 
-#if ZXC_USE_C11_ATOMICS
-    atomic_store_explicit(&zxc_decompress_ptr, zxc_decompress_ptr_local, memory_order_release);
-#else
-    zxc_decompress_ptr = zxc_decompress_ptr_local;
-#endif
-    return zxc_decompress_ptr_local(ctx, src, src_sz, dst, dst_cap);
+// Instruction set of the first selection: ZXC_ISA if usable, else the widest supported
+static int zxc_isa_default(void) {
+    const char* env = getenv("ZXC_ISA");
+    int isa = env ? zxc_isa_from_name(env) : -1;
+    if (isa > ZXC_ISA_AUTO && zxc_isa_supported(isa)) return isa;
+
+    static const int order[] = {ZXC_ISA_AVX512, ZXC_ISA_AVX2, ZXC_ISA_NEON};
+    for (size_t i = 0; i < sizeof(order) / sizeof(order[0]); i++)
+        if (zxc_isa_supported(order[i])) return order[i];
+    return ZXC_ISA_GENERIC;
 }
 
-// Initializer for Compression
-static int zxc_compress_dispatch_init(zxc_cctx_t* ctx, const uint8_t* src, size_t src_sz,
-                                      uint8_t* dst, size_t dst_cap) {
-    zxc_cpu_feature_t cpu = zxc_detect_cpu_features();
-    zxc_compress_func_t zxc_compress_ptr_local = NULL;
+// Publishes the wrappers of a supported instruction set
+static void zxc_isa_install(int isa) {
+    zxc_compress_func_t zxc_compress_ptr_local = zxc_compress_chunk_wrapper_default;
+    zxc_decompress_func_t zxc_decompress_ptr_local = zxc_decompress_chunk_wrapper_default;
 
 #ifndef ZXC_ONLY_DEFAULT
 #if defined(__x86_64__) || defined(_M_X64)
-    if (cpu == ZXC_CPU_AVX512)
+    if (isa == ZXC_ISA_AVX512) {
         zxc_compress_ptr_local = zxc_compress_chunk_wrapper_avx512;
-    else if (cpu == ZXC_CPU_AVX2)
+        zxc_decompress_ptr_local = zxc_decompress_chunk_wrapper_avx512;
+    } else if (isa == ZXC_ISA_AVX2) {
         zxc_compress_ptr_local = zxc_compress_chunk_wrapper_avx2;
-    else
-        zxc_compress_ptr_local = zxc_compress_chunk_wrapper_default;
+        zxc_decompress_ptr_local = zxc_decompress_chunk_wrapper_avx2;
+    }
 #elif defined(__aarch64__) || defined(_M_ARM64) || defined(__arm__) || defined(_M_ARM)
-    // cppcheck-suppress knownConditionTrueFalse
-    if (cpu == ZXC_CPU_NEON)
+    if (isa == ZXC_ISA_NEON) {
         zxc_compress_ptr_local = zxc_compress_chunk_wrapper_neon;
-    else
-        zxc_compress_ptr_local = zxc_compress_chunk_wrapper_default;
-#else
-    (void)cpu;
-    zxc_compress_ptr_local = zxc_compress_chunk_wrapper_default;
+        zxc_decompress_ptr_local = zxc_decompress_chunk_wrapper_neon;
+    }
 #endif
-#else
-    (void)cpu;
-    zxc_compress_ptr_local = zxc_compress_chunk_wrapper_default;
 #endif
 
 #if ZXC_USE_C11_ATOMICS
     atomic_store_explicit(&zxc_compress_ptr, zxc_compress_ptr_local, memory_order_release);
+    atomic_store_explicit(&zxc_decompress_ptr, zxc_decompress_ptr_local, memory_order_release);
+    atomic_store_explicit(&zxc_isa_active, isa, memory_order_release);
 #else
     zxc_compress_ptr = zxc_compress_ptr_local;
+    zxc_decompress_ptr = zxc_decompress_ptr_local;
+    zxc_isa_active = isa;
+#endif
+}
+
+// First use: keeps a selection made meanwhile by zxc_set_isa()
+static void zxc_isa_init(void) {
+#if ZXC_USE_C11_ATOMICS
+    int isa = atomic_load_explicit(&zxc_isa_active, memory_order_acquire);
+#else
+    int isa = zxc_isa_active;
 #endif
-    return zxc_compress_ptr_local(ctx, src, src_sz, dst, dst_cap);
+    zxc_isa_install(isa == ZXC_ISA_AUTO ? zxc_isa_default() : isa);
+}
+
+// cppcheck-suppress unusedFunction
+int zxc_set_isa(zxc_isa_t isa) {
+    if (isa == ZXC_ISA_AUTO) {
+        zxc_isa_install(zxc_isa_default());
+        return 0;
+    }
+    if (UNLIKELY(!zxc_isa_supported((int)isa))) return -1;
+    zxc_isa_install((int)isa);
+    return 0;
+}
+
+// cppcheck-suppress unusedFunction
+zxc_isa_t zxc_get_active_isa(void) {
+#if ZXC_USE_C11_ATOMICS
+    int isa = atomic_load_explicit(&zxc_isa_active, memory_order_acquire);
+#else
+    int isa = zxc_isa_active;
+#endif
+    if (isa == ZXC_ISA_AUTO) {
+        isa = zxc_isa_default();
+        zxc_isa_install(isa);
+    }
+    return (zxc_isa_t)isa;
+}
+
+// cppcheck-suppress unusedFunction
+const char* zxc_isa_name(zxc_isa_t isa) {
+    if ((int)isa < ZXC_ISA_AUTO || (int)isa > ZXC_ISA_NEON) return "unknown";
+    return zxc_isa_names[isa];
+}
+
+int zxc_isa_from_name(const char* name) {
+    if (UNLIKELY(!name)) return -1;
+    for (int isa = ZXC_ISA_AUTO; isa <= ZXC_ISA_NEON; isa++) {
+        const char* ref = zxc_isa_names[isa];
+        size_t i = 0;
+        while (ref[i] && (name[i] >= 'A' && name[i] <= 'Z' ? name[i] + 32 : name[i]) == ref[i])
+            i++;
+        if (!ref[i] && !name[i]) return isa;
+    }
+    return -1;
 }
 
 // Public Wrappers (Dispatcher and Main API)
@@ -228,7 +275,10 @@ int zxc_decompress_chunk_wrapper(zxc_cctx_t* ctx, const uint8_t* src, size_t src
 #else
     zxc_decompress_func_t func = zxc_decompress_ptr;
 #endif
-    if (UNLIKELY(!func)) return zxc_decompress_dispatch_init(ctx, src, src_sz, dst, dst_cap);
+    if (UNLIKELY(!func)) {
+        zxc_isa_init();
+        return zxc_decompress_chunk_wrapper(ctx, src, src_sz, dst, dst_cap);
+    }
     return func(ctx, src, src_sz, dst, dst_cap);
 }
 
@@ -239,10 +289,177 @@ int zxc_compress_chunk_wrapper(zxc_cctx_t* ctx, const uint8_t* src, size_t src_s
 #else
     zxc_compress_func_t func = zxc_compress_ptr;
 #endif
-    if (UNLIKELY(!func)) return zxc_compress_dispatch_init(ctx, src, src_sz, dst, dst_cap);
+    if (UNLIKELY(!func)) {
+        zxc_isa_init();
+        return zxc_compress_chunk_wrapper(ctx, src, src_sz, dst, dst_cap);
+    }
     return func(ctx, src, src_sz, dst, dst_cap);
 }
 
+// cppcheck-suppress unusedFunction
+size_t zxc_block_bound(size_t src_size) {
+    return src_size + ZXC_BLOCK_HEADER_SIZE + ZXC_BLOCK_CHECKSUM_SIZE;
+}
+
+// cppcheck-suppress unusedFunction
+int zxc_compress_block(zxc_cctx_t* ctx, const uint8_t* src, size_t src_size, uint8_t* dst,
+                       size_t dst_capacity) {
+    if (UNLIKELY(!ctx || !ctx->memory_block || !src || !dst || src_size == 0 ||
+                 src_size > ctx->chunk_size))
+        return -1;
+    return zxc_compress_chunk_wrapper(ctx, src, src_size, dst, dst_capacity);
+}
+
+// cppcheck-suppress unusedFunction
+int zxc_decompress_block(zxc_cctx_t* ctx, const uint8_t* src, size_t src_size, uint8_t* dst,
+                         size_t dst_capacity) {
+    if (UNLIKELY(!ctx || !src || !dst)) return -1;
+    size_t block_sz = zxc_peek_block_size(src, src_size);
+    if (UNLIKELY(block_sz == 0 || block_sz > src_size)) return -1;
+    return zxc_decompress_chunk_wrapper(ctx, src, src_size, dst, dst_capacity);
+}
+
+/*
+ * ============================================================================
+ * INCREMENTAL ENCODER (FLUSH POINTS)
+ * ============================================================================
+ * Input is gathered into the open block; a flush compresses it at whatever
+ * size it has. Whole blocks the caller hands over at once are compressed in
+ * place, without going through the pending buffer.
+ */
+
+/**
+ * @brief Worst-case size of the blocks and frame header the encoder writes next.
+ *
+ * @param[in] cs Encoder.
+ * @param[in] n_blocks Number of full blocks about to be closed.
+ * @param[in] partial Size of a last, partial block (0 = none).
+ * @return Bytes needed in the destination.
+ */
+static size_t zxc_cstream_need(const zxc_cstream_t* cs, size_t n_blocks, size_t partial) {
+    const size_t overhead = ZXC_BLOCK_HEADER_SIZE + ZXC_BLOCK_CHECKSUM_SIZE;
+    size_t need = cs->header_done ? 0 : ZXC_FILE_HEADER_SIZE;
+    need += n_blocks * (cs->block_size + overhead);
+    if (partial) need += partial + overhead;
+    return need;
+}
+
+/**
+ * @brief Writes the file header if the current frame has none yet.
+ *
+ * @param[in,out] cs Encoder.
+ * @param[out] dst Destination (zxc_cstream_need() checked by the caller).
+ * @return Bytes written.
+ */
+static size_t zxc_cstream_header(zxc_cstream_t* cs, uint8_t* dst) {
+    if (cs->header_done) return 0;
+    zxc_file_header_t fh = {cs->block_size, ZXC_FILE_FLAG_NONE, 0, 0};
+    cs->header_done = 1;
+    return (size_t)zxc_write_file_header(dst, ZXC_FILE_HEADER_SIZE, &fh);
+}
+
+// cppcheck-suppress unusedFunction
+int zxc_cstream_init(zxc_cstream_t* cs, size_t block_size, int level, int checksum_enabled) {
+    if (UNLIKELY(!cs)) return -1;
+    ZXC_MEMSET(cs, 0, sizeof(*cs));
+    block_size = zxc_resolve_block_size(block_size);
+    if (UNLIKELY(block_size == 0)) return -1;
+    if (UNLIKELY(zxc_cctx_init(&cs->cctx, block_size, 1, level > 0 ? level : ZXC_LEVEL_DEFAULT,
+                               checksum_enabled) != 0))
+        return -1;
+    // Padded: the encoders' wild literal copies may read past the open block.
+    cs->pending = malloc(block_size + ZXC_PAD_SIZE);
+    if (UNLIKELY(!cs->pending)) {
+        zxc_cctx_free(&cs->cctx);
+        return -1;
+    }
+    cs->block_size = block_size;
+    return 0;
+}
+
+// cppcheck-suppress unusedFunction
+void zxc_cstream_free(zxc_cstream_t* cs) {
+    if (!cs) return;
+    zxc_cctx_free(&cs->cctx);
+    free(cs->pending);
+    ZXC_MEMSET(cs, 0, sizeof(*cs));
+}
+
+// cppcheck-suppress unusedFunction
+size_t zxc_cstream_bound(size_t block_size, size_t src_size) {
+    block_size = zxc_resolve_block_size(block_size);
+    if (UNLIKELY(block_size == 0 || src_size > SIZE_MAX / 2)) return 0;
+    // Pending bytes (less than a block) plus the input: at most one block more
+    // than the input fills, one partial block at the end, and the END block.
+    const size_t n_blocks = src_size / block_size + 2;
+    return ZXC_FILE_HEADER_SIZE + src_size + block_size +
+           n_blocks * (ZXC_BLOCK_HEADER_SIZE + ZXC_BLOCK_CHECKSUM_SIZE) + ZXC_BLOCK_HEADER_SIZE;
+}
+
+// cppcheck-suppress unusedFunction
+int zxc_cstream_compress(zxc_cstream_t* cs, const uint8_t* src, size_t src_size, uint8_t* dst,
+                         size_t dst_capacity) {
+    if (UNLIKELY(!cs || !cs->pending || !dst || (!src && src_size > 0))) return -1;
+    const size_t block_size = cs->block_size;
+    if (UNLIKELY(src_size > SIZE_MAX - block_size)) return -1;
+    const size_t need = zxc_cstream_need(cs, (cs->pending_size + src_size) / block_size, 0);
+    if (UNLIKELY(need > dst_capacity || need > INT32_MAX)) return -1;
+
+    uint8_t* op = dst + zxc_cstream_header(cs, dst);
+    const uint8_t* const op_end = dst + dst_capacity;
+    while (src_size > 0) {
+        const uint8_t* block = src;
+        size_t take = block_size;
+        if (cs->pending_size > 0 || src_size < block_size) {
+            take = block_size - cs->pending_size;
+            if (take > src_size) take = src_size;
+            ZXC_MEMCPY(cs->pending + cs->pending_size, src, take);
+            cs->pending_size += take;
+            block = cs->pending;
+        }
+        src += take;
+        src_size -= take;
+        if (block == cs->pending && cs->pending_size < block_size) break;
+
+        int res = zxc_compress_chunk_wrapper(&cs->cctx, block, block_size, op,
+                                             (size_t)(op_end - op));
+        if (UNLIKELY(res < 0)) return -1;
+        op += res;
+        if (block == cs->pending) cs->pending_size = 0;
+    }
+    return (int)(op - dst);
+}
+
+// cppcheck-suppress unusedFunction
+int zxc_cstream_flush(zxc_cstream_t* cs, uint8_t* dst, size_t dst_capacity) {
+    if (UNLIKELY(!cs || !cs->pending || !dst)) return -1;
+    if (UNLIKELY(zxc_cstream_need(cs, 0, cs->pending_size) > dst_capacity)) return -1;
+
+    uint8_t* op = dst + zxc_cstream_header(cs, dst);
+    if (cs->pending_size > 0) {
+        int res = zxc_compress_chunk_wrapper(&cs->cctx, cs->pending, cs->pending_size, op,
+                                             dst_capacity - (size_t)(op - dst));
+        if (UNLIKELY(res < 0)) return -1;
+        op += res;
+        cs->pending_size = 0;
+    }
+    return (int)(op - dst);
+}
+
+// cppcheck-suppress unusedFunction
+int zxc_cstream_end(zxc_cstream_t* cs, uint8_t* dst, size_t dst_capacity) {
+    if (UNLIKELY(!cs || !cs->pending || !dst)) return -1;
+    if (UNLIKELY(zxc_cstream_need(cs, 0, cs->pending_size) + ZXC_BLOCK_HEADER_SIZE >
+                 dst_capacity))
+        return -1;
+
+    int res = zxc_cstream_flush(cs, dst, dst_capacity);
+    if (UNLIKELY(res < 0)) return -1;
+    res += zxc_write_end_block(dst + res, dst_capacity - (size_t)res);
+    cs->header_done = 0;
+    return res;
+}
+
 /*
  * ============================================================================
  * PUBLIC UTILITY API
@@ -251,97 +468,643 @@ int zxc_compress_chunk_wrapper(zxc_cctx_t* ctx, const uint8_t* src, size_t src_s
  * allocation and looping over blocks. They call the dispatched wrappers above.
  */
 
-// cppcheck-suppress unusedFunction
-size_t zxc_compress(const void* src, size_t src_size, void* dst, size_t dst_capacity, int level,
-                    int checksum_enabled) {
-    if (UNLIKELY(!src || !dst || src_size == 0 || dst_capacity == 0)) return 0;
+/**
+ * @brief Compresses a whole buffer into a ZXC frame using an initialized context.
+ *
+ * Shared by the one-shot and the reusable-context entry points. The context
+ * must have been initialized for compression with a chunk size of at least
+ * zxc_cctx_chunk_size(src_size, block_size); its level and checksum settings
+ * are overwritten from opts.
+ *
+ * @param[in,out] ctx Initialized compression context.
+ * @param[in] block_size Validated block size (see zxc_resolve_block_size()).
+ * @param[in] src Source buffer.
+ * @param[in] src_size Size of the source data.
+ * @param[out] dst Destination buffer.
+ * @param[in] dst_capacity Capacity of the destination buffer.
+ * @param[in] opts Frame options (NULL selects the defaults).
+ * @param[in] dict Prepared dictionary every block may reference (NULL = none).
+ * @return Bytes written to dst, or 0 on error.
+ */
+static size_t zxc_compress_frame_impl(zxc_cctx_t* ctx, size_t block_size, const void* src,
+                                      size_t src_size, void* dst, size_t dst_capacity,
+                                      const zxc_compress_opts_t* opts, const zxc_dict* dict) {
+    int seekable = opts ? opts->seekable : 0;
+    int linked = opts ? opts->linked : 0;
+    int digest = opts ? opts->digest : 0;
+    size_t elem_size = opts ? opts->elem_size : 0;
+    // A seek table promises independent blocks; linked blocks are not. Linked
+    // history is raw data, so it does not mix with shuffled blocks either.
+    if (UNLIKELY(seekable && linked)) return 0;
+    if (UNLIKELY(elem_size > ZXC_ELEM_SIZE_MAX || (linked && elem_size > 1))) return 0;
+    ctx->compression_level = (opts && opts->level > 0) ? opts->level : ZXC_LEVEL_DEFAULT;
+    // The digest combines the block checksums.
+    ctx->checksum_enabled = (opts && opts->checksum_enabled) || digest;
+    ctx->num_type = opts ? opts->num_type : ZXC_NUM_AUTO;
+    ctx->elem_size = elem_size;
+    ctx->dict = dict;
+    ZXC_MEMSET(&ctx->stats, 0, sizeof(ctx->stats));
+    zxc_cctx_link(ctx, NULL, 0, 0);
 
     const uint8_t* ip = (const uint8_t*)src;
     uint8_t* op = (uint8_t*)dst;
     const uint8_t* op_start = op;
     const uint8_t* op_end = op + dst_capacity;
 
-    zxc_cctx_t ctx;
-    if (zxc_cctx_init(&ctx, ZXC_BLOCK_SIZE, 1, level, checksum_enabled) != 0) return 0;
+    zxc_seek_entry_t* seek = NULL;
+    size_t n_blocks = (src_size + block_size - 1) / block_size;
+    if (seekable) {
+        seek = malloc(n_blocks * sizeof(zxc_seek_entry_t));
+        if (UNLIKELY(!seek)) return 0;
+    }
 
-    int h_size = zxc_write_file_header(op, (size_t)(op_end - op));
-    if (UNLIKELY(h_size < 0)) {
-        zxc_cctx_free(&ctx);
-        return 0;
+    zxc_file_header_t fh = {block_size, ZXC_FILE_FLAG_CONTENT_SIZE, (uint64_t)src_size, 0};
+    if (seekable) fh.flags |= ZXC_FILE_FLAG_SEEKABLE;
+    if (digest) fh.flags |= ZXC_FILE_FLAG_DIGEST;
+    if (dict) {
+        fh.flags |= ZXC_FILE_FLAG_DICT_ID;
+        fh.dict_id = dict->id;
     }
+    int h_size = zxc_write_file_header(op, (size_t)(op_end - op), &fh);
+    if (UNLIKELY(h_size < 0)) goto error;
     op += h_size;
 
     size_t pos = 0;
+    size_t blk = 0;
+    zxc_digest_t dg = {0, 0, 0};
     while (pos < src_size) {
-        size_t chunk_len = (src_size - pos > ZXC_BLOCK_SIZE) ? ZXC_BLOCK_SIZE : (src_size - pos);
+        size_t chunk_len = (src_size - pos > block_size) ? block_size : (src_size - pos);
         size_t rem_cap = (size_t)(op_end - op);
 
-        int res = zxc_compress_chunk_wrapper(&ctx, ip + pos, chunk_len, op, rem_cap);
-        if (UNLIKELY(res < 0)) {
-            zxc_cctx_free(&ctx);
-            return 0;
+        if (seek) {
+            seek[blk].comp_offset = (uint64_t)(op - op_start);
+            seek[blk].raw_offset = (uint64_t)pos;
         }
 
+        // Previous blocks are all full: the history is the last block_size bytes.
+        if (linked && pos > 0 && UNLIKELY(zxc_cctx_link(ctx, ip + pos - block_size, block_size, 1)))
+            goto error;
+
+        int res = zxc_compress_chunk_wrapper(ctx, ip + pos, chunk_len, op, rem_cap);
+        if (UNLIKELY(res < 0)) goto error;
+        if (digest && UNLIKELY(zxc_digest_update(&dg, op, (size_t)res) != 0)) goto error;
+
         op += res;
         pos += chunk_len;
+        blk++;
     }
 
-    zxc_cctx_free(&ctx);
+    if (digest) {
+        int res = zxc_write_digest(op, (size_t)(op_end - op), &dg);
+        if (UNLIKELY(res < 0)) goto error;
+        op += res;
+    }
+    if (seek) {
+        int res = zxc_write_seek_table(op, (size_t)(op_end - op), seek, blk);
+        if (UNLIKELY(res < 0)) goto error;
+        op += res;
+    }
+
+    free(seek);
+    if (opts && opts->block_stats) zxc_block_stats_add(opts->block_stats, &ctx->stats);
     return (size_t)(op - op_start);
-}
 
-// cppcheck-suppress unusedFunction
-size_t zxc_decompress(const void* src, size_t src_size, void* dst, size_t dst_capacity,
-                      int checksum_enabled) {
-    if (UNLIKELY(!src || !dst || src_size < ZXC_FILE_HEADER_SIZE)) return 0;
+error:
+    free(seek);
+    return 0;
+}
 
+/**
+ * @brief Decompresses a whole ZXC frame using a decompression context.
+ *
+ * The context only carries scratch state (e.g. the RLE literal buffer, which
+ * grows on demand), so it can be reused across frames of any block size.
+ *
+ * @param[in,out] ctx Context initialized for decompression.
+ * @param[in] src Compressed frame.
+ * @param[in] src_size Size of the compressed frame.
+ * @param[out] dst Destination buffer.
+ * @param[in] dst_capacity Capacity of the destination buffer.
+ * @param[in] checksum_enabled Verify the block checksums and the frame digest (1) or not (0).
+ * @param[in] dict Dictionary to decode a dictionary frame with (ignored for other frames).
+ * @param[in] in_place The frame lies inside dst, after the output: each block
+ * may then only write up to its own compressed bytes.
+ * @return Bytes written to dst, or 0 on error (including a dictionary frame
+ * without the matching dictionary).
+ */
+static size_t zxc_decompress_frame_impl(zxc_cctx_t* ctx, const void* src, size_t src_size,
+                                        void* dst, size_t dst_capacity, int checksum_enabled,
+                                        const zxc_dict* dict, int in_place) {
     const uint8_t* ip = (const uint8_t*)src;
     const uint8_t* ip_end = ip + src_size;
     uint8_t* op = (uint8_t*)dst;
     const uint8_t* op_start = op;
     const uint8_t* op_end = op + dst_capacity;
-    size_t runtime_chunk_size = 0;
 
     // File header verification
-    if (zxc_read_file_header(ip, src_size, &runtime_chunk_size) != 0) return 0;
+    zxc_file_header_t fh;
+    int h_size = zxc_read_file_header(ip, src_size, &fh);
+    if (UNLIKELY(h_size < 0)) return 0;
+    // Known content size: reject a too small destination before decoding anything
+    if ((fh.flags & ZXC_FILE_FLAG_CONTENT_SIZE) && UNLIKELY(fh.content_size > dst_capacity))
+        return 0;
+    // Dictionary frame: the exact dictionary it was compressed with is required
+    if (fh.flags & ZXC_FILE_FLAG_DICT_ID) {
+        if (UNLIKELY(!dict || dict->id != fh.dict_id)) return 0;
+        ctx->dict = dict;
+    } else {
+        ctx->dict = NULL;
+    }
 
-    zxc_cctx_t ctx;
-    if (zxc_cctx_init(&ctx, runtime_chunk_size, 0, 0, checksum_enabled) != 0) return 0;
+    ctx->checksum_enabled = checksum_enabled;
+    zxc_cctx_link(ctx, NULL, 0, 0);
+    ip += h_size;
 
-    ip += ZXC_FILE_HEADER_SIZE;
+    // Frame digest: combined from the stored block checksums as the blocks go by.
+    const int check_digest = checksum_enabled && (fh.flags & ZXC_FILE_FLAG_DIGEST);
+    zxc_digest_t dg = {0, 0, 0};
+    int digest_ok = 0;
 
     // Block decompression loop
     while (ip < ip_end) {
         size_t rem_src = (size_t)(ip_end - ip);
         zxc_block_header_t bh;
         // Read the block header to determine the compressed size
-        if (zxc_read_block_header(ip, rem_src, &bh) != 0) {
-            zxc_cctx_free(&ctx);
-            return 0;
-        }
+        if (zxc_read_block_header(ip, rem_src, &bh) != 0) return 0;
 
         // Safety check: ensure the block (header + data + checksum) fits in the input buffer
         size_t checksum_sz =
             (bh.block_flags & ZXC_BLOCK_FLAG_CHECKSUM) ? ZXC_BLOCK_CHECKSUM_SIZE : 0;
         size_t total_block_sz = ZXC_BLOCK_HEADER_SIZE + bh.comp_size + checksum_sz;
 
-        if (UNLIKELY(total_block_sz > rem_src)) {
-            zxc_cctx_free(&ctx);
-            return 0;
+        if (UNLIKELY(total_block_sz > rem_src)) return 0;
+
+        // End of stream: closes the frame, nothing may follow it.
+        if (bh.block_type == ZXC_BLOCK_END) {
+            if (UNLIKELY(!zxc_is_end_block(ip, rem_src) || total_block_sz != rem_src)) return 0;
+            break;
+        }
+
+        if (check_digest && bh.block_type != ZXC_BLOCK_SEK) {
+            if (bh.block_type == ZXC_BLOCK_DIG) {
+                if (UNLIKELY(zxc_check_digest(ip, rem_src, &dg) != 0)) return 0;
+                digest_ok = 1;
+            } else if (UNLIKELY(digest_ok || zxc_digest_update(&dg, ip, rem_src) != 0)) {
+                return 0;  // Block past the digest, or without a checksum
+            }
         }
 
         size_t rem_cap = (size_t)(op_end - op);
-        int res = zxc_decompress_chunk_wrapper(&ctx, ip, rem_src, op, rem_cap);
-        if (UNLIKELY(res < 0)) {
-            zxc_cctx_free(&ctx);
-            return 0;
+        if (in_place) {
+            // The output must not catch up with the bytes still to be read.
+            if (UNLIKELY(ip < op)) return 0;
+            rem_cap = (size_t)(ip - op);
         }
+        int res = zxc_decompress_chunk_wrapper(ctx, ip, rem_src, op, rem_cap);
+        if (UNLIKELY(res < 0)) return 0;
+        // History of a linked next block: this block's output, never a seek table.
+        if (res > 0 && UNLIKELY(zxc_cctx_link(ctx, op, (size_t)res, 0) != 0)) return 0;
 
-        ip += ZXC_BLOCK_HEADER_SIZE + bh.comp_size;
-        ip += (bh.block_flags & ZXC_BLOCK_FLAG_CHECKSUM) ? ZXC_BLOCK_CHECKSUM_SIZE : 0;
+        ip += total_block_sz;
         op += res;
     }
 
-    zxc_cctx_free(&ctx);
+    if (check_digest && UNLIKELY(!digest_ok)) return 0;
+    if ((fh.flags & ZXC_FILE_FLAG_CONTENT_SIZE) &&
+        UNLIKELY((uint64_t)(op - op_start) != fh.content_size))
+        return 0;
     return (size_t)(op - op_start);
 }
+
+/**
+ * @brief zxc_compress_frame_impl() as an instrumented call (see zxc_perf_begin()).
+ */
+static size_t zxc_compress_frame(zxc_cctx_t* ctx, size_t block_size, const void* src,
+                                 size_t src_size, void* dst, size_t dst_capacity,
+                                 const zxc_compress_opts_t* opts, const zxc_dict* dict) {
+    zxc_perf_call_t call;
+    zxc_perf_stats_t* perf = zxc_perf_begin(&call, "compress");
+    ctx->timed = perf != NULL;
+    ctx->checksum_ns = 0;
+    ZXC_MEMSET(&ctx->stats, 0, sizeof(ctx->stats));
+    const uint64_t t0 = perf ? zxc_perf_now() : 0;
+    size_t res =
+        zxc_compress_frame_impl(ctx, block_size, src, src_size, dst, dst_capacity, opts, dict);
+    if (perf) {
+        perf->work_ns += zxc_perf_now() - t0;
+        perf->checksum_ns += ctx->checksum_ns;
+        zxc_block_stats_add(&perf->blocks, &ctx->stats);
+    }
+    zxc_perf_end(&call, src_size, res);
+    return res;
+}
+
+/**
+ * @brief zxc_decompress_frame_impl() as an instrumented call (see zxc_perf_begin()).
+ */
+static size_t zxc_decompress_frame(zxc_cctx_t* ctx, const void* src, size_t src_size, void* dst,
+                                   size_t dst_capacity, int checksum_enabled, const zxc_dict* dict,
+                                   int in_place) {
+    zxc_perf_call_t call;
+    zxc_perf_stats_t* perf = zxc_perf_begin(&call, "decompress");
+    ctx->timed = perf != NULL;
+    ctx->checksum_ns = 0;
+    ZXC_MEMSET(&ctx->stats, 0, sizeof(ctx->stats));
+    const uint64_t t0 = perf ? zxc_perf_now() : 0;
+    size_t res = zxc_decompress_frame_impl(ctx, src, src_size, dst, dst_capacity, checksum_enabled,
+                                           dict, in_place);
+    if (perf) {
+        perf->work_ns += zxc_perf_now() - t0;
+        perf->checksum_ns += ctx->checksum_ns;
+        zxc_block_stats_add(&perf->blocks, &ctx->stats);
+    }
+    zxc_perf_end(&call, src_size, res);
+    return res;
+}
+
+// cppcheck-suppress unusedFunction
+size_t zxc_compress_ex(const void* src, size_t src_size, void* dst, size_t dst_capacity,
+                       const zxc_compress_opts_t* opts) {
+    if (UNLIKELY(!src || !dst || src_size == 0 || dst_capacity == 0)) return 0;
+
+    size_t block_size = zxc_resolve_block_size(opts ? opts->block_size : 0);
+    if (UNLIKELY(block_size == 0)) return 0;
+
+    zxc_cctx_t ctx;
+    if (zxc_cctx_init(&ctx, zxc_cctx_chunk_size(src_size, block_size), 1, 0, 0) != 0) {
+        zxc_cctx_free(&ctx);
+        return 0;
+    }
+    size_t res =
+        zxc_compress_frame(&ctx, block_size, src, src_size, dst, dst_capacity, opts, NULL);
+    zxc_cctx_free(&ctx);
+    return res;
+}
+
+// cppcheck-suppress unusedFunction
+size_t zxc_compress(const void* src, size_t src_size, void* dst, size_t dst_capacity, int level,
+                    int checksum_enabled) {
+    zxc_compress_opts_t opts = {level, checksum_enabled, 0, 0, 0, 0, 0, NULL, 0, 0, 0};
+    return zxc_compress_ex(src, src_size, dst, dst_capacity, &opts);
+}
+
+// cppcheck-suppress unusedFunction
+size_t zxc_compress_typed(const void* src, size_t n_elems, size_t elem_size, void* dst,
+                          size_t dst_capacity, const zxc_compress_opts_t* opts) {
+    if (UNLIKELY(elem_size == 0 || elem_size > ZXC_ELEM_SIZE_MAX ||
+                 n_elems > SIZE_MAX / elem_size))
+        return 0;
+
+    zxc_compress_opts_t o;
+    if (opts)
+        o = *opts;
+    else
+        ZXC_MEMSET(&o, 0, sizeof(o));
+    o.elem_size = elem_size;
+    return zxc_compress_ex(src, n_elems * elem_size, dst, dst_capacity, &o);
+}
+
+// cppcheck-suppress unusedFunction
+size_t zxc_decompress(const void* src, size_t src_size, void* dst, size_t dst_capacity,
+                      int checksum_enabled) {
+    if (UNLIKELY(!src || !dst || src_size < ZXC_FILE_HEADER_SIZE)) return 0;
+
+    zxc_cctx_t ctx;
+    if (zxc_cctx_init(&ctx, 0, 0, 0, checksum_enabled) != 0) return 0;
+    size_t res =
+        zxc_decompress_frame(&ctx, src, src_size, dst, dst_capacity, checksum_enabled, NULL, 0);
+    zxc_cctx_free(&ctx);
+    return res;
+}
+
+// cppcheck-suppress unusedFunction
+size_t zxc_get_decompressed_size(const void* src, size_t src_size) {
+    if (UNLIKELY(!src)) return 0;
+
+    const uint8_t* ip = (const uint8_t*)src;
+    const uint8_t* ip_end = ip + src_size;
+
+    zxc_file_header_t fh;
+    int h_size = zxc_read_file_header(ip, src_size, &fh);
+    if (UNLIKELY(h_size < 0)) return 0;
+    if (fh.flags & ZXC_FILE_FLAG_CONTENT_SIZE) {
+        if (UNLIKELY((uint64_t)(size_t)fh.content_size != fh.content_size)) return 0;
+        return (size_t)fh.content_size;
+    }
+
+    // Frame without content size (e.g. written by the stream API): sum the
+    // block headers, no data is decoded.
+    size_t total = 0;
+    ip += h_size;
+    while (ip < ip_end) {
+        size_t rem_src = (size_t)(ip_end - ip);
+        zxc_block_header_t bh;
+        if (zxc_read_block_header(ip, rem_src, &bh) != 0) return 0;
+
+        size_t checksum_sz =
+            (bh.block_flags & ZXC_BLOCK_FLAG_CHECKSUM) ? ZXC_BLOCK_CHECKSUM_SIZE : 0;
+        size_t total_block_sz = ZXC_BLOCK_HEADER_SIZE + bh.comp_size + checksum_sz;
+        if (UNLIKELY(total_block_sz > rem_src)) return 0;
+
+        if (bh.block_type != ZXC_BLOCK_SEK) total += bh.raw_size;
+        ip += total_block_sz;
+    }
+    return total;
+}
+
+/**
+ * @brief Locates the block containing a given raw offset using the seek table.
+ *
+ * @param[in] src Start of the frame.
+ * @param[in] src_size Size of the frame.
+ * @param[in] raw_off Requested decompressed offset.
+ * @param[out] out_block_off Receives the offset of the block header in the frame.
+ * @param[out] out_block_raw Receives the raw offset at which that block starts.
+ * @return 0 on success, -1 if the frame has no valid seek table or raw_off is
+ * past the end of the data.
+ */
+static int zxc_seek_lookup(const uint8_t* src, size_t src_size, size_t h_size, size_t raw_off,
+                           size_t* out_block_off, size_t* out_block_raw) {
+    size_t n = 0, table_size = 0;
+    if (zxc_read_seek_trailer(src, src_size, &n, &table_size) != 0 || n == 0 ||
+        table_size > src_size - h_size)
+        return -1;
+
+    const uint8_t* entries = src + (src_size - table_size) + ZXC_BLOCK_HEADER_SIZE;
+
+    // Last entry whose raw offset is <= raw_off
+    size_t lo = 0, hi = n;
+    while (hi - lo > 1) {
+        size_t mid = lo + ((hi - lo) >> 1);
+        if (zxc_le64(entries + mid * ZXC_SEEK_ENTRY_SIZE + 8) <= raw_off)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    uint64_t comp_off = zxc_le64(entries + lo * ZXC_SEEK_ENTRY_SIZE);
+    uint64_t block_raw = zxc_le64(entries + lo * ZXC_SEEK_ENTRY_SIZE + 8);
+    if (UNLIKELY(comp_off < h_size || comp_off >= src_size - table_size ||
+                 block_raw > raw_off))
+        return -1;
+
+    *out_block_off = (size_t)comp_off;
+    *out_block_raw = (size_t)block_raw;
+    return 0;
+}
+
+// cppcheck-suppress unusedFunction
+size_t zxc_decompress_range(const void* src, size_t src_size, size_t raw_off, size_t len,
+                            void* dst, int checksum_enabled) {
+    if (UNLIKELY(!src || !dst || len == 0 || src_size < ZXC_FILE_HEADER_SIZE)) return 0;
+
+    const uint8_t* ip_start = (const uint8_t*)src;
+    const uint8_t* ip_end = ip_start + src_size;
+    zxc_file_header_t fh;
+    int h_size = zxc_read_file_header(ip_start, src_size, &fh);
+    if (UNLIKELY(h_size < 0 || (fh.flags & ZXC_FILE_FLAG_DICT_ID))) return 0;
+    if ((fh.flags & ZXC_FILE_FLAG_CONTENT_SIZE) && raw_off >= fh.content_size) return 0;
+
+    // 1. Find the first block that covers raw_off: seek table if present,
+    //    otherwise a header-only walk (no decoding of the prefix).
+    const uint8_t* ip = ip_start + h_size;
+    size_t block_raw = 0;
+    size_t off = 0;
+    if ((fh.flags & ZXC_FILE_FLAG_SEEKABLE) &&
+        zxc_seek_lookup(ip_start, src_size, (size_t)h_size, raw_off, &off, &block_raw) == 0) {
+        ip = ip_start + off;
+    }
+
+    zxc_cctx_t ctx;
+    if (zxc_cctx_init(&ctx, fh.block_size, 0, 0, checksum_enabled) != 0) return 0;
+    ctx.checksum_enabled = checksum_enabled;
+
+    uint8_t* op = (uint8_t*)dst;
+    uint8_t* scratch = NULL;
+    size_t scratch_cap = 0;
+    size_t written = 0;
+
+    // 2. Decode only the blocks overlapping [raw_off, raw_off + len).
+    while (ip < ip_end && written < len) {
+        size_t rem_src = (size_t)(ip_end - ip);
+        zxc_block_header_t bh;
+        if (zxc_read_block_header(ip, rem_src, &bh) != 0) goto error;
+
+        size_t checksum_sz =
+            (bh.block_flags & ZXC_BLOCK_FLAG_CHECKSUM) ? ZXC_BLOCK_CHECKSUM_SIZE : 0;
+        size_t total_block_sz = ZXC_BLOCK_HEADER_SIZE + bh.comp_size + checksum_sz;
+        if (UNLIKELY(total_block_sz > rem_src)) goto error;
+        if (bh.block_type == ZXC_BLOCK_SEK || bh.block_type == ZXC_BLOCK_DIG ||
+            bh.block_type == ZXC_BLOCK_END)
+            break;
+
+        size_t block_end = block_raw + bh.raw_size;
+        if (block_end > raw_off) {
+            size_t from = (raw_off + written) - block_raw;  // Offset inside this block
+            size_t take = bh.raw_size - from;
+            if (take > len - written) take = len - written;
+
+            if (from == 0 && take == bh.raw_size) {
+                // Block fully inside the range: decode in place.
+                int res = zxc_decompress_chunk_wrapper(&ctx, ip, rem_src, op + written, take);
+                if (UNLIKELY(res < 0 || (size_t)res != take)) goto error;
+            } else {
+                // Partial block: decode into scratch and copy the requested slice.
+                if (scratch_cap < bh.raw_size) {
+                    free(scratch);
+                    scratch_cap = bh.raw_size > fh.block_size ? bh.raw_size : fh.block_size;
+                    scratch = malloc(scratch_cap + ZXC_PAD_SIZE);
+                    if (UNLIKELY(!scratch)) goto error;
+                }
+                int res = zxc_decompress_chunk_wrapper(&ctx, ip, rem_src, scratch, bh.raw_size);
+                if (UNLIKELY(res < 0 || (size_t)res != bh.raw_size)) goto error;
+                ZXC_MEMCPY(op + written, scratch + from, take);
+            }
+            written += take;
+        }
+
+        block_raw = block_end;
+        ip += total_block_sz;
+    }
+
+    free(scratch);
+    zxc_cctx_free(&ctx);
+    return written;
+
+error:
+    free(scratch);
+    zxc_cctx_free(&ctx);
+    return 0;
+}
+
+/*
+ * ============================================================================
+ * REUSABLE CONTEXTS
+ * ============================================================================
+ * Opaque wrappers around zxc_cctx_t that keep the working memory alive between
+ * calls. The compressor's epoch scheme invalidates the hash table lazily, so a
+ * reused context costs no allocation and no table reset per call.
+ */
+
+struct zxc_cctx_s {
+    zxc_cctx_t ctx;  // Working memory, allocated on first use
+};
+
+struct zxc_dctx_s {
+    zxc_cctx_t ctx;  // Scratch state (RLE literal buffer), grown on demand
+    int is_static;   // Lives in caller memory (zxc_init_static_dctx())
+};
+
+// cppcheck-suppress unusedFunction
+zxc_cctx* zxc_create_cctx(void) {
+    zxc_cctx* cctx = calloc(1, sizeof(zxc_cctx));
+    return cctx;
+}
+
+// cppcheck-suppress unusedFunction
+void zxc_free_cctx(zxc_cctx* cctx) {
+    if (!cctx) return;
+    zxc_cctx_free(&cctx->ctx);
+    free(cctx);
+}
+
+// cppcheck-suppress unusedFunction
+size_t zxc_compress_cctx(zxc_cctx* cctx, const void* src, size_t src_size, void* dst,
+                         size_t dst_capacity, const zxc_compress_opts_t* opts) {
+    return zxc_compress_dict(cctx, src, src_size, dst, dst_capacity, opts, NULL);
+}
+
+// cppcheck-suppress unusedFunction
+size_t zxc_compress_dict(zxc_cctx* cctx, const void* src, size_t src_size, void* dst,
+                         size_t dst_capacity, const zxc_compress_opts_t* opts,
+                         const zxc_dict* dict) {
+    if (UNLIKELY(!cctx || !src || !dst || src_size == 0 || dst_capacity == 0)) return 0;
+
+    // Grow to the size class of this input if needed; never shrink, so a context
+    // settles on the largest message it has seen.
+    size_t block_size = zxc_resolve_block_size(opts ? opts->block_size : 0);
+    if (UNLIKELY(block_size == 0)) return 0;
+
+    size_t chunk_size = zxc_cctx_chunk_size(src_size, block_size);
+    if (!cctx->ctx.memory_block || cctx->ctx.chunk_size < chunk_size) {
+        zxc_cctx_free(&cctx->ctx);
+        if (zxc_cctx_init(&cctx->ctx, chunk_size, 1, 0, 0) != 0) {
+            zxc_cctx_free(&cctx->ctx);
+            return 0;
+        }
+    }
+    return zxc_compress_frame(&cctx->ctx, block_size, src, src_size, dst, dst_capacity, opts,
+                              dict);
+}
+
+// cppcheck-suppress unusedFunction
+zxc_dctx* zxc_create_dctx(void) {
+    zxc_dctx* dctx = calloc(1, sizeof(zxc_dctx));
+    return dctx;
+}
+
+// cppcheck-suppress unusedFunction
+void zxc_free_dctx(zxc_dctx* dctx) {
+    if (!dctx || dctx->is_static) return;
+    zxc_cctx_free(&dctx->ctx);
+    free(dctx);
+}
+
+// cppcheck-suppress unusedFunction
+size_t zxc_decompress_dctx(zxc_dctx* dctx, const void* src, size_t src_size, void* dst,
+                           size_t dst_capacity, int checksum_enabled) {
+    return zxc_decompress_dict(dctx, src, src_size, dst, dst_capacity, checksum_enabled, NULL);
+}
+
+// cppcheck-suppress unusedFunction
+size_t zxc_decompress_dict(zxc_dctx* dctx, const void* src, size_t src_size, void* dst,
+                           size_t dst_capacity, int checksum_enabled, const zxc_dict* dict) {
+    if (UNLIKELY(!dctx || !src || !dst || src_size < ZXC_FILE_HEADER_SIZE)) return 0;
+    return zxc_decompress_frame(&dctx->ctx, src, src_size, dst, dst_capacity, checksum_enabled,
+                                dict, 0);
+}
+
+/*
+ * ============================================================================
+ * STATIC CONTEXTS AND IN-PLACE DECOMPRESSION
+ * ============================================================================
+ * A static context is a zxc_dctx whose scratch buffers are carved out of the
+ * caller's workspace: the decoder needs at most 2 * block bytes of literal and
+ * token scratch and one block of unshuffle scratch, and the link to the
+ * previous block is a view that owns nothing. fixed_scratch makes the decoder
+ * fail a block instead of growing a buffer.
+ */
+
+#define ZXC_WS_ALIGN(n) (((n) + ZXC_ALIGNMENT_MASK) & ~(size_t)ZXC_ALIGNMENT_MASK)
+
+// cppcheck-suppress unusedFunction
+size_t zxc_static_dctx_size(size_t max_block_size) {
+    if (UNLIKELY(max_block_size == 0 || max_block_size > ZXC_BLOCK_SIZE_MAX)) return 0;
+    return ZXC_STATIC_DCTX_SIZE(max_block_size);
+}
+
+// cppcheck-suppress unusedFunction
+zxc_dctx* zxc_init_static_dctx(void* workspace, size_t workspace_size, size_t max_block_size) {
+    const size_t need = zxc_static_dctx_size(max_block_size);
+    if (UNLIKELY(!workspace || need == 0 || workspace_size < need)) return NULL;
+
+    // [alignment][dctx][link][literals + tokens + 2 pads][shuffle + pad]
+    const size_t skew = (size_t)(-(uintptr_t)workspace) & ZXC_ALIGNMENT_MASK;
+    const size_t fixed = skew + ZXC_WS_ALIGN(sizeof(zxc_dctx)) + ZXC_WS_ALIGN(sizeof(zxc_dict)) +
+                         3 * ZXC_PAD_SIZE;
+    if (UNLIKELY(fixed > ZXC_STATIC_DCTX_OVERHEAD)) return NULL;
+
+    uint8_t* p = (uint8_t*)workspace + skew;
+    zxc_dctx* dctx = (zxc_dctx*)p;
+    p += ZXC_WS_ALIGN(sizeof(zxc_dctx));
+    zxc_dict* link = (zxc_dict*)p;
+    p += ZXC_WS_ALIGN(sizeof(zxc_dict));
+
+    ZXC_MEMSET(dctx, 0, sizeof(zxc_dctx));
+    ZXC_MEMSET(link, 0, sizeof(zxc_dict));
+    zxc_cctx_init(&dctx->ctx, 0, 0, 0, 0);  // Mode 0 never allocates
+    dctx->is_static = 1;
+    dctx->ctx.fixed_scratch = 1;
+    dctx->ctx.link = link;
+    dctx->ctx.lit_buffer = p;
+    dctx->ctx.lit_buffer_cap = 2 * max_block_size + 2 * ZXC_PAD_SIZE;
+    p += dctx->ctx.lit_buffer_cap;
+    dctx->ctx.shuffle_buf = p;
+    dctx->ctx.shuffle_buf_cap = max_block_size;  // Followed by ZXC_PAD_SIZE bytes of slack
+    return dctx;
+}
+
+// cppcheck-suppress unusedFunction
+size_t zxc_in_place_bound(size_t decompressed_size, size_t block_size) {
+    block_size = zxc_resolve_block_size(block_size);
+    if (UNLIKELY(block_size == 0 || decompressed_size > SIZE_MAX / 2 - block_size)) return 0;
+
+    // Block i is decoded into the bytes between the output and its own header.
+    // Every block ahead of it is at most its raw size plus header and checksum,
+    // so a buffer holding the data, the largest block (plus padding), those
+    // expansions and the trailing seek table and digest always leaves room.
+    size_t n = (decompressed_size + block_size - 1) / block_size;
+    if (n == 0) n = 1;
+    const size_t largest = decompressed_size < block_size ? decompressed_size : block_size;
+    return decompressed_size + largest + ZXC_PAD_SIZE + ZXC_FILE_HEADER_MAX_SIZE +
+           n * (ZXC_BLOCK_HEADER_SIZE + ZXC_BLOCK_CHECKSUM_SIZE + ZXC_SEEK_ENTRY_SIZE) +
+           ZXC_BLOCK_HEADER_SIZE + ZXC_SEEK_TRAILER_SIZE + ZXC_DIGEST_BLOCK_SIZE;
+}
+
+// cppcheck-suppress unusedFunction
+size_t zxc_decompress_in_place(zxc_dctx* dctx, void* buf, size_t buf_capacity, size_t src_size,
+                               int checksum_enabled) {
+    if (UNLIKELY(!buf || src_size < ZXC_FILE_HEADER_SIZE || src_size > buf_capacity)) return 0;
+
+    const uint8_t* src = (const uint8_t*)buf + (buf_capacity - src_size);
+    if (dctx)
+        return zxc_decompress_frame(&dctx->ctx, src, src_size, buf, buf_capacity,
+                                    checksum_enabled, NULL, 1);
+
+    zxc_cctx_t ctx;
+    if (zxc_cctx_init(&ctx, 0, 0, 0, checksum_enabled) != 0) return 0;
+    size_t res =
+        zxc_decompress_frame(&ctx, src, src_size, buf, buf_capacity, checksum_enabled, NULL, 1);
+    zxc_cctx_free(&ctx);
+    return res;
+}
@@ -11,6 +11,7 @@
 #include <stdio.h>
 
 #include "../../include/zxc_buffer.h"
+#include "../../include/zxc_pool.h"
 #include "../../include/zxc_sans_io.h"
 #include "../../include/zxc_stream.h"
 #include "zxc_internal.h"
@@ -90,8 +91,783 @@ static int pthread_join(pthread_t thread, void** retval) {
 #define _SC_NPROCESSORS_ONLN 0
 
 #else
+#include <errno.h>
+#include <fcntl.h>
 #include <pthread.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
+
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+// Regular input files are mapped, and decompressed with positional writes.
+#if !defined(ZXC_DISABLE_MMAP) && defined(MAP_ANONYMOUS)
+#define ZXC_STREAM_MMAP 1
+#endif
+
+// Linux: ordered writes to regular files go through io_uring, several at once.
+#if defined(__linux__) && !defined(ZXC_DISABLE_URING) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define ZXC_STREAM_URING 1
+#endif
+#endif
+#endif
+#endif
+
+/*
+ * ============================================================================
+ * ATOMIC HELPERS
+ * ============================================================================
+ * Sequentially consistent load / store / fetch-add / compare-and-swap used by
+ * the lock-free job hand-off. C11 atomics when available, compiler intrinsics otherwise.
+ */
+#if ZXC_USE_C11_ATOMICS
+#define ZXC_ATOMIC_LOAD(p) atomic_load(p)
+#define ZXC_ATOMIC_STORE(p, v) atomic_store((p), (v))
+#define ZXC_ATOMIC_FETCH_ADD(p, v) atomic_fetch_add((p), (v))
+#define ZXC_ATOMIC_CAS(p, expected, desired) \
+    atomic_compare_exchange_strong((p), &(int64_t){(expected)}, (desired))
+#elif defined(_MSC_VER)
+#define ZXC_ATOMIC_LOAD(p) (*(p))
+#define ZXC_ATOMIC_STORE(p, v) (*(p) = (v), MemoryBarrier())
+#define ZXC_ATOMIC_FETCH_ADD(p, v) _InterlockedExchangeAdd64((volatile __int64*)(p), (v))
+#define ZXC_ATOMIC_CAS(p, expected, desired)                                           \
+    (_InterlockedCompareExchange64((volatile __int64*)(p), (desired), (expected)) == \
+     (expected))
+#else
+#define ZXC_ATOMIC_LOAD(p) __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define ZXC_ATOMIC_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+#define ZXC_ATOMIC_FETCH_ADD(p, v) __atomic_fetch_add((p), (v), __ATOMIC_SEQ_CST)
+#define ZXC_ATOMIC_CAS(p, expected, desired)                                    \
+    __atomic_compare_exchange_n((p), &(int64_t){(expected)}, (desired), 0, \
+                                __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
+#endif
+
+// Spin-wait hint: lets the sibling hyper-thread run while we poll.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ZXC_CPU_RELAX() _mm_pause()
+#elif (defined(__aarch64__) || defined(__arm__)) && defined(__GNUC__)
+#define ZXC_CPU_RELAX() __asm__ __volatile__("yield" ::: "memory")
+#else
+#define ZXC_CPU_RELAX() ((void)0)
+#endif
+
+// Polls before a waiting thread parks on its slot's condition variable. A few
+// thousand pause cycles are well below the time needed to process one block.
+// Spinning is disabled when there are more threads than online processors.
+#define ZXC_SPIN_COUNT 1024
+
+#if defined(ZXC_STREAM_MMAP) || defined(ZXC_STREAM_URING)
+/**
+ * @brief Writes @p len bytes at file offset @p off, retrying short writes.
+ *
+ * @param[in] fd  Destination file descriptor.
+ * @param[in] buf Data to write.
+ * @param[in] len Number of bytes.
+ * @param[in] off Absolute file offset.
+ * @return 0 on success, -1 on I/O error.
+ */
+static int zxc_pwrite_all(int fd, const uint8_t* buf, size_t len, int64_t off) {
+    while (len > 0) {
+        ssize_t n = pwrite(fd, buf, len, (off_t)off);
+        if (n < 0 && errno == EINTR) continue;
+        if (UNLIKELY(n <= 0)) return -1;
+        buf += n;
+        len -= (size_t)n;
+        off += n;
+    }
+    return 0;
+}
+#endif
+
+/*
+ * ============================================================================
+ * ENGINE FLAGS
+ * ============================================================================
+ */
+
+static ZXC_ATOMIC unsigned zxc_stream_flags = 0;
+
+// cppcheck-suppress unusedFunction
+void zxc_stream_set_flags(unsigned flags) { ZXC_ATOMIC_STORE(&zxc_stream_flags, flags); }
+
+// cppcheck-suppress unusedFunction
+unsigned zxc_stream_get_flags(void) { return ZXC_ATOMIC_LOAD(&zxc_stream_flags); }
+
+/**
+ * @brief Pins a freshly started worker to one CPU when
+ * `ZXC_STREAM_PIN_THREADS` is set.
+ *
+ * Workers are spread over the CPUs the process may run on, in order, so
+ * worker @p index lands on the `index`-th allowed CPU (wrapping around).
+ * Failures are ignored: pinning is a hint. No-op outside Linux.
+ *
+ * @param[in] th    Worker thread.
+ * @param[in] index Rank of the worker among its siblings.
+ */
+static void zxc_pin_thread(pthread_t th, int index) {
+#if defined(__linux__) && defined(CPU_SET)
+    if (!(zxc_stream_get_flags() & ZXC_STREAM_PIN_THREADS)) return;
+    cpu_set_t allowed, one;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return;
+    int n = CPU_COUNT(&allowed);
+    if (n <= 0) return;
+    int want = index % n;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &allowed) || want-- > 0) continue;
+        CPU_ZERO(&one);
+        CPU_SET(cpu, &one);
+        pthread_setaffinity_np(th, sizeof(one), &one);
+        return;
+    }
+#else
+    (void)th;
+    (void)index;
+#endif
+}
+
+/*
+ * ============================================================================
+ * THREAD POOL
+ * ============================================================================
+ * Long-lived workers shared by any number of concurrent calls (see
+ * zxc_pool.h). A call attaches a *run* to the pool: a step function that
+ * processes at most one block of that call. Workers walk the list of runs
+ * round-robin, one step each, so every call gets its share of the threads;
+ * the calling thread steps its own run too instead of waiting idle. When a
+ * full pass finds nothing to do, a worker sleeps until a call reports new
+ * work (`zxc_pool_notify()`).
+ */
+
+/** Number of ring buffers a pool keeps around for later stream calls. */
+#define ZXC_POOL_MEM_CACHE 8
+
+typedef struct zxc_pool_slot_s zxc_pool_slot_t;
+typedef struct zxc_pool_run_s zxc_pool_run_t;
+
+/**
+ * @struct zxc_pool_slot_s
+ * @brief Per-thread state of a pool: a context kept across calls.
+ *
+ * @var zxc_pool_slot_s::cctx
+ *      Context, valid when `ready` is set.
+ * @var zxc_pool_slot_s::ready
+ *      `cctx` has been initialized for `chunk_size` and `mode`.
+ * @var zxc_pool_slot_s::chunk_size
+ *      Block size `cctx` was built for.
+ * @var zxc_pool_slot_s::mode
+ *      Mode `cctx` was built for (1 = compression, 0 = decompression).
+ * @var zxc_pool_slot_s::scratch
+ *      Private output buffer of positional decompression (grown on demand).
+ * @var zxc_pool_slot_s::scratch_cap
+ *      Capacity of `scratch`.
+ * @var zxc_pool_slot_s::frame_cctx
+ *      Whole-frame context for the small inputs of a batch call (created on
+ * first use).
+ * @var zxc_pool_slot_s::pool
+ *      Owning pool (worker slots only).
+ * @var zxc_pool_slot_s::next
+ *      Next spare slot (caller slots only).
+ */
+struct zxc_pool_slot_s {
+    zxc_cctx_t cctx;
+    int ready;
+    size_t chunk_size;
+    int mode;
+    uint8_t* scratch;
+    size_t scratch_cap;
+    zxc_cctx* frame_cctx;
+    zxc_pool_t* pool;
+    zxc_pool_slot_t* next;
+};
+
+/**
+ * @struct zxc_pool_run_s
+ * @brief One call executing on a pool.
+ *
+ * @var zxc_pool_run_s::step
+ *      Processes at most one block of the call with the context of @p slot.
+ * Returns 1 if it did (or may soon find) something to do, 0 if the run has
+ * no work ready right now. Called concurrently from several threads.
+ * @var zxc_pool_run_s::arg
+ *      Call state passed to `step`.
+ * @var zxc_pool_run_s::next
+ *      Next run in the pool's circular list.
+ * @var zxc_pool_run_s::prev
+ *      Previous run in the pool's circular list.
+ * @var zxc_pool_run_s::busy
+ *      Number of workers inside `step` (protected by the pool lock).
+ */
+struct zxc_pool_run_s {
+    int (*step)(zxc_pool_run_t* run, zxc_pool_slot_t* slot);
+    void* arg;
+    zxc_pool_run_t* next;
+    zxc_pool_run_t* prev;
+    int busy;
+};
+
+/**
+ * @struct zxc_pool_s
+ * @brief Shared thread pool.
+ *
+ * @var zxc_pool_s::lock
+ *      Protects every field below except `threads` and `n_threads`.
+ * @var zxc_pool_s::work_cond
+ *      Idle workers sleep on it.
+ * @var zxc_pool_s::idle_cond
+ *      Signaled when a worker leaves a run (for `zxc_pool_detach()`).
+ * @var zxc_pool_s::threads
+ *      Worker threads.
+ * @var zxc_pool_s::slots
+ *      One slot per worker.
+ * @var zxc_pool_s::n_threads
+ *      Number of workers.
+ * @var zxc_pool_s::runs
+ *      Round-robin cursor into the circular list of attached runs (NULL when
+ * there is none).
+ * @var zxc_pool_s::n_runs
+ *      Number of attached runs.
+ * @var zxc_pool_s::epoch
+ *      Bumped by every `zxc_pool_notify()`; a worker only sleeps if it did not
+ * change during its last fruitless pass.
+ * @var zxc_pool_s::sleepers
+ *      Number of workers waiting on `work_cond`.
+ * @var zxc_pool_s::shutdown
+ *      Set by `zxc_pool_free()`.
+ * @var zxc_pool_s::spare
+ *      Slots of calling threads, kept for the next calls.
+ * @var zxc_pool_s::mem
+ *      Ring buffers of finished stream calls.
+ * @var zxc_pool_s::mem_size
+ *      Size of each block of `mem` (0 = empty entry).
+ */
+struct zxc_pool_s {
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;
+    pthread_cond_t idle_cond;
+    pthread_t* threads;
+    zxc_pool_slot_t* slots;
+    int n_threads;
+    zxc_pool_run_t* runs;
+    int n_runs;
+    int64_t epoch;
+    int sleepers;
+    int shutdown;
+    zxc_pool_slot_t* spare;
+    void* mem[ZXC_POOL_MEM_CACHE];
+    size_t mem_size[ZXC_POOL_MEM_CACHE];
+};
+
+/**
+ * @brief Returns the context of @p slot set up for a run, rebuilding it only
+ * when the block size or the mode differs from the previous run.
+ *
+ * @param[in,out] slot       Thread slot.
+ * @param[in]     chunk_size Block size of the run.
+ * @param[in]     mode       1 for compression, 0 for decompression.
+ * @param[in]     level      Compression level.
+ * @param[in]     checksum_enabled Checksum flag of the run.
+ * @return The context, or NULL on allocation failure.
+ */
+static zxc_cctx_t* zxc_pool_slot_cctx(zxc_pool_slot_t* slot, size_t chunk_size, int mode,
+                                      int level, int checksum_enabled) {
+    if (!slot->ready || slot->chunk_size != chunk_size || slot->mode != mode) {
+        if (slot->ready) zxc_cctx_free(&slot->cctx);
+        slot->ready = 0;
+        if (zxc_cctx_init(&slot->cctx, chunk_size, mode, level, checksum_enabled) != 0) {
+            zxc_cctx_free(&slot->cctx);
+            return NULL;
+        }
+        slot->ready = 1;
+        slot->chunk_size = chunk_size;
+        slot->mode = mode;
+    }
+    slot->cctx.compression_level = level;
+    slot->cctx.checksum_enabled = checksum_enabled;
+    return &slot->cctx;
+}
+
+/**
+ * @brief Returns the scratch buffer of @p slot, grown to at least @p size
+ * bytes.
+ *
+ * @param[in,out] slot Thread slot.
+ * @param[in]     size Bytes needed.
+ * @return The buffer, or NULL on allocation failure.
+ */
+static uint8_t* zxc_pool_slot_scratch(zxc_pool_slot_t* slot, size_t size) {
+    if (slot->scratch_cap < size) {
+        free(slot->scratch);
+        slot->scratch = malloc(size);
+        slot->scratch_cap = slot->scratch ? size : 0;
+    }
+    return slot->scratch;
+}
+
+/**
+ * @brief Releases what a slot holds (not the slot itself).
+ *
+ * @param[in,out] slot Thread slot.
+ */
+static void zxc_pool_slot_free(zxc_pool_slot_t* slot) {
+    if (slot->ready) zxc_cctx_free(&slot->cctx);
+    slot->ready = 0;
+    free(slot->scratch);
+    slot->scratch = NULL;
+    slot->scratch_cap = 0;
+    zxc_free_cctx(slot->frame_cctx);
+    slot->frame_cctx = NULL;
+}
+
+/**
+ * @brief Main loop of a pool worker.
+ *
+ * @param[in] arg The worker's `zxc_pool_slot_t`.
+ * @return Always returns NULL.
+ */
+static void* zxc_pool_worker(void* arg) {
+    zxc_pool_slot_t* slot = (zxc_pool_slot_t*)arg;
+    zxc_pool_t* pool = slot->pool;
+    zxc_perf_enter_worker();
+
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->shutdown) {
+        const int64_t epoch = pool->epoch;
+        int did_work = 0;
+        // One pass: as many steps as there are runs, each on the run under the
+        // shared cursor, which then moves on.
+        for (int k = 0; k < pool->n_runs && !pool->shutdown; k++) {
+            zxc_pool_run_t* run = pool->runs;
+            pool->runs = run->next;
+            run->busy++;
+            pthread_mutex_unlock(&pool->lock);
+            did_work |= run->step(run, slot);
+            pthread_mutex_lock(&pool->lock);
+            if (--run->busy == 0) pthread_cond_broadcast(&pool->idle_cond);
+        }
+        if (!did_work && pool->epoch == epoch && !pool->shutdown) {
+            pool->sleepers++;
+            pthread_cond_wait(&pool->work_cond, &pool->lock);
+            pool->sleepers--;
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+/**
+ * @brief Tells the workers that a run has new work.
+ *
+ * @param[in,out] pool Pool.
+ * @param[in]     all  Wake every sleeping worker instead of one.
+ */
+static void zxc_pool_notify(zxc_pool_t* pool, int all) {
+    pthread_mutex_lock(&pool->lock);
+    pool->epoch++;
+    if (pool->sleepers > 0) {
+        if (all)
+            pthread_cond_broadcast(&pool->work_cond);
+        else
+            pthread_cond_signal(&pool->work_cond);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * @brief Adds a run to the pool and wakes the workers.
+ *
+ * @param[in,out] pool Pool.
+ * @param[in,out] run  Run, with `step` and `arg` set.
+ */
+static void zxc_pool_attach(zxc_pool_t* pool, zxc_pool_run_t* run) {
+    pthread_mutex_lock(&pool->lock);
+    run->busy = 0;
+    if (pool->runs) {
+        // Just behind the cursor: every attached run gets a step before it.
+        run->next = pool->runs;
+        run->prev = pool->runs->prev;
+        run->prev->next = run;
+        run->next->prev = run;
+    } else {
+        run->next = run->prev = run;
+        pool->runs = run;
+    }
+    pool->n_runs++;
+    pthread_mutex_unlock(&pool->lock);
+    zxc_pool_notify(pool, 1);
+}
+
+/**
+ * @brief Removes a run from the pool and waits until no worker is inside its
+ * step function anymore.
+ *
+ * @param[in,out] pool Pool.
+ * @param[in,out] run  Attached run.
+ */
+static void zxc_pool_detach(zxc_pool_t* pool, zxc_pool_run_t* run) {
+    pthread_mutex_lock(&pool->lock);
+    if (run->next == run) {
+        pool->runs = NULL;
+    } else {
+        run->prev->next = run->next;
+        run->next->prev = run->prev;
+        if (pool->runs == run) pool->runs = run->next;
+    }
+    pool->n_runs--;
+    while (run->busy > 0) pthread_cond_wait(&pool->idle_cond, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * @brief Hands a slot to a calling thread, reusing a spare one if possible.
+ *
+ * @param[in,out] pool Pool.
+ * @return The slot, or NULL on allocation failure.
+ */
+static zxc_pool_slot_t* zxc_pool_borrow(zxc_pool_t* pool) {
+    pthread_mutex_lock(&pool->lock);
+    zxc_pool_slot_t* slot = pool->spare;
+    if (slot) pool->spare = slot->next;
+    pthread_mutex_unlock(&pool->lock);
+    if (!slot) slot = calloc(1, sizeof(*slot));
+    return slot;
+}
+
+/**
+ * @brief Gives a slot from zxc_pool_borrow() back to the pool.
+ *
+ * @param[in,out] pool Pool.
+ * @param[in]     slot Slot (NULL is ignored).
+ */
+static void zxc_pool_return(zxc_pool_t* pool, zxc_pool_slot_t* slot) {
+    if (!slot) return;
+    pthread_mutex_lock(&pool->lock);
+    slot->next = pool->spare;
+    pool->spare = slot;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * @brief Returns an aligned block of @p size bytes, reusing one a previous
+ * call gave back when the size matches.
+ *
+ * A fresh block is zeroed; a reused one holds whatever the previous call left
+ * in it.
+ *
+ * @param[in,out] pool Pool, or NULL to always allocate.
+ * @param[in]     size Bytes needed.
+ * @return The block, or NULL on allocation failure.
+ */
+static void* zxc_pool_get_mem(zxc_pool_t* pool, size_t size) {
+    void* p = NULL;
+    if (pool) {
+        pthread_mutex_lock(&pool->lock);
+        for (int i = 0; i < ZXC_POOL_MEM_CACHE; i++) {
+            if (pool->mem_size[i] == size) {
+                p = pool->mem[i];
+                pool->mem[i] = NULL;
+                pool->mem_size[i] = 0;
+                break;
+            }
+        }
+        pthread_mutex_unlock(&pool->lock);
+        if (p) return p;
+    }
+    p = zxc_aligned_malloc(size, ZXC_CACHE_LINE_SIZE);
+    if (LIKELY(p)) ZXC_MEMSET(p, 0, size);
+    return p;
+}
+
+/**
+ * @brief Releases a block from zxc_pool_get_mem(), keeping it in the pool's
+ * cache when there is room (evicting the oldest entry otherwise).
+ *
+ * @param[in,out] pool Pool, or NULL to free the block.
+ * @param[in]     p    Block (NULL is ignored).
+ * @param[in]     size Size given to zxc_pool_get_mem().
+ */
+static void zxc_pool_put_mem(zxc_pool_t* pool, void* p, size_t size) {
+    if (!p) return;
+    if (pool) {
+        void* evicted;
+        pthread_mutex_lock(&pool->lock);
+        int i = 0;
+        while (i < ZXC_POOL_MEM_CACHE - 1 && pool->mem_size[i] != 0) i++;
+        evicted = pool->mem[i];
+        // Shift so that entry 0 is always the most recent one.
+        for (; i > 0; i--) {
+            pool->mem[i] = pool->mem[i - 1];
+            pool->mem_size[i] = pool->mem_size[i - 1];
+        }
+        pool->mem[0] = p;
+        pool->mem_size[0] = size;
+        pthread_mutex_unlock(&pool->lock);
+        p = evicted;
+    }
+    zxc_aligned_free(p);
+}
+
+// cppcheck-suppress unusedFunction
+zxc_pool_t* zxc_pool_create(int n_threads) {
+    int n = (n_threads > 0) ? n_threads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1) n = 1;
+
+    zxc_pool_t* pool = calloc(1, sizeof(*pool));
+    if (UNLIKELY(!pool)) return NULL;
+    pool->threads = malloc((size_t)n * sizeof(pthread_t));
+    pool->slots = calloc((size_t)n, sizeof(zxc_pool_slot_t));
+    if (UNLIKELY(!pool->threads || !pool->slots)) {
+        free(pool->threads);
+        free(pool->slots);
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    pthread_cond_init(&pool->idle_cond, NULL);
+
+    for (int i = 0; i < n; i++) {
+        pool->slots[i].pool = pool;
+        if (pthread_create(&pool->threads[i], NULL, zxc_pool_worker, &pool->slots[i]) != 0) break;
+        zxc_pin_thread(pool->threads[i], i);
+        pool->n_threads++;
+    }
+    if (UNLIKELY(pool->n_threads == 0)) {
+        zxc_pool_free(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+// cppcheck-suppress unusedFunction
+void zxc_pool_free(zxc_pool_t* pool) {
+    if (!pool) return;
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->n_threads; i++) pthread_join(pool->threads[i], NULL);
+
+    for (int i = 0; i < pool->n_threads; i++) zxc_pool_slot_free(&pool->slots[i]);
+    while (pool->spare) {
+        zxc_pool_slot_t* slot = pool->spare;
+        pool->spare = slot->next;
+        zxc_pool_slot_free(slot);
+        free(slot);
+    }
+    for (int i = 0; i < ZXC_POOL_MEM_CACHE; i++) zxc_aligned_free(pool->mem[i]);
+
+    pthread_cond_destroy(&pool->idle_cond);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->slots);
+    free(pool->threads);
+    free(pool);
+}
+
+// cppcheck-suppress unusedFunction
+int zxc_pool_size(const zxc_pool_t* pool) { return pool->n_threads; }
+
+#ifdef ZXC_STREAM_URING
+/*
+ * ============================================================================
+ * IO_URING (Linux)
+ * ============================================================================
+ * A minimal submission/completion ring over the raw system calls, used by the
+ * writer thread only: it queues each block as a write at its final offset and
+ * moves on, so the disk sees several requests at once instead of one `fwrite`
+ * at a time. The ring is private to one thread; the kernel is the only other
+ * party, hence the acquire/release accesses on the shared head/tail indices.
+ */
+
+/**
+ * @struct zxc_uring_t
+ * @brief Mapped io_uring instance.
+ *
+ * @var zxc_uring_t::fd
+ *      Ring file descriptor (-1 when not set up).
+ * @var zxc_uring_t::sq_head
+ *      Submission queue head, advanced by the kernel.
+ * @var zxc_uring_t::sq_tail
+ *      Submission queue tail, advanced by us.
+ * @var zxc_uring_t::sq_mask
+ *      Index mask of the submission queue.
+ * @var zxc_uring_t::sq_array
+ *      Indirection array from queue slots to `sqes`.
+ * @var zxc_uring_t::sqes
+ *      Submission queue entries.
+ * @var zxc_uring_t::cq_head
+ *      Completion queue head, advanced by us.
+ * @var zxc_uring_t::cq_tail
+ *      Completion queue tail, advanced by the kernel.
+ * @var zxc_uring_t::cq_mask
+ *      Index mask of the completion queue.
+ * @var zxc_uring_t::cqes
+ *      Completion queue entries.
+ * @var zxc_uring_t::sq_map
+ *      Mapping holding the submission ring (and the completion ring when the
+ * kernel supports a single mapping).
+ * @var zxc_uring_t::sq_map_len
+ *      Length of `sq_map`.
+ * @var zxc_uring_t::cq_map
+ *      Mapping holding the completion ring (may equal `sq_map`).
+ * @var zxc_uring_t::cq_map_len
+ *      Length of `cq_map`.
+ * @var zxc_uring_t::sqes_len
+ *      Length of the `sqes` mapping.
+ * @var zxc_uring_t::entries
+ *      Submission queue size.
+ */
+typedef struct {
+    int fd;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    struct io_uring_sqe* sqes;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_cqe* cqes;
+    void* sq_map;
+    size_t sq_map_len;
+    void* cq_map;
+    size_t cq_map_len;
+    size_t sqes_len;
+    unsigned entries;
+} zxc_uring_t;
+
+/**
+ * @brief Creates a ring of at least @p depth entries.
+ *
+ * @param[out] r     Ring to set up.
+ * @param[in]  depth Number of requests that may be in flight.
+ * @return 0 on success, -1 if io_uring is unavailable (old kernel, seccomp
+ * filter, sysctl); the caller then falls back to stdio.
+ */
+static int zxc_uring_init(zxc_uring_t* r, unsigned depth) {
+    struct io_uring_params p;
+    ZXC_MEMSET(r, 0, sizeof(*r));
+    ZXC_MEMSET(&p, 0, sizeof(p));
+    r->fd = (int)syscall(__NR_io_uring_setup, depth, &p);
+    if (r->fd < 0) return -1;
+
+    r->sq_map_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_map_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    int single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single && r->cq_map_len > r->sq_map_len) r->sq_map_len = r->cq_map_len;
+
+    r->sq_map = mmap(NULL, r->sq_map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     r->fd, IORING_OFF_SQ_RING);
+    if (r->sq_map == MAP_FAILED) goto fail_fd;
+    r->cq_map = single ? r->sq_map
+                       : mmap(NULL, r->cq_map_len, PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_CQ_RING);
+    if (r->cq_map == MAP_FAILED) goto fail_sq;
+    r->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = mmap(NULL, r->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd,
+                   IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED) goto fail_cq;
+
+    uint8_t* sq = (uint8_t*)r->sq_map;
+    uint8_t* cq = (uint8_t*)r->cq_map;
+    r->sq_head = (unsigned*)(sq + p.sq_off.head);
+    r->sq_tail = (unsigned*)(sq + p.sq_off.tail);
+    r->sq_mask = (unsigned*)(sq + p.sq_off.ring_mask);
+    r->sq_array = (unsigned*)(sq + p.sq_off.array);
+    r->cq_head = (unsigned*)(cq + p.cq_off.head);
+    r->cq_tail = (unsigned*)(cq + p.cq_off.tail);
+    r->cq_mask = (unsigned*)(cq + p.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+    r->entries = p.sq_entries;
+    return 0;
+
+fail_cq:
+    if (!single) munmap(r->cq_map, r->cq_map_len);
+fail_sq:
+    munmap(r->sq_map, r->sq_map_len);
+fail_fd:
+    close(r->fd);
+    r->fd = -1;
+    return -1;
+}
+
+/**
+ * @brief Tears down a ring set up by zxc_uring_init().
+ *
+ * @param[in,out] r Ring (every request must have completed).
+ */
+static void zxc_uring_free(zxc_uring_t* r) {
+    if (r->fd < 0) return;
+    munmap(r->sqes, r->sqes_len);
+    if (r->cq_map != r->sq_map) munmap(r->cq_map, r->cq_map_len);
+    munmap(r->sq_map, r->sq_map_len);
+    close(r->fd);
+    r->fd = -1;
+}
+
+/**
+ * @brief Queues and submits one write of @p len bytes at offset @p off.
+ *
+ * @param[in,out] r         Ring with a free submission entry (callers keep at
+ * most `entries` requests in flight).
+ * @param[in]     fd        Destination file descriptor.
+ * @param[in]     buf       Data; must stay valid until the completion.
+ * @param[in]     len       Number of bytes.
+ * @param[in]     off       Absolute file offset.
+ * @param[in]     user_data Tag returned with the completion.
+ * @return 0 on success, -1 if the kernel refused the submission.
+ */
+static int zxc_uring_write(zxc_uring_t* r, int fd, const void* buf, size_t len, int64_t off,
+                           uint64_t user_data) {
+    unsigned tail = *r->sq_tail;
+    unsigned idx = tail & *r->sq_mask;
+    struct io_uring_sqe* sqe = &r->sqes[idx];
+    ZXC_MEMSET(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)buf;
+    sqe->len = (uint32_t)len;
+    sqe->off = (uint64_t)off;
+    sqe->user_data = user_data;
+    r->sq_array[idx] = idx;
+    __atomic_store_n(r->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    for (;;) {
+        long n = syscall(__NR_io_uring_enter, r->fd, 1, 0, 0, NULL, 0);
+        if (n == 1) return 0;
+        if (n < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+        return -1;
+    }
+}
+
+/**
+ * @brief Takes the next completion, waiting for one if @p wait is set.
+ *
+ * @param[in,out] r         Ring.
+ * @param[in]     wait      Block until a completion is available.
+ * @param[out]    user_data Tag of the completed request.
+ * @param[out]    res       Result of the request (bytes written or -errno).
+ * @return 1 if a completion was taken, 0 if none was ready, -1 on error.
+ */
+static int zxc_uring_reap(zxc_uring_t* r, int wait, uint64_t* user_data, int32_t* res) {
+    for (;;) {
+        unsigned head = *r->cq_head;
+        if (head != __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE)) {
+            const struct io_uring_cqe* cqe = &r->cqes[head & *r->cq_mask];
+            *user_data = cqe->user_data;
+            *res = cqe->res;
+            __atomic_store_n(r->cq_head, head + 1, __ATOMIC_RELEASE);
+            return 1;
+        }
+        if (!wait) return 0;
+        long n = syscall(__NR_io_uring_enter, r->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (n < 0 && errno != EINTR && errno != EAGAIN) return -1;
+    }
+}
 #endif
 
 /*
@@ -99,6 +875,19 @@ static int pthread_join(pthread_t thread, void** retval) {
  * STREAMING ENGINE (Producer / Worker / Consumer)
  * ============================================================================
  * Implements a Ring Buffer architecture to parallelize block processing.
+ *
+ * Blocks are numbered by a 64-bit sequence `s` and live in slot
+ * `s % ring_size`. Each slot carries an atomic stamp `s * 4 + status`, so a
+ * thread waiting for block `s` can never mistake the slot's previous or next
+ * occupant for its own:
+ * - the reader waits for `(s, FREE)`, fills the slot, publishes `(s, FILLED)`;
+ * - a worker claims `s` with a fetch-add, waits for `(s, FILLED)`, publishes
+ *   `(s, PROCESSED)`;
+ * - the writer waits for `(s, PROCESSED)`, writes, publishes
+ *   `(s + ring_size, FREE)`.
+ * Waiters spin briefly, then park on the slot's own condition variable. The
+ * mutex is only taken by a publisher when somebody is actually parked, so the
+ * hot path is one atomic store per transition.
  */
 
 /**
@@ -118,6 +907,13 @@ static int pthread_join(pthread_t thread, void** retval) {
  */
 typedef enum { JOB_STATUS_FREE, JOB_STATUS_FILLED, JOB_STATUS_PROCESSED } job_status_t;
 
+/**
+ * @brief Builds the stamp a job slot holds when block @p seq is in state @p st.
+ */
+static ZXC_ALWAYS_INLINE int64_t zxc_job_stamp(int64_t seq, job_status_t st) {
+    return seq * 4 + (int64_t)st;
+}
+
 /**
  * @struct zxc_stream_job_t
  * @brief Represents a single unit of work (a chunk of data) to be processed.
@@ -127,11 +923,17 @@ typedef enum { JOB_STATUS_FREE, JOB_STATUS_FILLED, JOB_STATUS_PROCESSED } job_st
  * lines to prevent false sharing in a multi-threaded environment.
  *
  * @var zxc_stream_job_t::in_buf
- *      Pointer to the buffer containing raw input data.
+ *      Pointer to the job's own input buffer (NULL when the input is mapped).
+ * @var zxc_stream_job_t::in_ptr
+ *      The data to process: `in_buf`, or a read-only view into the mapped
+ * input file.
  * @var zxc_stream_job_t::in_cap
- *      The total allocated capacity of the input buffer.
+ *      The largest input a job accepts (the allocated capacity of `in_buf`).
  * @var zxc_stream_job_t::in_sz
  *      The actual size of the valid data currently in the input buffer.
+ * @var zxc_stream_job_t::prefix_len
+ *      Linked compression: number of bytes of the previous block readable
+ * right before `in_ptr` (its history).
  * @var zxc_stream_job_t::out_buf
  *      Pointer to the buffer where processed (compressed/decompressed) data is
  * stored.
@@ -139,10 +941,25 @@ typedef enum { JOB_STATUS_FREE, JOB_STATUS_FILLED, JOB_STATUS_PROCESSED } job_st
  *      The total allocated capacity of the output buffer.
  * @var zxc_stream_job_t::result_sz
  *      The actual size of the valid data produced in the output buffer.
+ * @var zxc_stream_job_t::write_off
+ *      io_uring writer only: file offset the block is being written at.
+ * @var zxc_stream_job_t::write_done
+ *      io_uring writer only: the block has reached the file.
+ * @var zxc_stream_job_t::level
+ *      Adaptive compression only: level the block was compressed at.
+ * @var zxc_stream_job_t::work_ns
+ *      Adaptive compression with a target speed only: time spent compressing
+ * the block.
  * @var zxc_stream_job_t::job_id
  *      A unique identifier for the job, often used for ordering or debugging.
- * @var zxc_stream_job_t::status
- *      The current state of this job (Free, Filled, or Processed).
+ * @var zxc_stream_job_t::stamp
+ *      Block sequence and state of this slot, see `zxc_job_stamp()`.
+ * @var zxc_stream_job_t::waiters
+ *      Number of threads parked (or about to park) on this slot.
+ * @var zxc_stream_job_t::park_lock
+ *      Mutex paired with `park_cond`; only used on the slow path.
+ * @var zxc_stream_job_t::park_cond
+ *      Condition variable parked waiters sleep on.
  * @var zxc_stream_job_t::pad
  *      Padding bytes to ensure the structure size aligns with typical cache
  * lines (64 bytes), minimizing cache contention between threads accessing
@@ -150,11 +967,20 @@ typedef enum { JOB_STATUS_FREE, JOB_STATUS_FILLED, JOB_STATUS_PROCESSED } job_st
  */
 typedef struct {
     uint8_t* in_buf;
+    const uint8_t* in_ptr;
     size_t in_cap, in_sz;
+    size_t prefix_len;
     uint8_t* out_buf;
     size_t out_cap, result_sz;
+    int64_t write_off;
+    int write_done;
+    int level;
+    uint64_t work_ns;
     int job_id;
-    job_status_t status;
+    ZXC_ATOMIC int64_t stamp;
+    ZXC_ATOMIC int64_t waiters;
+    pthread_mutex_t park_lock;
+    pthread_cond_t park_cond;
     char pad[ZXC_CACHE_LINE_SIZE];  // Prevent False Sharing
 } zxc_stream_job_t;
 
@@ -179,42 +1005,54 @@ typedef struct {
 typedef int (*zxc_chunk_processor_t)(zxc_cctx_t* ctx, const uint8_t* in, size_t in_sz, uint8_t* out,
                                      size_t out_cap);
 
+/**
+ * @struct zxc_level_ctl_t
+ * @brief Adaptive level control of a compression stream, driven by the writer
+ * (see zxc_level_ctl_update()).
+ *
+ * @var zxc_level_ctl_t::min
+ *      Lowest level (the configured one), also the starting level.
+ * @var zxc_level_ctl_t::max
+ *      Highest level (equal to `min` when the level is fixed).
+ * @var zxc_level_ctl_t::target_bps
+ *      Compression speed to hold, in bytes per second (0 = follow the writer).
+ * @var zxc_level_ctl_t::n_workers
+ *      Number of threads compressing blocks, to scale one block's speed.
+ * @var zxc_level_ctl_t::streak
+ *      Consecutive votes so far: positive to move up, negative to move down.
+ * @var zxc_level_ctl_t::rate
+ *      Smoothed compression speed at the current level, in bytes per second
+ * (target speed only, 0 = no sample yet).
+ */
+typedef struct {
+    int min, max;
+    uint64_t target_bps;
+    int n_workers;
+    int streak;
+    uint64_t rate;
+} zxc_level_ctl_t;
+
 /**
  * @struct zxc_stream_ctx_t
  * @brief The main context structure managing the streaming
  * compression/decompression state.
  *
  * This structure orchestrates the producer-consumer workflow. It manages the
- * ring buffer of jobs, the worker queue, synchronization primitives (mutexes
- * and condition variables), and configuration settings for the compression
- * algorithm.
+ * ring buffer of jobs, the shared claim counter of the workers, and
+ * configuration settings for the compression algorithm. All synchronization
+ * lives in the job slots themselves.
  *
  * @var zxc_stream_ctx_t::jobs
  *      Array of job structures acting as the ring buffer.
  * @var zxc_stream_ctx_t::ring_size
  *      The total number of slots in the jobs array.
- * @var zxc_stream_ctx_t::worker_queue
- *      A circular queue containing indices of jobs ready to be picked up by
- * worker threads.
- * @var zxc_stream_ctx_t::wq_head
- *      Index of the head of the worker queue (where workers take jobs).
- * @var zxc_stream_ctx_t::wq_tail
- *      Index of the tail of the worker queue (where the writer adds jobs).
- * @var zxc_stream_ctx_t::wq_count
- *      Current number of items in the worker queue.
- * @var zxc_stream_ctx_t::lock
- *      Mutex used to protect access to shared resources (queue indices, status
- * changes).
- * @var zxc_stream_ctx_t::cond_reader
- *      Condition variable to signal the output thread (reader) that processed
- * data is available.
- * @var zxc_stream_ctx_t::cond_worker
- *      Condition variable to signal worker threads that new work is available.
- * @var zxc_stream_ctx_t::cond_writer
- *      Condition variable to signal the input thread (writer) that job slots
- * are free.
+ * @var zxc_stream_ctx_t::next_seq
+ *      Sequence number of the next block a worker will claim. Kept on its own
+ * cache line: every worker increments it.
  * @var zxc_stream_ctx_t::shutdown_workers
  *      Flag indicating that worker threads should terminate.
+ * @var zxc_stream_ctx_t::spin_count
+ *      Polls before a waiter parks (0 when the machine is oversubscribed).
  * @var zxc_stream_ctx_t::compression_mode
  *      Indicates the operation mode (e.g., compression or decompression).
  * @var zxc_stream_ctx_t::io_error
@@ -222,30 +1060,60 @@ typedef int (*zxc_chunk_processor_t)(zxc_cctx_t* ctx, const uint8_t* in, size_t
  * @var zxc_stream_ctx_t::processor
  *      Function pointer or object responsible for the actual chunk processing
  * logic.
- * @var zxc_stream_ctx_t::write_idx
- *      The index of the next job slot to be written to by the main thread.
  * @var zxc_stream_ctx_t::checksum_enabled
  *      Flag indicating whether checksum verification/generation is active.
  * @var zxc_stream_ctx_t::compression_level
  *      The configured level of compression (trading off speed vs. ratio).
  * @var zxc_stream_ctx_t::chunk_size
  *      The size of each data chunk to be processed.
+ * @var zxc_stream_ctx_t::linked
+ *      Compression only: link every block to the tail of the previous one.
+ * @var zxc_stream_ctx_t::num_type
+ *      Compression only: element type hint for NUM blocks (zxc_num_type_t).
+ * @var zxc_stream_ctx_t::elem_size
+ *      Compression only: byte-shuffle element size (0 or 1 = off).
+ * @var zxc_stream_ctx_t::stats
+ *      Compression only: block selection counters the workers add to on exit
+ * (NULL = not collected).
+ * @var zxc_stream_ctx_t::perf
+ *      Performance counters of the call (NULL = not collected).
+ * @var zxc_stream_ctx_t::digest_check
+ *      Decompression only: the reader checks the frame digest.
+ * @var zxc_stream_ctx_t::digest_ok
+ *      Decompression only: a matching DIG block has been read.
+ * @var zxc_stream_ctx_t::digest
+ *      Decompression only: digest of the blocks read so far (reader thread).
+ * @var zxc_stream_ctx_t::level_now
+ *      Adaptive compression only: level of the blocks claimed from now on
+ * (written by the writer, read by the workers).
+ * @var zxc_stream_ctx_t::adapt
+ *      Adaptive compression only: controller state (writer thread).
+ * @var zxc_stream_ctx_t::stats_lock
+ *      Serializes the updates of `stats` and `perf`.
  */
 typedef struct {
     zxc_stream_job_t* jobs;
     int ring_size;
-    int* worker_queue;
-    int wq_head, wq_tail, wq_count;
-    pthread_mutex_t lock;
-    pthread_cond_t cond_reader, cond_worker, cond_writer;
-    int shutdown_workers;
+    ZXC_ALIGN(ZXC_CACHE_LINE_SIZE) ZXC_ATOMIC int64_t next_seq;
+    ZXC_ALIGN(ZXC_CACHE_LINE_SIZE) ZXC_ATOMIC int shutdown_workers;
+    int spin_count;
     int compression_mode;
     ZXC_ATOMIC int io_error;
     zxc_chunk_processor_t processor;
-    int write_idx;
     int checksum_enabled;
     int compression_level;
     size_t chunk_size;
+    int linked;
+    int num_type;
+    size_t elem_size;
+    zxc_block_stats_t* stats;
+    zxc_perf_stats_t* perf;
+    int digest_check;
+    int digest_ok;
+    zxc_digest_t digest;
+    ZXC_ATOMIC int level_now;
+    zxc_level_ctl_t adapt;
+    pthread_mutex_t stats_lock;
 } zxc_stream_ctx_t;
 
 /**
@@ -263,369 +1131,2717 @@ typedef struct {
  * @var writer_args_t::f
  * Pointer to the output file stream where data will be written.
  *
+ * @var writer_args_t::write_fn
+ * Sink callback used instead of `f` when set (callback stream API).
+ *
+ * @var writer_args_t::opaque
+ * User pointer passed to `write_fn`.
+ *
  * @var writer_args_t::total_bytes
  * Accumulator for the total number of bytes written to the file so far.
+ *
+ * @var writer_args_t::seek
+ * Growable array of seek table entries (NULL unless the frame is seekable).
+ *
+ * @var writer_args_t::seek_n
+ * Number of entries recorded in `seek`.
+ *
+ * @var writer_args_t::seek_cap
+ * Allocated capacity of `seek`, in entries.
+ *
+ * @var writer_args_t::raw_total
+ * Number of raw bytes covered by the blocks written so far.
+ *
+ * @var writer_args_t::digest
+ * Append a frame digest after the last block (compression only).
+ *
+ * @var writer_args_t::dg
+ * Digest of the blocks written so far, when `digest` is set.
+ *
+ * @var writer_args_t::perf
+ * Writer counters (`write_ns`, `write_wait_ns`) when the call collects them.
+ *
+ * @var writer_args_t::ring
+ * io_uring instance the blocks are written through, when set up (`ring.fd`
+ * >= 0); `f` is then only used again for the digest and seek table.
+ *
+ * @var writer_args_t::out_fd
+ * Descriptor of `f`, used with `ring`.
+ *
+ * @var writer_args_t::out_off
+ * File offset of the next block, used with `ring`.
  */
 typedef struct {
     zxc_stream_ctx_t* ctx;
     FILE* f;
+    zxc_write_fn write_fn;
+    void* opaque;
     int64_t total_bytes;
+    zxc_seek_entry_t* seek;
+    size_t seek_n, seek_cap;
+    uint64_t raw_total;
+    int digest;
+    zxc_digest_t dg;
+    zxc_perf_stats_t perf;
+#ifdef ZXC_STREAM_URING
+    zxc_uring_t ring;
+    int out_fd;
+    int64_t out_off;
+#endif
 } writer_args_t;
 
 /**
- * @brief Worker thread function for parallel stream processing.
- *
- * This function serves as the entry point for worker threads in the ZXC
- * streaming compression/decompression context. It continuously retrieves jobs
- * from a shared work queue, processes them using a thread-local compression
- * context (`zxc_cctx_t`), and signals the writer thread upon completion.
+ * @brief Waits until a job slot holds the given stamp.
  *
- * **Worker Lifecycle & Synchronization:**
- * 1. **Initialization:** Allocates a thread-local `zxc_cctx_t` to avoid lock
- * contention during compression/decompression.
- * 2. **Wait Loop:** Uses `pthread_cond_wait` on `cond_worker` to sleep until a
- * job is available in the `worker_queue`.
- * 3. **Job Retrieval:** Dequeues a job ID from the ring buffer. The
- * `worker_queue` acts as a load balancer.
- * 4. **Processing:** Calls `ctx->processor` (the compression/decompression
- * function) on the job's data. This is the CPU-intensive part and runs in
- * parallel.
- * 5. **Completion:** Updates `job->status` to `JOB_STATUS_PROCESSED`.
- * 6. **Signaling:** If the processed job is the *next* one expected by the
- * writer
- *    (`jid == ctx->write_idx`), it signals `cond_writer`. This optimization
- * prevents unnecessary wake-ups of the writer thread for out-of-order
- * completions.
+ * Spins for `ctx->spin_count` polls, then parks on the slot's condition
+ * variable. The waiter count is raised before the final check, and publishers
+ * store the stamp before reading the count, so a publication can never slip
+ * between the check and the sleep unnoticed.
  *
- * @param[in] arg A pointer to the shared stream context (`zxc_stream_ctx_t`).
- * @return Always returns NULL.
+ * @param[in] ctx  Stream context (its error and shutdown flags abort the wait).
+ * @param[in,out] job Slot to wait on.
+ * @param[in] want Stamp to wait for.
+ * @return 0 once the slot holds @p want, -1 if the engine is stopping.
  */
-static void* zxc_stream_worker(void* arg) {
-    zxc_stream_ctx_t* ctx = (zxc_stream_ctx_t*)arg;
-    zxc_cctx_t cctx;
-
-    if (zxc_cctx_init(&cctx, ctx->chunk_size, ctx->compression_mode, ctx->compression_level,
-                      ctx->checksum_enabled) != 0) {
-        zxc_cctx_free(&cctx);
-        return NULL;
+static int zxc_job_wait(zxc_stream_ctx_t* ctx, zxc_stream_job_t* job, int64_t want) {
+    for (int i = 0; i < ctx->spin_count; i++) {
+        if (LIKELY(ZXC_ATOMIC_LOAD(&job->stamp) == want)) return 0;
+        if (UNLIKELY(ZXC_ATOMIC_LOAD(&ctx->io_error) || ZXC_ATOMIC_LOAD(&ctx->shutdown_workers)))
+            return -1;
+        ZXC_CPU_RELAX();
     }
 
-    cctx.checksum_enabled = ctx->checksum_enabled;
-    cctx.compression_level = ctx->compression_level;
+    ZXC_ATOMIC_FETCH_ADD(&job->waiters, 1);
+    pthread_mutex_lock(&job->park_lock);
+    while (ZXC_ATOMIC_LOAD(&job->stamp) != want && !ZXC_ATOMIC_LOAD(&ctx->io_error) &&
+           !ZXC_ATOMIC_LOAD(&ctx->shutdown_workers))
+        pthread_cond_wait(&job->park_cond, &job->park_lock);
+    pthread_mutex_unlock(&job->park_lock);
+    ZXC_ATOMIC_FETCH_ADD(&job->waiters, -1);
 
-    while (1) {
-        zxc_stream_job_t* job = NULL;
-        pthread_mutex_lock(&ctx->lock);
-        while (ctx->wq_count == 0 && !ctx->shutdown_workers) {
-            pthread_cond_wait(&ctx->cond_worker, &ctx->lock);
-        }
-        if (ctx->shutdown_workers && ctx->wq_count == 0) {
-            pthread_mutex_unlock(&ctx->lock);
-            break;
-        }
-        int jid = ctx->worker_queue[ctx->wq_tail];
-        ctx->wq_tail = (ctx->wq_tail + 1) % ctx->ring_size;
-        ctx->wq_count--;
-        job = &ctx->jobs[jid];
-        pthread_mutex_unlock(&ctx->lock);
-
-        int res = ctx->processor(&cctx, job->in_buf, job->in_sz, job->out_buf, job->out_cap);
-        pthread_mutex_lock(&ctx->lock);
-
-        if (UNLIKELY(res < 0)) {
-            ctx->io_error = 1;
-            job->result_sz = 0;
-            job->status = JOB_STATUS_PROCESSED;
-            pthread_cond_broadcast(&ctx->cond_writer);
-            pthread_cond_broadcast(&ctx->cond_reader);
-        } else {
-            job->result_sz = (size_t)res;
-            job->status = JOB_STATUS_PROCESSED;
-            if (jid == ctx->write_idx) pthread_cond_broadcast(&ctx->cond_writer);
-        }
-        pthread_mutex_unlock(&ctx->lock);
-    }
-    zxc_cctx_free(&cctx);
-    return NULL;
+    return (ZXC_ATOMIC_LOAD(&job->stamp) == want) ? 0 : -1;
 }
 
 /**
- * @brief Asynchronous writer thread function.
- *
- * This function runs as a separate thread responsible for writing processed
- * data chunks to the output file. It operates on a ring buffer of jobs shared
- * with the reader and worker threads.
+ * @brief zxc_job_wait() that adds the time it blocked to @p ns when the call
+ * collects performance counters.
  *
- * **Ordering Enforcement:**
+ * @param[in]     ctx  Stream context.
+ * @param[in,out] job  Slot to wait on.
+ * @param[in]     want Stamp to wait for.
+ * @param[in,out] ns   Wait counter to add to.
+ * @return 0 once the slot holds @p want, -1 if the engine is stopping.
+ */
+static int zxc_job_wait_timed(zxc_stream_ctx_t* ctx, zxc_stream_job_t* job, int64_t want,
+                              uint64_t* ns) {
+    if (LIKELY(!ctx->perf) || ZXC_ATOMIC_LOAD(&job->stamp) == want)
+        return zxc_job_wait(ctx, job, want);
+    const uint64_t t0 = zxc_perf_now();
+    int res = zxc_job_wait(ctx, job, want);
+    *ns += zxc_perf_now() - t0;
+    return res;
+}
+
+/**
+ * @brief Adds a thread's counters to those of the call.
+ *
+ * @param[in,out] ctx  Stream context.
+ * @param[in]     cctx Context of the thread (block counters, checksum time).
+ * @param[in]     perf Time counters of the thread (NULL = none).
+ */
+static void zxc_stream_add_stats(zxc_stream_ctx_t* ctx, const zxc_cctx_t* cctx,
+                                 const zxc_perf_stats_t* perf) {
+    if (!ctx->stats && !ctx->perf) return;
+    pthread_mutex_lock(&ctx->stats_lock);
+    if (ctx->stats) zxc_block_stats_add(ctx->stats, &cctx->stats);
+    if (ctx->perf) {
+        zxc_block_stats_add(&ctx->perf->blocks, &cctx->stats);
+        ctx->perf->checksum_ns += cctx->checksum_ns;
+        if (perf) zxc_perf_stats_add(ctx->perf, perf);
+    }
+    pthread_mutex_unlock(&ctx->stats_lock);
+}
+
+/**
+ * @brief Wakes every thread parked on a job slot.
+ *
+ * @param[in,out] job Slot whose waiters should re-check their condition.
+ */
+static void zxc_job_wake(zxc_stream_job_t* job) {
+    if (ZXC_ATOMIC_LOAD(&job->waiters) > 0) {
+        pthread_mutex_lock(&job->park_lock);
+        pthread_cond_broadcast(&job->park_cond);
+        pthread_mutex_unlock(&job->park_lock);
+    }
+}
+
+/**
+ * @brief Moves a job slot to a new stamp and wakes its parked waiters.
+ *
+ * Everything written to the job before this call is visible to the thread
+ * whose `zxc_job_wait()` returns for @p stamp.
+ *
+ * @param[in,out] job   Slot to update.
+ * @param[in]     stamp New stamp, see `zxc_job_stamp()`.
+ */
+static void zxc_job_publish(zxc_stream_job_t* job, int64_t stamp) {
+    ZXC_ATOMIC_STORE(&job->stamp, stamp);
+    zxc_job_wake(job);
+}
+
+/**
+ * @brief Raises the stop flag @p flag (error or shutdown) and wakes every
+ * parked thread so that it can observe it.
+ *
+ * @param[in,out] ctx  Stream context.
+ * @param[in,out] flag `&ctx->io_error` or `&ctx->shutdown_workers`.
+ */
+static void zxc_stream_stop(zxc_stream_ctx_t* ctx, ZXC_ATOMIC int* flag) {
+    ZXC_ATOMIC_STORE(flag, 1);
+    for (int i = 0; i < ctx->ring_size; i++) zxc_job_wake(&ctx->jobs[i]);
+}
+
+/**
+ * @brief Processes block @p seq, claimed from its `JOB_STATUS_FILLED` slot,
+ * and publishes the slot as `JOB_STATUS_PROCESSED`.
+ *
+ * A linked block gets the tail of its predecessor as history: the input bytes
+ * in front of it when compressing, a copy of the predecessor's output in front
+ * of its own when decompressing (after waiting for it; the writer keeps that
+ * slot until this block is written). With an adaptive level, the block is
+ * compressed at the level the controller currently holds.
+ *
+ * @param[in,out] ctx  Stream context.
+ * @param[in,out] cctx Context of the calling thread.
+ * @param[in,out] job  Slot of the block.
+ * @param[in]     seq  Sequence number of the block.
+ * @return 0 once published, -1 if the engine stopped while waiting for the
+ * predecessor (the slot is then left as is).
+ */
+static int zxc_stream_process(zxc_stream_ctx_t* ctx, zxc_cctx_t* cctx, zxc_stream_job_t* job,
+                              int64_t seq) {
+    int res;
+    if (ctx->compression_mode == 1) {
+        res = zxc_cctx_link(cctx, job->in_ptr - job->prefix_len, job->prefix_len, 1);
+    } else if (seq > 0 && (job->in_ptr[1] & ZXC_BLOCK_FLAG_LINKED)) {
+        zxc_stream_job_t* prev = &ctx->jobs[(seq - 1) % ctx->ring_size];
+        if (zxc_job_wait(ctx, prev, zxc_job_stamp(seq - 1, JOB_STATUS_PROCESSED)) != 0)
+            return -1;
+        // Copied in front of the output, so the decoder sees one contiguous history.
+        size_t len = prev->result_sz < ZXC_DICT_SIZE_MAX ? prev->result_sz : ZXC_DICT_SIZE_MAX;
+        ZXC_MEMCPY(job->out_buf - len, prev->out_buf + prev->result_sz - len, len);
+        res = zxc_cctx_link(cctx, job->out_buf - len, len, 0);
+    } else {
+        res = zxc_cctx_link(cctx, NULL, 0, 0);
+    }
+    if (ctx->adapt.max > ctx->adapt.min) {
+        job->level = ZXC_ATOMIC_LOAD(&ctx->level_now);
+        cctx->compression_level = job->level;
+    }
+    const uint64_t t0 = ctx->adapt.target_bps ? zxc_perf_now() : 0;
+    if (LIKELY(res == 0))
+        res = ctx->processor(cctx, job->in_ptr, job->in_sz, job->out_buf, job->out_cap);
+    if (ctx->adapt.target_bps) job->work_ns = zxc_perf_now() - t0;
+
+    if (UNLIKELY(res < 0)) {
+        job->result_sz = 0;
+        zxc_stream_stop(ctx, &ctx->io_error);
+    } else {
+        job->result_sz = (size_t)res;
+    }
+    zxc_job_publish(job, zxc_job_stamp(seq, JOB_STATUS_PROCESSED));
+    return 0;
+}
+
+/**
+ * @brief Worker thread function for parallel stream processing.
+ *
+ * This function serves as the entry point for worker threads in the ZXC
+ * streaming compression/decompression context. It continuously claims jobs
+ * from the ring buffer, processes them using a thread-local compression
+ * context (`zxc_cctx_t`), and hands them to the writer thread upon completion.
+ *
+ * **Worker Lifecycle & Synchronization:**
+ * 1. **Initialization:** Allocates a thread-local `zxc_cctx_t` to avoid lock
+ * contention during compression/decompression.
+ * 2. **Claim:** Takes the next block sequence number with a single fetch-add
+ * on `ctx->next_seq`. Workers therefore pick blocks in order and never
+ * contend on anything but that counter.
+ * 3. **Wait:** Waits (spin, then park) until the reader has filled that
+ * block's slot.
+ * 4. **Processing:** Calls `ctx->processor` (the compression/decompression
+ * function) on the job's data, see `zxc_stream_process()`. This is the
+ * CPU-intensive part and runs in parallel.
+ * 5. **Completion:** Publishes the slot as `JOB_STATUS_PROCESSED`, which wakes
+ * the writer only if it is parked on this very slot.
+ *
+ * @param[in] arg A pointer to the shared stream context (`zxc_stream_ctx_t`).
+ * @return Always returns NULL.
+ */
+static void* zxc_stream_worker(void* arg) {
+    zxc_stream_ctx_t* ctx = (zxc_stream_ctx_t*)arg;
+    zxc_cctx_t cctx;
+
+    if (zxc_cctx_init(&cctx, ctx->chunk_size, ctx->compression_mode, ctx->compression_level,
+                      ctx->checksum_enabled) != 0) {
+        zxc_cctx_free(&cctx);
+        zxc_stream_stop(ctx, &ctx->io_error);
+        return NULL;
+    }
+
+    cctx.checksum_enabled = ctx->checksum_enabled;
+    cctx.compression_level = ctx->compression_level;
+    cctx.num_type = ctx->num_type;
+    cctx.elem_size = ctx->elem_size;
+    cctx.timed = ctx->perf != NULL;
+
+    zxc_perf_stats_t perf;
+    ZXC_MEMSET(&perf, 0, sizeof(perf));
+    while (1) {
+        int64_t seq = ZXC_ATOMIC_FETCH_ADD(&ctx->next_seq, 1);
+        zxc_stream_job_t* job = &ctx->jobs[seq % ctx->ring_size];
+        if (zxc_job_wait_timed(ctx, job, zxc_job_stamp(seq, JOB_STATUS_FILLED),
+                               &perf.work_wait_ns) != 0)
+            break;
+        const uint64_t t0 = ctx->perf ? zxc_perf_now() : 0;
+        if (zxc_stream_process(ctx, &cctx, job, seq) != 0) break;
+        if (ctx->perf) perf.work_ns += zxc_perf_now() - t0;
+    }
+    zxc_stream_add_stats(ctx, &cctx, &perf);
+    zxc_cctx_free(&cctx);
+    return NULL;
+}
+
+/**
+ * @brief Pool step of a stream run (see `zxc_pool_run_s::step`).
+ *
+ * Unlike a dedicated worker, which claims a sequence number up front and waits
+ * for its block, a pool thread only takes block `next_seq` if the reader has
+ * already filled it, so it never waits on a call that has nothing ready.
+ *
+ * @param[in] run  Run whose `arg` is the stream context.
+ * @param[in] slot Context of the calling thread.
+ * @return 1 if a block was processed (or taken by another thread first), 0 if
+ * none is ready.
+ */
+static int zxc_stream_pool_step(zxc_pool_run_t* run, zxc_pool_slot_t* slot) {
+    zxc_stream_ctx_t* ctx = (zxc_stream_ctx_t*)run->arg;
+    if (UNLIKELY(ctx->io_error)) return 0;
+
+    const int64_t seq = ZXC_ATOMIC_LOAD(&ctx->next_seq);
+    zxc_stream_job_t* job = &ctx->jobs[seq % ctx->ring_size];
+    if (ZXC_ATOMIC_LOAD(&job->stamp) != zxc_job_stamp(seq, JOB_STATUS_FILLED)) return 0;
+    if (!ZXC_ATOMIC_CAS(&ctx->next_seq, seq, seq + 1)) return 1;
+
+    zxc_cctx_t* cctx = zxc_pool_slot_cctx(slot, ctx->chunk_size, ctx->compression_mode,
+                                          ctx->compression_level, ctx->checksum_enabled);
+    if (UNLIKELY(!cctx)) {
+        zxc_stream_stop(ctx, &ctx->io_error);
+        return 0;
+    }
+    cctx->num_type = ctx->num_type;
+    cctx->elem_size = ctx->elem_size;
+    cctx->timed = ctx->perf != NULL;
+    cctx->checksum_ns = 0;
+    ZXC_MEMSET(&cctx->stats, 0, sizeof(cctx->stats));
+    zxc_perf_stats_t perf;
+    ZXC_MEMSET(&perf, 0, sizeof(perf));
+    const uint64_t t0 = ctx->perf ? zxc_perf_now() : 0;
+    zxc_stream_process(ctx, cctx, job, seq);
+    if (ctx->perf) perf.work_ns = zxc_perf_now() - t0;
+    zxc_stream_add_stats(ctx, cctx, &perf);
+    return 1;
+}
+
+/**
+ * @brief Hands @p n bytes to the output: the sink callback, the stdio stream,
+ * or nowhere when neither is set.
+ *
+ * @param[in] args Writer state holding the output.
+ * @param[in] buf  Bytes to write.
+ * @param[in] n    Number of bytes (may be 0).
+ * @return 0 on success, -1 on I/O failure.
+ */
+static int zxc_output_write(const writer_args_t* args, const void* buf, size_t n) {
+    if (n == 0) return 0;
+    if (args->write_fn) return args->write_fn(args->opaque, buf, n) == 0 ? 0 : -1;
+    if (args->f) return fwrite(buf, 1, n, args->f) == n ? 0 : -1;
+    return 0;
+}
+
+/**
+ * @brief Writes the blocks that close the frame: the digest, then the seek
+ * table built from the collected entries (each only if enabled).
+ *
+ * @param[in,out] args Writer state holding the digest, the seek entries and
+ * the output stream.
+ * @return 0 on success, -1 on allocation or I/O failure.
+ */
+static int zxc_write_trailer_blocks(writer_args_t* args) {
+    if (args->digest) {
+        uint8_t dig[ZXC_DIGEST_BLOCK_SIZE];
+        int res = zxc_write_digest(dig, sizeof(dig), &args->dg);
+        if (res < 0 || zxc_output_write(args, dig, (size_t)res) != 0) return -1;
+        args->total_bytes += res;
+    }
+    if (!args->seek) return 0;
+
+    size_t sz = ZXC_BLOCK_HEADER_SIZE + args->seek_n * ZXC_SEEK_ENTRY_SIZE + ZXC_SEEK_TRAILER_SIZE;
+    uint8_t* buf = malloc(sz);
+    if (UNLIKELY(!buf)) return -1;
+
+    int res = zxc_write_seek_table(buf, sz, args->seek, args->seek_n);
+    if (res > 0 && zxc_output_write(args, buf, (size_t)res) != 0) res = -1;
+    if (res > 0) args->total_bytes += res;
+    free(buf);
+    return res > 0 ? 0 : -1;
+}
+
+/**
+ * @brief Adds the block about to be written to the frame digest.
+ *
+ * @param[in,out] args Writer state (`digest` must be set).
+ * @param[in]     job  Block at the current output position.
+ */
+static void zxc_writer_record_digest(writer_args_t* args, const zxc_stream_job_t* job) {
+    zxc_stream_ctx_t* ctx = args->ctx;
+    if (UNLIKELY(zxc_digest_update(&args->dg, job->out_buf, job->result_sz) != 0))
+        zxc_stream_stop(ctx, &ctx->io_error);
+}
+
+/**
+ * @brief Records the seek table entry of the block about to be written.
+ *
+ * @param[in,out] args Writer state (`seek` must be set).
+ * @param[in]     job  Block at the current output position.
+ */
+static void zxc_writer_record_seek(writer_args_t* args, const zxc_stream_job_t* job) {
+    zxc_stream_ctx_t* ctx = args->ctx;
+    if (args->seek_n == args->seek_cap) {
+        size_t new_cap = args->seek_cap * 2;
+        zxc_seek_entry_t* grown = realloc(args->seek, new_cap * sizeof(zxc_seek_entry_t));
+        if (UNLIKELY(!grown)) {
+            zxc_stream_stop(ctx, &ctx->io_error);
+        } else {
+            args->seek = grown;
+            args->seek_cap = new_cap;
+        }
+    }
+    if (LIKELY(!ctx->io_error)) {
+        args->seek[args->seek_n].comp_offset = (uint64_t)args->total_bytes;
+        args->seek[args->seek_n].raw_offset = args->raw_total;
+        args->seek_n++;
+        args->raw_total += job->in_sz;
+    }
+}
+
+#define ZXC_ADAPT_DOWN 2  // Votes in a row to step the level down (falling behind is costly)
+#define ZXC_ADAPT_UP 8    // Votes in a row to step the level up
+
+/**
+ * @brief Tells whether the writer is about to wait for block @p seq while a
+ * worker is still compressing it, i.e. whether compression is the bottleneck.
+ *
+ * A block that is already processed, or not even read yet (the input is the
+ * bottleneck), leaves compression time to spare.
+ *
+ * @param[in] ctx Stream context.
+ * @param[in] job Slot of the block.
+ * @param[in] seq Sequence number of the block.
+ * @return 1 if the block is being compressed, 0 otherwise (or if the level is fixed).
+ */
+static int zxc_level_ctl_lagging(const zxc_stream_ctx_t* ctx, const zxc_stream_job_t* job,
+                                 int64_t seq) {
+    return ctx->adapt.max > ctx->adapt.min &&
+           ZXC_ATOMIC_LOAD(&job->stamp) == zxc_job_stamp(seq, JOB_STATUS_FILLED);
+}
+
+/**
+ * @brief Adaptive level control: counts the vote of a processed block about to
+ * be written, and steps the level once enough votes agree.
+ *
+ * Without a target speed, a block the writer had to wait for (see
+ * zxc_level_ctl_lagging()) votes down and any other one votes up, so the level
+ * settles where compression just keeps the output busy. With a target, the
+ * block's compression speed, scaled to the number of workers, votes down
+ * below the target and up above 1.25 times it. Blocks compressed at another
+ * level than the current one measure the past and do not vote.
+ *
+ * @param[in,out] ctx     Stream context (writer thread).
+ * @param[in]     job     Slot of the block.
+ * @param[in]     lagging The writer waited for the block while it was compressed.
+ */
+static void zxc_level_ctl_update(zxc_stream_ctx_t* ctx, const zxc_stream_job_t* job,
+                                 int lagging) {
+    zxc_level_ctl_t* a = &ctx->adapt;
+    const int level = ZXC_ATOMIC_LOAD(&ctx->level_now);
+    if (a->max == a->min || job->level != level || job->in_sz == 0) return;
+
+    int vote;
+    if (a->target_bps) {
+        const uint64_t ns = job->work_ns ? job->work_ns : 1;
+        const uint64_t rate =
+            (uint64_t)((double)job->in_sz * 1e9 / (double)ns) * (uint64_t)a->n_workers;
+        a->rate = a->rate ? (a->rate * 3 + rate) / 4 : rate;
+        vote = a->rate < a->target_bps ? -1 : a->rate > a->target_bps + a->target_bps / 4;
+    } else {
+        vote = lagging ? -1 : 1;
+    }
+    if (vote == 0 || (vote > 0) != (a->streak > 0)) a->streak = 0;
+    a->streak += vote;
+    if (a->streak > -ZXC_ADAPT_DOWN && a->streak < ZXC_ADAPT_UP) return;
+
+    const int next = a->streak < 0 ? level - 1 : level + 1;
+    a->streak = 0;
+    if (next < a->min || next > a->max) return;
+    a->rate = 0;
+    ZXC_ATOMIC_STORE(&ctx->level_now, next);
+}
+
+/**
+ * @brief Writes processed block @p seq and releases the slot of block
+ * `seq - 1`, see zxc_async_writer().
+ *
+ * @param[in,out] args Writer state.
+ * @param[in]     job  Slot of the block.
+ * @param[in]     seq  Sequence number of the block.
+ * @return 0 on success, -1 once the engine has stopped on an error.
+ */
+static int zxc_writer_emit(writer_args_t* args, const zxc_stream_job_t* job, int64_t seq) {
+    zxc_stream_ctx_t* ctx = args->ctx;
+    if (args->seek && job->result_sz > 0) zxc_writer_record_seek(args, job);
+    if (args->digest && job->result_sz > 0) zxc_writer_record_digest(args, job);
+
+    if (zxc_output_write(args, job->out_buf, job->result_sz) != 0)
+        zxc_stream_stop(ctx, &ctx->io_error);
+    if (UNLIKELY(ctx->io_error)) return -1;
+    args->total_bytes += (int64_t)job->result_sz;
+
+    if (seq > 0)
+        zxc_job_publish(&ctx->jobs[(seq - 1) % ctx->ring_size],
+                        zxc_job_stamp(seq - 1 + ctx->ring_size, JOB_STATUS_FREE));
+    return 0;
+}
+
+#ifdef ZXC_STREAM_URING
+/**
+ * @brief Handles one io_uring completion of the writer.
+ *
+ * A short write is finished synchronously (regular files only return one on
+ * a full disk or a signal, where the retry reports the actual error).
+ *
+ * @param[in,out] args Writer state.
+ * @param[in]     seq  Sequence number of the completed block.
+ * @param[in]     res  Result of the write.
+ */
+static void zxc_uring_writer_complete(writer_args_t* args, int64_t seq, int32_t res) {
+    zxc_stream_ctx_t* ctx = args->ctx;
+    zxc_stream_job_t* job = &ctx->jobs[seq % ctx->ring_size];
+    if (UNLIKELY(res < 0 || ((size_t)res < job->result_sz &&
+                             zxc_pwrite_all(args->out_fd, job->out_buf + res,
+                                            job->result_sz - (size_t)res,
+                                            job->write_off + res) != 0)))
+        zxc_stream_stop(ctx, &ctx->io_error);
+    job->write_done = 1;
+}
+
+/**
+ * @brief Writer loop of the io_uring path, see zxc_async_writer().
+ *
+ * Blocks are handed to the kernel in order, each at its final offset, and
+ * the loop moves on without waiting: up to one write per ring slot can be in
+ * flight. A slot is released once its write has completed and, as in the
+ * stdio loop, the next block has been processed. While the next block is not
+ * ready, the writer waits for completions rather than for the block, so that
+ * slots keep flowing back to the reader.
+ *
+ * @param[in,out] args Writer state with `ring` set up.
+ */
+static void zxc_uring_writer(writer_args_t* args) {
+    zxc_stream_ctx_t* ctx = args->ctx;
+    zxc_uring_t* r = &args->ring;
+    unsigned inflight = 0;
+    int64_t released = 0;
+    uint64_t tag;
+    int32_t res;
+
+    for (int64_t seq = 0;; seq++) {
+        zxc_stream_job_t* job = &ctx->jobs[seq % ctx->ring_size];
+        const int64_t want = zxc_job_stamp(seq, JOB_STATUS_PROCESSED);
+        const int lagging = zxc_level_ctl_lagging(ctx, job, seq);
+        // Everything until the block is ready counts as waiting, the rest as writing.
+        uint64_t t0 = ctx->perf ? zxc_perf_now() : 0;
+        while (inflight > 0 && ZXC_ATOMIC_LOAD(&job->stamp) != want) {
+            if (UNLIKELY(zxc_uring_reap(r, 1, &tag, &res) < 0)) goto fail;
+            zxc_uring_writer_complete(args, (int64_t)tag, res);
+            inflight--;
+            for (; released < seq - 1 && ctx->jobs[released % ctx->ring_size].write_done;
+                 released++)
+                zxc_job_publish(&ctx->jobs[released % ctx->ring_size],
+                                zxc_job_stamp(released + ctx->ring_size, JOB_STATUS_FREE));
+        }
+        if (zxc_job_wait(ctx, job, want) != 0 || UNLIKELY(ctx->io_error)) break;
+        if (job->result_sz == (size_t)-1) break;
+        zxc_level_ctl_update(ctx, job, lagging);
+        if (ctx->perf) {
+            const uint64_t t1 = zxc_perf_now();
+            args->perf.write_wait_ns += t1 - t0;
+            t0 = t1;
+        }
+
+        if (args->seek && job->result_sz > 0) zxc_writer_record_seek(args, job);
+        if (args->digest && job->result_sz > 0) zxc_writer_record_digest(args, job);
+        if (UNLIKELY(ctx->io_error)) break;
+
+        job->write_done = job->result_sz == 0;
+        job->write_off = args->out_off;
+        if (job->result_sz > 0) {
+            if (inflight == r->entries) {
+                if (UNLIKELY(zxc_uring_reap(r, 1, &tag, &res) < 0)) goto fail;
+                zxc_uring_writer_complete(args, (int64_t)tag, res);
+                inflight--;
+            }
+            if (zxc_uring_write(r, args->out_fd, job->out_buf, job->result_sz, args->out_off,
+                                (uint64_t)seq) == 0)
+                inflight++;
+            else
+                zxc_uring_writer_complete(args, seq, 0);  // Written synchronously instead
+        }
+        args->out_off += (int64_t)job->result_sz;
+        args->total_bytes += (int64_t)job->result_sz;
+
+        while (zxc_uring_reap(r, 0, &tag, &res) == 1) {
+            zxc_uring_writer_complete(args, (int64_t)tag, res);
+            inflight--;
+        }
+        for (; released < seq && ctx->jobs[released % ctx->ring_size].write_done; released++)
+            zxc_job_publish(&ctx->jobs[released % ctx->ring_size],
+                            zxc_job_stamp(released + ctx->ring_size, JOB_STATUS_FREE));
+        if (ctx->perf) args->perf.write_ns += zxc_perf_now() - t0;
+    }
+
+    // Every buffer must be back before the ring is torn down.
+    while (inflight > 0) {
+        if (UNLIKELY(zxc_uring_reap(r, 1, &tag, &res) < 0)) goto fail;
+        zxc_uring_writer_complete(args, (int64_t)tag, res);
+        inflight--;
+    }
+    if (fseeko(args->f, (off_t)args->out_off, SEEK_SET) != 0)
+        zxc_stream_stop(ctx, &ctx->io_error);
+    if (!ctx->io_error && zxc_write_trailer_blocks(args) != 0)
+        zxc_stream_stop(ctx, &ctx->io_error);
+    return;
+
+fail:
+    // The ring itself failed: requests may still reference the buffers.
+    zxc_stream_stop(ctx, &ctx->io_error);
+    while (inflight > 0 && zxc_uring_reap(r, 1, &tag, &res) == 1) inflight--;
+}
+#endif
+
+/**
+ * @brief Asynchronous writer thread function.
+ *
+ * This function runs as a separate thread responsible for writing processed
+ * data chunks to the output file. It operates on a ring buffer of jobs shared
+ * with the reader and worker threads.
+ *
+ * **Ordering Enforcement:**
  * The writer MUST write blocks in the exact order they were read. Even if
  * worker threads finish jobs out of order (e.g., job 2 finishes before job 1),
- * the writer waits for `ctx->write_idx` (job 1) to be `JOB_STATUS_PROCESSED`.
+ * the writer waits for block 1 to be `JOB_STATUS_PROCESSED`.
+ *
+ * **Workflow:**
+ * 1. **Wait:** Waits (spin, then park) until the next sequential block is
+ * processed.
+ * 2. **Write:** Writes the `out_buf` to the file, or hands it by pointer to
+ * the sink callback.
+ * 3. **Release:** Publishes the slot of the *previous* block as
+ * `JOB_STATUS_FREE` for the block one ring further, allowing the main thread
+ * to reuse it for new input. Releasing one block late keeps the output of
+ * block N-1 alive until block N, which may be linked to it, is written.
+ * 4. **Advance:** Moves on to the next sequential block.
+ *
+ * @param[in] arg Pointer to a `writer_args_t` structure containing the stream
+ * context, the output file handle, and a counter for total bytes written.
+ * @return Always returns NULL.
+ */
+static void* zxc_async_writer(void* arg) {
+    writer_args_t* args = (writer_args_t*)arg;
+    zxc_stream_ctx_t* ctx = args->ctx;
+#ifdef ZXC_STREAM_URING
+    if (args->ring.fd >= 0) {
+        zxc_uring_writer(args);
+        return NULL;
+    }
+#endif
+    for (int64_t seq = 0;; seq++) {
+        zxc_stream_job_t* job = &ctx->jobs[seq % ctx->ring_size];
+        const int lagging = zxc_level_ctl_lagging(ctx, job, seq);
+        if (zxc_job_wait_timed(ctx, job, zxc_job_stamp(seq, JOB_STATUS_PROCESSED),
+                               &args->perf.write_wait_ns) != 0)
+            break;
+
+        const uint64_t t0 = ctx->perf ? zxc_perf_now() : 0;
+        if (job->result_sz == (size_t)-1) {
+            if (!ctx->io_error && zxc_write_trailer_blocks(args) != 0)
+                zxc_stream_stop(ctx, &ctx->io_error);
+            break;
+        }
+        zxc_level_ctl_update(ctx, job, lagging);
+        if (zxc_writer_emit(args, job, seq) != 0) break;
+        if (ctx->perf) args->perf.write_ns += zxc_perf_now() - t0;
+    }
+    return NULL;
+}
+
+/**
+ * @struct zxc_stream_io_t
+ * @brief Both ends of a stream run: stdio streams, or callbacks.
+ *
+ * @var zxc_stream_io_t::f_in
+ *      Input stream (stdio API), NULL with callbacks.
+ * @var zxc_stream_io_t::f_out
+ *      Output stream (stdio API), NULL to discard or with callbacks.
+ * @var zxc_stream_io_t::read_fn
+ *      Source callback (callback API), NULL with stdio.
+ * @var zxc_stream_io_t::write_fn
+ *      Sink callback (callback API), NULL to discard or with stdio.
+ * @var zxc_stream_io_t::opaque
+ *      User pointer passed to the callbacks.
+ */
+typedef struct {
+    FILE* f_in;
+    FILE* f_out;
+    zxc_read_fn read_fn;
+    zxc_write_fn write_fn;
+    void* opaque;
+} zxc_stream_io_t;
+
+/**
+ * @struct zxc_stream_input_t
+ * @brief Source of the reader loop: a stdio stream, a source callback, or a
+ * read-only mapping of the file.
+ *
+ * When the input is a regular file (POSIX only), it is mapped once and jobs
+ * point straight into the mapping: no per-block `fread` copy, and no input
+ * buffers in the ring. Pipes, terminals and Windows use stdio.
+ *
+ * @var zxc_stream_input_t::f
+ *      The stream given by the caller, NULL with a callback.
+ * @var zxc_stream_input_t::read_fn
+ *      Source callback, NULL with a stream.
+ * @var zxc_stream_input_t::opaque
+ *      User pointer passed to `read_fn`.
+ * @var zxc_stream_input_t::ended
+ *      Set once `read_fn` has reported the end of the input (1) or an error (-1).
+ * @var zxc_stream_input_t::data
+ *      Mapped bytes starting at the stream's initial position, or NULL.
+ * @var zxc_stream_input_t::size
+ *      Number of bytes available from `data`.
+ * @var zxc_stream_input_t::pos
+ *      Number of bytes consumed from `data`.
+ * @var zxc_stream_input_t::consumed
+ *      Number of bytes read through stdio or `read_fn`.
+ * @var zxc_stream_input_t::origin
+ *      File offset of `data[0]`, used to reposition `f` afterwards.
+ * @var zxc_stream_input_t::map_addr
+ *      Start of the mapping (for munmap).
+ * @var zxc_stream_input_t::map_len
+ *      Length of the mapping, padding included.
+ */
+typedef struct {
+    FILE* f;
+    zxc_read_fn read_fn;
+    void* opaque;
+    int ended;
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+    uint64_t consumed;
+    int64_t origin;
+    void* map_addr;
+    size_t map_len;
+} zxc_stream_input_t;
+
+/**
+ * @brief Prepares the reader's input, mapping it when it is a regular file.
+ *
+ * The mapping is followed by at least one page of zeros so that the codecs'
+ * padded look-ahead past the last block (the reason `in_buf` carries
+ * `ZXC_PAD_SIZE` extra bytes) never touches unmapped memory. Falls back to
+ * stdio silently on any failure. A source callback is never mapped.
+ *
+ * @param[out] in Input state to initialize.
+ * @param[in]  io Ends of the run; only the input side is used.
+ */
+static void zxc_input_open(zxc_stream_input_t* in, const zxc_stream_io_t* io) {
+    ZXC_MEMSET(in, 0, sizeof(*in));
+    in->f = io->f_in;
+    in->read_fn = io->read_fn;
+    in->opaque = io->opaque;
+    FILE* f = io->f_in;
+    if (!f) return;
+#ifdef ZXC_STREAM_MMAP
+    struct stat st;
+    int fd = fileno(f);
+    if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) return;
+    off_t origin = ftello(f);
+    if (origin < 0 || origin >= st.st_size) return;
+
+    long page = sysconf(_SC_PAGESIZE);
+    if (page <= 0 || (uint64_t)st.st_size > (uint64_t)SIZE_MAX - (uint64_t)page) return;
+    size_t file_len = (size_t)st.st_size;
+    size_t map_len = file_len + (size_t)page;
+
+    // Reserve the whole range with zero pages, then lay the file over its start.
+    void* addr = mmap(NULL, map_len, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED) return;
+    if (mmap(addr, file_len, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(addr, map_len);
+        return;
+    }
+#ifdef MADV_SEQUENTIAL
+    madvise(addr, file_len, MADV_SEQUENTIAL);
+#endif
+    in->map_addr = addr;
+    in->map_len = map_len;
+    in->origin = (int64_t)origin;
+    in->data = (const uint8_t*)addr + origin;
+    in->size = file_len - (size_t)origin;
+#endif
+}
+
+/**
+ * @brief Releases the mapping and leaves the stream positioned right after
+ * the consumed bytes, as the stdio path would.
+ *
+ * @param[in,out] in Input state.
+ */
+static void zxc_input_close(zxc_stream_input_t* in) {
+#ifdef ZXC_STREAM_MMAP
+    if (in->data) {
+        munmap(in->map_addr, in->map_len);
+        fseeko(in->f, (off_t)(in->origin + (int64_t)in->pos), SEEK_SET);
+        in->data = NULL;
+    }
+#else
+    (void)in;
+#endif
+}
+
+/**
+ * @brief Returns a view of up to @p n mapped bytes and consumes them.
+ *
+ * @param[in,out] in  Mapped input state.
+ * @param[in]     n   Number of bytes wanted.
+ * @param[out]    got Number of bytes actually available (short at the end).
+ * @return Pointer to the bytes inside the mapping.
+ */
+static const uint8_t* zxc_input_take(zxc_stream_input_t* in, size_t n, size_t* got) {
+    const uint8_t* p = in->data + in->pos;
+    size_t left = in->size - in->pos;
+    *got = (n < left) ? n : left;
+    in->pos += *got;
+    return p;
+}
+
+/**
+ * @brief Copies up to @p n bytes of input, from the mapping, through stdio or
+ * from the source callback.
+ *
+ * Short callback reads are retried until @p n bytes, the end of the input or
+ * an error, so a short result always means the input is exhausted; the
+ * callback is not called again after that.
+ *
+ * @param[in,out] in  Input state.
+ * @param[out]    dst Destination.
+ * @param[in]     n   Number of bytes wanted.
+ * @return Number of bytes copied.
+ */
+static size_t zxc_input_read(zxc_stream_input_t* in, void* dst, size_t n) {
+    if (in->read_fn) {
+        size_t got = 0;
+        while (got < n && !in->ended) {
+            int64_t r = in->read_fn(in->opaque, (uint8_t*)dst + got, n - got);
+            if (r <= 0 || (uint64_t)r > n - got) {
+                in->ended = (r == 0) ? 1 : -1;
+                break;
+            }
+            got += (size_t)r;
+        }
+        in->consumed += got;
+        return got;
+    }
+    if (!in->data) {
+        size_t got = fread(dst, 1, n, in->f);
+        in->consumed += got;
+        return got;
+    }
+    size_t got;
+    const uint8_t* p = zxc_input_take(in, n, &got);
+    ZXC_MEMCPY(dst, p, got);
+    return got;
+}
+
+static int64_t zxc_stream_decompress_positional(zxc_pool_t* pool, zxc_stream_input_t* in,
+                                                size_t h_size, const zxc_file_header_t* fh,
+                                                FILE* f_out, int n_threads, int checksum_enabled,
+                                                zxc_perf_stats_t* perf);
+
+/**
+ * @brief Tells whether decompressed blocks can be written to @p f anywhere,
+ * in any order (a regular file not opened in append mode), or not written at
+ * all (NULL).
+ *
+ * @param[in] f Output stream, may be NULL.
+ * @return 1 if positional writes are possible, 0 otherwise.
+ */
+static int zxc_output_is_positional(FILE* f) {
+#if defined(ZXC_STREAM_MMAP) || defined(ZXC_STREAM_URING)
+    struct stat st;
+    if (!f) return 1;
+    int fd = fileno(f);
+    if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) return 0;
+    int fl = fcntl(fd, F_GETFL);
+    return fl >= 0 && !(fl & O_APPEND);
+#else
+    (void)f;
+    return 0;
+#endif
+}
+
+/**
+ * @brief Reads the next block of the input into a free slot and publishes it
+ * as `JOB_STATUS_FILLED`.
+ *
+ * Compression takes `chunk_size` raw bytes (fewer at the end of the input);
+ * decompression takes one block with its header, skipping seek tables and
+ * checking the frame digest if asked to, and stops at an END block. A block
+ * cut short by the end of the input is still published (its decoding reports
+ * the damage).
+ *
+ * @param[in,out] ctx Stream context.
+ * @param[in,out] in  Input of the run.
+ * @param[in,out] job Free slot for block @p seq.
+ * @param[in]     seq Sequence number of the block.
+ * @param[out]    eof Set once the input (or the frame) is exhausted.
+ * @return 1 if a block was published, 0 if there was none left or the framing
+ * is invalid (the engine is then stopped).
+ */
+static int zxc_reader_fill(zxc_stream_ctx_t* ctx, zxc_stream_input_t* in, zxc_stream_job_t* job,
+                           int64_t seq, int* eof) {
+    const size_t chunk_size = ctx->chunk_size;
+    size_t read_sz = 0;
+    if (ctx->compression_mode == 1) {
+        if (in->data) {
+            job->in_ptr = zxc_input_take(in, chunk_size, &read_sz);
+        } else {
+            read_sz = zxc_input_read(in, job->in_buf, chunk_size);
+            job->in_ptr = job->in_buf;
+        }
+        if (read_sz == 0) *eof = 1;
+
+        job->prefix_len = 0;
+        if (ctx->linked && seq > 0) {
+            // Mapped blocks are contiguous; copied ones get their history copied too.
+            const zxc_stream_job_t* prev = &ctx->jobs[(seq - 1) % ctx->ring_size];
+            job->prefix_len = prev->in_sz < ZXC_DICT_SIZE_MAX ? prev->in_sz : ZXC_DICT_SIZE_MAX;
+            if (!in->data)
+                ZXC_MEMCPY(job->in_buf - job->prefix_len,
+                           prev->in_ptr + prev->in_sz - job->prefix_len, job->prefix_len);
+        }
+    } else {
+        while (!*eof) {
+            uint8_t bh_buf[ZXC_BLOCK_HEADER_SIZE + ZXC_BLOCK_CHECKSUM_SIZE];
+            size_t h_read = zxc_input_read(in, bh_buf, ZXC_BLOCK_HEADER_SIZE);
+            if (UNLIKELY(h_read < ZXC_BLOCK_HEADER_SIZE)) {
+                *eof = 1;
+                break;
+            }
+            zxc_block_header_t bh;
+            zxc_read_block_header(bh_buf, ZXC_BLOCK_HEADER_SIZE, &bh);
+            if (bh.block_type == ZXC_BLOCK_END) {
+                // End of stream: the frame is complete, the input past it is left unread.
+                if (UNLIKELY(!zxc_is_end_block(bh_buf, ZXC_BLOCK_HEADER_SIZE))) {
+                    zxc_stream_stop(ctx, &ctx->io_error);
+                    return 0;
+                }
+                *eof = 1;
+                break;
+            }
+
+            int has_crc = (bh.block_flags & ZXC_BLOCK_FLAG_CHECKSUM);
+            if (has_crc) {
+                if (zxc_input_read(in, bh_buf + ZXC_BLOCK_HEADER_SIZE, ZXC_BLOCK_CHECKSUM_SIZE) !=
+                    ZXC_BLOCK_CHECKSUM_SIZE) {
+                    *eof = 1;
+                }
+            }
+
+            size_t header_len = ZXC_BLOCK_HEADER_SIZE + (has_crc ? ZXC_BLOCK_CHECKSUM_SIZE : 0);
+
+            if (ctx->digest_check && bh.block_type != ZXC_BLOCK_SEK) {
+                // The digest block is as large as a header with its checksum.
+                int ok;
+                if (bh.block_type == ZXC_BLOCK_DIG) {
+                    ok = !has_crc && bh.comp_size == ZXC_DIGEST_SIZE &&
+                         zxc_input_read(in, bh_buf + ZXC_BLOCK_HEADER_SIZE, ZXC_DIGEST_SIZE) ==
+                             ZXC_DIGEST_SIZE &&
+                         zxc_check_digest(bh_buf, ZXC_DIGEST_BLOCK_SIZE, &ctx->digest) == 0;
+                    ctx->digest_ok = ok;
+                } else {
+                    // A data block without checksum, or past the digest, is not covered.
+                    ok = !ctx->digest_ok &&
+                         zxc_digest_update(&ctx->digest, bh_buf, header_len) == 0;
+                }
+                if (UNLIKELY(!ok)) {
+                    zxc_stream_stop(ctx, &ctx->io_error);
+                    return 0;
+                }
+                if (bh.block_type == ZXC_BLOCK_DIG) continue;
+            }
+
+            if (bh.block_type == ZXC_BLOCK_SEK || bh.block_type == ZXC_BLOCK_DIG) {
+                // Seek table or unchecked digest: not needed for sequential decoding, drain it.
+                size_t left = bh.comp_size;
+                if (in->data) {
+                    size_t got;
+                    zxc_input_take(in, left, &got);
+                    if (got != left) *eof = 1;
+                    left = 0;
+                }
+                while (left > 0) {
+                    size_t n = left < job->in_cap ? left : job->in_cap;
+                    if (zxc_input_read(in, job->in_buf, n) != n) {
+                        *eof = 1;
+                        break;
+                    }
+                    left -= n;
+                }
+                continue;
+            }
+
+            if (UNLIKELY(bh.comp_size > job->in_cap - header_len)) {
+                zxc_stream_stop(ctx, &ctx->io_error);
+                return 0;
+            }
+
+            size_t body_read;
+            if (in->data) {
+                // Header and body are already contiguous in the mapping.
+                job->in_ptr = in->data + in->pos - header_len;
+                zxc_input_take(in, bh.comp_size, &body_read);
+            } else {
+                ZXC_MEMCPY(job->in_buf, bh_buf, header_len);
+                body_read = zxc_input_read(in, job->in_buf + header_len, bh.comp_size);
+                job->in_ptr = job->in_buf;
+            }
+            read_sz = header_len + body_read;
+            if (UNLIKELY(body_read != bh.comp_size)) *eof = 1;
+            break;
+        }
+    }
+    if (*eof && read_sz == 0) return 0;
+
+    job->in_sz = read_sz;
+    zxc_job_publish(job, zxc_job_stamp(seq, JOB_STATUS_FILLED));
+    if (read_sz < chunk_size && ctx->compression_mode == 1) *eof = 1;
+    return 1;
+}
+
+/**
+ * @brief Reader, writer and worker of a stream run on a pool, all on the
+ * calling thread.
+ *
+ * The pool threads take blocks through `zxc_stream_pool_step()`. The caller
+ * writes the next block as soon as it is processed, otherwise fills the next
+ * free slot, otherwise processes a block itself, and only waits for the next
+ * block to write when none of this is possible. The digest and seek table,
+ * if any, are written last.
+ *
+ * @param[in,out] ctx    Stream context, ring set up.
+ * @param[in,out] in     Input of the run.
+ * @param[in,out] w_args Writer state, file header already written.
+ * @param[in,out] pool   Pool.
+ */
+static void zxc_stream_pool_loop(zxc_stream_ctx_t* ctx, zxc_stream_input_t* in,
+                                 writer_args_t* w_args, zxc_pool_t* pool) {
+    zxc_pool_slot_t* slot = zxc_pool_borrow(pool);
+    if (UNLIKELY(!slot)) {
+        zxc_stream_stop(ctx, &ctx->io_error);
+        return;
+    }
+    zxc_pool_run_t run;
+    ZXC_MEMSET(&run, 0, sizeof(run));
+    run.step = zxc_stream_pool_step;
+    run.arg = ctx;
+    zxc_pool_attach(pool, &run);
+
+    int64_t read_seq = 0, write_seq = 0;
+    int read_eof = 0, lagging = 0;
+    zxc_perf_stats_t* perf = &w_args->perf;
+    uint64_t t0 = 0;
+    while (!ctx->io_error) {
+        zxc_stream_job_t* out_job = &ctx->jobs[write_seq % ctx->ring_size];
+        const int64_t processed = zxc_job_stamp(write_seq, JOB_STATUS_PROCESSED);
+        if (ctx->perf) t0 = zxc_perf_now();
+        if (write_seq < read_seq && ZXC_ATOMIC_LOAD(&out_job->stamp) == processed) {
+            zxc_level_ctl_update(ctx, out_job, lagging);
+            lagging = 0;
+            if (zxc_writer_emit(w_args, out_job, write_seq) != 0) break;
+            if (ctx->perf) perf->write_ns += zxc_perf_now() - t0;
+            write_seq++;
+            continue;
+        }
+        if (read_eof && write_seq == read_seq) break;
+
+        zxc_stream_job_t* in_job = &ctx->jobs[read_seq % ctx->ring_size];
+        if (!read_eof &&
+            ZXC_ATOMIC_LOAD(&in_job->stamp) == zxc_job_stamp(read_seq, JOB_STATUS_FREE)) {
+            if (zxc_reader_fill(ctx, in, in_job, read_seq, &read_eof)) {
+                read_seq++;
+                zxc_pool_notify(pool, 0);
+            } else {
+                read_eof = 1;
+            }
+            if (ctx->perf) perf->read_ns += zxc_perf_now() - t0;
+            continue;
+        }
+        if (zxc_stream_pool_step(&run, slot)) continue;
+        lagging |= zxc_level_ctl_lagging(ctx, out_job, write_seq);
+        if (zxc_job_wait_timed(ctx, out_job, processed, &perf->write_wait_ns) != 0) break;
+    }
+
+    zxc_pool_detach(pool, &run);
+    zxc_pool_return(pool, slot);
+    if (ctx->perf) zxc_perf_stats_add(ctx->perf, perf);
+    if (!ctx->io_error && zxc_write_trailer_blocks(w_args) != 0)
+        zxc_stream_stop(ctx, &ctx->io_error);
+}
+
+/**
+ * @brief Reader loop of a stream run on its own threads: starts the workers
+ * and the writer, feeds the ring until the end of the input, then stops and
+ * joins them all.
+ *
+ * @param[in,out] ctx         Stream context, ring set up.
+ * @param[in,out] in          Input of the run.
+ * @param[in,out] w_args      Writer state, file header already written.
+ * @param[out]    workers     Room for @p num_workers thread handles.
+ * @param[in]     num_workers Number of workers to start.
+ */
+static void zxc_stream_thread_loop(zxc_stream_ctx_t* ctx, zxc_stream_input_t* in,
+                                   writer_args_t* w_args, pthread_t* workers, int num_workers) {
+    for (int i = 0; i < num_workers; i++) {
+        pthread_create(&workers[i], NULL, zxc_stream_worker, ctx);
+        zxc_pin_thread(workers[i], i);
+    }
+#ifdef ZXC_STREAM_URING
+    // Ordered writes to a regular file can overlap: hand them to io_uring.
+    FILE* f_out = w_args->f;
+    w_args->ring.fd = -1;
+    if (f_out && !w_args->write_fn && !(zxc_stream_get_flags() & ZXC_STREAM_NO_URING) &&
+        zxc_output_is_positional(f_out) && fflush(f_out) == 0) {
+        off_t pos = ftello(f_out);
+        if (pos >= 0 && zxc_uring_init(&w_args->ring, (unsigned)ctx->ring_size) == 0) {
+            w_args->out_fd = fileno(f_out);
+            w_args->out_off = (int64_t)pos;
+        }
+    }
+#endif
+    pthread_t writer_th;
+    pthread_create(&writer_th, NULL, zxc_async_writer, w_args);
+
+    int64_t read_seq = 0;
+    int read_eof = 0;
+    zxc_perf_stats_t rd;
+    ZXC_MEMSET(&rd, 0, sizeof(rd));
+
+    // Reader Loop: Reads from file, prepares jobs, publishes them to the workers.
+    while (!read_eof && !ctx->io_error) {
+        zxc_stream_job_t* job = &ctx->jobs[read_seq % ctx->ring_size];
+        if (zxc_job_wait_timed(ctx, job, zxc_job_stamp(read_seq, JOB_STATUS_FREE),
+                               &rd.read_wait_ns) != 0)
+            break;
+
+        const uint64_t t0 = ctx->perf ? zxc_perf_now() : 0;
+        if (!zxc_reader_fill(ctx, in, job, read_seq, &read_eof)) break;
+        if (ctx->perf) rd.read_ns += zxc_perf_now() - t0;
+        read_seq++;
+    }
+
+    // End marker: handed straight to the writer, workers never claim it.
+    zxc_stream_job_t* end_job = &ctx->jobs[read_seq % ctx->ring_size];
+    if (zxc_job_wait(ctx, end_job, zxc_job_stamp(read_seq, JOB_STATUS_FREE)) == 0) {
+        end_job->result_sz = -1;
+        zxc_job_publish(end_job, zxc_job_stamp(read_seq, JOB_STATUS_PROCESSED));
+    }
+
+    pthread_join(writer_th, NULL);
+#ifdef ZXC_STREAM_URING
+    zxc_uring_free(&w_args->ring);
+#endif
+    // Workers that claimed a block past the end are parked on it: release them.
+    zxc_stream_stop(ctx, &ctx->shutdown_workers);
+    for (int i = 0; i < num_workers; i++) pthread_join(workers[i], NULL);
+    if (ctx->perf) {
+        zxc_perf_stats_add(ctx->perf, &rd);
+        zxc_perf_stats_add(ctx->perf, &w_args->perf);
+    }
+}
+
+/**
+ * @brief Orchestrates the multithreaded streaming compression or decompression
+ * engine.
+ *
+ * This function initializes the stream context, allocates the necessary ring
+ * buffer memory for jobs and I/O buffers, and spawns the worker threads and the
+ * asynchronous writer thread. It acts as the main "producer" (reader) loop.
+ *
+ * **Architecture: Producer-Consumer with Ring Buffer**
+ * - **Ring Buffer:** A fixed-size array of `zxc_stream_job_t` structures.
+ * - **Producer (Main Thread):** Reads chunks from `f_in` and fills "Free" slots
+ *   in the ring buffer. It blocks if no slots are free (backpressure).
+ * - **Workers:** Claim "Filled" jobs in sequence order, process them, and mark
+ * them as "Processed".
+ * - **Consumer (Writer Thread):** Waits for the *next sequential* job to be
+ *   "Processed", writes it to `f_out`, and marks the slot as "Free".
+ *
+ * **Double-Buffering & Zero-Copy:**
+ * We allocate `alloc_in` and `alloc_out` buffers for each job. The reader reads
+ * directly into `in_buf`, and the writer writes directly from `out_buf`,
+ * minimizing memory copies. When `f_in` is a regular file it is mapped instead
+ * (see `zxc_stream_input_t`): jobs then point into the mapping and no input
+ * buffers are allocated at all.
+ *
+ * **Positional Decompression:**
+ * A mapped input decompressed into a regular file (or into nothing) does not
+ * need the ring at all: the whole frame is visible, so it is handed to
+ * `zxc_stream_decompress_positional()`, whose workers pick blocks themselves
+ * and write them at their raw offsets.
+ *
+ * **Shared Pool:**
+ * With a pool, no thread is started: the pool threads process the blocks and
+ * the calling thread does the reading and the writing, see
+ * `zxc_stream_pool_loop()`. The ring buffers come from the pool's cache.
+ *
+ * @param[in] pool      Pool to run on, or NULL to start threads for this run.
+ * @param[in] io        Input and output of the run: stdio streams or callbacks.
+ * @param[in] n_threads Number of worker threads to spawn. If set to 0 or less, the
+ * function automatically detects the number of online processors. Ignored with
+ * a pool.
+ * @param[in] mode      Operation mode: 1 for compression, 0 for decompression.
+ * @param[in] level     Compression level to be applied (relevant for compression
+ * mode).
+ * @param[in] checksum_enabled  Flag indicating whether to enable checksum
+ * generation/verification.
+ * @param[in] seekable  Compression only: append a seek table after the last block.
+ * @param[in] digest    Compression only: append a frame digest after the last block
+ * (decompression checks it whenever the frame has one and checksums are verified).
+ * @param[in] linked    Compression only: link every block to the previous one.
+ * @param[in] num_type  Compression only: element type hint for NUM blocks.
+ * @param[in] elem_size Compression only: byte-shuffle element size (0 or 1 = off).
+ * @param[out] stats    Compression only: block selection counters to add to (NULL = none).
+ * @param[in] block_size Compression only: validated block size (ignored when
+ * decompressing, where the file header provides it).
+ * @param[in] level_max Compression only: adapt the level of every block between
+ * @p level and this (0 or @p level = fixed level), see zxc_level_ctl_update().
+ * @param[in] target_mb_s Adaptive compression only: speed to hold in MB/s (0 =
+ * follow the writer).
+ * @param[in] func      Function pointer to the chunk processor (compression or
+ * decompression logic).
+ * @param[out] perf     Performance counters of the call (NULL = not collected).
+ *
+ * @return The total number of bytes written to the output stream on success, or
+ * -1 if an initialization or I/O error occurred.
+ */
+static int64_t zxc_stream_engine_exec(zxc_pool_t* pool, const zxc_stream_io_t* io, int n_threads,
+                                      int mode, int level, int checksum_enabled, int seekable,
+                                      int digest, int linked, int num_type, size_t elem_size,
+                                      zxc_block_stats_t* stats, size_t block_size, int level_max,
+                                      uint32_t target_mb_s, zxc_chunk_processor_t func,
+                                      zxc_perf_stats_t* perf) {
+    // A seek table promises independent blocks; linked blocks are not. Linked
+    // history is raw data, so it does not mix with shuffled blocks either.
+    if (UNLIKELY(seekable && linked)) return -1;
+    // The digest combines the block checksums.
+    if (mode == 1 && digest) checksum_enabled = 1;
+    if (UNLIKELY(elem_size > ZXC_ELEM_SIZE_MAX || (linked && elem_size > 1))) return -1;
+    if (mode == 0 || level_max == 0)
+        level_max = level;
+    else if (UNLIKELY(level_max < level || level_max > ZXC_LEVEL_ARCHIVE))
+        return -1;
+
+    zxc_stream_ctx_t ctx;
+    ZXC_MEMSET(&ctx, 0, sizeof(ctx));
+
+    ctx.compression_mode = mode;
+    ctx.processor = func;
+    ctx.io_error = 0;
+    ctx.checksum_enabled = checksum_enabled;
+    ctx.compression_level = level;
+    ctx.linked = linked;
+    ctx.num_type = num_type;
+    ctx.elem_size = elem_size;
+    ctx.stats = stats;
+    ctx.perf = perf;
+
+    int num_procs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int num_threads = (n_threads > 0) ? n_threads : num_procs;
+    // Reserve 1 thread for Writer/Reader overhead if possible
+    int num_workers = (num_threads > 1) ? num_threads - 1 : 1;
+    if (pool) {
+        // The calling thread comes on top of the pool's.
+        num_workers = pool->n_threads;
+        num_threads = num_workers + 1;
+    }
+    ctx.ring_size = num_workers * 4;
+    ctx.level_now = level;
+    ctx.adapt.min = level;
+    ctx.adapt.max = level_max;
+    ctx.adapt.target_bps = level_max > level ? (uint64_t)target_mb_s * 1000000 : 0;
+    ctx.adapt.n_workers = num_workers;
+    // A spinning thread would steal the core of the one it waits for.
+    ctx.spin_count = (num_procs > 1 && num_threads <= num_procs) ? ZXC_SPIN_COUNT : 0;
+
+    zxc_stream_input_t in;
+    zxc_input_open(&in, io);
+
+    size_t runtime_chunk_sz = block_size;
+    int64_t expected_raw = -1;  // Content size announced by the header, if any
+    if (mode == 0) {
+        // Fixed part first: its flags byte tells how many optional bytes follow.
+        uint8_t h[ZXC_FILE_HEADER_MAX_SIZE];
+        zxc_file_header_t fh;
+        size_t h_size = ZXC_FILE_HEADER_SIZE;
+        int ok = zxc_input_read(&in, h, ZXC_FILE_HEADER_SIZE) == ZXC_FILE_HEADER_SIZE;
+        if (ok) {
+            h_size = zxc_file_header_size(h[6]);
+            ok = zxc_input_read(&in, h + ZXC_FILE_HEADER_SIZE, h_size - ZXC_FILE_HEADER_SIZE) ==
+                     h_size - ZXC_FILE_HEADER_SIZE &&
+                 zxc_read_file_header(h, h_size, &fh) >= 0 &&
+                 !(fh.flags & ZXC_FILE_FLAG_DICT_ID);  // Dictionaries: buffer API only
+        }
+        if (UNLIKELY(!ok)) {
+            zxc_input_close(&in);
+            return -1;
+        }
+        if (in.data && zxc_output_is_positional(io->f_out)) {
+            int64_t res = zxc_stream_decompress_positional(pool, &in, h_size, &fh, io->f_out,
+                                                           n_threads, checksum_enabled, perf);
+            if (res != -2) {
+                if (perf) perf->bytes_in = in.pos;
+                zxc_input_close(&in);
+                return res;
+            }
+        }
+        runtime_chunk_sz = fh.block_size;
+        if (fh.flags & ZXC_FILE_FLAG_CONTENT_SIZE) expected_raw = (int64_t)fh.content_size;
+        ctx.digest_check = checksum_enabled && (fh.flags & ZXC_FILE_FLAG_DIGEST);
+    }
+    ctx.chunk_size = runtime_chunk_sz;
+
+    size_t max_out = zxc_compress_bound(runtime_chunk_sz);
+    size_t raw_alloc_in = ((mode) ? runtime_chunk_sz : max_out) + ZXC_PAD_SIZE;
+    size_t alloc_in = (raw_alloc_in + ZXC_ALIGNMENT_MASK) & ~ZXC_ALIGNMENT_MASK;
+    const size_t in_cap = alloc_in - ZXC_PAD_SIZE;
+    // Room for the previous block's tail in front of each raw buffer: the input
+    // of linked compression, the output of any decompression (linked blocks
+    // are only found while decoding).
+    const size_t hist = (ZXC_DICT_SIZE_MAX + ZXC_ALIGNMENT_MASK) & ~ZXC_ALIGNMENT_MASK;
+    size_t hist_in = (mode == 1 && linked) ? hist : 0;
+    size_t hist_out = (mode == 0) ? hist : 0;
+    alloc_in += hist_in;
+    if (in.data) alloc_in = 0;  // Jobs read straight from the mapping.
+
+    size_t raw_alloc_out = ((mode) ? max_out : runtime_chunk_sz) + ZXC_PAD_SIZE;
+    size_t alloc_out = (raw_alloc_out + ZXC_ALIGNMENT_MASK) & ~ZXC_ALIGNMENT_MASK;
+    alloc_out += hist_out;
+
+    size_t alloc_size = ctx.ring_size * (sizeof(zxc_stream_job_t) + alloc_in + alloc_out);
+    uint8_t* mem_block = zxc_pool_get_mem(pool, alloc_size);
+    if (UNLIKELY(!mem_block)) {
+        zxc_input_close(&in);
+        return -1;
+    }
+    // A block reused from the pool holds the previous run's jobs.
+    ZXC_MEMSET(mem_block, 0, ctx.ring_size * sizeof(zxc_stream_job_t));
+
+    uint8_t* ptr = mem_block;
+    ctx.jobs = (zxc_stream_job_t*)ptr;
+    ptr += ctx.ring_size * sizeof(zxc_stream_job_t);
+    uint8_t* buf_in = ptr;
+    ptr += ctx.ring_size * alloc_in;
+    uint8_t* buf_out = ptr;
+
+    for (int i = 0; i < ctx.ring_size; i++) {
+        ctx.jobs[i].job_id = i;
+        ctx.jobs[i].stamp = zxc_job_stamp(i, JOB_STATUS_FREE);
+        ctx.jobs[i].waiters = 0;
+        ctx.jobs[i].in_buf = alloc_in ? buf_in + (i * alloc_in) + hist_in : NULL;
+        ctx.jobs[i].in_cap = in_cap;
+        ctx.jobs[i].out_buf = buf_out + (i * alloc_out) + hist_out;
+        ctx.jobs[i].out_cap = alloc_out - hist_out - ZXC_PAD_SIZE;
+        ctx.jobs[i].result_sz = 0;
+        pthread_mutex_init(&ctx.jobs[i].park_lock, NULL);
+        pthread_cond_init(&ctx.jobs[i].park_cond, NULL);
+    }
+
+    pthread_mutex_init(&ctx.stats_lock, NULL);
+
+    pthread_t* workers = pool ? NULL : malloc(num_workers * sizeof(pthread_t));
+    if (UNLIKELY(!pool && !workers)) {
+        for (int i = 0; i < ctx.ring_size; i++) {
+            pthread_mutex_destroy(&ctx.jobs[i].park_lock);
+            pthread_cond_destroy(&ctx.jobs[i].park_cond);
+        }
+        pthread_mutex_destroy(&ctx.stats_lock);
+        zxc_pool_put_mem(pool, mem_block, alloc_size);
+        zxc_input_close(&in);
+        return -1;
+    }
+
+    writer_args_t w_args;
+    ZXC_MEMSET(&w_args, 0, sizeof(w_args));
+    w_args.ctx = &ctx;
+    w_args.f = io->f_out;
+    w_args.write_fn = io->write_fn;
+    w_args.opaque = io->opaque;
+    w_args.digest = mode == 1 && digest;
+    if (mode == 1 && seekable) {
+        w_args.seek_cap = 64;
+        w_args.seek = malloc(w_args.seek_cap * sizeof(zxc_seek_entry_t));
+        if (UNLIKELY(!w_args.seek)) zxc_stream_stop(&ctx, &ctx.io_error);
+    }
+    if (mode == 1) {
+        // The total size is not known up front: stream frames carry no content size.
+        uint8_t h[ZXC_FILE_HEADER_SIZE];
+        zxc_file_header_t fh = {runtime_chunk_sz,
+                                seekable ? ZXC_FILE_FLAG_SEEKABLE : ZXC_FILE_FLAG_NONE, 0, 0};
+        if (digest) fh.flags |= ZXC_FILE_FLAG_DIGEST;
+        zxc_write_file_header(h, sizeof(h), &fh);
+        if (zxc_output_write(&w_args, h, ZXC_FILE_HEADER_SIZE) != 0) {
+            zxc_stream_stop(&ctx, &ctx.io_error);
+        }
+        w_args.total_bytes = ZXC_FILE_HEADER_SIZE;
+    }
+    if (pool)
+        zxc_stream_pool_loop(&ctx, &in, &w_args, pool);
+    else
+        zxc_stream_thread_loop(&ctx, &in, &w_args, workers, num_workers);
+
+    for (int i = 0; i < ctx.ring_size; i++) {
+        pthread_mutex_destroy(&ctx.jobs[i].park_lock);
+        pthread_cond_destroy(&ctx.jobs[i].park_cond);
+    }
+    pthread_mutex_destroy(&ctx.stats_lock);
+    free(workers);
+    free(w_args.seek);
+    zxc_pool_put_mem(pool, mem_block, alloc_size);
+    if (perf) perf->bytes_in = in.consumed + in.pos;
+    zxc_input_close(&in);
+
+    if (UNLIKELY(ctx.io_error || in.ended < 0)) return -1;
+    if (UNLIKELY(ctx.digest_check && !ctx.digest_ok)) return -1;
+    if (UNLIKELY(expected_raw >= 0 && w_args.total_bytes != expected_raw)) return -1;
+
+    return w_args.total_bytes;
+}
+
+/**
+ * @brief zxc_stream_engine_exec() as an instrumented call (see zxc_perf_begin()).
+ */
+static int64_t zxc_stream_engine_run(zxc_pool_t* pool, const zxc_stream_io_t* io, int n_threads,
+                                     int mode, int level, int checksum_enabled, int seekable,
+                                     int digest, int linked, int num_type, size_t elem_size,
+                                     zxc_block_stats_t* stats, size_t block_size, int level_max,
+                                     uint32_t target_mb_s, zxc_chunk_processor_t func) {
+    zxc_perf_call_t call;
+    zxc_perf_stats_t* perf =
+        zxc_perf_begin(&call, mode == 1 ? "stream_compress" : "stream_decompress");
+    int64_t res = zxc_stream_engine_exec(pool, io, n_threads, mode, level, checksum_enabled,
+                                         seekable, digest, linked, num_type, elem_size, stats,
+                                         block_size, level_max, target_mb_s, func, perf);
+    zxc_perf_end(&call, 0, res > 0 ? (uint64_t)res : 0);
+    return res;
+}
+
+/**
+ * @brief Resolves the compression options and runs the engine on @p io.
+ *
+ * @param[in] pool      Pool to run on, or NULL.
+ * @param[in] io        Ends of the run.
+ * @param[in] n_threads Number of threads (0 = auto).
+ * @param[in] opts      Frame options (NULL selects the defaults).
+ * @return Total compressed bytes written, or -1 on error.
+ */
+static int64_t zxc_stream_compress_io(zxc_pool_t* pool, const zxc_stream_io_t* io,
+                                      int n_threads, const zxc_compress_opts_t* opts) {
+    int level = (opts && opts->level > 0) ? opts->level : ZXC_LEVEL_DEFAULT;
+    size_t block_size = zxc_resolve_block_size(opts ? opts->block_size : 0);
+    if (UNLIKELY(block_size == 0)) return -1;
+
+    return zxc_stream_engine_run(pool, io, n_threads, 1, level,
+                                 opts ? opts->checksum_enabled : 0, opts ? opts->seekable : 0,
+                                 opts ? opts->digest : 0, opts ? opts->linked : 0,
+                                 opts ? opts->num_type : ZXC_NUM_AUTO, opts ? opts->elem_size : 0,
+                                 opts ? opts->block_stats : NULL, block_size,
+                                 opts ? opts->level_max : 0, opts ? opts->target_mb_s : 0,
+                                 zxc_compress_chunk_wrapper);
+}
+
+/**
+ * @brief Runs the decompression engine on @p io.
+ *
+ * @param[in] pool             Pool to run on, or NULL.
+ * @param[in] io               Ends of the run.
+ * @param[in] n_threads        Number of threads (0 = auto).
+ * @param[in] checksum_enabled Verify block checksums.
+ * @return Total decompressed bytes written, or -1 on error.
+ */
+static int64_t zxc_stream_decompress_io(zxc_pool_t* pool, const zxc_stream_io_t* io,
+                                        int n_threads, int checksum_enabled) {
+    return zxc_stream_engine_run(pool, io, n_threads, 0, 0, checksum_enabled, 0, 0, 0,
+                                 ZXC_NUM_AUTO, 0, NULL, 0, 0, 0,
+                                 (zxc_chunk_processor_t)zxc_decompress_chunk_wrapper);
+}
+
+int64_t zxc_stream_compress(FILE* f_in, FILE* f_out, int n_threads, int level,
+                            int checksum_enabled) {
+    if (UNLIKELY(!f_in)) return -1;
+
+    zxc_stream_io_t io = {f_in, f_out, NULL, NULL, NULL};
+    return zxc_stream_engine_run(NULL, &io, n_threads, 1, level, checksum_enabled, 0, 0, 0,
+                                 ZXC_NUM_AUTO, 0, NULL, ZXC_BLOCK_SIZE, 0, 0,
+                                 zxc_compress_chunk_wrapper);
+}
+
+int64_t zxc_stream_compress_ex(FILE* f_in, FILE* f_out, int n_threads,
+                               const zxc_compress_opts_t* opts) {
+    if (UNLIKELY(!f_in)) return -1;
+
+    zxc_stream_io_t io = {f_in, f_out, NULL, NULL, NULL};
+    return zxc_stream_compress_io(NULL, &io, n_threads, opts);
+}
+
+int64_t zxc_stream_decompress(FILE* f_in, FILE* f_out, int n_threads, int checksum_enabled) {
+    if (UNLIKELY(!f_in)) return -1;
+
+    zxc_stream_io_t io = {f_in, f_out, NULL, NULL, NULL};
+    return zxc_stream_decompress_io(NULL, &io, n_threads, checksum_enabled);
+}
+
+// cppcheck-suppress unusedFunction
+int64_t zxc_stream_compress_cb(zxc_read_fn read_fn, zxc_write_fn write_fn, void* opaque,
+                               int n_threads, const zxc_compress_opts_t* opts) {
+    if (UNLIKELY(!read_fn)) return -1;
+
+    zxc_stream_io_t io = {NULL, NULL, read_fn, write_fn, opaque};
+    return zxc_stream_compress_io(NULL, &io, n_threads, opts);
+}
+
+// cppcheck-suppress unusedFunction
+int64_t zxc_stream_decompress_cb(zxc_read_fn read_fn, zxc_write_fn write_fn, void* opaque,
+                                 int n_threads, int checksum_enabled) {
+    if (UNLIKELY(!read_fn)) return -1;
+
+    zxc_stream_io_t io = {NULL, NULL, read_fn, write_fn, opaque};
+    return zxc_stream_decompress_io(NULL, &io, n_threads, checksum_enabled);
+}
+
+// cppcheck-suppress unusedFunction
+int64_t zxc_stream_compress_pool(zxc_pool_t* pool, FILE* f_in, FILE* f_out,
+                                 const zxc_compress_opts_t* opts) {
+    if (UNLIKELY(!pool || !f_in)) return -1;
+
+    zxc_stream_io_t io = {f_in, f_out, NULL, NULL, NULL};
+    return zxc_stream_compress_io(pool, &io, 0, opts);
+}
+
+// cppcheck-suppress unusedFunction
+int64_t zxc_stream_decompress_pool(zxc_pool_t* pool, FILE* f_in, FILE* f_out,
+                                   int checksum_enabled) {
+    if (UNLIKELY(!pool || !f_in)) return -1;
+
+    zxc_stream_io_t io = {f_in, f_out, NULL, NULL, NULL};
+    return zxc_stream_decompress_io(pool, &io, 0, checksum_enabled);
+}
+
+// cppcheck-suppress unusedFunction
+int64_t zxc_stream_compress_cb_pool(zxc_pool_t* pool, zxc_read_fn read_fn, zxc_write_fn write_fn,
+                                    void* opaque, const zxc_compress_opts_t* opts) {
+    if (UNLIKELY(!pool || !read_fn)) return -1;
+
+    zxc_stream_io_t io = {NULL, NULL, read_fn, write_fn, opaque};
+    return zxc_stream_compress_io(pool, &io, 0, opts);
+}
+
+// cppcheck-suppress unusedFunction
+int64_t zxc_stream_decompress_cb_pool(zxc_pool_t* pool, zxc_read_fn read_fn,
+                                      zxc_write_fn write_fn, void* opaque, int checksum_enabled) {
+    if (UNLIKELY(!pool || !read_fn)) return -1;
+
+    zxc_stream_io_t io = {NULL, NULL, read_fn, write_fn, opaque};
+    return zxc_stream_decompress_io(pool, &io, 0, checksum_enabled);
+}
+
+/*
+ * ============================================================================
+ * PARALLEL BUFFER API
+ * ============================================================================
+ * Buffer-to-buffer variants of zxc_compress() / zxc_decompress() that spread
+ * the blocks of a single in-memory frame across a pool of worker threads.
+ * Blocks are independent, so each worker only needs its own context; the
+ * block table built up-front tells every worker where to read and where to
+ * write.
+ */
+
+/**
+ * @struct zxc_buffer_block_t
+ * @brief Describes the location of one block inside a parallel buffer job.
+ *
+ * @var zxc_buffer_block_t::src_off
+ *      Offset of the block in the source buffer.
+ * @var zxc_buffer_block_t::src_len
+ *      Length of the block in the source buffer (raw bytes when compressing,
+ * header + payload + checksum when decompressing).
+ * @var zxc_buffer_block_t::dst_off
+ *      Offset of the block output (compression slot or raw offset).
+ * @var zxc_buffer_block_t::dst_cap
+ *      Capacity reserved for the block output.
+ * @var zxc_buffer_block_t::result_sz
+ *      Number of bytes actually produced by the worker.
+ */
+typedef struct {
+    size_t src_off;
+    size_t src_len;
+    size_t dst_off;
+    size_t dst_cap;
+    size_t result_sz;
+} zxc_buffer_block_t;
+
+/**
+ * @struct zxc_buffer_mt_ctx_t
+ * @brief Shared state for a parallel buffer compression/decompression call.
+ *
+ * @var zxc_buffer_mt_ctx_t::src
+ *      Source buffer.
+ * @var zxc_buffer_mt_ctx_t::src_end
+ *      End of the source buffer (bounds decoder look-ahead).
+ * @var zxc_buffer_mt_ctx_t::dst
+ *      Base of the output area addressed by `zxc_buffer_block_t::dst_off`.
+ * When NULL (decompression only), each worker decodes into a private buffer
+ * and writes it to `out_fd` instead.
+ * @var zxc_buffer_mt_ctx_t::out_fd
+ *      File descriptor receiving the blocks when `dst` is NULL, or -1 to only
+ * decode them.
+ * @var zxc_buffer_mt_ctx_t::out_origin
+ *      File offset of raw byte 0 in `out_fd`.
+ * @var zxc_buffer_mt_ctx_t::blocks
+ *      Block table, one entry per block.
+ * @var zxc_buffer_mt_ctx_t::n_blocks
+ *      Number of entries in the block table.
+ * @var zxc_buffer_mt_ctx_t::next_block
+ *      Index of the next block to hand out (claimed with an atomic fetch-add).
+ * @var zxc_buffer_mt_ctx_t::linked
+ *      Compression only: link every block to the tail of the previous one.
+ * The source is one contiguous buffer, so the history is simply read in place.
+ * @var zxc_buffer_mt_ctx_t::num_type
+ *      Compression only: element type hint for NUM blocks (zxc_num_type_t).
+ * @var zxc_buffer_mt_ctx_t::elem_size
+ *      Compression only: byte-shuffle element size (0 or 1 = off).
+ * @var zxc_buffer_mt_ctx_t::stats
+ *      Compression only: block selection counters the workers add to on exit
+ * (NULL = not collected).
+ * @var zxc_buffer_mt_ctx_t::perf
+ *      Performance counters of the call (NULL = not collected).
+ * @var zxc_buffer_mt_ctx_t::stats_lock
+ *      Serializes the updates of `stats` and `perf`.
+ * @var zxc_buffer_mt_ctx_t::error
+ *      Set by any worker that fails; remaining blocks are skipped.
+ */
+typedef struct {
+    const uint8_t* src;
+    const uint8_t* src_end;
+    uint8_t* dst;
+    int out_fd;
+    int64_t out_origin;
+    zxc_buffer_block_t* blocks;
+    size_t n_blocks;
+    ZXC_ATOMIC int64_t next_block;
+    int mode;
+    int level;
+    int checksum_enabled;
+    size_t chunk_size;
+    int linked;
+    int num_type;
+    size_t elem_size;
+    zxc_block_stats_t* stats;
+    zxc_perf_stats_t* perf;
+    pthread_mutex_t stats_lock;
+    ZXC_ATOMIC int error;
+} zxc_buffer_mt_ctx_t;
+
+/**
+ * @brief Adds a thread's counters to those of a parallel buffer call.
+ *
+ * @param[in,out] ctx     Shared context.
+ * @param[in]     cctx    Context of the thread (block counters, checksum time).
+ * @param[in]     work_ns Time the thread spent on its blocks.
+ */
+static void zxc_buffer_add_stats(zxc_buffer_mt_ctx_t* ctx, const zxc_cctx_t* cctx,
+                                 uint64_t work_ns) {
+    if (!ctx->stats && !ctx->perf) return;
+    pthread_mutex_lock(&ctx->stats_lock);
+    if (ctx->stats) zxc_block_stats_add(ctx->stats, &cctx->stats);
+    if (ctx->perf) {
+        zxc_block_stats_add(&ctx->perf->blocks, &cctx->stats);
+        ctx->perf->checksum_ns += cctx->checksum_ns;
+        ctx->perf->work_ns += work_ns;
+    }
+    pthread_mutex_unlock(&ctx->stats_lock);
+}
+
+/**
+ * @brief Compresses or decompresses block @p i of a parallel buffer call.
+ *
+ * @param[in,out] ctx     Shared context.
+ * @param[in,out] cctx    Context of the calling thread.
+ * @param[out]    scratch Private output buffer when `ctx->dst` is NULL.
+ * @param[in]     i       Index of the block.
+ * @return 0 on success, -1 if the block failed.
+ */
+static int zxc_buffer_process(zxc_buffer_mt_ctx_t* ctx, zxc_cctx_t* cctx, uint8_t* scratch,
+                              size_t i) {
+    zxc_buffer_block_t* b = &ctx->blocks[i];
+    int res;
+    if (ctx->mode == 1) {
+        size_t prev_len = (ctx->linked && i > 0) ? ctx->blocks[i - 1].src_len : 0;
+        res = zxc_cctx_link(cctx, ctx->src + b->src_off - prev_len, prev_len, 1);
+        if (LIKELY(res == 0))
+            res = zxc_compress_chunk_wrapper(cctx, ctx->src + b->src_off, b->src_len,
+                                             ctx->dst + b->dst_off, b->dst_cap);
+    } else {
+        // Let the decoder see the rest of the input (read-only look-ahead), but
+        // never more output than the block owns: neighbours are written concurrently.
+        uint8_t* out = scratch ? scratch : ctx->dst + b->dst_off;
+        res = zxc_decompress_chunk_wrapper(cctx, ctx->src + b->src_off,
+                                           (size_t)(ctx->src_end - (ctx->src + b->src_off)), out,
+                                           b->dst_cap);
+        if (res >= 0 && (size_t)res != b->dst_cap) res = -1;
+#ifdef ZXC_STREAM_MMAP
+        if (res > 0 && scratch && ctx->out_fd >= 0 &&
+            zxc_pwrite_all(ctx->out_fd, scratch, (size_t)res,
+                           ctx->out_origin + (int64_t)b->dst_off) != 0)
+            res = -1;
+#endif
+    }
+    if (UNLIKELY(res < 0)) return -1;
+    b->result_sz = (size_t)res;
+    return 0;
+}
+
+/**
+ * @brief Worker thread for the parallel buffer API.
+ *
+ * Claims block indices one at a time from the shared counter and runs the
+ * dispatched chunk compressor/decompressor on them with a thread-local
+ * context. Each block writes into its own disjoint region of the output, so no
+ * locking is needed around the processing itself.
+ *
+ * @param[in] arg Pointer to the shared `zxc_buffer_mt_ctx_t`.
+ * @return Always returns NULL.
+ */
+static void* zxc_buffer_mt_worker(void* arg) {
+    zxc_buffer_mt_ctx_t* ctx = (zxc_buffer_mt_ctx_t*)arg;
+    zxc_cctx_t cctx;
+    uint8_t* scratch = NULL;
+
+    if (zxc_cctx_init(&cctx, ctx->chunk_size, ctx->mode, ctx->level, ctx->checksum_enabled) !=
+        0) {
+        zxc_cctx_free(&cctx);
+        ctx->error = 1;
+        return NULL;
+    }
+    if (!ctx->dst) {
+        scratch = malloc(ctx->chunk_size + ZXC_PAD_SIZE);
+        if (UNLIKELY(!scratch)) {
+            zxc_cctx_free(&cctx);
+            ctx->error = 1;
+            return NULL;
+        }
+    }
+
+    cctx.checksum_enabled = ctx->checksum_enabled;
+    cctx.compression_level = ctx->level;
+    cctx.num_type = ctx->num_type;
+    cctx.elem_size = ctx->elem_size;
+    cctx.timed = ctx->perf != NULL;
+
+    const uint64_t t0 = ctx->perf ? zxc_perf_now() : 0;
+    while (!ctx->error) {
+        size_t i = (size_t)ZXC_ATOMIC_FETCH_ADD(&ctx->next_block, 1);
+        if (i >= ctx->n_blocks) break;
+        if (UNLIKELY(zxc_buffer_process(ctx, &cctx, scratch, i) != 0)) {
+            ctx->error = 1;
+            break;
+        }
+    }
+
+    zxc_buffer_add_stats(ctx, &cctx, ctx->perf ? zxc_perf_now() - t0 : 0);
+    free(scratch);
+    zxc_cctx_free(&cctx);
+    return NULL;
+}
+
+/**
+ * @brief Pool step of a parallel buffer call (see `zxc_pool_run_s::step`).
+ *
+ * @param[in] run  Run whose `arg` is the buffer context.
+ * @param[in] slot Context of the calling thread.
+ * @return 1 if a block was processed, 0 once every block has been handed out.
+ */
+static int zxc_buffer_pool_step(zxc_pool_run_t* run, zxc_pool_slot_t* slot) {
+    zxc_buffer_mt_ctx_t* ctx = (zxc_buffer_mt_ctx_t*)run->arg;
+    if (UNLIKELY(ctx->error)) return 0;
+    size_t i = (size_t)ZXC_ATOMIC_FETCH_ADD(&ctx->next_block, 1);
+    if (i >= ctx->n_blocks) return 0;
+
+    zxc_cctx_t* cctx =
+        zxc_pool_slot_cctx(slot, ctx->chunk_size, ctx->mode, ctx->level, ctx->checksum_enabled);
+    uint8_t* scratch =
+        ctx->dst ? NULL : zxc_pool_slot_scratch(slot, ctx->chunk_size + ZXC_PAD_SIZE);
+    if (UNLIKELY(!cctx || (!ctx->dst && !scratch))) {
+        ctx->error = 1;
+        return 0;
+    }
+    cctx->num_type = ctx->num_type;
+    cctx->elem_size = ctx->elem_size;
+    cctx->timed = ctx->perf != NULL;
+    cctx->checksum_ns = 0;
+    ZXC_MEMSET(&cctx->stats, 0, sizeof(cctx->stats));
+    const uint64_t t0 = ctx->perf ? zxc_perf_now() : 0;
+    if (UNLIKELY(zxc_buffer_process(ctx, cctx, scratch, i) != 0)) ctx->error = 1;
+    zxc_buffer_add_stats(ctx, cctx, ctx->perf ? zxc_perf_now() - t0 : 0);
+    return 1;
+}
+
+/**
+ * @brief Runs the parallel buffer workers over a prepared block table.
  *
- * **Workflow:**
- * 1. **Wait:** Sleeps on `cond_writer` until the job at `ctx->write_idx` is
- * ready.
- * 2. **Write:** Writes the `out_buf` to the file.
- * 3. **Release:** Sets the job status to `JOB_STATUS_FREE` and signals
- * `cond_reader`, allowing the main thread to reuse this slot for new input.
- * 4. **Advance:** Increments `ctx->write_idx` to wait for the next sequential
- * block.
+ * With a pool, the blocks are processed by the pool threads and the calling
+ * thread, which returns once the last of them is done.
  *
- * @param[in] arg Pointer to a `writer_args_t` structure containing the stream
- * context, the output file handle, and a counter for total bytes written.
- * @return Always returns NULL.
+ * @param[in,out] ctx        Shared context with the block table filled in.
+ * @param[in]     pool       Pool to run on, or NULL to start threads.
+ * @param[in]     n_threads  Requested thread count (0 = auto-detect), without a pool.
+ * @return 0 on success, -1 if a thread could not be started or a block failed.
  */
-static void* zxc_async_writer(void* arg) {
-    writer_args_t* args = (writer_args_t*)arg;
-    zxc_stream_ctx_t* ctx = args->ctx;
-    while (1) {
-        zxc_stream_job_t* job = &ctx->jobs[ctx->write_idx];
-        pthread_mutex_lock(&ctx->lock);
-        while (job->status != JOB_STATUS_PROCESSED)
-            pthread_cond_wait(&ctx->cond_writer, &ctx->lock);
+static int zxc_buffer_mt_run(zxc_buffer_mt_ctx_t* ctx, zxc_pool_t* pool, int n_threads) {
+    if (pool) {
+        zxc_pool_slot_t* slot = zxc_pool_borrow(pool);
+        if (UNLIKELY(!slot)) return -1;
+        zxc_pool_run_t run;
+        ZXC_MEMSET(&run, 0, sizeof(run));
+        run.step = zxc_buffer_pool_step;
+        run.arg = ctx;
+        ctx->next_block = 0;
+        ctx->error = 0;
+        pthread_mutex_init(&ctx->stats_lock, NULL);
 
-        if (job->result_sz == (size_t)-1) {
-            pthread_mutex_unlock(&ctx->lock);
-            break;
-        }
-        pthread_mutex_unlock(&ctx->lock);
+        zxc_pool_attach(pool, &run);
+        while (zxc_buffer_pool_step(&run, slot));
+        zxc_pool_detach(pool, &run);
 
-        if (args->f && job->result_sz > 0) {
-            if (fwrite(job->out_buf, 1, job->result_sz, args->f) != job->result_sz) {
-                ctx->io_error = 1;
-            }
-        }
-        if (UNLIKELY(ctx->io_error)) {
-            pthread_mutex_lock(&ctx->lock);
-            job->status = JOB_STATUS_FREE;
-            pthread_cond_signal(&ctx->cond_reader);
-            pthread_mutex_unlock(&ctx->lock);
-            break;
-        }
-        args->total_bytes += (int64_t)job->result_sz;
+        zxc_pool_return(pool, slot);
+        pthread_mutex_destroy(&ctx->stats_lock);
+        return ctx->error ? -1 : 0;
+    }
+
+    int num_threads = (n_threads > 0) ? n_threads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (num_threads < 1) num_threads = 1;
+    if ((size_t)num_threads > ctx->n_blocks) num_threads = (int)ctx->n_blocks;
+
+    pthread_t* workers = malloc(num_threads * sizeof(pthread_t));
+    if (UNLIKELY(!workers)) return -1;
 
-        pthread_mutex_lock(&ctx->lock);
-        job->status = JOB_STATUS_FREE;
-        ctx->write_idx = (ctx->write_idx + 1) % ctx->ring_size;
-        pthread_cond_signal(&ctx->cond_reader);
-        pthread_mutex_unlock(&ctx->lock);
+    ctx->next_block = 0;
+    ctx->error = 0;
+    pthread_mutex_init(&ctx->stats_lock, NULL);
+
+    // The calling thread acts as one of the workers.
+    int started = 0;
+    for (int i = 1; i < num_threads; i++) {
+        if (pthread_create(&workers[started], NULL, zxc_buffer_mt_worker, ctx) != 0) break;
+        zxc_pin_thread(workers[started], i);
+        started++;
     }
-    return NULL;
+    zxc_buffer_mt_worker(ctx);
+    for (int i = 0; i < started; i++) pthread_join(workers[i], NULL);
+
+    pthread_mutex_destroy(&ctx->stats_lock);
+    free(workers);
+    return ctx->error ? -1 : 0;
 }
 
 /**
- * @brief Orchestrates the multithreaded streaming compression or decompression
- * engine.
+ * @struct zxc_mt_frame_t
+ * @brief A frame being compressed block by block in parallel.
  *
- * This function initializes the stream context, allocates the necessary ring
- * buffer memory for jobs and I/O buffers, and spawns the worker threads and the
- * asynchronous writer thread. It acts as the main "producer" (reader) loop.
+ * @var zxc_mt_frame_t::mt
+ *      Shared context: block table and per-block output slots.
+ * @var zxc_mt_frame_t::dst
+ *      Destination of the frame.
+ * @var zxc_mt_frame_t::dst_capacity
+ *      Capacity of `dst`.
+ * @var zxc_mt_frame_t::h_size
+ *      Size of the file header already written to `dst`.
+ * @var zxc_mt_frame_t::seekable
+ *      Append a seek table after the last block.
+ * @var zxc_mt_frame_t::digest
+ *      Append a frame digest after the last block.
+ * @var zxc_mt_frame_t::scratch
+ *      Slot area when it does not fit in `dst` (NULL otherwise).
+ */
+typedef struct {
+    zxc_buffer_mt_ctx_t mt;
+    uint8_t* dst;
+    size_t dst_capacity;
+    size_t h_size;
+    int seekable;
+    int digest;
+    uint8_t* scratch;
+} zxc_mt_frame_t;
+
+/**
+ * @brief Writes the file header of a parallel frame and lays out its block
+ * table and output slots.
  *
- * **Architecture: Producer-Consumer with Ring Buffer**
- * - **Ring Buffer:** A fixed-size array of `zxc_stream_job_t` structures.
- * - **Producer (Main Thread):** Reads chunks from `f_in` and fills "Free" slots
- *   in the ring buffer. It blocks if no slots are free (backpressure).
- * - **Workers:** Pick up "Filled" jobs from a queue, process them, and mark
- * them as "Processed".
- * - **Consumer (Writer Thread):** Waits for the *next sequential* job to be
- *   "Processed", writes it to `f_out`, and marks the slot as "Free".
+ * Each block gets a worst-case slot (a block never grows past the RAW
+ * fallback). When the caller sized @p dst with zxc_compress_bound() the slots
+ * fit right after the header and the output is compacted in place by
+ * zxc_mt_frame_finish(); otherwise they go to a scratch area.
  *
- * **Double-Buffering & Zero-Copy:**
- * We allocate `alloc_in` and `alloc_out` buffers for each job. The reader reads
- * directly into `in_buf`, and the writer writes directly from `out_buf`,
- * minimizing memory copies.
+ * @param[out] f            Frame to set up.
+ * @param[in]  src          Source buffer.
+ * @param[in]  src_size     Size of the source data (not 0).
+ * @param[out] dst          Destination buffer.
+ * @param[in]  dst_capacity Capacity of the destination buffer (not 0).
+ * @param[in]  block_size   Validated block size.
+ * @param[in]  opts         Frame options (NULL selects the defaults).
+ * @return 0 on success, -1 on invalid options, a too small @p dst or
+ * allocation failure (nothing to release then).
+ */
+static int zxc_mt_frame_init(zxc_mt_frame_t* f, const void* src, size_t src_size, void* dst,
+                             size_t dst_capacity, size_t block_size,
+                             const zxc_compress_opts_t* opts) {
+    int seekable = opts ? opts->seekable : 0;
+    int linked = opts ? opts->linked : 0;
+    int digest = opts ? opts->digest : 0;
+    size_t elem_size = opts ? opts->elem_size : 0;
+    if (UNLIKELY(seekable && linked)) return -1;
+    if (UNLIKELY(elem_size > ZXC_ELEM_SIZE_MAX || (linked && elem_size > 1))) return -1;
+
+    ZXC_MEMSET(f, 0, sizeof(*f));
+    uint8_t* op = (uint8_t*)dst;
+    zxc_file_header_t fh = {block_size, ZXC_FILE_FLAG_CONTENT_SIZE, (uint64_t)src_size, 0};
+    if (seekable) fh.flags |= ZXC_FILE_FLAG_SEEKABLE;
+    if (digest) fh.flags |= ZXC_FILE_FLAG_DIGEST;
+    int h_size = zxc_write_file_header(op, dst_capacity, &fh);
+    if (UNLIKELY(h_size < 0)) return -1;
+
+    size_t n_blocks = (src_size + block_size - 1) / block_size;
+    zxc_buffer_block_t* blocks = malloc(n_blocks * sizeof(zxc_buffer_block_t));
+    if (UNLIKELY(!blocks)) return -1;
+
+    const size_t slot_extra = ZXC_BLOCK_HEADER_SIZE + ZXC_BLOCK_CHECKSUM_SIZE;
+    size_t slots_total = src_size + n_blocks * slot_extra;
+    uint8_t* slots = op + h_size;
+    if (dst_capacity - (size_t)h_size < slots_total) {
+        f->scratch = malloc(slots_total);
+        if (UNLIKELY(!f->scratch)) {
+            free(blocks);
+            return -1;
+        }
+        slots = f->scratch;
+    }
+
+    size_t slot_off = 0;
+    for (size_t i = 0; i < n_blocks; i++) {
+        size_t pos = i * block_size;
+        size_t len = (src_size - pos > block_size) ? block_size : (src_size - pos);
+        blocks[i].src_off = pos;
+        blocks[i].src_len = len;
+        blocks[i].dst_off = slot_off;
+        blocks[i].dst_cap = len + slot_extra;
+        blocks[i].result_sz = 0;
+        slot_off += blocks[i].dst_cap;
+    }
+
+    zxc_buffer_mt_ctx_t* ctx = &f->mt;
+    ctx->src = (const uint8_t*)src;
+    ctx->src_end = ctx->src + src_size;
+    ctx->dst = slots;
+    ctx->blocks = blocks;
+    ctx->n_blocks = n_blocks;
+    ctx->mode = 1;
+    ctx->level = (opts && opts->level > 0) ? opts->level : ZXC_LEVEL_DEFAULT;
+    ctx->checksum_enabled = (opts && opts->checksum_enabled) || digest;
+    ctx->chunk_size = block_size;
+    ctx->linked = linked;
+    ctx->num_type = opts ? opts->num_type : ZXC_NUM_AUTO;
+    ctx->elem_size = elem_size;
+    ctx->stats = opts ? opts->block_stats : NULL;
+
+    f->dst = op;
+    f->dst_capacity = dst_capacity;
+    f->h_size = (size_t)h_size;
+    f->seekable = seekable;
+    f->digest = digest;
+    return 0;
+}
+
+/**
+ * @brief Moves the compressed blocks of a parallel frame into place and
+ * appends its digest and seek table.
  *
- * @param[in] f_in      Pointer to the input file stream (source).
- * @param[out] f_out     Pointer to the output file stream (destination).
- * @param[in] n_threads Number of worker threads to spawn. If set to 0 or less, the
- * function automatically detects the number of online processors.
- * @param[in] mode      Operation mode: 1 for compression, 0 for decompression.
- * @param[in] level     Compression level to be applied (relevant for compression
- * mode).
- * @param[in] checksum_enabled  Flag indicating whether to enable checksum
- * generation/verification.
- * @param[in] func      Function pointer to the chunk processor (compression or
- * decompression logic).
+ * The digest only reads the checksums the workers stored in the blocks, so
+ * it adds no pass over the data.
  *
- * @return The total number of bytes written to the output stream on success, or
- * -1 if an initialization or I/O error occurred.
+ * @param[in,out] f Frame whose blocks have all been compressed.
+ * @return Size of the frame, or 0 if it does not fit in the destination.
  */
-static int64_t zxc_stream_engine_run(FILE* f_in, FILE* f_out, int n_threads, int mode, int level,
-                                     int checksum_enabled, zxc_chunk_processor_t func) {
-    zxc_stream_ctx_t ctx;
-    ZXC_MEMSET(&ctx, 0, sizeof(ctx));
+static size_t zxc_mt_frame_finish(zxc_mt_frame_t* f) {
+    zxc_buffer_block_t* blocks = f->mt.blocks;
+    const size_t n_blocks = f->mt.n_blocks;
+    const uint8_t* slots = f->mt.dst;
 
-    ctx.compression_mode = mode;
-    ctx.processor = func;
-    ctx.io_error = 0;
-    ctx.checksum_enabled = checksum_enabled;
-    ctx.compression_level = level;
+    // Compaction: blocks only ever move towards the start, so memmove in
+    // block order never overwrites a slot that has not been copied yet.
+    uint8_t* wp = f->dst + f->h_size;
+    const uint8_t* op_end = f->dst + f->dst_capacity;
+    size_t total = f->h_size;
+    zxc_digest_t dg = {0, 0, 0};
+    for (size_t i = 0; i < n_blocks; i++) {
+        size_t sz = blocks[i].result_sz;
+        if (UNLIKELY(sz > (size_t)(op_end - wp))) return 0;
+        memmove(wp, slots + blocks[i].dst_off, sz);
+        if (f->digest && UNLIKELY(zxc_digest_update(&dg, wp, sz) != 0)) return 0;
+        // From here on dst_off holds the final position (used by the seek table).
+        blocks[i].dst_off = total;
+        wp += sz;
+        total += sz;
+    }
 
-    int num_threads = (n_threads > 0) ? n_threads : (int)sysconf(_SC_NPROCESSORS_ONLN);
-    // Reserve 1 thread for Writer/Reader overhead if possible
-    int num_workers = (num_threads > 1) ? num_threads - 1 : 1;
-    ctx.ring_size = num_workers * 4;
+    if (f->digest) {
+        int res = zxc_write_digest(wp, (size_t)(op_end - wp), &dg);
+        if (UNLIKELY(res < 0)) return 0;
+        total += (size_t)res;
+    }
 
-    size_t runtime_chunk_sz = ZXC_BLOCK_SIZE;
-    if (mode == 0) {
-        uint8_t h[ZXC_FILE_HEADER_SIZE];
-        if (fread(h, 1, ZXC_FILE_HEADER_SIZE, f_in) != ZXC_FILE_HEADER_SIZE ||
-            zxc_read_file_header(h, ZXC_FILE_HEADER_SIZE, &runtime_chunk_sz) != 0)
-            return -1;
+    if (f->seekable) {
+        zxc_seek_entry_t* seek = malloc(n_blocks * sizeof(zxc_seek_entry_t));
+        int res = -1;
+        if (LIKELY(seek)) {
+            for (size_t i = 0; i < n_blocks; i++) {
+                seek[i].comp_offset = (uint64_t)blocks[i].dst_off;
+                seek[i].raw_offset = (uint64_t)blocks[i].src_off;
+            }
+            res = zxc_write_seek_table(f->dst + total, f->dst_capacity - total, seek, n_blocks);
+            free(seek);
+        }
+        total = (res > 0) ? total + (size_t)res : 0;
     }
-    ctx.chunk_size = runtime_chunk_sz;
+    return total;
+}
 
-    size_t max_out = zxc_compress_bound(runtime_chunk_sz);
-    size_t raw_alloc_in = ((mode) ? runtime_chunk_sz : max_out) + ZXC_PAD_SIZE;
-    size_t alloc_in = (raw_alloc_in + ZXC_ALIGNMENT_MASK) & ~ZXC_ALIGNMENT_MASK;
+/**
+ * @brief Releases the block table and slot area of a parallel frame.
+ *
+ * @param[in,out] f Frame set up by zxc_mt_frame_init().
+ */
+static void zxc_mt_frame_free(zxc_mt_frame_t* f) {
+    free(f->scratch);
+    free(f->mt.blocks);
+    f->scratch = NULL;
+    f->mt.blocks = NULL;
+}
 
-    size_t raw_alloc_out = ((mode) ? max_out : runtime_chunk_sz) + ZXC_PAD_SIZE;
-    size_t alloc_out = (raw_alloc_out + ZXC_ALIGNMENT_MASK) & ~ZXC_ALIGNMENT_MASK;
+/**
+ * @brief zxc_compress_mt_ex() on its own threads or on a pool.
+ *
+ * @param[in] pool Pool to run on, or NULL to start @p n_threads threads.
+ * @return Number of bytes written to @p dst, or 0 on error.
+ */
+static size_t zxc_compress_mt_impl(zxc_pool_t* pool, const void* src, size_t src_size, void* dst,
+                                   size_t dst_capacity, int n_threads,
+                                   const zxc_compress_opts_t* opts) {
+    if (UNLIKELY(!src || !dst || src_size == 0 || dst_capacity == 0)) return 0;
 
-    size_t alloc_size =
-        ctx.ring_size * (sizeof(zxc_stream_job_t) + sizeof(int) + alloc_in + alloc_out);
-    uint8_t* mem_block = zxc_aligned_malloc(alloc_size, ZXC_CACHE_LINE_SIZE);
-    if (UNLIKELY(!mem_block)) return -1;
-    ZXC_MEMSET(mem_block, 0, alloc_size);
+    size_t block_size = zxc_resolve_block_size(opts ? opts->block_size : 0);
+    if (UNLIKELY(block_size == 0)) return 0;
 
-    uint8_t* ptr = mem_block;
-    ctx.jobs = (zxc_stream_job_t*)ptr;
-    ptr += ctx.ring_size * sizeof(zxc_stream_job_t);
-    ctx.worker_queue = (int*)ptr;
-    ptr += ctx.ring_size * sizeof(int);
-    uint8_t* buf_in = ptr;
-    ptr += ctx.ring_size * alloc_in;
-    uint8_t* buf_out = ptr;
+    size_t n_blocks = (src_size + block_size - 1) / block_size;
+    if ((!pool && n_threads == 1) || n_blocks == 1)
+        return zxc_compress_ex(src, src_size, dst, dst_capacity, opts);
 
-    for (int i = 0; i < ctx.ring_size; i++) {
-        ctx.jobs[i].job_id = i;
-        ctx.jobs[i].status = JOB_STATUS_FREE;
-        ctx.jobs[i].in_buf = buf_in + (i * alloc_in);
-        ctx.jobs[i].in_cap = alloc_in - ZXC_PAD_SIZE;
-        ctx.jobs[i].out_buf = buf_out + (i * alloc_out);
-        ctx.jobs[i].out_cap = alloc_out - ZXC_PAD_SIZE;
-        ctx.jobs[i].result_sz = 0;
+    zxc_perf_call_t call;
+    zxc_mt_frame_t f;
+    size_t total = 0;
+    zxc_perf_stats_t* perf = zxc_perf_begin(&call, "compress_mt");
+    if (zxc_mt_frame_init(&f, src, src_size, dst, dst_capacity, block_size, opts) == 0) {
+        f.mt.perf = perf;
+        if (zxc_buffer_mt_run(&f.mt, pool, n_threads) == 0) total = zxc_mt_frame_finish(&f);
+        zxc_mt_frame_free(&f);
     }
+    zxc_perf_end(&call, src_size, total);
+    return total;
+}
 
-    pthread_mutex_init(&ctx.lock, NULL);
-    pthread_cond_init(&ctx.cond_reader, NULL);
-    pthread_cond_init(&ctx.cond_worker, NULL);
-    pthread_cond_init(&ctx.cond_writer, NULL);
+// cppcheck-suppress unusedFunction
+size_t zxc_compress_mt_ex(const void* src, size_t src_size, void* dst, size_t dst_capacity,
+                          int n_threads, const zxc_compress_opts_t* opts) {
+    return zxc_compress_mt_impl(NULL, src, src_size, dst, dst_capacity, n_threads, opts);
+}
 
-    pthread_t* workers = malloc(num_workers * sizeof(pthread_t));
-    if (UNLIKELY(!workers)) {
-        zxc_aligned_free(mem_block);
-        return -1;
+// cppcheck-suppress unusedFunction
+size_t zxc_compress_pool(zxc_pool_t* pool, const void* src, size_t src_size, void* dst,
+                         size_t dst_capacity, const zxc_compress_opts_t* opts) {
+    if (UNLIKELY(!pool)) return 0;
+    return zxc_compress_mt_impl(pool, src, src_size, dst, dst_capacity, 0, opts);
+}
+
+// cppcheck-suppress unusedFunction
+size_t zxc_compress_mt(const void* src, size_t src_size, void* dst, size_t dst_capacity,
+                       int n_threads, int level, int checksum_enabled) {
+    zxc_compress_opts_t opts = {level, checksum_enabled, 0, 0, 0, 0, 0, NULL, 0, 0, 0};
+    return zxc_compress_mt_ex(src, src_size, dst, dst_capacity, n_threads, &opts);
+}
+
+/*
+ * ============================================================================
+ * BATCH COMPRESSION
+ * ============================================================================
+ * Many independent inputs, one frame each. The work is cut into tasks: one
+ * per block of an input larger than a block (its frame is assembled as in
+ * zxc_compress_mt_ex(), by whichever thread finishes its last block), one per
+ * smaller input (compressed whole). Tasks are ordered by decreasing size and
+ * claimed in groups of at least `ZXC_BATCH_GROUP_BYTES` input bytes: big tasks
+ * first so that the end of the batch is made of small ones that even out the
+ * threads, and groups so that thousands of tiny inputs do not cost one claim
+ * each.
+ */
+
+/** Minimum number of input bytes claimed at once. */
+#define ZXC_BATCH_GROUP_BYTES (64 * 1024)
+
+/**
+ * @struct zxc_batch_task_t
+ * @brief One unit of batch work.
+ *
+ * @var zxc_batch_task_t::input
+ *      Index of the input.
+ * @var zxc_batch_task_t::frame
+ *      Index of the split frame in `zxc_batch_ctx_t::frames`, or -1 for an
+ * input compressed whole.
+ * @var zxc_batch_task_t::block
+ *      Block of the split frame.
+ * @var zxc_batch_task_t::bytes
+ *      Input bytes covered (sort key).
+ */
+typedef struct {
+    size_t input;
+    int64_t frame;
+    size_t block;
+    size_t bytes;
+} zxc_batch_task_t;
+
+/**
+ * @struct zxc_batch_frame_t
+ * @brief Input of a batch split into blocks.
+ *
+ * @var zxc_batch_frame_t::f
+ *      Frame under construction.
+ * @var zxc_batch_frame_t::input
+ *      Index of the input.
+ * @var zxc_batch_frame_t::pending
+ *      Blocks not processed yet; the thread taking it to 0 finishes the frame.
+ */
+typedef struct {
+    zxc_mt_frame_t f;
+    size_t input;
+    ZXC_ATOMIC int64_t pending;
+} zxc_batch_frame_t;
+
+/**
+ * @struct zxc_batch_ctx_t
+ * @brief Shared state of a batch call.
+ *
+ * @var zxc_batch_ctx_t::in
+ *      Inputs.
+ * @var zxc_batch_ctx_t::out
+ *      Outputs.
+ * @var zxc_batch_ctx_t::opts
+ *      Options of every input, without `block_stats`.
+ * @var zxc_batch_ctx_t::stats
+ *      Counters of the whole batch (NULL = not collected).
+ * @var zxc_batch_ctx_t::perf
+ *      Performance counters of the call (NULL = not collected).
+ * @var zxc_batch_ctx_t::stats_lock
+ *      Serializes the updates of `stats` and `perf`.
+ * @var zxc_batch_ctx_t::tasks
+ *      Tasks, largest first.
+ * @var zxc_batch_ctx_t::groups
+ *      `n_groups + 1` offsets into `tasks`: group g is `[groups[g], groups[g + 1])`.
+ * @var zxc_batch_ctx_t::n_groups
+ *      Number of groups.
+ * @var zxc_batch_ctx_t::next_group
+ *      Next group to hand out (claimed with an atomic fetch-add).
+ * @var zxc_batch_ctx_t::frames
+ *      Inputs split into blocks.
+ * @var zxc_batch_ctx_t::done
+ *      Number of inputs compressed successfully.
+ */
+typedef struct {
+    const zxc_buf_t* in;
+    zxc_buf_t* out;
+    zxc_compress_opts_t opts;
+    zxc_block_stats_t* stats;
+    zxc_perf_stats_t* perf;
+    pthread_mutex_t stats_lock;
+    zxc_batch_task_t* tasks;
+    size_t* groups;
+    size_t n_groups;
+    ZXC_ATOMIC int64_t next_group;
+    zxc_batch_frame_t* frames;
+    ZXC_ATOMIC int64_t done;
+} zxc_batch_ctx_t;
+
+/**
+ * @brief Runs one batch task on the context of @p slot.
+ *
+ * @param[in,out] ctx  Batch state.
+ * @param[in,out] slot Context of the calling thread.
+ * @param[in]     task Task to run.
+ * @param[in,out] acc  Counters of the calling thread's current group (blocks,
+ * and checksum time of the split inputs).
+ */
+static void zxc_batch_task_run(zxc_batch_ctx_t* ctx, zxc_pool_slot_t* slot,
+                               const zxc_batch_task_t* task, zxc_perf_stats_t* acc) {
+    const zxc_buf_t* in = &ctx->in[task->input];
+    zxc_buf_t* out = &ctx->out[task->input];
+    if (task->frame < 0) {
+        if (!slot->frame_cctx) slot->frame_cctx = zxc_create_cctx();
+        zxc_compress_opts_t opts = ctx->opts;
+        opts.block_stats = &acc->blocks;
+        out->size = slot->frame_cctx ? zxc_compress_cctx(slot->frame_cctx, in->data, in->size,
+                                                         out->data, out->capacity, &opts)
+                                     : 0;
+        if (out->size > 0) ZXC_ATOMIC_FETCH_ADD(&ctx->done, 1);
+        return;
     }
-    for (int i = 0; i < num_workers; i++)
-        pthread_create(&workers[i], NULL, zxc_stream_worker, &ctx);
 
-    writer_args_t w_args = {&ctx, f_out, 0};
-    if (mode == 1 && f_out) {
-        uint8_t h[8];
-        zxc_write_file_header(h, 8);
-        if (fwrite(h, 1, 8, f_out) != 8) {
-            ctx.io_error = 1;
+    zxc_batch_frame_t* bf = &ctx->frames[task->frame];
+    zxc_buffer_mt_ctx_t* mt = &bf->f.mt;
+    if (!mt->error) {
+        zxc_cctx_t* cctx =
+            zxc_pool_slot_cctx(slot, mt->chunk_size, 1, mt->level, mt->checksum_enabled);
+        if (UNLIKELY(!cctx)) {
+            mt->error = 1;
+        } else {
+            cctx->num_type = mt->num_type;
+            cctx->elem_size = mt->elem_size;
+            cctx->timed = ctx->perf != NULL;
+            cctx->checksum_ns = 0;
+            ZXC_MEMSET(&cctx->stats, 0, sizeof(cctx->stats));
+            if (UNLIKELY(zxc_buffer_process(mt, cctx, NULL, task->block) != 0)) mt->error = 1;
+            zxc_block_stats_add(&acc->blocks, &cctx->stats);
+            acc->checksum_ns += cctx->checksum_ns;
         }
-        w_args.total_bytes = 8;
     }
-    pthread_t writer_th;
-    pthread_create(&writer_th, NULL, zxc_async_writer, &w_args);
+    // Last block of the frame: this thread assembles it.
+    if (ZXC_ATOMIC_FETCH_ADD(&bf->pending, -1) == 1) {
+        out->size = mt->error ? 0 : zxc_mt_frame_finish(&bf->f);
+        if (out->size > 0) ZXC_ATOMIC_FETCH_ADD(&ctx->done, 1);
+    }
+}
 
-    int read_idx = 0;
-    int read_eof = 0;
+/**
+ * @brief Pool step of a batch call (see `zxc_pool_run_s::step`): runs one
+ * group of tasks.
+ *
+ * @param[in] run  Run whose `arg` is the batch state.
+ * @param[in] slot Context of the calling thread.
+ * @return 1 if a group was run, 0 once every group has been handed out.
+ */
+static int zxc_batch_pool_step(zxc_pool_run_t* run, zxc_pool_slot_t* slot) {
+    zxc_batch_ctx_t* ctx = (zxc_batch_ctx_t*)run->arg;
+    size_t g = (size_t)ZXC_ATOMIC_FETCH_ADD(&ctx->next_group, 1);
+    if (g >= ctx->n_groups) return 0;
 
-    // Reader Loop: Reads from file, prepares jobs, pushes to worker queue.
-    while (!read_eof && !ctx.io_error) {
-        zxc_stream_job_t* job = &ctx.jobs[read_idx];
-        pthread_mutex_lock(&ctx.lock);
-        while (job->status != JOB_STATUS_FREE) pthread_cond_wait(&ctx.cond_reader, &ctx.lock);
-        pthread_mutex_unlock(&ctx.lock);
+    zxc_perf_stats_t acc;
+    ZXC_MEMSET(&acc, 0, sizeof(acc));
+    const uint64_t t0 = ctx->perf ? zxc_perf_now() : 0;
+    for (size_t t = ctx->groups[g]; t < ctx->groups[g + 1]; t++)
+        zxc_batch_task_run(ctx, slot, &ctx->tasks[t], &acc);
+    if (ctx->stats || ctx->perf) {
+        if (ctx->perf) acc.work_ns = zxc_perf_now() - t0;
+        pthread_mutex_lock(&ctx->stats_lock);
+        if (ctx->stats) zxc_block_stats_add(ctx->stats, &acc.blocks);
+        if (ctx->perf) zxc_perf_stats_add(ctx->perf, &acc);
+        pthread_mutex_unlock(&ctx->stats_lock);
+    }
+    return 1;
+}
+
+/**
+ * @brief qsort() order of batch tasks: largest first, then in input and
+ * block order.
+ */
+static int zxc_batch_task_cmp(const void* a, const void* b) {
+    const zxc_batch_task_t* x = (const zxc_batch_task_t*)a;
+    const zxc_batch_task_t* y = (const zxc_batch_task_t*)b;
+    if (x->bytes != y->bytes) return x->bytes > y->bytes ? -1 : 1;
+    if (x->input != y->input) return x->input < y->input ? -1 : 1;
+    return (x->block > y->block) - (x->block < y->block);
+}
 
-        if (UNLIKELY(ctx.io_error)) break;
+// cppcheck-suppress unusedFunction
+size_t zxc_compress_batch(zxc_pool_t* pool, const zxc_buf_t* in, zxc_buf_t* out, size_t n,
+                          const zxc_compress_opts_t* opts) {
+    if (UNLIKELY(!in || !out || n == 0)) return 0;
+    for (size_t i = 0; i < n; i++) out[i].size = 0;
+    size_t block_size = zxc_resolve_block_size(opts ? opts->block_size : 0);
+    if (UNLIKELY(block_size == 0)) return 0;
+
+    zxc_batch_ctx_t ctx;
+    ZXC_MEMSET(&ctx, 0, sizeof(ctx));
+    ctx.in = in;
+    ctx.out = out;
+    if (opts) ctx.opts = *opts;
+    ctx.stats = ctx.opts.block_stats;
+    ctx.opts.block_stats = NULL;
 
-        size_t read_sz = 0;
-        if (mode == 1) {
-            read_sz = fread(job->in_buf, 1, ZXC_BLOCK_SIZE, f_in);
-            if (read_sz == 0) read_eof = 1;
+    // Count first: one task per block of a split input, one per other input.
+    size_t n_tasks = 0, n_frames = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (!in[i].data || in[i].size == 0 || !out[i].data || out[i].capacity == 0) continue;
+        if (in[i].size > block_size) {
+            n_tasks += (in[i].size + block_size - 1) / block_size;
+            n_frames++;
         } else {
-            uint8_t bh_buf[ZXC_BLOCK_HEADER_SIZE + ZXC_BLOCK_CHECKSUM_SIZE];
-            size_t h_read = fread(bh_buf, 1, ZXC_BLOCK_HEADER_SIZE, f_in);
-            if (UNLIKELY(h_read < ZXC_BLOCK_HEADER_SIZE)) {
-                read_eof = 1;
-            } else {
-                zxc_block_header_t bh;
-                zxc_read_block_header(bh_buf, ZXC_BLOCK_HEADER_SIZE, &bh);
-
-                int has_crc = (bh.block_flags & ZXC_BLOCK_FLAG_CHECKSUM);
-                if (has_crc) {
-                    if (fread(bh_buf + ZXC_BLOCK_HEADER_SIZE, 1, ZXC_BLOCK_CHECKSUM_SIZE, f_in) !=
-                        ZXC_BLOCK_CHECKSUM_SIZE) {
-                        read_eof = 1;
-                    }
-                }
+            n_tasks++;
+        }
+    }
+    if (n_tasks == 0) return 0;
 
-                size_t header_len = ZXC_BLOCK_HEADER_SIZE + (has_crc ? ZXC_BLOCK_CHECKSUM_SIZE : 0);
+    zxc_perf_call_t call;
+    ctx.perf = zxc_perf_begin(&call, "compress_batch");
+    ctx.tasks = malloc(n_tasks * sizeof(zxc_batch_task_t));
+    ctx.groups = malloc((n_tasks + 1) * sizeof(size_t));
+    ctx.frames = n_frames ? malloc(n_frames * sizeof(zxc_batch_frame_t)) : NULL;
+    if (UNLIKELY(!ctx.tasks || !ctx.groups || (n_frames && !ctx.frames))) goto done;
 
-                if (UNLIKELY(bh.comp_size > job->in_cap - header_len)) {
-                    ctx.io_error = 1;
-                    break;
-                }
+    size_t t = 0;
+    n_frames = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (!in[i].data || in[i].size == 0 || !out[i].data || out[i].capacity == 0) continue;
+        if (in[i].size <= block_size) {
+            zxc_batch_task_t task = {i, -1, 0, in[i].size};
+            ctx.tasks[t++] = task;
+            continue;
+        }
+        zxc_batch_frame_t* bf = &ctx.frames[n_frames];
+        if (zxc_mt_frame_init(&bf->f, in[i].data, in[i].size, out[i].data, out[i].capacity,
+                              block_size, &ctx.opts) != 0)
+            continue;  // This input fails alone.
+        bf->input = i;
+        bf->pending = (int64_t)bf->f.mt.n_blocks;
+        for (size_t b = 0; b < bf->f.mt.n_blocks; b++) {
+            zxc_batch_task_t task = {i, (int64_t)n_frames, b, bf->f.mt.blocks[b].src_len};
+            ctx.tasks[t++] = task;
+        }
+        n_frames++;
+    }
+    n_tasks = t;
+    qsort(ctx.tasks, n_tasks, sizeof(zxc_batch_task_t), zxc_batch_task_cmp);
 
-                ZXC_MEMCPY(job->in_buf, bh_buf, header_len);
-                size_t body_read = fread(job->in_buf + header_len, 1, bh.comp_size, f_in);
-                read_sz = header_len + body_read;
-                if (UNLIKELY(body_read != bh.comp_size)) read_eof = 1;
-            }
+    size_t group_bytes = 0;
+    for (t = 0; t < n_tasks; t++) {
+        if (group_bytes == 0) ctx.groups[ctx.n_groups++] = t;
+        group_bytes += ctx.tasks[t].bytes;
+        if (group_bytes >= ZXC_BATCH_GROUP_BYTES) group_bytes = 0;
+    }
+    ctx.groups[ctx.n_groups] = n_tasks;
+
+    pthread_mutex_init(&ctx.stats_lock, NULL);
+    zxc_pool_run_t run;
+    ZXC_MEMSET(&run, 0, sizeof(run));
+    run.step = zxc_batch_pool_step;
+    run.arg = &ctx;
+    if (pool) {
+        zxc_pool_slot_t* slot = zxc_pool_borrow(pool);
+        if (LIKELY(slot)) {
+            zxc_pool_attach(pool, &run);
+            while (zxc_batch_pool_step(&run, slot));
+            zxc_pool_detach(pool, &run);
+            zxc_pool_return(pool, slot);
         }
-        if (read_eof && read_sz == 0) break;
+    } else {
+        zxc_pool_slot_t local;
+        ZXC_MEMSET(&local, 0, sizeof(local));
+        while (zxc_batch_pool_step(&run, &local));
+        zxc_pool_slot_free(&local);
+    }
+    pthread_mutex_destroy(&ctx.stats_lock);
+
+done:
+    for (size_t f = 0; f < n_frames; f++) zxc_mt_frame_free(&ctx.frames[f].f);
+    free(ctx.frames);
+    free(ctx.groups);
+    free(ctx.tasks);
+    uint64_t bytes_in = 0, bytes_out = 0;
+    if (ctx.perf) {
+        for (size_t i = 0; i < n; i++) {
+            if (out[i].size == 0) continue;
+            bytes_in += in[i].size;
+            bytes_out += out[i].size;
+        }
+    }
+    zxc_perf_end(&call, bytes_in, bytes_out);
+    return (size_t)ctx.done;
+}
 
-        job->in_sz = read_sz;
-        pthread_mutex_lock(&ctx.lock);
-        job->status = JOB_STATUS_FILLED;
-        ctx.worker_queue[ctx.wq_head] = read_idx;
-        ctx.wq_head = (ctx.wq_head + 1) % ctx.ring_size;
-        ctx.wq_count++;
-        read_idx = (read_idx + 1) % ctx.ring_size;
-        pthread_cond_signal(&ctx.cond_worker);
-        pthread_mutex_unlock(&ctx.lock);
+/**
+ * @brief Builds the decompression block table of a frame by walking its block
+ * headers (no payload is decoded).
+ *
+ * @param[in]  src          Start of the frame.
+ * @param[in]  src_size     Size of the frame.
+ * @param[in]  h_size       Size of the file header.
+ * @param[in]  raw_capacity Upper bound for the total decompressed size.
+ * @param[out] n_blocks     Receives the number of data blocks.
+ * @param[out] raw_total    Receives the total decompressed size.
+ * @param[out] linked       Set to 1 if a block depends on the previous one.
+ * @return A malloc'ed table of `*n_blocks` entries, or NULL if the framing is
+ * invalid, the frame holds no data block or it exceeds @p raw_capacity.
+ */
+static zxc_buffer_block_t* zxc_walk_block_table(const uint8_t* src, size_t src_size,
+                                                size_t h_size, size_t raw_capacity,
+                                                size_t* n_blocks, size_t* raw_total,
+                                                int* linked) {
+    const uint8_t* ip_end = src + src_size;
 
-        if (read_sz < ZXC_BLOCK_SIZE && mode == 1) read_eof = 1;
+    // Pass 1: validate block framing and count blocks.
+    size_t n = 0;
+    *linked = 0;
+    const uint8_t* ip = src + h_size;
+    while (ip < ip_end) {
+        size_t rem_src = (size_t)(ip_end - ip);
+        zxc_block_header_t bh;
+        if (zxc_read_block_header(ip, rem_src, &bh) != 0) return NULL;
+        size_t checksum_sz =
+            (bh.block_flags & ZXC_BLOCK_FLAG_CHECKSUM) ? ZXC_BLOCK_CHECKSUM_SIZE : 0;
+        size_t total_block_sz = ZXC_BLOCK_HEADER_SIZE + bh.comp_size + checksum_sz;
+        if (UNLIKELY(total_block_sz > rem_src)) return NULL;
+        ip += total_block_sz;
+        if (bh.block_type == ZXC_BLOCK_END) {
+            if (UNLIKELY(ip != ip_end)) return NULL;  // The end of stream is the last block
+            break;
+        }
+        if (bh.block_type != ZXC_BLOCK_SEK && bh.block_type != ZXC_BLOCK_DIG) n++;
+        if (bh.block_flags & ZXC_BLOCK_FLAG_LINKED) *linked = 1;
     }
+    if (n == 0) return NULL;
 
-    zxc_stream_job_t* end_job = &ctx.jobs[read_idx];
-    pthread_mutex_lock(&ctx.lock);
-    while (end_job->status != JOB_STATUS_FREE) pthread_cond_wait(&ctx.cond_reader, &ctx.lock);
-    end_job->result_sz = -1;
-    end_job->status = JOB_STATUS_PROCESSED;
-    pthread_cond_broadcast(&ctx.cond_writer);
-    pthread_mutex_unlock(&ctx.lock);
+    zxc_buffer_block_t* blocks = malloc(n * sizeof(zxc_buffer_block_t));
+    if (UNLIKELY(!blocks)) return NULL;
 
-    pthread_join(writer_th, NULL);
-    pthread_mutex_lock(&ctx.lock);
-    ctx.shutdown_workers = 1;
-    pthread_cond_broadcast(&ctx.cond_worker);
-    pthread_mutex_unlock(&ctx.lock);
-    for (int i = 0; i < num_workers; i++) pthread_join(workers[i], NULL);
+    // Pass 2: record source offsets and derive each block's raw offset.
+    size_t raw_off = 0;
+    ip = src + h_size;
+    for (size_t i = 0; i < n;) {
+        zxc_block_header_t bh;
+        zxc_read_block_header(ip, (size_t)(ip_end - ip), &bh);
+        size_t checksum_sz =
+            (bh.block_flags & ZXC_BLOCK_FLAG_CHECKSUM) ? ZXC_BLOCK_CHECKSUM_SIZE : 0;
+        size_t total_block_sz = ZXC_BLOCK_HEADER_SIZE + bh.comp_size + checksum_sz;
+        if (bh.block_type == ZXC_BLOCK_SEK || bh.block_type == ZXC_BLOCK_DIG) {
+            ip += total_block_sz;
+            continue;
+        }
 
-    free(workers);
-    zxc_aligned_free(mem_block);
+        if (UNLIKELY(bh.raw_size > raw_capacity - raw_off)) {
+            free(blocks);
+            return NULL;
+        }
+        blocks[i].src_off = (size_t)(ip - src);
+        blocks[i].src_len = total_block_sz;
+        blocks[i].dst_off = raw_off;
+        blocks[i].dst_cap = bh.raw_size;
+        blocks[i].result_sz = 0;
+        raw_off += bh.raw_size;
+        ip += total_block_sz;
+        i++;
+    }
 
-    if (UNLIKELY(ctx.io_error)) return -1;
+    *n_blocks = n;
+    *raw_total = raw_off;
+    return blocks;
+}
 
-    return w_args.total_bytes;
+/**
+ * @brief Checks the digest of a frame against the checksums stored in the
+ * blocks of its decompression table.
+ *
+ * Only the block headers are read, so the workers that verify each block
+ * against its data leave nothing to rehash: together they cover the frame.
+ *
+ * @param[in] src      Start of the frame.
+ * @param[in] src_size Size of the frame.
+ * @param[in] blocks   Block table, in frame order.
+ * @param[in] n_blocks Number of blocks in the table (not 0).
+ * @return 0 if the DIG block right after the last block matches, -1 otherwise.
+ */
+static int zxc_check_table_digest(const uint8_t* src, size_t src_size,
+                                  const zxc_buffer_block_t* blocks, size_t n_blocks) {
+    zxc_digest_t dg = {0, 0, 0};
+    for (size_t i = 0; i < n_blocks; i++)
+        if (zxc_digest_update(&dg, src + blocks[i].src_off, blocks[i].src_len) != 0) return -1;
+
+    const zxc_buffer_block_t* last = &blocks[n_blocks - 1];
+    size_t end = last->src_off + zxc_peek_block_size(src + last->src_off, last->src_len);
+    if (UNLIKELY(end > src_size)) return -1;
+    return zxc_check_digest(src + end, src_size - end, &dg);
 }
 
-int64_t zxc_stream_compress(FILE* f_in, FILE* f_out, int n_threads, int level,
-                            int checksum_enabled) {
-    if (UNLIKELY(!f_in)) return -1;
+/**
+ * @brief zxc_decompress_mt() on its own threads or on a pool.
+ *
+ * @param[in] pool Pool to run on, or NULL to start @p n_threads threads.
+ * @return Number of decompressed bytes, or 0 on error.
+ */
+static size_t zxc_decompress_mt_impl(zxc_pool_t* pool, const void* src, size_t src_size,
+                                     void* dst, size_t dst_capacity, int n_threads,
+                                     int checksum_enabled) {
+    if (UNLIKELY(!src || !dst || src_size < ZXC_FILE_HEADER_SIZE)) return 0;
+    if (!pool && n_threads == 1)
+        return zxc_decompress(src, src_size, dst, dst_capacity, checksum_enabled);
 
-    return zxc_stream_engine_run(f_in, f_out, n_threads, 1, level, checksum_enabled,
-                                 zxc_compress_chunk_wrapper);
+    const uint8_t* ip_start = (const uint8_t*)src;
+    const uint8_t* ip_end = ip_start + src_size;
+
+    zxc_file_header_t fh;
+    int h_size = zxc_read_file_header(ip_start, src_size, &fh);
+    if (UNLIKELY(h_size < 0 || (fh.flags & ZXC_FILE_FLAG_DICT_ID))) return 0;
+    if ((fh.flags & ZXC_FILE_FLAG_CONTENT_SIZE) && UNLIKELY(fh.content_size > dst_capacity))
+        return 0;
+
+    size_t n_blocks = 0, raw_off = 0;
+    int linked = 0;
+    zxc_buffer_block_t* blocks = zxc_walk_block_table(ip_start, src_size, (size_t)h_size,
+                                                      dst_capacity, &n_blocks, &raw_off, &linked);
+    if (UNLIKELY(!blocks)) return 0;
+    // Linked blocks need the output of their predecessor: decode in order.
+    if (n_blocks == 1 || linked) {
+        free(blocks);
+        return zxc_decompress(src, src_size, dst, dst_capacity, checksum_enabled);
+    }
+    if (checksum_enabled && (fh.flags & ZXC_FILE_FLAG_DIGEST) &&
+        UNLIKELY(zxc_check_table_digest(ip_start, src_size, blocks, n_blocks) != 0)) {
+        free(blocks);
+        return 0;
+    }
+
+    zxc_buffer_mt_ctx_t ctx;
+    ZXC_MEMSET(&ctx, 0, sizeof(ctx));
+    ctx.src = ip_start;
+    ctx.src_end = ip_end;
+    ctx.dst = (uint8_t*)dst;
+    ctx.blocks = blocks;
+    ctx.n_blocks = n_blocks;
+    ctx.mode = 0;
+    ctx.checksum_enabled = checksum_enabled;
+    ctx.chunk_size = fh.block_size;
+
+    zxc_perf_call_t call;
+    ctx.perf = zxc_perf_begin(&call, "decompress_mt");
+    size_t total = (zxc_buffer_mt_run(&ctx, pool, n_threads) == 0) ? raw_off : 0;
+    if ((fh.flags & ZXC_FILE_FLAG_CONTENT_SIZE) && UNLIKELY((uint64_t)total != fh.content_size))
+        total = 0;
+    zxc_perf_end(&call, src_size, total);
+
+    free(blocks);
+    return total;
 }
 
-int64_t zxc_stream_decompress(FILE* f_in, FILE* f_out, int n_threads, int checksum_enabled) {
-    if (UNLIKELY(!f_in)) return -1;
+// cppcheck-suppress unusedFunction
+size_t zxc_decompress_mt(const void* src, size_t src_size, void* dst, size_t dst_capacity,
+                         int n_threads, int checksum_enabled) {
+    return zxc_decompress_mt_impl(NULL, src, src_size, dst, dst_capacity, n_threads,
+                                  checksum_enabled);
+}
 
-    return zxc_stream_engine_run(f_in, f_out, n_threads, 0, 0, checksum_enabled,
-                                 (zxc_chunk_processor_t)zxc_decompress_chunk_wrapper);
+// cppcheck-suppress unusedFunction
+size_t zxc_decompress_pool(zxc_pool_t* pool, const void* src, size_t src_size, void* dst,
+                           size_t dst_capacity, int checksum_enabled) {
+    if (UNLIKELY(!pool)) return 0;
+    return zxc_decompress_mt_impl(pool, src, src_size, dst, dst_capacity, 0, checksum_enabled);
+}
+
+#ifdef ZXC_STREAM_MMAP
+/**
+ * @brief Builds the decompression block table of a seekable frame from its
+ * seek table, without touching the data blocks.
+ *
+ * Every entry is checked against its neighbours, so a damaged table can at
+ * worst make a block fail to decode; it can never make two blocks write the
+ * same output bytes.
+ *
+ * @param[in]  src        Start of the frame.
+ * @param[in]  src_size   Size of the frame.
+ * @param[in]  h_size     Size of the file header.
+ * @param[in]  block_size Block size announced by the file header.
+ * @param[out] n_blocks   Receives the number of data blocks.
+ * @param[out] raw_total  Receives the total decompressed size.
+ * @return A malloc'ed table of `*n_blocks` entries, or NULL if the frame has
+ * no usable seek table.
+ */
+static zxc_buffer_block_t* zxc_seek_block_table(const uint8_t* src, size_t src_size,
+                                                size_t h_size, size_t block_size,
+                                                size_t* n_blocks, size_t* raw_total) {
+    size_t n = 0, table_size = 0;
+    if (zxc_read_seek_trailer(src, src_size, &n, &table_size) != 0 || n == 0 ||
+        table_size > src_size - h_size)
+        return NULL;
+
+    size_t table_off = src_size - table_size;
+    const uint8_t* entries = src + table_off + ZXC_BLOCK_HEADER_SIZE;
+    zxc_buffer_block_t* blocks = malloc(n * sizeof(zxc_buffer_block_t));
+    if (UNLIKELY(!blocks)) return NULL;
+
+    for (size_t i = 0; i < n; i++) {
+        uint64_t comp = zxc_le64(entries + i * ZXC_SEEK_ENTRY_SIZE);
+        uint64_t raw = zxc_le64(entries + i * ZXC_SEEK_ENTRY_SIZE + 8);
+        uint64_t next_comp = table_off;
+        if (i + 1 < n) next_comp = zxc_le64(entries + (i + 1) * ZXC_SEEK_ENTRY_SIZE);
+        // Entries are read pairwise, so ordering each one against the next is enough.
+        if (UNLIKELY((i == 0 && (comp < h_size || raw != 0)) || next_comp <= comp ||
+                     next_comp > table_off))
+            goto error;
+
+        // The raw size comes from the next entry; the last block's from its header.
+        size_t raw_size;
+        if (i + 1 < n) {
+            uint64_t next_raw = zxc_le64(entries + (i + 1) * ZXC_SEEK_ENTRY_SIZE + 8);
+            if (UNLIKELY(next_raw <= raw)) goto error;
+            raw_size = (next_raw - raw > block_size) ? 0 : (size_t)(next_raw - raw);
+        } else {
+            zxc_block_header_t bh;
+            if (zxc_read_block_header(src + comp, (size_t)(next_comp - comp), &bh) != 0) goto error;
+            raw_size = bh.raw_size;
+        }
+        if (UNLIKELY(raw_size == 0 || raw_size > block_size)) goto error;
+
+        blocks[i].src_off = (size_t)comp;
+        blocks[i].src_len = (size_t)(next_comp - comp);
+        blocks[i].dst_off = (size_t)raw;
+        blocks[i].dst_cap = raw_size;
+        blocks[i].result_sz = 0;
+    }
+
+    *n_blocks = n;
+    *raw_total = blocks[n - 1].dst_off + blocks[n - 1].dst_cap;
+    return blocks;
+
+error:
+    free(blocks);
+    return NULL;
+}
+#endif
+
+/**
+ * @brief Decompresses a whole mapped frame with positional I/O.
+ *
+ * Used by the stream engine when the input is mapped and the output is a
+ * regular file or NULL. The block table comes from the seek table when the
+ * frame has one, otherwise from a header-only walk of the mapping. Workers
+ * claim blocks from a shared counter, decode them into a private buffer and
+ * `pwrite` them at their raw offset, so neither a reader nor an ordered writer
+ * sits between them. On return both streams are positioned after the data.
+ *
+ * @param[in]     pool      Pool to run on, or NULL.
+ * @param[in,out] in        Mapped input, positioned after the file header.
+ * @param[in]     h_size    Size of the file header.
+ * @param[in]     fh        Parsed file header.
+ * @param[out]    f_out     Output stream (regular file), or NULL.
+ * @param[in]     n_threads Number of threads (0 = auto-detect).
+ * @param[in]     checksum_enabled Verify block checksums.
+ * @return Number of decompressed bytes, -1 on error, or -2 if no block table
+ * could be built or the blocks are linked (the caller then decodes
+ * sequentially, and reports the error if there is one).
+ */
+static int64_t zxc_stream_decompress_positional(zxc_pool_t* pool, zxc_stream_input_t* in,
+                                                size_t h_size, const zxc_file_header_t* fh,
+                                                FILE* f_out, int n_threads, int checksum_enabled,
+                                                zxc_perf_stats_t* perf) {
+#ifdef ZXC_STREAM_MMAP
+    size_t n_blocks = 0, raw_total = 0;
+    int linked = 0;
+    zxc_buffer_block_t* blocks = NULL;
+    if (fh->flags & ZXC_FILE_FLAG_SEEKABLE)
+        blocks = zxc_seek_block_table(in->data, in->size, h_size, fh->block_size, &n_blocks,
+                                      &raw_total);
+    if (!blocks)
+        blocks = zxc_walk_block_table(in->data, in->size, h_size, SIZE_MAX, &n_blocks,
+                                      &raw_total, &linked);
+    if (linked) {
+        // Blocks that depend on each other go through the ordered ring.
+        free(blocks);
+        blocks = NULL;
+    }
+    if (!blocks) return -2;
+
+    int64_t total = -1;
+    if (checksum_enabled && (fh->flags & ZXC_FILE_FLAG_DIGEST) &&
+        zxc_check_table_digest(in->data, in->size, blocks, n_blocks) != 0) {
+        free(blocks);
+        return -1;
+    }
+    zxc_buffer_mt_ctx_t ctx;
+    ZXC_MEMSET(&ctx, 0, sizeof(ctx));
+    ctx.src = in->data;
+    ctx.src_end = in->data + in->size;
+    ctx.dst = NULL;
+    ctx.out_fd = -1;
+    ctx.blocks = blocks;
+    ctx.n_blocks = n_blocks;
+    ctx.mode = 0;
+    ctx.checksum_enabled = checksum_enabled;
+    ctx.chunk_size = fh->block_size;
+    ctx.perf = perf;
+
+    if (f_out) {
+        off_t origin;
+        if (fflush(f_out) != 0 || (origin = ftello(f_out)) < 0) goto done;
+        ctx.out_fd = fileno(f_out);
+        ctx.out_origin = (int64_t)origin;
+    }
+
+    if (zxc_buffer_mt_run(&ctx, pool, n_threads) == 0 &&
+        (!(fh->flags & ZXC_FILE_FLAG_CONTENT_SIZE) || (uint64_t)raw_total == fh->content_size)) {
+        total = (int64_t)raw_total;
+        in->pos = in->size;
+        if (f_out && fseeko(f_out, (off_t)(ctx.out_origin + total), SEEK_SET) != 0) total = -1;
+    }
+
+done:
+    free(blocks);
+    return total;
+#else
+    (void)pool, (void)in, (void)h_size, (void)fh, (void)f_out, (void)n_threads;
+    (void)checksum_enabled, (void)perf;
+    return -2;
+#endif
 }
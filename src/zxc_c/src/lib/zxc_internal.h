@@ -17,7 +17,9 @@
 #include <string.h>
 
 #include "../../include/rapidhash.h"
+#include "../../include/zxc_constants.h"
 #include "../../include/zxc_sans_io.h"
+#include "../../include/zxc_stats.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -33,6 +35,14 @@ extern "C" {
 #define ZXC_USE_C11_ATOMICS 0
 #endif
 
+#if defined(_MSC_VER)
+#define ZXC_THREAD_LOCAL __declspec(thread)
+#elif !defined(__cplusplus) && defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define ZXC_THREAD_LOCAL _Thread_local
+#else
+#define ZXC_THREAD_LOCAL __thread
+#endif
+
 /*
  * ============================================================================
  * SIMD INTRINSICS & COMPILER MACROS
@@ -78,6 +88,7 @@ extern "C" {
 #define ZXC_MEMSET(dst, val, n) __builtin_memset(dst, val, n)
 #define ZXC_ALIGN(x) __attribute__((aligned(x)))
 #define ZXC_ALWAYS_INLINE inline __attribute__((always_inline))
+#define ZXC_NOINLINE __attribute__((noinline))
 
 #elif defined(_MSC_VER)
 #include <intrin.h>
@@ -97,6 +108,7 @@ extern "C" {
 #define ZXC_MEMSET(dst, val, n) memset(dst, val, n)
 #define ZXC_ALIGN(x) __declspec(align(x))
 #define ZXC_ALWAYS_INLINE __forceinline
+#define ZXC_NOINLINE __declspec(noinline)
 #pragma intrinsic(_BitScanReverse)
 #else
 #define LIKELY(x) (x)
@@ -107,6 +119,7 @@ extern "C" {
 #define ZXC_MEMCPY(dst, src, n) memcpy(dst, src, n)
 #define ZXC_MEMSET(dst, val, n) memset(dst, val, n)
 #define ZXC_ALWAYS_INLINE inline
+#define ZXC_NOINLINE
 #if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
 #include <stdalign.h>
 #define ZXC_ALIGN(x) _Alignas(x)
@@ -131,14 +144,15 @@ extern "C" {
 #define ZXC_CACHE_LINE_SIZE 64                // Cache line size
 #define ZXC_ALIGNMENT_MASK (ZXC_CACHE_LINE_SIZE - 1)  // Alignment mask
 #define ZXC_VBYTE_MAX_LEN 5                           // Maximum length of variable byte encoding
-#define ZXC_VBYTE_ALLOC_LEN 3  // Max length for allocation (sufficient for < 2MB blocks)
+#define ZXC_VBYTE_ALLOC_LEN 4  // Max length for allocation (sufficient for < 256MB blocks)
 
 // Binary Header Sizes
 #define ZXC_FILE_HEADER_SIZE 8  // Magic (4 bytes) + Version (1 byte) + Reserved (3 bytes)
 #define ZXC_BLOCK_HEADER_SIZE \
-    12  // Type (1) + Flags (1) + Reserved (2) + Comp Size (4) + Raw Size (4)
+    12  // Type (1) + Flags (1) + Elem Size (2) + Comp Size (4) + Raw Size (4)
 #define ZXC_BLOCK_CHECKSUM_SIZE 8      // Size of checksum field in bytes
-#define ZXC_NUM_HEADER_BINARY_SIZE 16  // Num Header: N Values (8) + Frame Size (2) + Reserved (6)
+#define ZXC_NUM_HEADER_BINARY_SIZE \
+    16  // Num Header: N Values (8) + Frame Size (2) + Codec (1) + Reserved (5)
 #define ZXC_GLO_HEADER_BINARY_SIZE \
     16  // GLO Header: N Sequences (4) + N Literals (4) + 4 x 1-byte Encoding Types
 #define ZXC_GHI_HEADER_BINARY_SIZE \
@@ -153,11 +167,33 @@ extern "C" {
 // Block Flags
 #define ZXC_BLOCK_FLAG_NONE 0U         // No flags
 #define ZXC_BLOCK_FLAG_CHECKSUM 0x80U  // Block has a checksum (8 bytes after header)
+#define ZXC_BLOCK_FLAG_LINKED 0x40U    // Block references the tail of the previous block
+#define ZXC_BLOCK_FLAG_SHUFFLED 0x20U  // Payload holds the byte-shuffled data (see Elem Size)
 #define ZXC_CHECKSUM_TYPE_MASK 0x0FU   // Lower 4 bits for algorithm ID
 
 // Checksum Algorithms
 #define ZXC_CHECKSUM_RAPIDHASH 0x00U  // Default: rapidhash algorithm
 
+// File Header Flags (byte 6)
+#define ZXC_FILE_FLAG_NONE 0U             // No optional frame features
+#define ZXC_FILE_FLAG_SEEKABLE 0x01U      // Frame ends with a SEK block (seek table)
+#define ZXC_FILE_FLAG_CONTENT_SIZE 0x02U  // 8-byte raw content size follows the header
+#define ZXC_FILE_FLAG_DICT_ID 0x04U       // 4-byte dictionary ID follows the content size
+#define ZXC_FILE_FLAG_DIGEST 0x08U        // A DIG block follows the last data block
+#define ZXC_FILE_CONTENT_SIZE_SIZE 8      // Size of the optional content size field
+#define ZXC_FILE_DICT_ID_SIZE 4           // Size of the optional dictionary ID field
+#define ZXC_FILE_HEADER_MAX_SIZE \
+    (ZXC_FILE_HEADER_SIZE + ZXC_FILE_CONTENT_SIZE_SIZE + ZXC_FILE_DICT_ID_SIZE)  // All fields
+
+// Seek Table (SEK block payload: N entries followed by the trailer)
+#define ZXC_SEEK_MAGIC 0x5343585AU  // Trailer signature "ZXCS" (Little Endian)
+#define ZXC_SEEK_ENTRY_SIZE 16      // Comp Offset (8) + Raw Offset (8)
+#define ZXC_SEEK_TRAILER_SIZE 12    // N Entries (4) + Table Size (4) + Magic (4)
+
+// Frame Digest (DIG block payload)
+#define ZXC_DIGEST_SIZE 8  // Combined block checksums (u64)
+#define ZXC_DIGEST_BLOCK_SIZE (ZXC_BLOCK_HEADER_SIZE + ZXC_DIGEST_SIZE)  // Whole DIG block
+
 // Token Format Constants
 // Sequence Format Constants (GLO Token - 4-bit LL, 4-bit ML, 16-bit Offset)
 #define ZXC_TOKEN_LIT_BITS 4  // Number of bits for Literal Length in token
@@ -184,6 +220,13 @@ extern "C" {
 #define ZXC_LIT_LEN_MASK \
     (ZXC_LIT_RLE_FLAG - 1)  // Mask to extract length from RLE/Literal token (127)
 
+// FSE (tANS) Entropy Stage Constants
+#define ZXC_FSE_TABLE_LOG_MAX 11  // Largest state table (2048 states, 8KB decode table)
+#define ZXC_FSE_TABLE_LOG_MIN 5   // Smallest state table (32 states)
+#define ZXC_FSE_STATES 4          // Interleaved states (symbol i uses state i % 4)
+#define ZXC_FSE_MIN_INPUT 64      // Sections below this size are not entropy coded
+#define ZXC_FSE_SYMBOLS 256       // Alphabet size (bytes)
+
 // LZ77 Constants
 // The hash table uses 13 bits for addressing, resulting in 8192 (2^13) entries.
 // The hash table uses 2x entries (load factor < 0.5) to reduce collisions.
@@ -191,12 +234,96 @@ extern "C" {
 // Total memory footprint: 64KB (8192 entries * 2 * 4 bytes each).
 #define ZXC_LZ_HASH_BITS 13                        // (2*(2^13) * 4 bytes = 64KB)
 #define ZXC_LZ_HASH_SIZE (1U << ZXC_LZ_HASH_BITS)  // Hash table size
+#define ZXC_LZ_HASH_BITS_MIN 8                     // Smallest table for tiny inputs (2KB)
 #define ZXC_LZ_WINDOW_SIZE (1U << 16)              // 64KB sliding window
 // Note: sliding window of 64KB allows chain_table to use uint16_t for valid offsets (since any
 // match > 64KB is invalid).
 #define ZXC_LZ_MIN_MATCH_LEN 5                    // Minimum match length
 #define ZXC_LZ_MAX_DIST (ZXC_LZ_WINDOW_SIZE - 1)  // Maximum offset distance
 
+/**
+ * @brief Selects the number of hash bits for an LZ77 input of a given size.
+ *
+ * The table gets about one bucket per input position, between
+ * ZXC_LZ_HASH_BITS_MIN and ZXC_LZ_HASH_BITS bits. Inputs of 8KB and more use the
+ * full table; smaller ones touch (and allocate) proportionally less memory
+ * without adding collisions.
+ *
+ * @param[in] size Size of the input block (or of the largest block a context serves).
+ * @return Number of hash bits to use.
+ */
+static ZXC_ALWAYS_INLINE uint32_t zxc_lz_hash_log(size_t size) {
+    uint32_t log = ZXC_LZ_HASH_BITS_MIN;
+    while (log < ZXC_LZ_HASH_BITS && ((size_t)1 << log) < size) log++;
+    return log;
+}
+
+/**
+ * @brief Computes a hash value optimized for LZ77 pattern matching speed.
+ *
+ * Knuth's multiplicative hash constant: 2654435761 (golden ratio * 2^32)
+ * Returns upper bits which have the best avalanche properties
+ * Keeping only the top hash_log bits yields an index below (1 << hash_log).
+ *
+ * @param[in] val The 32-bit integer sequence (e.g., 4 bytes from the input stream).
+ * @param[in] hash_log Number of hash bits used by the current block (see zxc_lz_hash_log()).
+ * @return uint32_t A hash value suitable for indexing the match table.
+ */
+static ZXC_ALWAYS_INLINE uint32_t zxc_hash_func(uint32_t val, uint32_t hash_log) {
+    return (val * 2654435761U) >> (32 - hash_log);
+}
+
+/**
+ * @struct zxc_dict_s
+ * @brief Prepared dictionary: raw content plus a read-only LZ77 index over it.
+ *
+ * Every block of a dictionary frame may reference the dictionary as if it were
+ * the ZXC_DICT_SIZE_MAX bytes preceding the block. The index is built once by
+ * zxc_create_dict(); the match finder probes it after the block's own chain,
+ * so attaching a dictionary costs no table copy per block.
+ */
+struct zxc_dict_s {
+    uint8_t* content;       // Dictionary bytes (followed by ZXC_PAD_SIZE zero bytes)
+    uint32_t size;          // Content size (<= ZXC_DICT_SIZE_MAX)
+    uint32_t id;            // Identifier stored in the frame header
+    uint32_t hash_log;      // Number of hash bits of the index
+    uint32_t* hash_table;   // Per bucket: last position with that hash (0 = empty)
+    uint16_t* chain_table;  // Distance to the previous position with the same hash
+    void* memory_block;     // Single allocation block owner
+};
+
+/**
+ * @brief Rounds an input size up to the chunk size a compression context needs.
+ *
+ * Inputs of at least one block get a full block_size context. Smaller ones
+ * are rounded up to a power of two (at least 1 << ZXC_LZ_HASH_BITS_MIN), so
+ * contexts come in a few size classes and a reused context rarely has to grow.
+ *
+ * @param[in] src_size Total size of the data to compress.
+ * @param[in] block_size Block size of the frame being written.
+ * @return Chunk size to pass to zxc_cctx_init().
+ */
+static ZXC_ALWAYS_INLINE size_t zxc_cctx_chunk_size(size_t src_size, size_t block_size) {
+    size_t chunk = (size_t)1 << ZXC_LZ_HASH_BITS_MIN;
+    while (chunk < block_size && chunk < src_size) chunk <<= 1;
+    return chunk < block_size ? chunk : block_size;
+}
+
+/**
+ * @brief Validates a block size requested by the caller.
+ *
+ * @param[in] block_size Requested block size in bytes (0 selects the default).
+ * @return The block size to use, or 0 if it is outside
+ * [ZXC_BLOCK_SIZE_MIN, ZXC_BLOCK_SIZE_MAX] or not a multiple of ZXC_BLOCK_UNIT.
+ */
+static ZXC_ALWAYS_INLINE size_t zxc_resolve_block_size(size_t block_size) {
+    if (block_size == 0) return ZXC_BLOCK_SIZE;
+    if (UNLIKELY(block_size < ZXC_BLOCK_SIZE_MIN || block_size > ZXC_BLOCK_SIZE_MAX ||
+                 block_size % ZXC_BLOCK_UNIT != 0))
+        return 0;
+    return block_size;
+}
+
 /**
  * @struct zxc_lz77_params_t
  * @brief Search parameters for LZ77 compression levels.
@@ -220,8 +347,15 @@ typedef struct {
  * @return zxc_lz77_params_t The LZ77 parameters structure corresponding to the specified level.
  */
 static ZXC_ALWAYS_INLINE zxc_lz77_params_t zxc_get_lz77_params(int level) {
-    if (level >= 5) return (zxc_lz77_params_t){64, 256, 1, 16, 1, 31};
     // search_depth, sufficient_len, use_lazy, lazy_attempts, step_base, step_shift
+    static const zxc_lz77_params_t deep[5] = {
+        {64, 256, 1, 16, 1, 31},     // level 5
+        {64, 256, 1, 16, 1, 31},     // level 6
+        {128, 512, 1, 32, 1, 31},    // level 7
+        {32, 128, 0, 0, 1, 31},      // level 8 (optimal parser: tree depth, nice length)
+        {128, 512, 0, 0, 1, 31}      // level 9 (optimal parser, two passes)
+    };
+    if (level >= 5) return deep[(level > 9 ? 9 : level) - 5];
     static const zxc_lz77_params_t table[5] = {
         {6, 16, 0, 0, 2, 3},  // fallback
         {6, 16, 0, 0, 2, 3},  // level 1
@@ -247,12 +381,24 @@ static ZXC_ALWAYS_INLINE zxc_lz77_params_t zxc_get_lz77_params(int level) {
  *   Uses Delta Encoding + ZigZag + Bitpacking.
  * - `ZXC_BLOCK_GHI` (3): General-purpose high-velocity mode using LZ77 with advanced
  * techniques (lazy matching, step skipping) for maximum ratio. Includes 3 sections descriptors.
+ * - `ZXC_BLOCK_SEK` (4): Seek table. Carries no data (raw size 0) and is always the
+ * last block of a seekable frame; decoders skip it.
+ * - `ZXC_BLOCK_DIG` (5): Frame digest. Carries no data (raw size 0): its 8-byte
+ * payload combines the checksums of all the data blocks. It follows the last
+ * data block, before the seek table if there is one.
+ * - `ZXC_BLOCK_END` (6): End of stream. A bare header (no flags, both sizes 0)
+ * closing the frame, so a reader of a byte stream knows where it ends without
+ * waiting for the end of the input. Optional, last block of the frame (after
+ * the digest), never in a seekable frame.
  */
 typedef enum {
     ZXC_BLOCK_RAW = 0,
     ZXC_BLOCK_GLO = 1,
     ZXC_BLOCK_NUM = 2,
-    ZXC_BLOCK_GHI = 3
+    ZXC_BLOCK_GHI = 3,
+    ZXC_BLOCK_SEK = 4,
+    ZXC_BLOCK_DIG = 5,
+    ZXC_BLOCK_END = 6
 } zxc_block_type_t;
 
 /**
@@ -264,14 +410,14 @@ typedef enum {
  * - `ZXC_SECTION_ENCODING_RAW`: Data is stored uncompressed.
  * - `ZXC_SECTION_ENCODING_RLE`: Run-Length Encoding.
  * - `ZXC_SECTION_ENCODING_BITPACK`: Bitpacking for integer values.
- * - `ZXC_SECTION_ENCODING_FSE`: Finite State Entropy (Reserved).
+ * - `ZXC_SECTION_ENCODING_FSE`: Finite State Entropy (tANS, levels 6+).
  * - `ZXC_SECTION_ENCODING_BITPACK_FSE`: Combined Bitpacking and FSE (Reserved).
  */
 typedef enum {
     ZXC_SECTION_ENCODING_RAW = 0,
     ZXC_SECTION_ENCODING_RLE = 1,
     ZXC_SECTION_ENCODING_BITPACK = 2,
-    ZXC_SECTION_ENCODING_FSE = 3,         // Reserved
+    ZXC_SECTION_ENCODING_FSE = 3,         // tANS coded bytes (zxc_fse_encode)
     ZXC_SECTION_ENCODING_BITPACK_FSE = 4  // Reserved
 } zxc_section_encoding_t;
 
@@ -289,7 +435,8 @@ typedef enum {
  * @var zxc_gnr_header_t::enc_lit
  * Encoding method used for the literal stream.
  * @var zxc_gnr_header_t::enc_litlen
- * Encoding method used for the literal lengths stream.
+ * Encoding method used for the literal lengths stream (GLO: the token stream,
+ * RAW or FSE).
  * @var zxc_gnr_header_t::enc_mlen
  * Encoding method used for the match lengths stream.
  * @var zxc_gnr_header_t::enc_off
@@ -330,12 +477,49 @@ typedef struct {
  * The total number of numeric values encoded in the block.
  * @var zxc_num_header_t::frame_size
  * The size of the frame used for processing.
+ * @var zxc_num_header_t::codec
+ * Element width and transform of the values (zxc_num_codec_t).
  */
 typedef struct {
     uint64_t n_values;
     uint16_t frame_size;
+    uint8_t codec;
 } zxc_num_header_t;
 
+/**
+ * @enum zxc_num_codec_t
+ * @brief Element width and transform of a NUM block.
+ *
+ * Every frame packs the zigzag-coded (or XOR-ed) values with one bit width.
+ * The legacy codec 0 carries its values across frames; the others restart
+ * each frame from the frame base (the value preceding the frame), so the
+ * first value of a block costs no bits either.
+ */
+typedef enum {
+    ZXC_NUM_CODEC_U32_DELTA = 0,  // 32-bit integers, delta + zigzag
+    ZXC_NUM_CODEC_U16_DELTA = 1,  // 16-bit integers, delta + zigzag
+    ZXC_NUM_CODEC_U64_DELTA = 2,  // 64-bit integers, delta + zigzag
+    ZXC_NUM_CODEC_U64_DOD = 3,    // 64-bit integers, delta-of-delta + zigzag (delta carried)
+    ZXC_NUM_CODEC_F32_XOR = 4,    // 32-bit floats, XOR with the previous value
+    ZXC_NUM_CODEC_F64_XOR = 5     // 64-bit floats, XOR with the previous value
+} zxc_num_codec_t;
+
+#define ZXC_NUM_CODEC_COUNT 6  // Number of defined NUM codecs
+
+/**
+ * @brief Size in bytes of one element of a NUM codec.
+ *
+ * @param[in] codec NUM codec (< ZXC_NUM_CODEC_COUNT).
+ * @return 2, 4 or 8.
+ */
+static ZXC_ALWAYS_INLINE size_t zxc_num_elem_size(int codec) {
+    static const uint8_t size[ZXC_NUM_CODEC_COUNT] = {4, 2, 8, 8, 4, 8};
+    return size[codec];
+}
+// The frame bit-width field holds the width in its low byte and, for the XOR
+// codecs, the number of trailing zero bits dropped from every value above it.
+#define ZXC_NUM_SHIFT_SHIFT 8
+
 /**
  * @typedef zxc_bit_reader_t
  * @brief Internal bit reader structure for ZXC compression/decompression.
@@ -462,6 +646,21 @@ static ZXC_ALWAYS_INLINE void zxc_store_le32(void* p, uint32_t v) { ZXC_MEMCPY(p
  */
 static ZXC_ALWAYS_INLINE void zxc_store_le64(void* p, uint64_t v) { ZXC_MEMCPY(p, &v, sizeof(v)); }
 
+/**
+ * @brief Computes the full size of a file header from its flags byte.
+ *
+ * The fixed part is always ZXC_FILE_HEADER_SIZE bytes; optional fields
+ * announced by the flags follow it.
+ *
+ * @param[in] flags Frame flags (byte 6 of the file header).
+ * @return Size of the file header in bytes, optional fields included.
+ */
+static ZXC_ALWAYS_INLINE size_t zxc_file_header_size(uint8_t flags) {
+    return ZXC_FILE_HEADER_SIZE +
+           ((flags & ZXC_FILE_FLAG_CONTENT_SIZE) ? ZXC_FILE_CONTENT_SIZE_SIZE : 0) +
+           ((flags & ZXC_FILE_FLAG_DICT_ID) ? ZXC_FILE_DICT_ID_SIZE : 0);
+}
+
 /**
  * @brief Copies 16 bytes from the source memory location to the destination memory location.
  *
@@ -503,6 +702,51 @@ static ZXC_ALWAYS_INLINE void zxc_copy32(void* dst, const void* src) {
 #endif
 }
 
+#if defined(ZXC_USE_AVX2) || defined(ZXC_USE_AVX512)
+/**
+ * @brief Transposes a 4x4 matrix of 32-bit lanes held in four SSE registers.
+ *
+ * Its own inverse; used by the 4-byte shuffle and unshuffle kernels.
+ *
+ * @param[in,out] r Rows of the matrix, replaced by its columns.
+ */
+static ZXC_ALWAYS_INLINE void zxc_transpose_4x4_epi32(__m128i r[4]) {
+    __m128i t0 = _mm_unpacklo_epi32(r[0], r[1]);
+    __m128i t1 = _mm_unpackhi_epi32(r[0], r[1]);
+    __m128i t2 = _mm_unpacklo_epi32(r[2], r[3]);
+    __m128i t3 = _mm_unpackhi_epi32(r[2], r[3]);
+    r[0] = _mm_unpacklo_epi64(t0, t2);
+    r[1] = _mm_unpackhi_epi64(t0, t2);
+    r[2] = _mm_unpacklo_epi64(t1, t3);
+    r[3] = _mm_unpackhi_epi64(t1, t3);
+}
+
+/**
+ * @brief Transposes an 8x8 matrix of 16-bit lanes held in eight SSE registers.
+ *
+ * Its own inverse; used by the 8-byte shuffle and unshuffle kernels.
+ *
+ * @param[in,out] r Rows of the matrix, replaced by its columns.
+ */
+static ZXC_ALWAYS_INLINE void zxc_transpose_8x8_epi16(__m128i r[8]) {
+    __m128i s[8], q[8];
+    for (int k = 0; k < 4; k++) {
+        s[2 * k] = _mm_unpacklo_epi16(r[2 * k], r[2 * k + 1]);
+        s[2 * k + 1] = _mm_unpackhi_epi16(r[2 * k], r[2 * k + 1]);
+    }
+    for (int k = 0; k < 2; k++) {
+        q[4 * k + 0] = _mm_unpacklo_epi32(s[4 * k + 0], s[4 * k + 2]);
+        q[4 * k + 1] = _mm_unpackhi_epi32(s[4 * k + 0], s[4 * k + 2]);
+        q[4 * k + 2] = _mm_unpacklo_epi32(s[4 * k + 1], s[4 * k + 3]);
+        q[4 * k + 3] = _mm_unpackhi_epi32(s[4 * k + 1], s[4 * k + 3]);
+    }
+    for (int k = 0; k < 4; k++) {
+        r[2 * k] = _mm_unpacklo_epi64(q[k], q[k + 4]);
+        r[2 * k + 1] = _mm_unpackhi_epi64(q[k], q[k + 4]);
+    }
+}
+#endif
+
 /**
  * @brief Counts trailing zeros in a 32-bit unsigned integer.
  *
@@ -581,6 +825,17 @@ static ZXC_ALWAYS_INLINE uint8_t zxc_highbit32(uint32_t n) {
 #endif
 }
 
+/**
+ * @brief Number of significant bits of a 64-bit integer (see zxc_highbit32()).
+ *
+ * @param[in] n The 64-bit unsigned integer to analyze.
+ * @return 1 + the index of the highest set bit, or 0 if n is 0.
+ */
+static ZXC_ALWAYS_INLINE uint8_t zxc_highbit64(uint64_t n) {
+    uint32_t hi = (uint32_t)(n >> 32);
+    return hi ? (uint8_t)(32 + zxc_highbit32(hi)) : zxc_highbit32((uint32_t)n);
+}
+
 /**
  * @brief Encodes a signed 32-bit integer using ZigZag encoding.
  *
@@ -623,6 +878,63 @@ static ZXC_ALWAYS_INLINE int32_t zxc_zigzag_decode(uint32_t n) {
     return (int32_t)(n >> 1) ^ -(int32_t)(n & 1);
 }
 
+/**
+ * @brief ZigZag-encodes a signed 64-bit integer (see zxc_zigzag_encode()).
+ *
+ * @param[in] n The signed 64-bit integer to encode.
+ * @return The ZigZag encoded unsigned 64-bit integer.
+ */
+static ZXC_ALWAYS_INLINE uint64_t zxc_zigzag_encode64(int64_t n) {
+    return ((uint64_t)n << 1) ^ (uint64_t)(-(int64_t)((uint64_t)n >> 63));
+}
+
+/**
+ * @brief Decodes a ZigZag-encoded 64-bit integer (see zxc_zigzag_decode()).
+ *
+ * @param[in] n The unsigned 64-bit integer to decode.
+ * @return The decoded signed 64-bit integer.
+ */
+static ZXC_ALWAYS_INLINE int64_t zxc_zigzag_decode64(uint64_t n) {
+    return (int64_t)(n >> 1) ^ -(int64_t)(n & 1);
+}
+
+/*
+ * FSE (tANS) section layout (GLO literal and token sections, levels 6+):
+ *   [Table Log (1)] [Max Symbol (1)] [Normalized counts, Elias-gamma coded,
+ *   byte padded] [Size of stream A (4)] [Stream A] [Stream B]
+ *
+ * Stream A codes the first half of the symbols (rounded down to a multiple of
+ * 4), stream B the rest, both with the same table. Each stream is written
+ * forward while its symbols are encoded backward, and read backward by the
+ * decoder; it ends with the four final encoder states and a 1-bit end marker.
+ * Within a stream, symbol i is coded by state (i % 4).
+ *
+ * Decoding is latency bound (table lookup -> bit read -> next state), so the
+ * decoder runs both streams in lockstep: eight independent states, four per
+ * refill of each 64-bit window.
+ */
+
+/**
+ * @brief Spreads the symbols over the table (same walk on both sides).
+ *
+ * The step is odd, hence coprime with the table size: every cell is visited
+ * exactly once when the counts sum to the table size.
+ */
+static ZXC_ALWAYS_INLINE void zxc_fse_spread(const uint16_t* norm, unsigned max_sym, unsigned log,
+                                             uint8_t* cells) {
+    const uint32_t size = 1U << log;
+    const uint32_t mask = size - 1;
+    const uint32_t step = (size >> 1) + (size >> 3) + 3;
+    uint32_t pos = 0;
+    for (unsigned s = 0; s <= max_sym; s++) {
+        for (uint32_t i = 0; i < norm[s]; i++) {
+            cells[pos] = (uint8_t)s;
+            pos = (pos + step) & mask;
+        }
+    }
+}
+
+
 /**
  * @brief Allocates aligned memory in a cross-platform manner.
  *
@@ -764,6 +1076,23 @@ static ZXC_ALWAYS_INLINE void zxc_br_ensure(zxc_bit_reader_t* br, int needed) {
 int zxc_bitpack_stream_32(const uint32_t* RESTRICT src, size_t count, uint8_t* RESTRICT dst,
                           size_t dst_cap, uint8_t bits);
 
+/**
+ * @brief Bit-packs a stream of 64-bit integers into a destination buffer.
+ *
+ * Same layout as zxc_bitpack_stream_32(), LSB first, for widths up to 64 bits.
+ *
+ * @param[in] src Pointer to the source array of 64-bit integers.
+ * @param[in] count The number of integers to pack.
+ * @param[out] dst Pointer to the destination buffer where packed data will be
+ * written.
+ * @param[in] dst_cap The capacity of the destination buffer in bytes.
+ * @param[in] bits The number of bits to use for each integer (0..64).
+ * @return int The number of bytes written to the destination buffer, or a negative
+ * error code on failure.
+ */
+int zxc_bitpack_stream_64(const uint64_t* RESTRICT src, size_t count, uint8_t* RESTRICT dst,
+                          size_t dst_cap, uint8_t bits);
+
 /**
  * @brief Writes a numeric header structure to a destination buffer.
  *
@@ -897,6 +1226,105 @@ int zxc_decompress_chunk_wrapper(zxc_cctx_t* ctx, const uint8_t* src, size_t src
 int zxc_compress_chunk_wrapper(zxc_cctx_t* ctx, const uint8_t* chunk, size_t src_sz, uint8_t* dst,
                                size_t dst_cap);
 
+/**
+ * @brief Sets the history of the next block in linked mode.
+ *
+ * The last ZXC_DICT_SIZE_MAX bytes (at most) of the previous block become the
+ * history of the next one: the compressor may reference them and marks its
+ * GLO/GHI blocks with ZXC_BLOCK_FLAG_LINKED; the decompressor resolves the
+ * offsets of such blocks against them. The bytes are not copied and must stay
+ * valid until the next block has been processed.
+ *
+ * @param[in,out] ctx Context the history is attached to (owns its index).
+ * @param[in] prev Start of the previous block's raw data.
+ * @param[in] prev_len Size of the previous block (0 detaches the history).
+ * @param[in] index Build the match finder index (compression) or not.
+ * @return 0 on success, -1 on allocation failure.
+ */
+int zxc_cctx_link(zxc_cctx_t* ctx, const uint8_t* prev, size_t prev_len, int index);
+
+/**
+ * @brief Returns the shuffle scratch buffer of a context, growing it if needed.
+ *
+ * @param[in,out] ctx Context owning the buffer (freed by zxc_cctx_free()).
+ * @param[in] size Required size in bytes (ZXC_PAD_SIZE bytes of slack are added).
+ * @return The buffer, or NULL on allocation failure.
+ */
+uint8_t* zxc_cctx_shuffle_buf(zxc_cctx_t* ctx, size_t size);
+
+/**
+ * @brief Adds the block selection counters of @p src to @p dst.
+ *
+ * @param[in,out] dst Counters to add to.
+ * @param[in] src Counters to add.
+ */
+void zxc_block_stats_add(zxc_block_stats_t* dst, const zxc_block_stats_t* src);
+
+/**
+ * @brief Returns the time of a monotonic clock, in nanoseconds.
+ */
+uint64_t zxc_perf_now(void);
+
+/**
+ * @struct zxc_perf_call_t
+ * @brief Bookkeeping of one instrumented call, see zxc_perf_begin().
+ *
+ * @var zxc_perf_call_t::stats
+ *      Counters of this call.
+ * @var zxc_perf_call_t::dst
+ *      Counters of the calling thread (zxc_perf_capture()), or NULL.
+ * @var zxc_perf_call_t::name
+ *      Name passed to the trace hook.
+ * @var zxc_perf_call_t::t0
+ *      Start time of the call.
+ * @var zxc_perf_call_t::on
+ *      Counters are collected for this call.
+ */
+typedef struct {
+    zxc_perf_stats_t stats;
+    zxc_perf_stats_t* dst;
+    const char* name;
+    uint64_t t0;
+    int on;
+} zxc_perf_call_t;
+
+/**
+ * @brief Starts an instrumented call.
+ *
+ * Counters are collected for the outermost call of a thread only, when that
+ * thread captures them or a trace hook is installed. Every zxc_perf_begin()
+ * must be paired with a zxc_perf_end().
+ *
+ * @param[out] call Bookkeeping of the call.
+ * @param[in]  name Name of the call for the trace hook.
+ * @return The counters the call adds to, or NULL when they are not collected.
+ */
+zxc_perf_stats_t* zxc_perf_begin(zxc_perf_call_t* call, const char* name);
+
+/**
+ * @brief Ends an instrumented call: delivers its counters to the calling
+ * thread's capture and to the trace hook.
+ *
+ * @param[in,out] call      Call started by zxc_perf_begin().
+ * @param[in]     bytes_in  Bytes consumed by the call.
+ * @param[in]     bytes_out Bytes produced by the call (0 on failure).
+ */
+void zxc_perf_end(zxc_perf_call_t* call, uint64_t bytes_in, uint64_t bytes_out);
+
+/**
+ * @brief Adds a set of performance counters to another.
+ *
+ * @param[in,out] dst Counters to add to.
+ * @param[in]     src Counters to add.
+ */
+void zxc_perf_stats_add(zxc_perf_stats_t* dst, const zxc_perf_stats_t* src);
+
+/**
+ * @brief Marks the calling thread as working for other calls for good (pool
+ * workers): calls it makes are never instrumented on their own.
+ */
+void zxc_perf_enter_worker(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,79 @@
+#!/bin/bash
+# Copyright (c) 2025-2026, Bertrand Lebonnois
+# All rights reserved.
+#
+# This source code is licensed under the BSD-style license found in the
+# LICENSE file in the root directory of this source tree.
+#
+# Thread scaling benchmark for the streaming engine.
+# Runs the in-memory CLI benchmark (zxc -b) for an increasing number of
+# threads and prints the throughput and the speedup over one thread.
+#
+# Usage: ./tests/bench_threads.sh [path_to_zxc_binary] [input_file]
+#
+# Environment:
+#   THREADS     Thread counts to test   (default: "1 2 4 8 16 32 64 128")
+#   LEVELS      Compression levels      (default: "1 3")
+#   ITERATIONS  Iterations per run      (default: 5)
+#   BLOCK_SIZE  Block size passed to -B (default: engine default)
+
+set -e
+
+ZXC_BIN=${1:-"../build/zxc"}
+INPUT=$2
+THREADS=${THREADS:-"1 2 4 8 16 32 64 128"}
+LEVELS=${LEVELS:-"1 3"}
+ITERATIONS=${ITERATIONS:-5}
+
+if [ ! -f "$ZXC_BIN" ]; then
+    echo "Binary not found at $ZXC_BIN. Please build the project first."
+    exit 1
+fi
+
+GENERATED=""
+cleanup() {
+    if [ -n "$GENERATED" ]; then rm -f "$GENERATED"; fi
+}
+trap cleanup EXIT
+
+# Default input: 256 MB of text mixed with incompressible chunks, so that
+# there are enough blocks to keep 128 workers busy and block costs vary.
+if [ -z "$INPUT" ]; then
+    GENERATED=$(mktemp)
+    INPUT=$GENERATED
+    echo "Generating 256 MB test input..."
+    LOREM="Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua. "
+    for i in {1..64}; do
+        printf '%.0s'"$LOREM" {1..3000}
+        head -c 3800000 /dev/urandom | base64 -w 0
+    done | head -c 268435456 > "$INPUT"
+fi
+
+BLOCK_ARGS=()
+if [ -n "$BLOCK_SIZE" ]; then BLOCK_ARGS=(-B "$BLOCK_SIZE"); fi
+
+echo "Input: $INPUT ($(wc -c < "$INPUT" | tr -d ' ') bytes), $(getconf _NPROCESSORS_ONLN) CPUs online"
+
+for level in $LEVELS; do
+    echo ""
+    echo "Level $level"
+    printf "%8s %14s %8s %14s %8s\n" "threads" "comp MiB/s" "speedup" "decomp MiB/s" "speedup"
+    base_c=""
+    base_d=""
+    for t in $THREADS; do
+        out=$("$ZXC_BIN" -b -"$level" -T "$t" "${BLOCK_ARGS[@]}" "$INPUT" "$ITERATIONS")
+        c=$(echo "$out" | awk -F': ' '/Avg Compress/ {print $2}' | awk '{print $1}')
+        d=$(echo "$out" | awk -F': ' '/Avg Decompress/ {print $2}' | awk '{print $1}')
+        if [ -z "$c" ] || [ -z "$d" ]; then
+            echo "Benchmark failed for $t threads:"
+            echo "$out"
+            exit 1
+        fi
+        if [ -z "$base_c" ]; then
+            base_c=$c
+            base_d=$d
+        fi
+        awk -v t="$t" -v c="$c" -v d="$d" -v bc="$base_c" -v bd="$base_d" \
+            'BEGIN { printf "%8s %14s %7.2fx %14s %7.2fx\n", t, c, c / bc, d, d / bd }'
+    done
+done
@@ -6,12 +6,20 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L  // setenv()
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#ifndef _WIN32
+#include <pthread.h>
+#endif
 
 #include "../include/zxc_buffer.h"
+#include "../include/zxc_pool.h"
 #include "../include/zxc_stream.h"
 #include "../src/lib/zxc_internal.h"
 
@@ -483,6 +491,2770 @@ int test_buffer_api() {
     return 1;
 }
 
+// Checks the seek table footer and random-access decompression, on buffer and
+// stream output, with and without a seek table.
+int test_seekable_range() {
+    printf("=== TEST: Unit - Seek Table & zxc_decompress_range ===\n");
+
+    size_t src_size = 3 * 256 * 1024 + 777;  // 4 blocks, last one partial
+    uint8_t* src = malloc(src_size);
+    size_t cap = zxc_compress_bound(src_size);
+    uint8_t* comp = malloc(cap);
+    uint8_t* out = malloc(src_size);
+    char* s_buf = NULL;
+    int ok = 0;
+    if (!src || !comp || !out) goto cleanup;
+    gen_lz_data(src, src_size);
+
+    // Ranges: inside one block, across a block boundary, whole data, clamped tail
+    const size_t ranges[][2] = {{100, 64 * 1024},       {256 * 1024 - 10, 20},
+                                {0, src_size},          {src_size - 500, 4096},
+                                {3 * 256 * 1024, 777}};
+    const size_t n_ranges = sizeof(ranges) / sizeof(ranges[0]);
+
+    for (int pass = 0; pass < 3; pass++) {
+        zxc_compress_opts_t opts = {3, 1, pass != 1};
+        size_t c_sz = (pass == 2) ? zxc_compress_mt_ex(src, src_size, comp, cap, 3, &opts)
+                                  : zxc_compress_ex(src, src_size, comp, cap, &opts);
+        if (c_sz == 0) {
+            printf("Failed: compression returned 0 (pass %d)\n", pass);
+            goto cleanup;
+        }
+
+        size_t n = 0, table = 0;
+        int has_table = (zxc_read_seek_trailer(comp, c_sz, &n, &table) == 0);
+        if (has_table != (pass != 1) || (has_table && n != 4)) {
+            printf("Failed: unexpected seek trailer state (pass %d, n=%zu)\n", pass, n);
+            goto cleanup;
+        }
+
+        // Sequential decoders must skip the seek table
+        if (zxc_decompress(comp, c_sz, out, src_size, 1) != src_size ||
+            memcmp(out, src, src_size) != 0 ||
+            zxc_decompress_mt(comp, c_sz, out, src_size, 2, 1) != src_size ||
+            memcmp(out, src, src_size) != 0) {
+            printf("Failed: full decode mismatch (pass %d)\n", pass);
+            goto cleanup;
+        }
+
+        for (size_t r = 0; r < n_ranges; r++) {
+            size_t off = ranges[r][0];
+            size_t len = ranges[r][1];
+            size_t expect = (off + len > src_size) ? src_size - off : len;
+            uint8_t* part = malloc(len);
+            size_t got = zxc_decompress_range(comp, c_sz, off, len, part, 1);
+            int match = (got == expect && memcmp(part, src + off, expect) == 0);
+            free(part);
+            if (!match) {
+                printf("Failed: range [%zu, +%zu) returned %zu (pass %d)\n", off, len, got, pass);
+                goto cleanup;
+            }
+        }
+    }
+
+    // Range past the end yields nothing
+    if (zxc_decompress_range(comp, zxc_compress(src, src_size, comp, cap, 3, 0), src_size, 1,
+                             out, 0) != 0) {
+        printf("Failed: range past the end should return 0\n");
+        goto cleanup;
+    }
+
+    // Stream API output is seekable as well, and still decodes sequentially.
+    FILE* f_in = tmpfile();
+    FILE* f_out = tmpfile();
+    if (!f_in || !f_out) {
+        if (f_in) fclose(f_in);
+        if (f_out) fclose(f_out);
+        goto cleanup;
+    }
+    fwrite(src, 1, src_size, f_in);
+    rewind(f_in);
+    zxc_compress_opts_t s_opts = {2, 0, 1};
+    int64_t s_sz = zxc_stream_compress_ex(f_in, f_out, 2, &s_opts);
+    fclose(f_in);
+    if (s_sz <= 0) {
+        fclose(f_out);
+        printf("Failed: zxc_stream_compress_ex returned %lld\n", (long long)s_sz);
+        goto cleanup;
+    }
+    s_buf = malloc((size_t)s_sz);
+    rewind(f_out);
+    size_t s_read = s_buf ? fread(s_buf, 1, (size_t)s_sz, f_out) : 0;
+    fclose(f_out);
+    if (s_read != (size_t)s_sz ||
+        zxc_decompress_range(s_buf, s_read, 300000, 1000, out, 0) != 1000 ||
+        memcmp(out, src + 300000, 1000) != 0) {
+        printf("Failed: range decode of stream output\n");
+        goto cleanup;
+    }
+
+    FILE* f_c = tmpfile();
+    FILE* f_d = tmpfile();
+    if (!f_c || !f_d) {
+        if (f_c) fclose(f_c);
+        if (f_d) fclose(f_d);
+        goto cleanup;
+    }
+    fwrite(s_buf, 1, s_read, f_c);
+    rewind(f_c);
+    int64_t d_sz = zxc_stream_decompress(f_c, f_d, 2, 0);
+    rewind(f_d);
+    size_t d_read = fread(out, 1, src_size, f_d);
+    fclose(f_c);
+    fclose(f_d);
+    if (d_sz != (int64_t)src_size || d_read != src_size || memcmp(out, src, src_size) != 0) {
+        printf("Failed: stream decode of seekable stream output\n");
+        goto cleanup;
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+
+cleanup:
+    free(src);
+    free(comp);
+    free(out);
+    free(s_buf);
+    return ok;
+}
+
+// Checks the content size recorded in buffer frames and the header-walk
+// fallback used for stream frames.
+int test_content_size() {
+    printf("=== TEST: Unit - Frame Content Size (zxc_get_decompressed_size) ===\n");
+
+    size_t src_size = 2 * 256 * 1024 + 4321;
+    uint8_t* src = malloc(src_size);
+    size_t cap = zxc_compress_bound(src_size);
+    uint8_t* comp = malloc(cap);
+    uint8_t* out = malloc(src_size);
+    uint8_t* s_buf = NULL;
+    int ok = 0;
+    if (!src || !comp || !out) goto cleanup;
+    gen_lz_data(src, src_size);
+
+    // 1. Buffer frames carry the size in their header (single and multithreaded).
+    for (int pass = 0; pass < 2; pass++) {
+        size_t c_sz = pass ? zxc_compress_mt(src, src_size, comp, cap, 3, 3, 1)
+                           : zxc_compress(src, src_size, comp, cap, 3, 1);
+        zxc_file_header_t fh;
+        if (c_sz == 0 ||
+            zxc_read_file_header(comp, c_sz, &fh) !=
+                ZXC_FILE_HEADER_SIZE + ZXC_FILE_CONTENT_SIZE_SIZE ||
+            !(fh.flags & ZXC_FILE_FLAG_CONTENT_SIZE) || fh.content_size != src_size) {
+            printf("Failed: content size missing from header (pass %d)\n", pass);
+            goto cleanup;
+        }
+        if (zxc_get_decompressed_size(comp, c_sz) != src_size) {
+            printf("Failed: zxc_get_decompressed_size mismatch (pass %d)\n", pass);
+            goto cleanup;
+        }
+
+        // A destination smaller than the announced size fails up front.
+        if (zxc_decompress(comp, c_sz, out, src_size - 1, 0) != 0 ||
+            zxc_decompress_mt(comp, c_sz, out, src_size - 1, 2, 0) != 0) {
+            printf("Failed: short destination accepted (pass %d)\n", pass);
+            goto cleanup;
+        }
+        if (zxc_decompress(comp, c_sz, out, src_size, 1) != src_size ||
+            memcmp(out, src, src_size) != 0) {
+            printf("Failed: round trip mismatch (pass %d)\n", pass);
+            goto cleanup;
+        }
+    }
+
+    // 2. Stream frames have no content size: the block headers are summed.
+    FILE* f_in = tmpfile();
+    FILE* f_out = tmpfile();
+    if (!f_in || !f_out) {
+        if (f_in) fclose(f_in);
+        if (f_out) fclose(f_out);
+        goto cleanup;
+    }
+    fwrite(src, 1, src_size, f_in);
+    rewind(f_in);
+    int64_t s_sz = zxc_stream_compress(f_in, f_out, 2, 3, 1);
+    fclose(f_in);
+    s_buf = (s_sz > 0) ? malloc((size_t)s_sz) : NULL;
+    rewind(f_out);
+    size_t s_read = s_buf ? fread(s_buf, 1, (size_t)s_sz, f_out) : 0;
+    fclose(f_out);
+    if (s_read == 0 || s_read != (size_t)s_sz || (s_buf[6] & ZXC_FILE_FLAG_CONTENT_SIZE) ||
+        zxc_get_decompressed_size(s_buf, s_read) != src_size) {
+        printf("Failed: zxc_get_decompressed_size on stream frame\n");
+        goto cleanup;
+    }
+
+    // 3. Invalid input reports 0.
+    if (zxc_get_decompressed_size(comp, 4) != 0 ||
+        zxc_get_decompressed_size(s_buf, s_read - 1) != 0) {
+        printf("Failed: invalid frame should report 0\n");
+        goto cleanup;
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+
+cleanup:
+    free(src);
+    free(comp);
+    free(out);
+    free(s_buf);
+    return ok;
+}
+
+// Checks that reused contexts produce the same frames as the one-shot API
+// across many small messages, and still verify checksums.
+int test_reusable_context() {
+    printf("=== TEST: Unit - Reusable Contexts (zxc_compress_cctx/zxc_decompress_dctx) ===\n");
+
+    const size_t max_msg = 300 * 1024;  // Largest message spans two blocks
+    uint8_t* src = malloc(max_msg);
+    size_t cap = zxc_compress_bound(max_msg);
+    uint8_t* comp = malloc(cap);
+    uint8_t* ref = malloc(cap);
+    uint8_t* out = malloc(max_msg);
+    zxc_cctx* cctx = zxc_create_cctx();
+    zxc_dctx* dctx = zxc_create_dctx();
+    int ok = 0;
+    if (!src || !comp || !ref || !out || !cctx || !dctx) goto cleanup;
+    gen_lz_data(src, max_msg);
+
+    const size_t sizes[] = {4096, 300, 32 * 1024, 17, 12345, max_msg, 8 * 1024};
+    for (int round = 0; round < 3; round++) {
+        for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+            size_t sz = sizes[i];
+            zxc_compress_opts_t opts = {1 + (int)((i + round) % 5), 1, 0};
+            size_t c_sz = zxc_compress_cctx(cctx, src + i, sz - i, comp, cap, &opts);
+            size_t r_sz = zxc_compress_ex(src + i, sz - i, ref, cap, &opts);
+            if (c_sz == 0 || c_sz != r_sz || memcmp(comp, ref, c_sz) != 0) {
+                printf("Failed: reused context output differs (size %zu)\n", sz);
+                goto cleanup;
+            }
+            if (zxc_decompress_dctx(dctx, comp, c_sz, out, max_msg, 1) != sz - i ||
+                memcmp(out, src + i, sz - i) != 0) {
+                printf("Failed: reused context round trip (size %zu)\n", sz);
+                goto cleanup;
+            }
+        }
+    }
+
+    // Checksum verification goes through the context as well.
+    zxc_compress_opts_t opts = {3, 1, 0};
+    size_t c_sz = zxc_compress_cctx(cctx, src, 4096, comp, cap, &opts);
+    comp[c_sz - 1] ^= 0x01;
+    if (zxc_decompress_dctx(dctx, comp, c_sz, out, max_msg, 1) != 0 ||
+        zxc_decompress(comp, c_sz, out, max_msg, 1) != 0) {
+        printf("Failed: corrupted checksum not detected\n");
+        goto cleanup;
+    }
+
+    if (zxc_compress_cctx(NULL, src, 10, comp, cap, NULL) != 0 ||
+        zxc_decompress_dctx(NULL, comp, c_sz, out, max_msg, 0) != 0) {
+        printf("Failed: NULL context should fail\n");
+        goto cleanup;
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+
+cleanup:
+    zxc_free_cctx(cctx);
+    zxc_free_dctx(dctx);
+    free(src);
+    free(comp);
+    free(ref);
+    free(out);
+    return ok;
+}
+
+// Checks that small inputs get right-sized contexts that still round-trip,
+// and that a reused context grows when a larger message shows up.
+int test_small_input_context() {
+    printf("=== TEST: Unit - Small Input Context Sizing ===\n");
+
+    zxc_cctx_t ctx;
+    if (zxc_cctx_init(&ctx, zxc_cctx_chunk_size(300, ZXC_BLOCK_SIZE), 1, 3, 0) != 0 ||
+        ctx.chunk_size != 512 || ctx.hash_log != 9) {
+        printf("Failed: 300-byte context not scaled down (chunk %zu, hash_log %u)\n",
+               ctx.chunk_size, ctx.hash_log);
+        zxc_cctx_free(&ctx);
+        return 0;
+    }
+    zxc_cctx_free(&ctx);
+    if (zxc_cctx_chunk_size(ZXC_BLOCK_SIZE + 1, ZXC_BLOCK_SIZE) != ZXC_BLOCK_SIZE ||
+        zxc_lz_hash_log(ZXC_BLOCK_SIZE) != ZXC_LZ_HASH_BITS) {
+        printf("Failed: large inputs must keep the full context\n");
+        return 0;
+    }
+
+    const size_t max_sz = 100 * 1024;
+    uint8_t* src = malloc(max_sz);
+    size_t cap = zxc_compress_bound(max_sz);
+    uint8_t* comp = malloc(cap);
+    uint8_t* ref = malloc(cap);
+    uint8_t* out = malloc(max_sz);
+    zxc_cctx* cctx = zxc_create_cctx();
+    int ok = 0;
+    if (!src || !comp || !ref || !out || !cctx) goto cleanup;
+    gen_lz_data(src, max_sz);
+
+    // Growing then shrinking messages: the reused context must match the
+    // one-shot output, which is sized for each input on its own.
+    const size_t sizes[] = {1, 13, 64, 300, 1000, 4097, 9000, max_sz, 300, 5000};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        zxc_compress_opts_t opts = {1 + (int)(i % 5), 0, 0};
+        size_t c_sz = zxc_compress_cctx(cctx, src, sizes[i], comp, cap, &opts);
+        size_t r_sz = zxc_compress_ex(src, sizes[i], ref, cap, &opts);
+        if (c_sz == 0 || c_sz != r_sz || memcmp(comp, ref, c_sz) != 0 ||
+            zxc_decompress(comp, c_sz, out, sizes[i], 0) != sizes[i] ||
+            memcmp(out, src, sizes[i]) != 0) {
+            printf("Failed: round trip of %zu bytes\n", sizes[i]);
+            goto cleanup;
+        }
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+
+cleanup:
+    zxc_free_cctx(cctx);
+    free(src);
+    free(comp);
+    free(ref);
+    free(out);
+    return ok;
+}
+
+// Checks custom block sizes through the buffer, multithreaded, context and
+// stream APIs, including a 4MB block whose literal run needs a 4-byte VByte.
+int test_block_size() {
+    printf("=== TEST: Unit - Configurable Block Size ===\n");
+
+    size_t src_size = 9 * 1024 * 1024 + 333;
+    uint8_t* src = malloc(src_size);
+    size_t cap = zxc_compress_bound(src_size);
+    uint8_t* comp = malloc(cap);
+    uint8_t* out = malloc(src_size);
+    zxc_cctx* cctx = zxc_create_cctx();
+    int ok = 0;
+    if (!src || !comp || !out || !cctx) goto cleanup;
+    // 3MB of noise followed by repetitive data: with 4MB blocks the first
+    // GLO/GHI block starts with a literal run longer than 2MB.
+    gen_random_data(src, 3 * 1024 * 1024);
+    gen_lz_data(src + 3 * 1024 * 1024, src_size - 3 * 1024 * 1024);
+
+    const size_t sizes[] = {ZXC_BLOCK_SIZE_MIN, 1020 * 1024, ZXC_BLOCK_SIZE_MAX};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        for (int api = 0; api < 3; api++) {
+            int level = (api == 1) ? 2 : (int)(3 + i % 3);
+            zxc_compress_opts_t opts = {level, 1, 1, sizes[i]};
+            size_t c_sz = (api == 0)   ? zxc_compress_ex(src, src_size, comp, cap, &opts)
+                          : (api == 1) ? zxc_compress_mt_ex(src, src_size, comp, cap, 3, &opts)
+                                       : zxc_compress_cctx(cctx, src, src_size, comp, cap, &opts);
+            zxc_file_header_t fh;
+            if (c_sz == 0 || c_sz > cap || zxc_read_file_header(comp, c_sz, &fh) < 0 ||
+                fh.block_size != sizes[i]) {
+                printf("Failed: block size %zu not recorded (api %d)\n", sizes[i], api);
+                goto cleanup;
+            }
+            if (zxc_decompress(comp, c_sz, out, src_size, 1) != src_size ||
+                memcmp(out, src, src_size) != 0 ||
+                zxc_decompress_mt(comp, c_sz, out, src_size, 3, 1) != src_size ||
+                memcmp(out, src, src_size) != 0) {
+                printf("Failed: round trip with block size %zu (api %d)\n", sizes[i], api);
+                goto cleanup;
+            }
+            size_t off = sizes[i] - 100;
+            if (zxc_decompress_range(comp, c_sz, off, 5000, out, 1) != 5000 ||
+                memcmp(out, src + off, 5000) != 0) {
+                printf("Failed: range decode with block size %zu (api %d)\n", sizes[i], api);
+                goto cleanup;
+            }
+        }
+    }
+
+    // Invalid block sizes are rejected everywhere.
+    const size_t bad[] = {ZXC_BLOCK_SIZE_MIN - 4096, ZXC_BLOCK_SIZE_MAX + 4096, 100000};
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        zxc_compress_opts_t opts = {3, 0, 0, bad[i]};
+        if (zxc_compress_ex(src, src_size, comp, cap, &opts) != 0 ||
+            zxc_compress_mt_ex(src, src_size, comp, cap, 2, &opts) != 0 ||
+            zxc_compress_cctx(cctx, src, src_size, comp, cap, &opts) != 0) {
+            printf("Failed: invalid block size %zu accepted\n", bad[i]);
+            goto cleanup;
+        }
+    }
+
+    // Stream API: 64KB blocks written, block size read back by the decoder.
+    FILE* f_in = tmpfile();
+    FILE* f_c = tmpfile();
+    FILE* f_d = tmpfile();
+    if (!f_in || !f_c || !f_d) {
+        if (f_in) fclose(f_in);
+        if (f_c) fclose(f_c);
+        if (f_d) fclose(f_d);
+        goto cleanup;
+    }
+    fwrite(src, 1, src_size, f_in);
+    rewind(f_in);
+    zxc_compress_opts_t s_opts = {3, 1, 0, ZXC_BLOCK_SIZE_MIN};
+    int64_t c_sz = zxc_stream_compress_ex(f_in, f_c, 2, &s_opts);
+    rewind(f_c);
+    int64_t d_sz = (c_sz > 0) ? zxc_stream_decompress(f_c, f_d, 2, 1) : -1;
+    rewind(f_d);
+    size_t d_read = fread(out, 1, src_size, f_d);
+    fclose(f_in);
+    fclose(f_c);
+    fclose(f_d);
+    if (d_sz != (int64_t)src_size || d_read != src_size || memcmp(out, src, src_size) != 0) {
+        printf("Failed: stream round trip with 64KB blocks\n");
+        goto cleanup;
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+
+cleanup:
+    zxc_free_cctx(cctx);
+    free(src);
+    free(comp);
+    free(out);
+    return ok;
+}
+
+// Checks that a large block starting with an incompressible run longer than
+// the LZ window still finds the matches that follow it: the 4MB frame must be
+// no bigger than the one cut into 256KB blocks, where the noise stays RAW.
+int test_large_block_ratio() {
+    printf("=== TEST: Unit - Large Block After Incompressible Prefix ===\n");
+
+    const size_t noise = 2 * 1024 * 1024 + 100 * 1024;
+    size_t src_size = ZXC_BLOCK_SIZE_MAX;
+    uint8_t* src = malloc(src_size);
+    size_t cap = zxc_compress_bound(src_size);
+    uint8_t* comp = malloc(cap);
+    uint8_t* out = malloc(src_size);
+    int ok = 0;
+    if (!src || !comp || !out) goto cleanup;
+    gen_random_data(src, noise);
+    gen_lz_data(src + noise, src_size - noise);
+
+    for (int level = 1; level <= 5; level++) {
+        zxc_compress_opts_t small = {level, 0, 0, 256 * 1024};
+        zxc_compress_opts_t large = {level, 0, 0, ZXC_BLOCK_SIZE_MAX};
+        size_t ref_sz = zxc_compress_ex(src, src_size, comp, cap, &small);
+        size_t c_sz = zxc_compress_ex(src, src_size, comp, cap, &large);
+        if (ref_sz == 0 || c_sz == 0 || c_sz > ref_sz + ref_sz / 64) {
+            printf("Failed: level %d, 4MB block %zu bytes vs %zu with 256KB blocks\n", level,
+                   c_sz, ref_sz);
+            goto cleanup;
+        }
+        if (zxc_decompress(comp, c_sz, out, src_size, 0) != src_size ||
+            memcmp(out, src, src_size) != 0) {
+            printf("Failed: round trip at level %d\n", level);
+            goto cleanup;
+        }
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+
+cleanup:
+    free(src);
+    free(comp);
+    free(out);
+    return ok;
+}
+
+// Checks that decoding never writes past dst_capacity, even though the
+// decoders use wild copies: blocks that end on a long literal run or match
+// must be finished with exact copies (neighbouring blocks are decoded
+// concurrently by zxc_decompress_mt).
+int test_decompress_exact_capacity() {
+    printf("=== TEST: Unit - Decompress Into Exact Capacity ===\n");
+
+    const size_t max_size = 70000;
+    const size_t guard = 64;
+    uint8_t* src = malloc(max_size);
+    uint8_t* comp = malloc(zxc_compress_bound(max_size));
+    uint8_t* out = malloc(max_size + guard);
+    int ok = 0;
+    if (!src || !comp || !out) goto cleanup;
+
+    // Text with random islands: produces long literal runs next to long matches.
+    gen_lz_data(src, max_size);
+    for (size_t i = 0; i < max_size; i += 7919) gen_random_data(src + i, 300 + i % 500);
+
+    for (size_t size = 1000; size <= max_size; size += 997) {
+        for (int level = 1; level <= 5; level++) {
+            size_t c_sz = zxc_compress(src, size, comp, zxc_compress_bound(size), level, 0);
+            memset(out + size, 0xA5, guard);
+            if (c_sz == 0 || zxc_decompress(comp, c_sz, out, size, 0) != size ||
+                memcmp(out, src, size) != 0) {
+                printf("Failed: round trip, size %zu level %d\n", size, level);
+                goto cleanup;
+            }
+            for (size_t g = 0; g < guard; g++) {
+                if (out[size + g] != 0xA5) {
+                    printf("Failed: write past capacity, size %zu level %d\n", size, level);
+                    goto cleanup;
+                }
+            }
+        }
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+
+cleanup:
+    free(src);
+    free(comp);
+    free(out);
+    return ok;
+}
+
+// Stream input that is a regular file is mapped rather than read: check that
+// this honours the caller's starting offset, ends with the file positioned
+// after the consumed data, and copes with sizes on page boundaries.
+int test_stream_mapped_input() {
+    printf("=== TEST: Unit - Stream Mapped Input ===\n");
+
+    const size_t sizes[] = {1, 4096, 65536, 3 * 4096 + 17, 600000};
+    const char prefix[] = "not part of the stream";
+    const long prefix_len = (long)sizeof(prefix);
+    uint8_t* src = malloc(600000);
+    uint8_t* out = malloc(600000);
+    FILE* f_in = NULL;
+    FILE* f_comp = NULL;
+    FILE* f_out = NULL;
+    int ok = 0;
+    if (!src || !out) goto cleanup;
+    gen_lz_data(src, 600000);
+
+    for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+        size_t size = sizes[k];
+        f_in = tmpfile();
+        f_comp = tmpfile();
+        f_out = tmpfile();
+        if (!f_in || !f_comp || !f_out) goto cleanup;
+
+        fwrite(prefix, 1, sizeof(prefix), f_in);
+        fwrite(src, 1, size, f_in);
+        fseek(f_in, prefix_len, SEEK_SET);
+        fwrite(prefix, 1, sizeof(prefix), f_comp);
+
+        int64_t c_sz = zxc_stream_compress(f_in, f_comp, 2, 3, 1);
+        if (c_sz <= 0 || ftell(f_in) != prefix_len + (long)size) {
+            printf("Failed: compress size %zu (input at %ld)\n", size, ftell(f_in));
+            goto cleanup;
+        }
+
+        fseek(f_comp, prefix_len, SEEK_SET);
+        int64_t d_sz = zxc_stream_decompress(f_comp, f_out, 2, 1);
+        if (d_sz != (int64_t)size || ftell(f_comp) != prefix_len + (long)c_sz) {
+            printf("Failed: decompress size %zu (got %lld, input at %ld)\n", size,
+                   (long long)d_sz, ftell(f_comp));
+            goto cleanup;
+        }
+
+        rewind(f_out);
+        if (fread(out, 1, size, f_out) != size || memcmp(out, src, size) != 0) {
+            printf("Failed: content mismatch, size %zu\n", size);
+            goto cleanup;
+        }
+
+        fclose(f_in);
+        fclose(f_comp);
+        fclose(f_out);
+        f_in = f_comp = f_out = NULL;
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+
+cleanup:
+    if (f_in) fclose(f_in);
+    if (f_comp) fclose(f_comp);
+    if (f_out) fclose(f_out);
+    free(src);
+    free(out);
+    return ok;
+}
+
+// In-memory ends for the callback stream API.
+typedef struct {
+    const uint8_t* src;
+    size_t size, pos;
+    size_t max_read;  // Largest read served at once, to exercise short reads
+    int fail_read;    // Fail once this many bytes have been served (-1 = never)
+    uint8_t* dst;
+    size_t cap, len;
+    int writes;
+    int fail_write;  // Fail on this write call (-1 = never)
+} mem_io_t;
+
+static int64_t mem_read(void* opaque, void* buf, size_t len) {
+    mem_io_t* m = (mem_io_t*)opaque;
+    if (m->fail_read >= 0 && m->pos >= (size_t)m->fail_read) return -1;
+    size_t n = m->size - m->pos;
+    if (n > len) n = len;
+    if (n > m->max_read) n = m->max_read;
+    memcpy(buf, m->src + m->pos, n);
+    m->pos += n;
+    return (int64_t)n;
+}
+
+static int mem_write(void* opaque, const void* buf, size_t len) {
+    mem_io_t* m = (mem_io_t*)opaque;
+    if (m->writes++ == m->fail_write || m->len + len > m->cap) return -1;
+    memcpy(m->dst + m->len, buf, len);
+    m->len += len;
+    return 0;
+}
+
+// The callback variants run the same engine as the stdio ones: same frame,
+// whatever the read granularity, and callback failures surface as -1.
+int test_stream_callbacks() {
+    printf("=== TEST: Unit - Stream Callbacks ===\n");
+
+    const size_t size = 700000;
+    const size_t cap = zxc_compress_bound(size);
+    uint8_t* src = malloc(size);
+    uint8_t* comp = malloc(cap);
+    uint8_t* ref = malloc(cap);
+    uint8_t* out = malloc(size);
+    FILE* f_in = NULL;
+    FILE* f_comp = NULL;
+    int ok = 0;
+    if (!src || !comp || !ref || !out) goto cleanup;
+    gen_lz_data(src, size);
+    gen_random_data(src + 300000, 100000);
+
+    // Reference frame from the stdio API.
+    f_in = tmpfile();
+    f_comp = tmpfile();
+    if (!f_in || !f_comp) goto cleanup;
+    fwrite(src, 1, size, f_in);
+    rewind(f_in);
+    zxc_compress_opts_t opts = {.level = 3, .checksum_enabled = 1, .seekable = 1};
+    int64_t ref_sz = zxc_stream_compress_ex(f_in, f_comp, 3, &opts);
+    rewind(f_comp);
+    if (ref_sz <= 0 || fread(ref, 1, (size_t)ref_sz, f_comp) != (size_t)ref_sz) goto cleanup;
+
+    const size_t max_reads[] = {(size_t)-1, 4096, 7};
+    for (size_t k = 0; k < sizeof(max_reads) / sizeof(max_reads[0]); k++) {
+        mem_io_t c = {src, size, 0, max_reads[k], -1, comp, cap, 0, 0, -1};
+        int64_t c_sz = zxc_stream_compress_cb(mem_read, mem_write, &c, 3, &opts);
+        if (c_sz != ref_sz || c.len != (size_t)c_sz || memcmp(comp, ref, c.len) != 0) {
+            printf("Failed: compress with reads of %zu (%lld vs %lld)\n", max_reads[k],
+                   (long long)c_sz, (long long)ref_sz);
+            goto cleanup;
+        }
+
+        mem_io_t d = {comp, c.len, 0, max_reads[k], -1, out, size, 0, 0, -1};
+        int64_t d_sz = zxc_stream_decompress_cb(mem_read, mem_write, &d, 3, 1);
+        if (d_sz != (int64_t)size || d.len != size || memcmp(out, src, size) != 0) {
+            printf("Failed: decompress with reads of %zu (%lld)\n", max_reads[k],
+                   (long long)d_sz);
+            goto cleanup;
+        }
+    }
+
+    // No sink: the output is only measured.
+    mem_io_t m = {src, size, 0, (size_t)-1, -1, NULL, 0, 0, 0, -1};
+    if (zxc_stream_compress_cb(mem_read, NULL, &m, 2, &opts) != ref_sz) {
+        printf("Failed: compress without sink\n");
+        goto cleanup;
+    }
+    m = (mem_io_t){ref, (size_t)ref_sz, 0, (size_t)-1, -1, NULL, 0, 0, 0, -1};
+    if (zxc_stream_decompress_cb(mem_read, NULL, &m, 2, 1) != (int64_t)size) {
+        printf("Failed: decompress without sink\n");
+        goto cleanup;
+    }
+
+    // Failing callbacks, at the header and in the middle of the stream.
+    for (int k = 0; k < 2; k++) {
+        int at = k * (int)size / 3;
+        m = (mem_io_t){src, size, 0, (size_t)-1, at, comp, cap, 0, 0, -1};
+        if (zxc_stream_compress_cb(mem_read, mem_write, &m, 2, &opts) != -1) {
+            printf("Failed: read error at %d not reported (compress)\n", at);
+            goto cleanup;
+        }
+        at = k * (int)ref_sz / 2;
+        m = (mem_io_t){ref, (size_t)ref_sz, 0, (size_t)-1, at, out, size, 0, 0, -1};
+        if (zxc_stream_decompress_cb(mem_read, mem_write, &m, 2, 1) != -1) {
+            printf("Failed: read error at %d not reported (decompress)\n", at);
+            goto cleanup;
+        }
+    }
+    for (int w = 0; w < 3; w++) {
+        m = (mem_io_t){src, size, 0, (size_t)-1, -1, comp, cap, 0, 0, w};
+        if (zxc_stream_compress_cb(mem_read, mem_write, &m, 2, &opts) != -1) {
+            printf("Failed: write error on call %d not reported\n", w);
+            goto cleanup;
+        }
+    }
+    if (zxc_stream_compress_cb(NULL, mem_write, &m, 2, &opts) != -1 ||
+        zxc_stream_decompress_cb(NULL, mem_write, &m, 2, 1) != -1) {
+        printf("Failed: NULL read callback accepted\n");
+        goto cleanup;
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+
+cleanup:
+    if (f_in) fclose(f_in);
+    if (f_comp) fclose(f_comp);
+    free(src);
+    free(comp);
+    free(ref);
+    free(out);
+    return ok;
+}
+
+// The engine flags only change how blocks reach the file: io_uring or stdio,
+// pinned workers or not, the frame must be the same and the stream must be
+// left right after it, behind whatever the caller wrote first.
+int test_stream_engine_flags() {
+    printf("=== TEST: Unit - Stream Engine Flags ===\n");
+
+    const size_t size = 1500000;
+    const char prefix[] = "caller data";
+    const unsigned flags[] = {0, ZXC_STREAM_NO_URING, ZXC_STREAM_PIN_THREADS};
+    uint8_t* src = malloc(size);
+    uint8_t* ref = malloc(zxc_compress_bound(size));
+    uint8_t* got = malloc(zxc_compress_bound(size));
+    FILE* f_in = NULL;
+    FILE* f_out = NULL;
+    int64_t ref_sz = -1;
+    int ok = 0;
+    if (!src || !ref || !got) goto cleanup;
+    gen_lz_data(src, size);
+    gen_random_data(src + size / 2, size / 4);
+
+    f_in = tmpfile();
+    if (!f_in) goto cleanup;
+    fwrite(src, 1, size, f_in);
+
+    for (int seekable = 0; seekable <= 1; seekable++) {
+        for (size_t k = 0; k < sizeof(flags) / sizeof(flags[0]); k++) {
+            zxc_stream_set_flags(flags[k]);
+            zxc_compress_opts_t opts = {.level = 2, .checksum_enabled = 1, .seekable = seekable};
+            f_out = tmpfile();
+            if (!f_out) goto cleanup;
+            fwrite(prefix, 1, sizeof(prefix), f_out);
+            rewind(f_in);
+            int64_t c_sz = zxc_stream_compress_ex(f_in, f_out, 3, &opts);
+            long end = ftell(f_out);
+            fputc('!', f_out);  // Caller keeps writing after the frame
+            fseek(f_out, (long)sizeof(prefix), SEEK_SET);
+            if (c_sz <= 0 || end != (long)sizeof(prefix) + c_sz ||
+                fread(got, 1, (size_t)c_sz, f_out) != (size_t)c_sz || fgetc(f_out) != '!') {
+                printf("Failed: flags %u, seekable %d (size %lld, end %ld)\n", flags[k], seekable,
+                       (long long)c_sz, end);
+                goto cleanup;
+            }
+            if (k == 0) {
+                ref_sz = c_sz;
+                memcpy(ref, got, (size_t)c_sz);
+            } else if (c_sz != ref_sz || memcmp(got, ref, (size_t)c_sz) != 0) {
+                printf("Failed: flags %u change the frame (seekable %d)\n", flags[k], seekable);
+                goto cleanup;
+            }
+            fclose(f_out);
+            f_out = NULL;
+        }
+        if (zxc_decompress(ref, (size_t)ref_sz, got, size, 1) != size ||
+            memcmp(got, src, size) != 0) {
+            printf("Failed: frame does not decode (seekable %d)\n", seekable);
+            goto cleanup;
+        }
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+
+cleanup:
+    zxc_stream_set_flags(0);
+    if (f_in) fclose(f_in);
+    if (f_out) fclose(f_out);
+    free(src);
+    free(ref);
+    free(got);
+    return ok;
+}
+
+// Several threads share one pool: every call must produce the frame of the
+// equivalent n_threads call, whatever else runs on the pool at the time.
+typedef struct {
+    zxc_pool_t* pool;
+    const uint8_t* src;
+    size_t size;
+    const uint8_t* ref[2];  // Buffer and stream frame of the caller's level
+    size_t ref_sz[2];
+    const zxc_block_stats_t* ref_stats;
+    int level;
+    int failed;
+} pool_caller_t;
+
+static void* pool_caller(void* arg) {
+    pool_caller_t* c = (pool_caller_t*)arg;
+    const size_t cap = zxc_compress_bound(c->size);
+    uint8_t* comp = malloc(cap);
+    uint8_t* out = malloc(c->size);
+    c->failed = 1;
+    if (!comp || !out) goto done;
+
+    for (int iter = 0; iter < 3; iter++) {
+        zxc_block_stats_t stats = {0};
+        zxc_compress_opts_t opts = {
+            .level = c->level, .checksum_enabled = 1, .block_stats = &stats};
+        size_t c_sz = zxc_compress_pool(c->pool, c->src, c->size, comp, cap, &opts);
+        if (c_sz != c->ref_sz[0] || memcmp(comp, c->ref[0], c_sz) != 0 ||
+            memcmp(&stats, c->ref_stats, sizeof(stats)) != 0)
+            goto done;
+        if (zxc_decompress_pool(c->pool, comp, c_sz, out, c->size, 1) != c->size ||
+            memcmp(out, c->src, c->size) != 0)
+            goto done;
+
+        mem_io_t io = {c->src, c->size, 0, 100000, -1, comp, cap, 0, 0, -1};
+        int64_t s_sz = zxc_stream_compress_cb_pool(c->pool, mem_read, mem_write, &io, &opts);
+        if (s_sz != (int64_t)c->ref_sz[1] || memcmp(comp, c->ref[1], (size_t)s_sz) != 0) goto done;
+        mem_io_t back = {comp, (size_t)s_sz, 0, 70000, -1, out, c->size, 0, 0, -1};
+        if (zxc_stream_decompress_cb_pool(c->pool, mem_read, mem_write, &back, 1) !=
+                (int64_t)c->size ||
+            memcmp(out, c->src, c->size) != 0)
+            goto done;
+    }
+    c->failed = 0;
+
+done:
+    free(comp);
+    free(out);
+    return NULL;
+}
+
+int test_thread_pool() {
+    printf("=== TEST: Unit - Shared Thread Pool ===\n");
+
+    enum { N_CALLERS = 4 };
+    const size_t size = 2 * 1024 * 1024 + 4321;
+    const size_t cap = zxc_compress_bound(size);
+    uint8_t* src = malloc(size);
+    uint8_t* refs[N_CALLERS][2] = {{NULL}};
+    zxc_block_stats_t ref_stats[N_CALLERS];
+    pool_caller_t callers[N_CALLERS];
+    uint8_t* comp = malloc(cap);
+    uint8_t* out = malloc(size);
+    zxc_pool_t* pool = zxc_pool_create(3);
+    FILE* f_in = NULL;
+    FILE* f_c = NULL;
+    FILE* f_out = NULL;
+    int ok = 0;
+    if (!src || !comp || !out || !pool || zxc_pool_size(pool) != 3) goto cleanup;
+    gen_lz_data(src, size);
+    for (size_t i = 0; i + 70000 < size; i += 300007) gen_random_data(src + i, 70000);
+
+    // References from the per-call threads, one level per caller.
+    for (int k = 0; k < N_CALLERS; k++) {
+        refs[k][0] = malloc(cap);
+        refs[k][1] = malloc(cap);
+        if (!refs[k][0] || !refs[k][1]) goto cleanup;
+        ZXC_MEMSET(&ref_stats[k], 0, sizeof(ref_stats[k]));
+        zxc_compress_opts_t opts = {
+            .level = 1 + k, .checksum_enabled = 1, .block_stats = &ref_stats[k]};
+        mem_io_t io = {src, size, 0, size, -1, refs[k][1], cap, 0, 0, -1};
+        callers[k].pool = pool;
+        callers[k].src = src;
+        callers[k].size = size;
+        callers[k].level = 1 + k;
+        callers[k].ref[0] = refs[k][0];
+        callers[k].ref[1] = refs[k][1];
+        callers[k].ref_sz[0] = zxc_compress_mt_ex(src, size, refs[k][0], cap, 2, &opts);
+        opts.block_stats = NULL;
+        callers[k].ref_sz[1] = (size_t)zxc_stream_compress_cb(mem_read, mem_write, &io, 2, &opts);
+        callers[k].ref_stats = &ref_stats[k];
+        callers[k].failed = 1;
+        if (callers[k].ref_sz[0] == 0 || io.len != callers[k].ref_sz[1]) goto cleanup;
+    }
+
+#ifndef _WIN32
+    pthread_t th[N_CALLERS];
+    int started = 0;
+    for (; started < N_CALLERS; started++)
+        if (pthread_create(&th[started], NULL, pool_caller, &callers[started]) != 0) break;
+    for (int k = 0; k < started; k++) pthread_join(th[k], NULL);
+#else
+    for (int k = 0; k < N_CALLERS; k++) pool_caller(&callers[k]);
+#endif
+    for (int k = 0; k < N_CALLERS; k++) {
+        if (callers[k].failed) {
+            printf("Failed: concurrent caller %d (level %d)\n", k, callers[k].level);
+            goto cleanup;
+        }
+    }
+
+    // File streams, seekable: positional decompression runs on the pool too.
+    zxc_compress_opts_t opts = {.level = 3, .checksum_enabled = 1, .seekable = 1};
+    f_in = tmpfile();
+    f_c = tmpfile();
+    f_out = tmpfile();
+    if (!f_in || !f_c || !f_out) goto cleanup;
+    fwrite(src, 1, size, f_in);
+    rewind(f_in);
+    int64_t c_sz = zxc_stream_compress_pool(pool, f_in, f_c, &opts);
+    size_t ref_sz = zxc_compress_mt_ex(src, size, out, size, 2, &opts);
+    rewind(f_c);
+    if (c_sz <= 0 || ref_sz == 0 || fread(comp, 1, (size_t)c_sz, f_c) != (size_t)c_sz ||
+        zxc_decompress(comp, (size_t)c_sz, out, size, 1) != size || memcmp(out, src, size) != 0) {
+        printf("Failed: file stream compression (size %lld)\n", (long long)c_sz);
+        goto cleanup;
+    }
+    rewind(f_c);
+    if (zxc_stream_decompress_pool(pool, f_c, f_out, 1) != (int64_t)size) {
+        printf("Failed: file stream decompression\n");
+        goto cleanup;
+    }
+    rewind(f_out);
+    if (fread(out, 1, size, f_out) != size || memcmp(out, src, size) != 0) {
+        printf("Failed: file stream round trip\n");
+        goto cleanup;
+    }
+
+    // A damaged frame fails without breaking the pool for the next call.
+    size_t b_sz = zxc_compress_pool(pool, src, size, comp, cap, &opts);
+    comp[b_sz / 2] ^= 0x5A;
+    if (b_sz == 0 || zxc_decompress_pool(pool, comp, b_sz, out, size, 1) != 0) {
+        printf("Failed: damaged frame accepted\n");
+        goto cleanup;
+    }
+    comp[b_sz / 2] ^= 0x5A;
+    if (zxc_decompress_pool(pool, comp, b_sz, out, size, 1) != size ||
+        memcmp(out, src, size) != 0) {
+        printf("Failed: pool unusable after an error\n");
+        goto cleanup;
+    }
+    if (zxc_compress_pool(NULL, src, size, comp, cap, &opts) != 0 ||
+        zxc_stream_compress_pool(NULL, f_in, f_c, &opts) != -1) {
+        printf("Failed: NULL pool accepted\n");
+        goto cleanup;
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+
+cleanup:
+    zxc_pool_free(pool);
+    for (int k = 0; k < N_CALLERS; k++) {
+        free(refs[k][0]);
+        free(refs[k][1]);
+    }
+    if (f_in) fclose(f_in);
+    if (f_c) fclose(f_c);
+    if (f_out) fclose(f_out);
+    free(src);
+    free(comp);
+    free(out);
+    return ok;
+}
+
+// A batch mixing split inputs, whole small inputs and failing ones: every
+// frame matches zxc_compress_ex(), failures stay local and the counters add
+// up, with a pool and on the calling thread alone.
+int test_compress_batch() {
+    printf("=== TEST: Unit - Batch Compression ===\n");
+
+    enum { N = 48 };
+    const size_t sizes[6] = {3000, 100 * 1024, 3 * 1024 * 1024 + 17, 0, 200 * 1024, 1};
+    zxc_buf_t in[N], out[N];
+    uint8_t* refs[N] = {NULL};
+    size_t ref_sz[N];
+    zxc_block_stats_t ref_stats, stats;
+    zxc_pool_t* pool = zxc_pool_create(2);
+    int ok = 0;
+    ZXC_MEMSET(in, 0, sizeof(in));
+    ZXC_MEMSET(out, 0, sizeof(out));
+    ZXC_MEMSET(&ref_stats, 0, sizeof(ref_stats));
+    if (!pool) goto cleanup;
+
+    zxc_compress_opts_t opts = {.level = 2, .checksum_enabled = 1, .block_stats = &ref_stats};
+    for (int i = 0; i < N; i++) {
+        size_t size = i < 6 ? sizes[i] : 200 + (size_t)i * 37;
+        size_t cap = zxc_compress_bound(size);
+        in[i].data = malloc(size + 1);
+        out[i].data = malloc(cap);
+        refs[i] = malloc(cap);
+        if (!in[i].data || !out[i].data || !refs[i]) goto cleanup;
+        gen_lz_data(in[i].data, size);
+        if (i == 2) gen_random_data((uint8_t*)in[i].data + size / 2, 100000);
+        in[i].size = size;
+        out[i].capacity = i == 4 ? 100 : cap;
+        ref_sz[i] = zxc_compress_ex(in[i].data, size, refs[i], out[i].capacity, &opts);
+    }
+    if (ref_sz[3] != 0 || ref_sz[4] != 0) goto cleanup;
+
+    for (int pass = 0; pass < 2; pass++) {
+        zxc_pool_t* p = pass == 0 ? pool : NULL;
+        ZXC_MEMSET(&stats, 0, sizeof(stats));
+        opts.block_stats = &stats;
+        size_t done = zxc_compress_batch(p, in, out, N, &opts);
+        if (done != N - 2) {
+            printf("Failed: %zu inputs compressed (pool %d)\n", done, pass == 0);
+            goto cleanup;
+        }
+        for (int i = 0; i < N; i++) {
+            if (out[i].size != ref_sz[i] ||
+                (ref_sz[i] && memcmp(out[i].data, refs[i], ref_sz[i]) != 0)) {
+                printf("Failed: frame %d differs (pool %d)\n", i, pass == 0);
+                goto cleanup;
+            }
+        }
+        if (memcmp(&stats, &ref_stats, sizeof(stats)) != 0) {
+            printf("Failed: batch counters (pool %d)\n", pass == 0);
+            goto cleanup;
+        }
+    }
+    if (zxc_compress_batch(pool, NULL, out, N, &opts) != 0 ||
+        zxc_compress_batch(pool, in, out, 0, &opts) != 0) {
+        printf("Failed: invalid batch accepted\n");
+        goto cleanup;
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+
+cleanup:
+    zxc_pool_free(pool);
+    for (int i = 0; i < N; i++) {
+        free(in[i].data);
+        free(out[i].data);
+        free(refs[i]);
+    }
+    return ok;
+}
+
+// Sums the uncompressed and the in-frame bytes of every block type.
+static void perf_block_bytes(const zxc_perf_stats_t* p, uint64_t* raw, uint64_t* comp) {
+    const zxc_block_stats_t* b = &p->blocks;
+    *raw = b->raw_bytes + b->glo_bytes + b->ghi_bytes + b->num_bytes;
+    *comp = b->raw_comp_bytes + b->glo_comp_bytes + b->ghi_comp_bytes + b->num_comp_bytes;
+}
+
+typedef struct {
+    int begins;
+    int ends;
+    uint64_t bytes_in;
+} trace_log_t;
+
+static void trace_cb(void* opaque, const char* call, int end, const zxc_perf_stats_t* stats) {
+    trace_log_t* log = (trace_log_t*)opaque;
+    if (strcmp(call, "compress_mt") != 0) return;
+    if (end) {
+        log->ends++;
+        log->bytes_in += stats ? stats->bytes_in : 0;
+    } else {
+        log->begins++;
+    }
+}
+
+int test_perf_stats() {
+    printf("=== TEST: Unit - Performance Counters (zxc_perf_capture) ===\n");
+
+    const size_t size = 3 * 1024 * 1024 + 321;
+    const size_t cap = zxc_compress_bound(size);
+    uint8_t* src = malloc(size);
+    uint8_t* comp = malloc(cap);
+    uint8_t* out = malloc(size);
+    FILE* f_raw = tmpfile();
+    FILE* f_comp = tmpfile();
+    zxc_perf_stats_t p;
+    uint64_t raw, in_frame;
+    int ok = 0;
+    if (!src || !comp || !out || !f_raw || !f_comp) goto cleanup;
+    gen_lz_data(src, size);
+    gen_random_data(src + size / 2, 300000);
+
+    // Buffer call: one call, every block accounted for, checksums inside the work.
+    zxc_compress_opts_t opts = {.level = 3, .checksum_enabled = 1, .block_size = 256 * 1024};
+    ZXC_MEMSET(&p, 0, sizeof(p));
+    zxc_perf_capture(&p);
+    size_t c_sz = zxc_compress_ex(src, size, comp, cap, &opts);
+    zxc_perf_capture(NULL);
+    perf_block_bytes(&p, &raw, &in_frame);
+    if (c_sz == 0 || p.calls != 1 || p.bytes_in != size || p.bytes_out != c_sz || raw != size ||
+        in_frame >= c_sz || p.blocks.raw_blocks == 0 || p.wall_ns == 0 ||
+        p.work_ns > p.wall_ns || p.checksum_ns == 0 || p.checksum_ns > p.work_ns) {
+        printf("Failed: buffer compression counters\n");
+        goto cleanup;
+    }
+    printf("  [PASS] Buffer call\n");
+
+    // Nothing is collected once the capture is stopped.
+    if (zxc_decompress(comp, c_sz, out, size, 1) != size || p.calls != 1) {
+        printf("Failed: counters collected after capture stopped\n");
+        goto cleanup;
+    }
+
+    // Parallel call: worker times add up; a call nested in another counts once.
+    ZXC_MEMSET(&p, 0, sizeof(p));
+    zxc_perf_capture(&p);
+    size_t d_sz = zxc_decompress_mt(comp, c_sz, out, size, 2, 1);
+    size_t small = zxc_compress_mt_ex(src, 1000, comp + c_sz, cap - c_sz, 4, &opts);
+    zxc_perf_capture(NULL);
+    perf_block_bytes(&p, &raw, &in_frame);
+    if (d_sz != size || small == 0 || memcmp(out, src, size) != 0 || p.calls != 2 ||
+        p.bytes_in != c_sz + 1000 || p.bytes_out != size + small || raw != size + 1000 ||
+        p.work_ns == 0 || p.checksum_ns == 0) {
+        printf("Failed: parallel call counters\n");
+        goto cleanup;
+    }
+    printf("  [PASS] Parallel call\n");
+
+    // Stream calls: reading, writing and the pipeline waits are timed.
+    if (fwrite(src, 1, size, f_raw) != size) goto cleanup;
+    rewind(f_raw);
+    ZXC_MEMSET(&p, 0, sizeof(p));
+    zxc_perf_capture(&p);
+    int64_t s_sz = zxc_stream_compress_ex(f_raw, f_comp, 2, &opts);
+    zxc_perf_capture(NULL);
+    perf_block_bytes(&p, &raw, &in_frame);
+    if (s_sz <= 0 || p.calls != 1 || p.bytes_in != size || p.bytes_out != (uint64_t)s_sz ||
+        raw != size || in_frame >= (uint64_t)s_sz || p.read_ns == 0 || p.write_ns == 0 ||
+        p.work_ns == 0 || p.checksum_ns == 0) {
+        printf("Failed: stream compression counters\n");
+        goto cleanup;
+    }
+    rewind(f_comp);
+    ZXC_MEMSET(&p, 0, sizeof(p));
+    zxc_perf_capture(&p);
+    int64_t r_sz = zxc_stream_decompress(f_comp, NULL, 2, 1);
+    zxc_perf_capture(NULL);
+    perf_block_bytes(&p, &raw, &in_frame);
+    if (r_sz != (int64_t)size || p.calls != 1 || p.bytes_in != (uint64_t)s_sz ||
+        p.bytes_out != size || raw != size || p.work_ns == 0) {
+        printf("Failed: stream decompression counters\n");
+        goto cleanup;
+    }
+    printf("  [PASS] Stream calls\n");
+
+    // Trace hook: one begin and one end per top-level call, never per block.
+    trace_log_t log = {0, 0, 0};
+    if (zxc_set_trace_hook(trace_cb, &log) == 0) {
+        int hooked = zxc_compress_mt_ex(src, size, comp, cap, 2, &opts) > 0;
+        zxc_set_trace_hook(NULL, NULL);
+        if (!hooked || log.begins != 1 || log.ends != 1 || log.bytes_in != size) {
+            printf("Failed: trace hook events\n");
+            goto cleanup;
+        }
+        printf("  [PASS] Trace hook\n");
+    } else {
+        printf("  [SKIP] Trace hook (built without ZXC_ENABLE_TRACING)\n");
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+cleanup:
+    zxc_perf_capture(NULL);
+    if (f_raw) fclose(f_raw);
+    if (f_comp) fclose(f_comp);
+    free(src);
+    free(comp);
+    free(out);
+    return ok;
+}
+
+// Decompressing a mapped file into a regular file (or into nothing) goes
+// through positional writes driven by the seek table or a header walk: check
+// both, with an output that does not start at offset 0, and that a damaged
+// seek table or payload is handled.
+int test_stream_positional_decompress() {
+    printf("=== TEST: Unit - Stream Positional Decompress ===\n");
+
+    const size_t size = 3 * 1024 * 1024 + 12345;
+    const char prefix[] = "header kept as is";
+    const long prefix_len = (long)sizeof(prefix);
+    uint8_t* src = malloc(size);
+    uint8_t* out = malloc(size);
+    uint8_t* comp = malloc(zxc_compress_bound(size) + 4096);
+    FILE* f_in = NULL;
+    FILE* f_c = NULL;
+    FILE* f_out = NULL;
+    int ok = 0;
+    if (!src || !out || !comp) goto cleanup;
+    gen_lz_data(src, size);
+    for (size_t i = 0; i < size; i += 100003) gen_random_data(src + i, 2000);
+
+    for (int seekable = 0; seekable <= 1; seekable++) {
+        f_in = tmpfile();
+        f_c = tmpfile();
+        if (!f_in || !f_c) goto cleanup;
+        fwrite(src, 1, size, f_in);
+        rewind(f_in);
+        zxc_compress_opts_t opts = {2, 1, seekable, ZXC_BLOCK_SIZE_MIN};
+        int64_t c_sz = zxc_stream_compress_ex(f_in, f_c, 2, &opts);
+        if (c_sz <= 0) {
+            printf("Failed: compress (seekable %d)\n", seekable);
+            goto cleanup;
+        }
+        rewind(f_c);
+        if (fread(comp, 1, (size_t)c_sz, f_c) != (size_t)c_sz) goto cleanup;
+
+        for (int threads = 1; threads <= 4; threads += 3) {
+            f_out = tmpfile();
+            if (!f_out) goto cleanup;
+            fwrite(prefix, 1, sizeof(prefix), f_out);
+            rewind(f_c);
+            int64_t d_sz = zxc_stream_decompress(f_c, f_out, threads, 1);
+            if (d_sz != (int64_t)size || ftell(f_out) != prefix_len + (long)size ||
+                ftell(f_c) != (long)c_sz) {
+                printf("Failed: decompress (seekable %d, %d threads) returned %lld\n", seekable,
+                       threads, (long long)d_sz);
+                goto cleanup;
+            }
+            fseek(f_out, prefix_len, SEEK_SET);
+            if (fread(out, 1, size, f_out) != size || memcmp(out, src, size) != 0) {
+                printf("Failed: content (seekable %d, %d threads)\n", seekable, threads);
+                goto cleanup;
+            }
+            fclose(f_out);
+            f_out = NULL;
+        }
+
+        rewind(f_c);
+        if (zxc_stream_decompress(f_c, NULL, 4, 1) != (int64_t)size) {
+            printf("Failed: decompress without output (seekable %d)\n", seekable);
+            goto cleanup;
+        }
+
+        if (seekable) {
+            // Second entry's raw offset pointing past its block: the table is
+            // rejected and the headers are walked instead.
+            uint8_t* entry = comp + c_sz - ZXC_SEEK_TRAILER_SIZE -
+                             (size_t)zxc_le32(comp + c_sz - ZXC_SEEK_TRAILER_SIZE) *
+                                 ZXC_SEEK_ENTRY_SIZE +
+                             ZXC_SEEK_ENTRY_SIZE;
+            zxc_store_le64(entry + 8, zxc_le64(entry + 8) + 1000000);
+            fseek(f_c, (long)(entry - comp), SEEK_SET);
+            fwrite(entry, 1, ZXC_SEEK_ENTRY_SIZE, f_c);
+            rewind(f_c);
+            f_out = tmpfile();
+            if (!f_out) goto cleanup;
+            int64_t d_sz = zxc_stream_decompress(f_c, f_out, 4, 1);
+            rewind(f_out);
+            if (d_sz != (int64_t)size || fread(out, 1, size, f_out) != size ||
+                memcmp(out, src, size) != 0) {
+                printf("Failed: damaged seek table\n");
+                goto cleanup;
+            }
+            fclose(f_out);
+            f_out = NULL;
+        }
+
+        // Flip a payload byte in the middle: the checksum must catch it.
+        uint8_t byte = comp[c_sz / 2] ^ 0x40;
+        fseek(f_c, (long)(c_sz / 2), SEEK_SET);
+        fwrite(&byte, 1, 1, f_c);
+        rewind(f_c);
+        if (zxc_stream_decompress(f_c, NULL, 4, 1) != -1) {
+            printf("Failed: corruption not detected (seekable %d)\n", seekable);
+            goto cleanup;
+        }
+
+        fclose(f_in);
+        fclose(f_c);
+        f_in = f_c = NULL;
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+
+cleanup:
+    if (f_in) fclose(f_in);
+    if (f_c) fclose(f_c);
+    if (f_out) fclose(f_out);
+    free(src);
+    free(out);
+    free(comp);
+    return ok;
+}
+
+// Generates a JSON-like event record: shared field names, varying values.
+static size_t gen_json_record(char* buf, size_t cap, unsigned id) {
+    static const char* const kinds[] = {"click", "view", "purchase", "scroll"};
+    static const char* const regions[] = {"eu-west-1", "us-east-2", "ap-south-1"};
+    int n = snprintf(buf, cap,
+                     "{\"event_id\":%u,\"timestamp\":\"2026-03-%02u T12:%02u:%02u.%03uZ\","
+                     "\"type\":\"%s\",\"user\":{\"id\":%u,\"region\":\"%s\",\"premium\":%s},"
+                     "\"session_duration_ms\":%u,\"client\":\"zxc-test-agent/1.0\"}",
+                     id * 7919u, 1 + id % 28, id % 60, (id * 13) % 60, (id * 37) % 1000,
+                     kinds[id % 4], (id * 2654435761u) % 1000000, regions[id % 3],
+                     (id % 5) ? "false" : "true", (id * 104729u) % 90000);
+    return (size_t)n;
+}
+
+// Checks that trained and preset dictionaries improve small records, round-trip,
+// and that frames needing a dictionary fail cleanly without the right one.
+int test_dictionary() {
+    printf("=== TEST: Unit - Dictionary Compression (zxc_compress_dict/zxc_decompress_dict) ===\n");
+
+    const unsigned n_train = 1000, n_test = 500;
+    const size_t rec_cap = 512, big_size = 300 * 1024;
+    char* samples = malloc((size_t)n_train * rec_cap);
+    size_t* sizes = malloc(n_train * sizeof(size_t));
+    uint8_t* dict_buf = malloc(16 * 1024);
+    uint8_t* comp = malloc(zxc_compress_bound(big_size));
+    uint8_t* out = malloc(big_size);
+    uint8_t* big = malloc(big_size);
+    zxc_cctx* cctx = zxc_create_cctx();
+    zxc_dctx* dctx = zxc_create_dctx();
+    zxc_dict* dict = NULL;
+    zxc_dict* other = NULL;
+    int ok = 0;
+    if (!samples || !sizes || !dict_buf || !comp || !out || !big || !cctx || !dctx) goto cleanup;
+
+    size_t total = 0;
+    for (unsigned i = 0; i < n_train; i++) {
+        sizes[i] = gen_json_record(samples + total, rec_cap, i);
+        total += sizes[i];
+    }
+    size_t dict_size = zxc_train_dictionary(dict_buf, 16 * 1024, samples, sizes, n_train);
+    dict = zxc_create_dict(dict_buf, dict_size);
+    other = zxc_create_dict(samples, 4096);  // Preset dictionary: raw records
+    if (dict_size == 0 || dict_size > 16 * 1024 || !dict || !other ||
+        zxc_get_dict_id(dict) == 0 || zxc_get_dict_id(dict) == zxc_get_dict_id(other)) {
+        printf("Failed: dictionary training/creation (size %zu)\n", dict_size);
+        goto cleanup;
+    }
+
+    // Unseen records: the trained dictionary must shrink them considerably.
+    const int levels[] = {1, 3, 5, 8};
+    for (size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+        size_t plain_total = 0, dict_total = 0;
+        zxc_compress_opts_t opts = {levels[l], 1, 0, 0};
+        for (unsigned i = 0; i < n_test; i++) {
+            char rec[512];
+            size_t sz = gen_json_record(rec, sizeof(rec), n_train + i);
+            size_t cap = zxc_compress_bound(sz);
+            size_t p_sz = zxc_compress_cctx(cctx, rec, sz, comp, cap, &opts);
+            size_t d_sz = zxc_compress_dict(cctx, rec, sz, comp, cap, &opts, dict);
+            if (p_sz == 0 || d_sz == 0 ||
+                zxc_get_frame_dict_id(comp, d_sz) != zxc_get_dict_id(dict)) {
+                printf("Failed: compression of record %u (level %d)\n", i, levels[l]);
+                goto cleanup;
+            }
+            if (zxc_decompress_dict(dctx, comp, d_sz, out, sz, 1, dict) != sz ||
+                memcmp(out, rec, sz) != 0) {
+                printf("Failed: dictionary round trip of record %u (level %d)\n", i, levels[l]);
+                goto cleanup;
+            }
+            plain_total += p_sz;
+            dict_total += d_sz;
+        }
+        printf("  level %d: %zu -> %zu bytes with dictionary\n", levels[l], plain_total,
+               dict_total);
+        if (dict_total * 10 > plain_total * 7) {
+            printf("Failed: dictionary does not help (level %d)\n", levels[l]);
+            goto cleanup;
+        }
+    }
+
+    // Multi-block input and a preset dictionary.
+    gen_lz_data(big, big_size);
+    memcpy(big, samples, 2000);
+    zxc_compress_opts_t opts = {3, 1, 1, 64 * 1024};
+    size_t c_sz = zxc_compress_dict(cctx, big, big_size, comp, zxc_compress_bound(big_size), &opts,
+                                    other);
+    if (c_sz == 0 || zxc_decompress_dict(dctx, comp, c_sz, out, big_size, 1, other) != big_size ||
+        memcmp(out, big, big_size) != 0) {
+        printf("Failed: multi-block dictionary round trip\n");
+        goto cleanup;
+    }
+
+    // Missing or wrong dictionary: every decoder refuses the frame.
+    if (zxc_decompress(comp, c_sz, out, big_size, 1) != 0 ||
+        zxc_decompress_dict(dctx, comp, c_sz, out, big_size, 1, NULL) != 0 ||
+        zxc_decompress_dict(dctx, comp, c_sz, out, big_size, 1, dict) != 0 ||
+        zxc_decompress_mt(comp, c_sz, out, big_size, 2, 1) != 0 ||
+        zxc_decompress_range(comp, c_sz, 0, 100, out, 1) != 0) {
+        printf("Failed: dictionary frame decoded without its dictionary\n");
+        goto cleanup;
+    }
+
+    // Frames without a dictionary ignore the one passed in.
+    c_sz = zxc_compress_cctx(cctx, big, big_size, comp, zxc_compress_bound(big_size), &opts);
+    if (zxc_get_frame_dict_id(comp, c_sz) != 0 ||
+        zxc_decompress_dict(dctx, comp, c_sz, out, big_size, 1, dict) != big_size ||
+        memcmp(out, big, big_size) != 0) {
+        printf("Failed: plain frame through zxc_decompress_dict\n");
+        goto cleanup;
+    }
+
+    if (zxc_create_dict(NULL, 10) != NULL ||
+        zxc_train_dictionary(dict_buf, 16, NULL, sizes, 1) != 0) {
+        printf("Failed: invalid dictionary arguments should fail\n");
+        goto cleanup;
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+
+cleanup:
+    zxc_free_dict(dict);
+    zxc_free_dict(other);
+    zxc_free_cctx(cctx);
+    zxc_free_dctx(dctx);
+    free(samples);
+    free(sizes);
+    free(dict_buf);
+    free(comp);
+    free(out);
+    free(big);
+    return ok;
+}
+
+// Checks that linked blocks reach into the previous block, round-trip through
+// every decoder, and that the mode is refused where blocks must be independent.
+int test_linked_blocks() {
+    printf("=== TEST: Unit - Linked Blocks (zxc_compress_opts_t::linked) ===\n");
+
+    // A 50000-byte pattern repeated: 64 KB blocks only see most repeats across
+    // a block boundary.
+    const size_t size = 1024 * 1024 + 777, period = 50000;
+    const size_t cap = zxc_compress_bound(size);
+    uint8_t* src = malloc(size);
+    uint8_t* comp = malloc(cap);
+    uint8_t* comp2 = malloc(cap);
+    uint8_t* out = malloc(size);
+    FILE* f_in = NULL;
+    FILE* f_c = NULL;
+    FILE* f_out = NULL;
+    int ok = 0;
+    if (!src || !comp || !comp2 || !out) goto cleanup;
+    gen_random_data(src, period);
+    for (size_t i = period; i < size; i++) src[i] = src[i - period];
+
+    const int levels[] = {1, 3, 5, 8};
+    for (size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+        zxc_compress_opts_t opts = {levels[l], 1, 0, ZXC_BLOCK_SIZE_MIN, 0};
+        size_t plain = zxc_compress_ex(src, size, comp, cap, &opts);
+        opts.linked = 1;
+        size_t c_sz = zxc_compress_ex(src, size, comp, cap, &opts);
+        printf("  level %d: %zu -> %zu bytes linked\n", levels[l], plain, c_sz);
+        if (plain == 0 || c_sz == 0 || c_sz * 4 > plain) {
+            printf("Failed: linked blocks do not help (level %d)\n", levels[l]);
+            goto cleanup;
+        }
+        if (zxc_decompress(comp, c_sz, out, size, 1) != size || memcmp(out, src, size) != 0 ||
+            zxc_decompress_mt(comp, c_sz, out, size, 4, 1) != size ||
+            memcmp(out, src, size) != 0) {
+            printf("Failed: linked round trip (level %d)\n", levels[l]);
+            goto cleanup;
+        }
+        // The parallel compressor reads the history in place: same frame.
+        if (zxc_compress_mt_ex(src, size, comp2, cap, 4, &opts) != c_sz ||
+            memcmp(comp2, comp, c_sz) != 0) {
+            printf("Failed: parallel linked compression differs (level %d)\n", levels[l]);
+            goto cleanup;
+        }
+    }
+
+    // Only the first block is independent; dropping the flag of the second one
+    // must make it fail rather than decode garbage.
+    zxc_compress_opts_t opts = {3, 0, 0, ZXC_BLOCK_SIZE_MIN, 1};
+    size_t c_sz = zxc_compress_ex(src, size, comp, cap, &opts);
+    size_t b0 = (size_t)zxc_file_header_size(comp[6]);
+    size_t b1 = b0 + ZXC_BLOCK_HEADER_SIZE + zxc_le32(comp + b0 + 4);
+    if (c_sz == 0 || (comp[b0 + 1] & ZXC_BLOCK_FLAG_LINKED) ||
+        !(comp[b1 + 1] & ZXC_BLOCK_FLAG_LINKED)) {
+        printf("Failed: block flags\n");
+        goto cleanup;
+    }
+    comp[b1 + 1] &= ~ZXC_BLOCK_FLAG_LINKED;
+    if (zxc_decompress(comp, c_sz, out, size, 0) != 0) {
+        printf("Failed: unlinked block decoded without its history\n");
+        goto cleanup;
+    }
+    comp[b1 + 1] |= ZXC_BLOCK_FLAG_LINKED;
+    if (zxc_decompress_range(comp, c_sz, size / 2, 100, out, 0) != 0) {
+        printf("Failed: range decoding of a linked block should fail\n");
+        goto cleanup;
+    }
+
+    // Stream engine: linked compression, then every decoder on its output.
+    f_in = tmpfile();
+    f_c = tmpfile();
+    f_out = tmpfile();
+    if (!f_in || !f_c || !f_out) goto cleanup;
+    fwrite(src, 1, size, f_in);
+    rewind(f_in);
+    int64_t s_sz = zxc_stream_compress_ex(f_in, f_c, 3, &opts);
+    rewind(f_c);
+    if (s_sz <= 0 || (size_t)s_sz > c_sz + 64 ||
+        fread(comp2, 1, (size_t)s_sz, f_c) != (size_t)s_sz ||
+        zxc_decompress(comp2, (size_t)s_sz, out, size, 0) != size || memcmp(out, src, size) != 0) {
+        printf("Failed: linked stream compression\n");
+        goto cleanup;
+    }
+    for (int threads = 1; threads <= 4; threads += 3) {
+        rewind(f_c);
+        rewind(f_out);
+        if (zxc_stream_decompress(f_c, f_out, threads, 0) != (int64_t)size) {
+            printf("Failed: linked stream decompression (%d threads)\n", threads);
+            goto cleanup;
+        }
+        rewind(f_out);
+        if (fread(out, 1, size, f_out) != size || memcmp(out, src, size) != 0) {
+            printf("Failed: linked stream content (%d threads)\n", threads);
+            goto cleanup;
+        }
+    }
+
+    // A seek table promises independent blocks.
+    opts.seekable = 1;
+    rewind(f_in);
+    if (zxc_compress_ex(src, size, comp, cap, &opts) != 0 ||
+        zxc_compress_mt_ex(src, size, comp, cap, 2, &opts) != 0 ||
+        zxc_stream_compress_ex(f_in, f_c, 2, &opts) != -1) {
+        printf("Failed: seekable linked frames should be refused\n");
+        goto cleanup;
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+
+cleanup:
+    if (f_in) fclose(f_in);
+    if (f_c) fclose(f_c);
+    if (f_out) fclose(f_out);
+    free(src);
+    free(comp);
+    free(comp2);
+    free(out);
+    return ok;
+}
+
+// Checks the entropy-coded levels (6-9): FSE literal and token sections
+// round-trip, beat level 5, and malformed sections are rejected safely.
+int test_entropy_levels() {
+    printf("=== TEST: Unit - Entropy Levels (FSE, levels 6-9) ===\n");
+
+    // Random words from a small vocabulary: short matches, skewed literals.
+    static const char* const words[] = {"the",   "quick", "brown",  "fox",   "jumps", "over",
+                                        "lazy",  "dog",   "stream", "block", "entropy",
+                                        "table", "state", "symbol", "zxc",   "data\n"};
+    const size_t size = 600 * 1024;
+    const size_t cap = zxc_compress_bound(size);
+    uint8_t* src = malloc(size);
+    uint8_t* comp = malloc(cap);
+    uint8_t* out = malloc(size);
+    int ok = 0;
+    if (!src || !comp || !out) goto cleanup;
+    for (size_t i = 0; i < size;) {
+        const char* w = words[rand() % 16];
+        size_t len = strlen(w);
+        for (size_t k = 0; k < len && i < size; k++) src[i++] = (uint8_t)w[k];
+        if (i < size) src[i++] = (rand() % 7) ? ' ' : (uint8_t)('0' + rand() % 10);
+    }
+
+    size_t sz5 = zxc_compress(src, size, comp, cap, 5, 0);
+    for (int level = 6; level <= 9; level++) {
+        size_t c_sz = zxc_compress(src, size, comp, cap, level, 1);
+        printf("  level %d: %zu bytes (level 5: %zu)\n", level, c_sz, sz5);
+        if (c_sz == 0 || c_sz > sz5 - sz5 / 20) {
+            printf("Failed: level %d should be at least 5%% smaller than level 5\n", level);
+            goto cleanup;
+        }
+        if (zxc_decompress(comp, c_sz, out, size, 1) != size || memcmp(out, src, size) != 0 ||
+            zxc_decompress_mt(comp, c_sz, out, size, 3, 1) != size ||
+            memcmp(out, src, size) != 0) {
+            printf("Failed: level %d round trip\n", level);
+            goto cleanup;
+        }
+    }
+
+    // Both sections of the first GLO block are entropy coded.
+    size_t c_sz = zxc_compress(src, size, comp, cap, 6, 0);
+    size_t b0 = (size_t)zxc_file_header_size(comp[6]);
+    const uint8_t* gh = comp + b0 + ZXC_BLOCK_HEADER_SIZE;
+    if (c_sz == 0 || comp[b0] != ZXC_BLOCK_GLO || gh[8] != ZXC_SECTION_ENCODING_FSE ||
+        gh[9] != ZXC_SECTION_ENCODING_FSE) {
+        printf("Failed: FSE sections not used\n");
+        goto cleanup;
+    }
+
+    // Damaged FSE sections must be rejected or at least decoded within bounds.
+    size_t lit_sz = (size_t)zxc_le32(gh + ZXC_GLO_HEADER_BINARY_SIZE);
+    const size_t lit_off = b0 + ZXC_BLOCK_HEADER_SIZE + ZXC_GLO_HEADER_BINARY_SIZE +
+                           ZXC_GLO_SECTIONS * ZXC_SECTION_DESC_BINARY_SIZE;
+    for (size_t pos = 0; pos < lit_sz + 64; pos += 37) {
+        comp[lit_off + pos] ^= 0x5A;
+        (void)zxc_decompress(comp, c_sz, out, size, 0);
+        comp[lit_off + pos] ^= 0x5A;
+    }
+    comp[lit_off] = ZXC_FSE_TABLE_LOG_MAX + 1;  // Table log out of range
+    if (zxc_decompress(comp, c_sz, out, size, 0) != 0) {
+        printf("Failed: invalid table log accepted\n");
+        goto cleanup;
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+cleanup:
+    free(src);
+    free(comp);
+    free(out);
+    return ok;
+}
+
+// Checks the optimal parser of levels 8-9: better ratio than level 7 on text,
+// and exact round trips on long repeats, noise and tiny inputs.
+int test_optimal_parser() {
+    printf("=== TEST: Unit - Optimal Parser (levels 8-9) ===\n");
+
+    const size_t size = 512 * 1024;
+    const size_t cap = zxc_compress_bound(size);
+    uint8_t* src = malloc(size);
+    uint8_t* comp = malloc(cap);
+    uint8_t* out = malloc(size);
+    int ok = 0;
+    if (!src || !comp || !out) goto cleanup;
+
+    size_t used = 0;
+    for (unsigned id = 0; used + 512 < size; id++)
+        used += gen_json_record((char*)src + used, 512, id);
+    size_t sz7 = zxc_compress(src, used, comp, cap, 7, 0);
+    size_t prev = sz7;
+    for (int level = 8; level <= 9; level++) {
+        size_t c_sz = zxc_compress(src, used, comp, cap, level, 1);
+        printf("  level %d: %zu bytes (level 7: %zu)\n", level, c_sz, sz7);
+        if (c_sz == 0 || c_sz > prev || c_sz > sz7 - sz7 / 50) {
+            printf("Failed: level %d should beat level 7 by 2%%\n", level);
+            goto cleanup;
+        }
+        prev = c_sz;
+        if (zxc_decompress(comp, c_sz, out, size, 1) != used || memcmp(out, src, used) != 0 ||
+            zxc_decompress_mt(comp, c_sz, out, size, 2, 1) != used ||
+            memcmp(out, src, used) != 0) {
+            printf("Failed: level %d round trip\n", level);
+            goto cleanup;
+        }
+    }
+
+    // Long runs and a period beyond the enumerated lengths, mixed with noise.
+    gen_random_data(src, size);
+    ZXC_MEMSET(src + 1000, 0, 100000);
+    for (size_t i = 200000; i < 400000; i++) src[i] = src[i - 3000];
+    for (int level = 8; level <= 9; level++) {
+        for (size_t n = 1; n <= 70; n += 3) {  // Tiny inputs: no room for a parse window
+            size_t c_sz = zxc_compress(src + 1000 - n / 2, n, comp, cap, level, 1);
+            if (c_sz == 0 || zxc_decompress(comp, c_sz, out, size, 1) != n ||
+                memcmp(out, src + 1000 - n / 2, n) != 0) {
+                printf("Failed: level %d, %zu-byte input\n", level, n);
+                goto cleanup;
+            }
+        }
+        size_t c_sz = zxc_compress(src, size, comp, cap, level, 1);
+        if (c_sz == 0 || c_sz > size / 2 || zxc_decompress(comp, c_sz, out, size, 1) != size ||
+            memcmp(out, src, size) != 0) {
+            printf("Failed: level %d mixed round trip (%zu bytes)\n", level, c_sz);
+            goto cleanup;
+        }
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+cleanup:
+    free(src);
+    free(comp);
+    free(out);
+    return ok;
+}
+
+// Checks the typed NUM codecs selected through the num_type hint: each one must
+// be chosen on a matching column, beat the 32-bit probe, and round-trip through
+// the buffer, parallel and stream paths.
+int test_num_types() {
+    printf("=== TEST: Unit - Typed NUM Codecs (num_type hint) ===\n");
+
+    const size_t size = 1024 * 1024;
+    const size_t cap = zxc_compress_bound(size);
+    uint8_t* src = malloc(size);
+    uint8_t* comp = malloc(cap);
+    uint8_t* out = malloc(size);
+    int ok = 0;
+    if (!src || !comp || !out) goto cleanup;
+
+    const int types[] = {ZXC_NUM_U16, ZXC_NUM_U64, ZXC_NUM_TIMESTAMP64, ZXC_NUM_F32,
+                         ZXC_NUM_F64};
+    const int codecs[] = {ZXC_NUM_CODEC_U16_DELTA, ZXC_NUM_CODEC_U64_DELTA,
+                          ZXC_NUM_CODEC_U64_DOD, ZXC_NUM_CODEC_F32_XOR, ZXC_NUM_CODEC_F64_XOR};
+    for (int t = 0; t < 5; t++) {
+        srand(42 + t);
+        uint64_t v = 1700000000000000000ULL;
+        for (size_t i = 0; i < size / zxc_num_elem_size(codecs[t]); i++) {
+            switch (types[t]) {
+                case ZXC_NUM_U16:  // Random walk
+                    v += (uint64_t)(rand() % 7) - 3;
+                    zxc_store_le16(src + i * 2, (uint16_t)v);
+                    break;
+                case ZXC_NUM_U64:  // Counter with irregular increments
+                    v += (uint64_t)(rand() % 1000);
+                    zxc_store_le64(src + i * 8, v);
+                    break;
+                case ZXC_NUM_TIMESTAMP64:  // 1 ms period with a few ns of jitter
+                    zxc_store_le64(src + i * 8, v + i * 1000000 + (uint64_t)(rand() % 16));
+                    break;
+                case ZXC_NUM_F32: {  // Sensor reading quantized to 1/64
+                    v += (uint64_t)(rand() % 5) - 2;
+                    float f = 20.0f + (float)(int16_t)v / 64.0f;
+                    ZXC_MEMCPY(src + i * 4, &f, sizeof(f));
+                    break;
+                }
+                default: {  // Price series in quarter steps
+                    v += (uint64_t)(rand() % 9) - 4;
+                    double d = 1000.0 + (double)(int16_t)v * 0.25;
+                    ZXC_MEMCPY(src + i * 8, &d, sizeof(d));
+                    break;
+                }
+            }
+        }
+
+        zxc_compress_opts_t probe = {3, 1, 0, 0, 0, ZXC_NUM_AUTO};
+        zxc_compress_opts_t opts = {3, 1, 0, 0, 0, types[t]};
+        size_t sz_auto = zxc_compress_ex(src, size, comp, cap, &probe);
+        size_t c_sz = zxc_compress_ex(src, size, comp, cap, &opts);
+        size_t b0 = (size_t)zxc_file_header_size(comp[6]);
+        // Codec byte of the NUM header, behind the block header and checksum.
+        uint8_t* codec = comp + b0 + ZXC_BLOCK_HEADER_SIZE + ZXC_BLOCK_CHECKSUM_SIZE + 10;
+        printf("  type %d: %zu bytes (probe: %zu)\n", types[t], c_sz, sz_auto);
+        if (c_sz == 0 || c_sz >= sz_auto || comp[b0] != ZXC_BLOCK_NUM || *codec != codecs[t]) {
+            printf("Failed: codec %d not selected or not smaller\n", codecs[t]);
+            goto cleanup;
+        }
+        if (zxc_decompress(comp, c_sz, out, size, 1) != size || memcmp(out, src, size) != 0 ||
+            zxc_decompress_mt(comp, c_sz, out, size, 2, 1) != size ||
+            memcmp(out, src, size) != 0) {
+            printf("Failed: type %d round trip\n", types[t]);
+            goto cleanup;
+        }
+
+        // An unknown codec is rejected.
+        *codec = ZXC_NUM_CODEC_COUNT;
+        if (zxc_decompress(comp, c_sz, out, size, 0) != 0) {
+            printf("Failed: unknown codec accepted\n");
+            goto cleanup;
+        }
+
+        c_sz = zxc_compress_mt_ex(src, size, comp, cap, 2, &opts);
+        if (c_sz == 0 || zxc_decompress(comp, c_sz, out, size, 1) != size ||
+            memcmp(out, src, size) != 0) {
+            printf("Failed: type %d parallel round trip\n", types[t]);
+            goto cleanup;
+        }
+
+        FILE* f_in = tmpfile();
+        FILE* f_out = tmpfile();
+        int s_ok = f_in && f_out && fwrite(src, 1, size, f_in) == size;
+        if (s_ok) {
+            rewind(f_in);
+            s_ok = zxc_stream_compress_ex(f_in, f_out, 2, &opts) > 0;
+        }
+        if (s_ok) {
+            rewind(f_out);
+            c_sz = fread(comp, 1, cap, f_out);
+            s_ok = zxc_decompress(comp, c_sz, out, size, 1) == size &&
+                   memcmp(out, src, size) == 0;
+        }
+        if (f_in) fclose(f_in);
+        if (f_out) fclose(f_out);
+        if (!s_ok) {
+            printf("Failed: type %d stream round trip\n", types[t]);
+            goto cleanup;
+        }
+
+        // Sizes that are not a whole number of elements fall back to GLO.
+        const size_t odd = 64 * 1024 + 3;
+        c_sz = zxc_compress_ex(src, odd, comp, cap, &opts);
+        if (c_sz == 0 || zxc_decompress(comp, c_sz, out, size, 1) != odd ||
+            memcmp(out, src, odd) != 0) {
+            printf("Failed: type %d partial element round trip\n", types[t]);
+            goto cleanup;
+        }
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+cleanup:
+    free(src);
+    free(comp);
+    free(out);
+    return ok;
+}
+
+// Checks byte-shuffled compression (zxc_compress_typed and opts.elem_size):
+// float data must compress markedly better, and every element size, including
+// partial trailing elements, must round-trip through all the decoders.
+int test_byte_shuffle() {
+    printf("=== TEST: Unit - Byte Shuffle (zxc_compress_typed) ===\n");
+
+    const size_t n = 256 * 1024;  // float32 elements (1 MB)
+    const size_t size = n * sizeof(float);
+    const size_t cap = zxc_compress_bound(size);
+    uint8_t* src = malloc(size);
+    uint8_t* comp = malloc(cap);
+    uint8_t* out = malloc(size);
+    int ok = 0;
+    if (!src || !comp || !out) goto cleanup;
+
+    // Smooth float32 signal with a little noise in the low mantissa bits.
+    srand(7);
+    float x = 1.0f;
+    for (size_t i = 0; i < n; i++) {
+        x += ((float)(rand() % 2001) - 1000.0f) * 1e-6f;
+        ZXC_MEMCPY(src + i * 4, &x, sizeof(x));
+    }
+    for (int level = 3; level <= 6; level += 3) {
+        zxc_compress_opts_t opts = {level, 1, 0, 0, 0, ZXC_NUM_NONE, 0};
+        size_t plain = zxc_compress_ex(src, size, comp, cap, &opts);
+        size_t c_sz = zxc_compress_typed(src, n, sizeof(float), comp, cap, &opts);
+        size_t b0 = (size_t)zxc_file_header_size(comp[6]);
+        printf("  level %d: %zu bytes (unshuffled: %zu)\n", level, c_sz, plain);
+        if (c_sz == 0 || c_sz > plain - plain / 4 || !(comp[b0 + 1] & ZXC_BLOCK_FLAG_SHUFFLED) ||
+            zxc_le16(comp + b0 + 2) != sizeof(float)) {
+            printf("Failed: shuffled float data should be 25%% smaller\n");
+            goto cleanup;
+        }
+        if (zxc_decompress(comp, c_sz, out, size, 1) != size || memcmp(out, src, size) != 0 ||
+            zxc_decompress_mt(comp, c_sz, out, size, 2, 1) != size ||
+            memcmp(out, src, size) != 0 ||
+            zxc_decompress_range(comp, c_sz, 12345, 300000, out, 1) != 300000 ||
+            memcmp(out, src + 12345, 300000) != 0) {
+            printf("Failed: level %d round trip\n", level);
+            goto cleanup;
+        }
+
+        // A shuffled block with an impossible element size is rejected.
+        comp[b0 + 2] = 1;
+        if (zxc_decompress(comp, c_sz, out, size, 0) != 0) {
+            printf("Failed: element size 1 accepted\n");
+            goto cleanup;
+        }
+    }
+
+    // Every element size, with a partial element at the end of each block.
+    gen_num_data(src, size);
+    const size_t elems[] = {2, 3, 4, 8, 12, 16, 255};
+    for (size_t e = 0; e < sizeof(elems) / sizeof(elems[0]); e++) {
+        const size_t len = size - 7;
+        zxc_compress_opts_t opts = {e % 2 ? 2 : 3, 1, 0, ZXC_BLOCK_SIZE_MIN + 4096, 0, 0,
+                                    elems[e]};
+        size_t c_sz = zxc_compress_mt_ex(src, len, comp, cap, 2, &opts);
+        if (c_sz == 0 || zxc_decompress(comp, c_sz, out, size, 1) != len ||
+            memcmp(out, src, len) != 0) {
+            printf("Failed: element size %zu round trip\n", elems[e]);
+            goto cleanup;
+        }
+
+        FILE* f_in = tmpfile();
+        FILE* f_out = tmpfile();
+        int s_ok = f_in && f_out && fwrite(src, 1, len, f_in) == len;
+        if (s_ok) {
+            rewind(f_in);
+            s_ok = zxc_stream_compress_ex(f_in, f_out, 2, &opts) > 0;
+        }
+        if (s_ok) {
+            rewind(f_out);
+            c_sz = fread(comp, 1, cap, f_out);
+            s_ok = zxc_decompress(comp, c_sz, out, size, 1) == len && memcmp(out, src, len) == 0;
+        }
+        if (f_in) fclose(f_in);
+        if (f_out) fclose(f_out);
+        if (!s_ok) {
+            printf("Failed: element size %zu stream round trip\n", elems[e]);
+            goto cleanup;
+        }
+    }
+
+    // Out of range element sizes and linked blocks are refused.
+    zxc_compress_opts_t linked = {3, 0, 0, 0, 1, 0, 4};
+    if (zxc_compress_typed(src, 100, ZXC_ELEM_SIZE_MAX + 1, comp, cap, NULL) != 0 ||
+        zxc_compress_typed(src, 100, 0, comp, cap, NULL) != 0 ||
+        zxc_compress_ex(src, size, comp, cap, &linked) != 0) {
+        printf("Failed: invalid shuffle options accepted\n");
+        goto cleanup;
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+cleanup:
+    free(src);
+    free(comp);
+    free(out);
+    return ok;
+}
+
+// Compresses with the buffer, parallel buffer and stream APIs and checks the
+// block selection counters of each against the expected ones.
+static int check_block_stats(const uint8_t* src, size_t size, uint8_t* comp, size_t cap,
+                             uint8_t* out, int level, const zxc_block_stats_t* want) {
+    for (int api = 0; api < 3; api++) {
+        zxc_block_stats_t st;
+        ZXC_MEMSET(&st, 0, sizeof(st));
+        zxc_compress_opts_t opts = {level, 1, 0, 64 * 1024, 0, 0, 0, &st};
+        size_t c_sz = 0;
+        if (api == 0) {
+            c_sz = zxc_compress_ex(src, size, comp, cap, &opts);
+        } else if (api == 1) {
+            c_sz = zxc_compress_mt_ex(src, size, comp, cap, 2, &opts);
+        } else {
+            FILE* f_in = tmpfile();
+            FILE* f_out = tmpfile();
+            if (f_in && f_out && fwrite(src, 1, size, f_in) == size) {
+                rewind(f_in);
+                if (zxc_stream_compress_ex(f_in, f_out, 2, &opts) > 0) {
+                    rewind(f_out);
+                    c_sz = fread(comp, 1, cap, f_out);
+                }
+            }
+            if (f_in) fclose(f_in);
+            if (f_out) fclose(f_out);
+        }
+        printf("  level %d api %d: raw %llu (skipped %llu) glo %llu ghi %llu (by data %llu)\n",
+               level, api, (unsigned long long)st.raw_blocks, (unsigned long long)st.raw_skipped,
+               (unsigned long long)st.glo_blocks, (unsigned long long)st.ghi_blocks,
+               (unsigned long long)st.ghi_by_data);
+        if (c_sz == 0 || zxc_decompress(comp, c_sz, out, size, 1) != size ||
+            memcmp(out, src, size) != 0) {
+            printf("Failed: level %d api %d round trip\n", level, api);
+            return 0;
+        }
+        // Decisions must match; the byte counters must cover the input and the blocks.
+        const uint64_t raw_sz = st.raw_bytes + st.glo_bytes + st.ghi_bytes + st.num_bytes;
+        const uint64_t comp_sz =
+            st.raw_comp_bytes + st.glo_comp_bytes + st.ghi_comp_bytes + st.num_comp_bytes;
+        if (memcmp(&st, want, offsetof(zxc_block_stats_t, raw_bytes)) != 0 || raw_sz != size ||
+            comp_sz == 0 || comp_sz >= c_sz || st.raw_bytes < st.raw_blocks * 1024) {
+            printf("Failed: level %d api %d counters\n", level, api);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int test_block_selection() {
+    printf("=== TEST: Unit - Block Selection (zxc_block_stats_t) ===\n");
+
+    // 64 KB blocks: 4 random with long repeats (few matches), 4 random, 8 text.
+    const size_t size = 1024 * 1024;
+    const size_t cap = zxc_compress_bound(size);
+    uint8_t* src = malloc(size);
+    uint8_t* comp = malloc(cap);
+    uint8_t* out = malloc(size);
+    int ok = 0;
+    if (!src || !comp || !out) goto cleanup;
+
+    srand(17);
+    for (size_t pos = 0; pos < 256 * 1024; pos += 8192) {
+        gen_random_data(src + pos, 4096);
+        ZXC_MEMCPY(src + pos + 4096, src + pos, 4096);
+    }
+    gen_random_data(src + 256 * 1024, 256 * 1024);
+    gen_lz_data(src + 512 * 1024, 512 * 1024);
+
+    // Levels 1-2 never estimate: random blocks are tried, then stored RAW.
+    const zxc_block_stats_t fast = {4, 0, 8, 0, 0, 4, 0, 0};
+    // Level 5: random blocks are skipped, sparse repeats go GHI, text stays GLO.
+    const zxc_block_stats_t mid = {4, 8, 4, 0, 4, 0, 4, 0};
+    const size_t tail = 256 * 1024;
+    if (!check_block_stats(src + tail, size - tail, comp, cap, out, 1, &fast) ||
+        !check_block_stats(src, size, comp, cap, out, 5, &mid))
+        goto cleanup;
+
+    // Counters are added to, not overwritten.
+    zxc_block_stats_t st = {1, 0, 0, 0, 0, 1, 0, 0};
+    zxc_compress_opts_t opts = {5, 0, 0, 64 * 1024, 0, 0, 0, &st};
+    if (zxc_compress_ex(src + tail, 256 * 1024, comp, cap, &opts) == 0 || st.raw_blocks != 5 ||
+        st.raw_skipped != 4 || st.raw_fallback != 1) {
+        printf("Failed: counters not accumulated\n");
+        goto cleanup;
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+cleanup:
+    free(src);
+    free(comp);
+    free(out);
+    return ok;
+}
+
+// Builds a frame block by block with the sans-IO block API, including a short
+// block in the middle (a flush), and decodes it with each decoder.
+int test_block_api() {
+    printf("=== TEST: Unit - Sans-IO Block API (zxc_compress_block) ===\n");
+
+    const size_t bs = ZXC_BLOCK_SIZE_MIN;
+    const size_t size = 5 * bs + 1234;
+    const size_t cuts[] = {bs, bs, 1000, bs, bs - 1000, bs, 1234};
+    const size_t cap = zxc_compress_bound(size) + 2 * zxc_block_bound(bs);
+    uint8_t* src = malloc(size);
+    uint8_t* comp = malloc(cap);
+    uint8_t* out = malloc(size);
+    zxc_cctx_t cctx, dctx;
+    int ok = 0;
+    int c_init = -1, d_init = -1;
+    if (!src || !comp || !out) goto cleanup;
+    gen_lz_data(src, size);
+    gen_random_data(src + 2 * bs, bs);
+
+    c_init = zxc_cctx_init(&cctx, bs, 1, 3, 1);
+    d_init = zxc_cctx_init(&dctx, bs, 0, 0, 1);
+    if (c_init != 0 || d_init != 0) goto cleanup;
+
+    zxc_file_header_t fh = {bs, 0, 0, 0};
+    int h = zxc_write_file_header(comp, cap, &fh);
+    if (h <= 0 || zxc_peek_file_header_size(comp, 7) != 0 ||
+        zxc_peek_file_header_size(comp, (size_t)h) != (size_t)h) {
+        printf("Failed: file header\n");
+        goto cleanup;
+    }
+    size_t c_sz = (size_t)h, pos = 0;
+    for (size_t i = 0; i < sizeof(cuts) / sizeof(cuts[0]); i++) {
+        int res = zxc_compress_block(&cctx, src + pos, cuts[i], comp + c_sz, cap - c_sz);
+        if (res <= 0 || (size_t)res > zxc_block_bound(cuts[i]) ||
+            zxc_peek_block_size(comp + c_sz, (size_t)res) != (size_t)res) {
+            printf("Failed: block %zu\n", i);
+            goto cleanup;
+        }
+        c_sz += (size_t)res;
+        pos += cuts[i];
+    }
+    if (zxc_compress_block(&cctx, src, bs + 1, comp + c_sz, cap - c_sz) != -1) {
+        printf("Failed: block larger than the context accepted\n");
+        goto cleanup;
+    }
+
+    // Block by block, then as a whole frame.
+    size_t ip = (size_t)h, op = 0;
+    while (ip < c_sz) {
+        size_t blk = zxc_peek_block_size(comp + ip, c_sz - ip);
+        if (zxc_peek_block_size(comp + ip, 11) != 0 ||
+            zxc_decompress_block(&dctx, comp + ip, blk - 1, out + op, size - op) != -1) {
+            printf("Failed: truncated block accepted\n");
+            goto cleanup;
+        }
+        int res = zxc_decompress_block(&dctx, comp + ip, blk, out + op, size - op);
+        if (res <= 0) {
+            printf("Failed: block at %zu\n", ip);
+            goto cleanup;
+        }
+        ip += blk;
+        op += (size_t)res;
+    }
+    if (op != size || memcmp(out, src, size) != 0) {
+        printf("Failed: block by block round trip\n");
+        goto cleanup;
+    }
+    ZXC_MEMSET(out, 0, size);
+    if (zxc_decompress(comp, c_sz, out, size, 1) != size || memcmp(out, src, size) != 0) {
+        printf("Failed: frame round trip\n");
+        goto cleanup;
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+cleanup:
+    if (c_init == 0) zxc_cctx_free(&cctx);
+    if (d_init == 0) zxc_cctx_free(&dctx);
+    free(src);
+    free(comp);
+    free(out);
+    return ok;
+}
+
+// Checks that every instruction set the CPU supports can be selected at run
+// time and writes the same frames as the generic path.
+int test_isa_selection() {
+    printf("=== TEST: Unit - Instruction Set Selection ===\n");
+
+    const size_t size = 700 * 1024;
+    const size_t cap = zxc_compress_bound(size);
+    const int levels[] = {1, 3, 5, 6, 9};
+    const int n_levels = (int)(sizeof(levels) / sizeof(levels[0]));
+    uint8_t* src = malloc(size);
+    uint8_t* refs = malloc(cap * (size_t)n_levels);
+    uint8_t* comp = malloc(cap);
+    uint8_t* out = malloc(size);
+    size_t ref_sz[sizeof(levels) / sizeof(levels[0])];
+    int ok = 0;
+    if (!src || !refs || !comp || !out) goto cleanup;
+    gen_lz_data(src, size);
+    gen_random_data(src + 300 * 1024, 50 * 1024);
+    gen_num_data(src + 500 * 1024, 200 * 1024);
+
+    zxc_isa_t best = zxc_get_active_isa();
+    if (best == ZXC_ISA_AUTO || strcmp(zxc_isa_name(best), "unknown") == 0 ||
+        zxc_isa_from_name(zxc_isa_name(best)) != (int)best ||
+        zxc_isa_from_name("AVX2") != ZXC_ISA_AVX2 || zxc_isa_from_name("avx") != -1 ||
+        zxc_isa_from_name("avx2x") != -1) {
+        printf("Failed: active instruction set or names\n");
+        goto cleanup;
+    }
+    if (zxc_set_isa((zxc_isa_t)99) != -1 || zxc_get_active_isa() != best) {
+        printf("Failed: unknown instruction set accepted\n");
+        goto cleanup;
+    }
+
+    if (zxc_set_isa(ZXC_ISA_GENERIC) != 0 || zxc_get_active_isa() != ZXC_ISA_GENERIC) {
+        printf("Failed: generic path not selected\n");
+        goto cleanup;
+    }
+    for (int l = 0; l < n_levels; l++) {
+        zxc_compress_opts_t opts = {.level = levels[l], .checksum_enabled = 1};
+        ref_sz[l] = zxc_compress_ex(src, size, refs + cap * (size_t)l, cap, &opts);
+        if (ref_sz[l] == 0) goto cleanup;
+    }
+
+    for (int isa = ZXC_ISA_AVX2; isa <= ZXC_ISA_NEON; isa++) {
+        if (zxc_set_isa((zxc_isa_t)isa) != 0) {
+            printf("  [SKIP] %s (not supported here)\n", zxc_isa_name((zxc_isa_t)isa));
+            continue;
+        }
+        if (zxc_get_active_isa() != (zxc_isa_t)isa) goto cleanup;
+        for (int l = 0; l < n_levels; l++) {
+            zxc_compress_opts_t opts = {.level = levels[l], .checksum_enabled = 1};
+            size_t c_sz = zxc_compress_ex(src, size, comp, cap, &opts);
+            if (c_sz != ref_sz[l] || memcmp(comp, refs + cap * (size_t)l, c_sz) != 0) {
+                printf("Failed: %s level %d differs from generic\n",
+                       zxc_isa_name((zxc_isa_t)isa), levels[l]);
+                goto cleanup;
+            }
+            if (zxc_decompress(comp, c_sz, out, size, 1) != size || memcmp(out, src, size) != 0) {
+                printf("Failed: %s level %d round trip\n", zxc_isa_name((zxc_isa_t)isa),
+                       levels[l]);
+                goto cleanup;
+            }
+        }
+        printf("  [PASS] %s\n", zxc_isa_name((zxc_isa_t)isa));
+    }
+
+    if (zxc_set_isa(ZXC_ISA_AUTO) != 0 || zxc_get_active_isa() != best) {
+        printf("Failed: automatic selection not restored\n");
+        goto cleanup;
+    }
+
+#ifndef _WIN32
+    // The automatic selection follows ZXC_ISA, and ignores values it cannot honour.
+    char saved_env[32] = {0};
+    const char* env = getenv("ZXC_ISA");
+    if (env) snprintf(saved_env, sizeof(saved_env), "%s", env);
+    unsetenv("ZXC_ISA");
+    zxc_set_isa(ZXC_ISA_AUTO);
+    zxc_isa_t detected = zxc_get_active_isa();
+    setenv("ZXC_ISA", "Generic", 1);
+    int env_ok = zxc_set_isa(ZXC_ISA_AUTO) == 0 && zxc_get_active_isa() == ZXC_ISA_GENERIC;
+    setenv("ZXC_ISA", "mmx", 1);
+    env_ok &= zxc_set_isa(ZXC_ISA_AUTO) == 0 && zxc_get_active_isa() == detected;
+    if (env)
+        setenv("ZXC_ISA", saved_env, 1);
+    else
+        unsetenv("ZXC_ISA");
+    if (!env_ok) {
+        printf("Failed: ZXC_ISA environment variable\n");
+        goto cleanup;
+    }
+#endif
+
+    printf("PASS\n\n");
+    ok = 1;
+cleanup:
+    zxc_set_isa(ZXC_ISA_AUTO);
+    free(src);
+    free(refs);
+    free(comp);
+    free(out);
+    return ok;
+}
+
+// Returns the offset of the DIG block of a frame, or 0 if it has none.
+static size_t find_digest_block(const uint8_t* frame, size_t size) {
+    size_t off = zxc_peek_file_header_size(frame, size);
+    while (off != 0 && off + ZXC_BLOCK_HEADER_SIZE <= size) {
+        if (frame[off] == ZXC_BLOCK_DIG) return off;
+        size_t blk = zxc_peek_block_size(frame + off, size - off);
+        off = blk ? off + blk : 0;
+    }
+    return 0;
+}
+
+// Checks that the frame digest is the same whichever path wrote the frame, that
+// every decoder accepts it, and that dropping a block or damaging the digest is
+// caught even where each block still verifies on its own.
+int test_frame_digest() {
+    printf("=== TEST: Unit - Frame Digest ===\n");
+
+    const size_t size = 2 * 1024 * 1024 + 4321;
+    const size_t cap = zxc_compress_bound(size);
+    uint8_t* src = malloc(size);
+    uint8_t* out = malloc(size);
+    uint8_t* c_buf = malloc(cap);
+    uint8_t* c_mt = malloc(cap);
+    uint8_t* c_str = malloc(cap);
+    FILE* f = NULL;
+    int ok = 0;
+    if (!src || !out || !c_buf || !c_mt || !c_str) goto cleanup;
+    gen_lz_data(src, size);
+
+    for (int seekable = 0; seekable <= 1; seekable++) {
+        // No checksum asked for: the digest turns the block checksums on.
+        zxc_compress_opts_t opts;
+        memset(&opts, 0, sizeof(opts));
+        opts.level = 3;
+        opts.seekable = seekable;
+        opts.block_size = ZXC_BLOCK_SIZE_MIN;
+        opts.digest = 1;
+
+        size_t n_buf = zxc_compress_ex(src, size, c_buf, cap, &opts);
+        size_t n_mt = zxc_compress_mt_ex(src, size, c_mt, cap, 4, &opts);
+        mem_io_t m;
+        memset(&m, 0, sizeof(m));
+        m.src = src;
+        m.size = size;
+        m.max_read = size;
+        m.fail_read = m.fail_write = -1;
+        m.dst = c_str;
+        m.cap = cap;
+        int64_t n_str = zxc_stream_compress_cb(mem_read, mem_write, &m, 3, &opts);
+        size_t d_buf = find_digest_block(c_buf, n_buf);
+        size_t d_mt = find_digest_block(c_mt, n_mt);
+        size_t d_str = n_str > 0 ? find_digest_block(c_str, (size_t)n_str) : 0;
+        if (n_buf == 0 || n_mt == 0 || n_str <= 0 || !d_buf || !d_mt || !d_str ||
+            memcmp(c_buf + d_buf, c_mt + d_mt, ZXC_DIGEST_BLOCK_SIZE) != 0 ||
+            memcmp(c_buf + d_buf, c_str + d_str, ZXC_DIGEST_BLOCK_SIZE) != 0) {
+            printf("Failed: digest differs between paths (seekable %d)\n", seekable);
+            goto cleanup;
+        }
+        // Seek table last, digest right before it.
+        if ((seekable && c_buf[d_buf + ZXC_DIGEST_BLOCK_SIZE] != ZXC_BLOCK_SEK) ||
+            (!seekable && d_buf + ZXC_DIGEST_BLOCK_SIZE != n_buf)) {
+            printf("Failed: digest block misplaced (seekable %d)\n", seekable);
+            goto cleanup;
+        }
+
+        // Digest of two halves merged = digest of the whole frame.
+        zxc_digest_t whole = {0, 0, 0}, head = {0, 0, 0}, tail;
+        zxc_digest_start(&tail, 8);
+        size_t off = zxc_peek_file_header_size(c_buf, n_buf), n_blocks = 0;
+        for (; off < d_buf; n_blocks++) {
+            size_t blk = zxc_peek_block_size(c_buf + off, n_buf - off);
+            zxc_digest_update(&whole, c_buf + off, blk);
+            zxc_digest_update(n_blocks < 8 ? &head : &tail, c_buf + off, blk);
+            off += blk;
+        }
+        if (n_blocks <= 8 || zxc_digest_merge(&head, &tail) != 0 ||
+            zxc_check_digest(c_buf + d_buf, n_buf - d_buf, &head) != 0 ||
+            zxc_check_digest(c_buf + d_buf, n_buf - d_buf, &whole) != 0 ||
+            zxc_digest_merge(&whole, &tail) == 0) {
+            printf("Failed: sans-IO digest (seekable %d)\n", seekable);
+            goto cleanup;
+        }
+
+        if (zxc_decompress(c_buf, n_buf, out, size, 1) != size || memcmp(out, src, size) != 0 ||
+            zxc_decompress_mt(c_mt, n_mt, out, size, 4, 1) != size ||
+            memcmp(out, src, size) != 0 ||
+            zxc_get_decompressed_size(c_str, (size_t)n_str) != size) {
+            printf("Failed: buffer round trip (seekable %d)\n", seekable);
+            goto cleanup;
+        }
+        memset(&m, 0, sizeof(m));
+        m.src = c_str;
+        m.size = (size_t)n_str;
+        m.max_read = 777;
+        m.fail_read = m.fail_write = -1;
+        m.dst = out;
+        m.cap = size;
+        if (zxc_stream_decompress_cb(mem_read, mem_write, &m, 3, 1) != (int64_t)size ||
+            memcmp(out, src, size) != 0) {
+            printf("Failed: stream round trip (seekable %d)\n", seekable);
+            goto cleanup;
+        }
+        f = tmpfile();
+        if (!f) goto cleanup;
+        fwrite(c_str, 1, (size_t)n_str, f);
+        rewind(f);
+        if (zxc_stream_decompress(f, NULL, 4, 1) != (int64_t)size) {
+            printf("Failed: positional decompress (seekable %d)\n", seekable);
+            goto cleanup;
+        }
+        fclose(f);
+        f = NULL;
+
+        // Damaged digest: every block still verifies, the frame must not.
+        c_buf[d_buf + ZXC_DIGEST_BLOCK_SIZE - 1] ^= 1;
+        if (zxc_decompress(c_buf, n_buf, out, size, 1) != 0 ||
+            zxc_decompress(c_buf, n_buf, out, size, 0) != size) {
+            printf("Failed: damaged digest (seekable %d)\n", seekable);
+            goto cleanup;
+        }
+    }
+
+    // Stream frame (no content size) with its second block dropped: only the
+    // digest notices, on every decoding path.
+    size_t first = zxc_peek_file_header_size(c_str, cap);
+    size_t second = first + zxc_peek_block_size(c_str + first, cap - first);
+    size_t n_str = find_digest_block(c_str, cap) + ZXC_DIGEST_BLOCK_SIZE;
+    size_t drop = zxc_peek_block_size(c_str + second, cap - second);
+    c_str[6] &= (uint8_t)~ZXC_FILE_FLAG_SEEKABLE;  // No seek table: it went with the last pass
+    memmove(c_str + second, c_str + second + drop, n_str - second - drop);
+    n_str -= drop;
+    if (zxc_decompress(c_str, n_str, out, size, 1) != 0 ||
+        zxc_decompress_mt(c_str, n_str, out, size, 4, 1) != 0 ||
+        zxc_decompress(c_str, n_str, out, size, 0) != size - ZXC_BLOCK_SIZE_MIN) {
+        printf("Failed: dropped block (buffer)\n");
+        goto cleanup;
+    }
+    mem_io_t m;
+    memset(&m, 0, sizeof(m));
+    m.src = c_str;
+    m.size = n_str;
+    m.max_read = n_str;
+    m.fail_read = m.fail_write = -1;
+    if (zxc_stream_decompress_cb(mem_read, NULL, &m, 3, 1) != -1) {
+        printf("Failed: dropped block (stream)\n");
+        goto cleanup;
+    }
+    f = tmpfile();
+    if (!f) goto cleanup;
+    fwrite(c_str, 1, n_str, f);
+    rewind(f);
+    if (zxc_stream_decompress(f, NULL, 4, 1) != -1) {
+        printf("Failed: dropped block (positional)\n");
+        goto cleanup;
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+
+cleanup:
+    if (f) fclose(f);
+    free(src);
+    free(out);
+    free(c_buf);
+    free(c_mt);
+    free(c_str);
+    return ok;
+}
+
+// Checks that a static context decodes from its workspace alone and refuses
+// blocks larger than it was sized for, and that in-place decompression works
+// with exactly zxc_in_place_bound() bytes, incompressible blocks included, and
+// with small frames whose last byte is the last byte of the allocation.
+int test_static_dctx_in_place() {
+    printf("=== TEST: Unit - Static Decompression Context & In-Place Decompression ===\n");
+
+    const size_t size = 1024 * 1024 + 777;
+    const size_t bs = 64 * 1024;
+    const size_t ws_size = ZXC_STATIC_DCTX_SIZE(bs);
+    const size_t ip_cap = zxc_in_place_bound(size, bs);
+    const size_t cap = zxc_compress_bound(size);
+    uint8_t* src = malloc(size);
+    uint8_t* out = malloc(size);
+    uint8_t* comp = malloc(cap);
+    uint8_t* ws = malloc(ws_size + 1);
+    uint8_t* buf = malloc(ip_cap);
+    int ok = 0;
+    if (!src || !out || !comp || !ws || !buf || ip_cap == 0) goto cleanup;
+
+    // Compressible first half, incompressible (RAW blocks) second half.
+    gen_lz_data(src, size / 2);
+    gen_random_data(src + size / 2, size - size / 2);
+
+    if (zxc_static_dctx_size(bs) != ws_size || zxc_static_dctx_size(0) != 0 ||
+        zxc_init_static_dctx(ws, ws_size - 1, bs) != NULL || zxc_in_place_bound(size, 1000) != 0) {
+        printf("Failed: workspace sizing\n");
+        goto cleanup;
+    }
+    // Any alignment of the workspace is accepted.
+    zxc_dctx* dctx = zxc_init_static_dctx(ws + 1, ws_size, bs);
+    if (!dctx) {
+        printf("Failed: zxc_init_static_dctx\n");
+        goto cleanup;
+    }
+
+    // Plain, linked with digest, seekable, and shuffled frames.
+    const struct {
+        int level, linked, seekable, digest;
+        size_t elem;
+    } cases[] = {{1, 0, 0, 0, 0}, {5, 1, 0, 1, 0}, {4, 0, 1, 1, 0}, {3, 0, 0, 0, 4}};
+    for (size_t k = 0; k < sizeof(cases) / sizeof(cases[0]); k++) {
+        zxc_compress_opts_t o = {0};
+        o.level = cases[k].level;
+        o.checksum_enabled = 1;
+        o.block_size = bs;
+        o.linked = cases[k].linked;
+        o.seekable = cases[k].seekable;
+        o.digest = cases[k].digest;
+        o.elem_size = cases[k].elem;
+        size_t c_sz = zxc_compress_ex(src, size, comp, cap, &o);
+        if (c_sz == 0 || c_sz > ip_cap) {
+            printf("Failed: compression (case %zu)\n", k);
+            goto cleanup;
+        }
+
+        memset(out, 0, size);
+        if (zxc_decompress_dctx(dctx, comp, c_sz, out, size, 1) != size ||
+            memcmp(src, out, size) != 0) {
+            printf("Failed: static context round trip (case %zu)\n", k);
+            goto cleanup;
+        }
+
+        // In place, with the static context and with temporary scratch.
+        for (int use_dctx = 0; use_dctx < 2; use_dctx++) {
+            memcpy(buf + ip_cap - c_sz, comp, c_sz);
+            if (zxc_decompress_in_place(use_dctx ? dctx : NULL, buf, ip_cap, c_sz, 1) != size ||
+                memcmp(src, buf, size) != 0) {
+                printf("Failed: in-place decompression (case %zu, dctx %d)\n", k, use_dctx);
+                goto cleanup;
+            }
+        }
+    }
+
+    // Small compressible frames flush against the end of an exact-size
+    // allocation: literal wild copies must not read past it (sanitizer builds).
+    const size_t small_sizes[] = {708, 5000, 70000};
+    for (size_t k = 0; k < sizeof(small_sizes) / sizeof(small_sizes[0]); k++) {
+        const size_t n = small_sizes[k];
+        if (k == 0)
+            memset(out, 'a', n);
+        else
+            gen_lz_data(out, n);
+        for (int level = 1; level <= 6; level++) {
+            for (int checksum = 0; checksum < 2; checksum++) {
+                size_t s_sz = zxc_compress(out, n, comp, cap, level, checksum);
+                const size_t s_cap = zxc_in_place_bound(n, 0);
+                uint8_t* exact = malloc(s_sz);
+                uint8_t* ip = malloc(s_cap);
+                int good = s_sz != 0 && exact && ip;
+                if (good) {
+                    memcpy(exact, comp, s_sz);
+                    memcpy(ip + s_cap - s_sz, comp, s_sz);
+                    good = zxc_decompress(exact, s_sz, buf, ip_cap, checksum) == n &&
+                           memcmp(buf, out, n) == 0 &&
+                           zxc_decompress_in_place(NULL, ip, s_cap, s_sz, checksum) == n &&
+                           memcmp(ip, out, n) == 0;
+                }
+                free(exact);
+                free(ip);
+                if (!good) {
+                    printf("Failed: exact-end frame (size %zu, level %d, checksum %d)\n", n,
+                           level, checksum);
+                    goto cleanup;
+                }
+            }
+        }
+    }
+
+    // Too small a margin fails cleanly: the output would catch up with the RAW blocks.
+    size_t c_sz = zxc_compress(src, size, comp, cap, 1, 1);
+    memcpy(buf + (size + 16) - c_sz, comp, c_sz);
+    if (c_sz == 0 || zxc_decompress_in_place(NULL, buf, size + 16, c_sz, 1) != 0) {
+        printf("Failed: in-place decompression without margin not rejected\n");
+        goto cleanup;
+    }
+
+    // Blocks larger than the context's: the shuffle scratch cannot hold them.
+    zxc_compress_opts_t big = {0};
+    big.level = 3;
+    big.elem_size = 4;
+    big.block_size = 4 * bs;
+    c_sz = zxc_compress_ex(src, size, comp, cap, &big);
+    if (c_sz == 0 || zxc_decompress_dctx(dctx, comp, c_sz, out, size, 0) != 0 ||
+        zxc_decompress(comp, c_sz, out, size, 0) != size) {
+        printf("Failed: oversized block not rejected by the static context\n");
+        goto cleanup;
+    }
+
+    zxc_free_dctx(dctx);  // No-op: the caller owns the workspace
+    printf("PASS\n\n");
+    ok = 1;
+
+cleanup:
+    free(src);
+    free(out);
+    free(comp);
+    free(ws);
+    free(buf);
+    return ok;
+}
+
+// Checks the adaptive level of the stream engine: an unreachable speed target
+// keeps the lowest level (same frame as the fixed level), a trivial one climbs
+// to denser levels, and whatever the levels picked the frame decodes.
+int test_stream_adaptive_level() {
+    printf("=== TEST: Unit - Stream Adaptive Level ===\n");
+
+    const size_t size = 4 * 1024 * 1024;
+    const size_t cap = zxc_compress_bound(size);
+    uint8_t* src = malloc(size);
+    uint8_t* ref = malloc(cap);
+    uint8_t* comp = malloc(cap);
+    uint8_t* out = malloc(size);
+    zxc_pool_t* pool = NULL;
+    int ok = 0;
+    if (!src || !ref || !comp || !out) goto cleanup;
+    gen_lz_data(src, size);
+
+    zxc_compress_opts_t opts = {.level = 1, .checksum_enabled = 1, .block_size = 64 * 1024};
+    mem_io_t m = {src, size, 0, (size_t)-1, -1, ref, cap, 0, 0, -1};
+    int64_t ref_sz = zxc_stream_compress_cb(mem_read, mem_write, &m, 3, &opts);
+    if (ref_sz <= 0) goto cleanup;
+
+    // Every block is slower than 4 PB/s: the level never leaves the minimum.
+    opts.level_max = 5;
+    opts.target_mb_s = 4000000000U;
+    m = (mem_io_t){src, size, 0, (size_t)-1, -1, comp, cap, 0, 0, -1};
+    int64_t c_sz = zxc_stream_compress_cb(mem_read, mem_write, &m, 3, &opts);
+    if (c_sz != ref_sz || memcmp(comp, ref, (size_t)c_sz) != 0) {
+        printf("Failed: unreachable target left the lowest level\n");
+        goto cleanup;
+    }
+
+    // Every block is faster than 1 MB/s: denser levels are picked, the frame shrinks.
+    pool = zxc_pool_create(2);
+    if (!pool) goto cleanup;
+    opts.target_mb_s = 1;
+    for (int k = 0; k < 3; k++) {
+        // Target speed, then the writer's pace, on threads and on a pool.
+        if (k == 2) opts.target_mb_s = 0;
+        m = (mem_io_t){src, size, 0, (size_t)-1, -1, comp, cap, 0, 0, -1};
+        c_sz = k == 1 ? zxc_stream_compress_cb_pool(pool, mem_read, mem_write, &m, &opts)
+                      : zxc_stream_compress_cb(mem_read, mem_write, &m, 3, &opts);
+        if (c_sz <= 0 || (k < 2 && c_sz >= ref_sz)) {
+            printf("Failed: adaptive compression (case %d: %lld vs %lld)\n", k,
+                   (long long)c_sz, (long long)ref_sz);
+            goto cleanup;
+        }
+        mem_io_t d = {comp, (size_t)c_sz, 0, (size_t)-1, -1, out, size, 0, 0, -1};
+        if (zxc_stream_decompress_cb(mem_read, mem_write, &d, 3, 1) != (int64_t)size ||
+            memcmp(out, src, size) != 0) {
+            printf("Failed: adaptive round trip (case %d)\n", k);
+            goto cleanup;
+        }
+    }
+
+    // The range must start at the level.
+    opts.level = 4;
+    opts.level_max = 2;
+    m = (mem_io_t){src, size, 0, (size_t)-1, -1, comp, cap, 0, 0, -1};
+    if (zxc_stream_compress_cb(mem_read, mem_write, &m, 3, &opts) != -1) {
+        printf("Failed: inverted level range accepted\n");
+        goto cleanup;
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+
+cleanup:
+    zxc_pool_free(pool);
+    free(src);
+    free(ref);
+    free(comp);
+    free(out);
+    return ok;
+}
+
+// Streams messages through the incremental encoder: each flush makes all the
+// input so far decodable, END closes the frame, and the context then starts
+// the next frame. Decoders stop at the END block.
+int test_cstream_flush() {
+    printf("=== TEST: Unit - Sans-IO Incremental Encoder (zxc_cstream_flush) ===\n");
+
+    const size_t bs = ZXC_BLOCK_SIZE_MIN;
+    const size_t msgs[] = {100, 3000, 0, bs + 7000, 1, 2 * bs, 200};
+    const size_t n_msgs = sizeof(msgs) / sizeof(msgs[0]);
+    const size_t size = 4 * bs;
+    const size_t cap = 4 * zxc_cstream_bound(bs, size);
+    uint8_t* src = malloc(size);
+    uint8_t* comp = malloc(cap);
+    uint8_t* out = malloc(size);
+    zxc_cstream_t cs;
+    zxc_cctx_t dctx;
+    int cs_init = -1;
+    int ok = 0;
+    if (!src || !comp || !out) goto cleanup;
+    gen_lz_data(src, size);
+
+    cs_init = zxc_cstream_init(&cs, bs, 1, 1);
+    if (cs_init != 0 || zxc_cstream_init(&(zxc_cstream_t){0}, 1000, 1, 1) != -1 ||
+        zxc_cstream_bound(1000, 1) != 0) {
+        printf("Failed: init\n");
+        goto cleanup;
+    }
+
+    // Frame 1: one flush per message, the output decodes after each of them.
+    size_t c_sz = 0, pos = 0;
+    for (size_t i = 0; i < n_msgs; i++) {
+        int res = zxc_cstream_compress(&cs, src + pos, msgs[i], comp + c_sz, cap - c_sz);
+        if (res < 0 || (size_t)res > zxc_cstream_bound(bs, msgs[i])) {
+            printf("Failed: compress message %zu\n", i);
+            goto cleanup;
+        }
+        c_sz += (size_t)res;
+        pos += msgs[i];
+        // A destination too small for the open block leaves the encoder untouched.
+        if (cs.pending_size > 0 && zxc_cstream_flush(&cs, comp + c_sz, cs.pending_size) != -1) {
+            printf("Failed: short flush accepted\n");
+            goto cleanup;
+        }
+        res = zxc_cstream_flush(&cs, comp + c_sz, cap - c_sz);
+        if (res < 0 || cs.pending_size != 0) {
+            printf("Failed: flush %zu\n", i);
+            goto cleanup;
+        }
+        c_sz += (size_t)res;
+        if (zxc_decompress(comp, c_sz, out, size, 1) != pos || memcmp(out, src, pos) != 0) {
+            printf("Failed: data not decodable after flush %zu\n", i);
+            goto cleanup;
+        }
+    }
+    const size_t len1 = pos;
+    int res = zxc_cstream_end(&cs, comp + c_sz, cap - c_sz);
+    if (res != ZXC_BLOCK_HEADER_SIZE || !zxc_is_end_block(comp + c_sz, (size_t)res)) {
+        printf("Failed: end of frame 1\n");
+        goto cleanup;
+    }
+    c_sz += (size_t)res;
+    const size_t frame1 = c_sz;
+
+    // Frame 2 on the same context: a large write (whole blocks straight from
+    // the input) and the end of stream, without an explicit flush.
+    const size_t len2 = size - len1;
+    res = zxc_cstream_compress(&cs, src + len1, len2, comp + c_sz, cap - c_sz);
+    if (res <= 0 || zxc_read_file_header(comp + c_sz, (size_t)res, NULL) < 0) {
+        printf("Failed: second frame header\n");
+        goto cleanup;
+    }
+    c_sz += (size_t)res;
+    res = zxc_cstream_end(&cs, comp + c_sz, cap - c_sz);
+    if (res <= ZXC_BLOCK_HEADER_SIZE) {
+        printf("Failed: end of frame 2\n");
+        goto cleanup;
+    }
+    c_sz += (size_t)res;
+
+    // Each frame alone decodes; the buffer decoders reject bytes past END.
+    if (zxc_decompress_mt(comp + frame1, c_sz - frame1, out, size, 2, 1) != len2 ||
+        memcmp(out, src + len1, len2) != 0 || zxc_decompress(comp, frame1 + 1, out, size, 1) != 0 ||
+        zxc_decompress_mt(comp, c_sz, out, size, 2, 1) != 0) {
+        printf("Failed: frame boundaries with the buffer API\n");
+        goto cleanup;
+    }
+
+    // The stream decoder ends with the first frame.
+    mem_io_t d = {comp, c_sz, 0, (size_t)-1, -1, out, size, 0, 0, -1};
+    if (zxc_stream_decompress_cb(mem_read, mem_write, &d, 2, 1) != (int64_t)len1 ||
+        memcmp(out, src, len1) != 0) {
+        printf("Failed: stream decoder past the end of stream\n");
+        goto cleanup;
+    }
+
+    // Sans-IO reader: blocks up to the END block.
+    if (zxc_cctx_init(&dctx, bs, 0, 0, 1) != 0) goto cleanup;
+    size_t ip = (size_t)zxc_read_file_header(comp, c_sz, NULL), op = 0;
+    while (!zxc_is_end_block(comp + ip, c_sz - ip)) {
+        res = zxc_decompress_block(&dctx, comp + ip, c_sz - ip, out + op, size - op);
+        if (res <= 0) break;
+        ip += zxc_peek_block_size(comp + ip, c_sz - ip);
+        op += (size_t)res;
+    }
+    res = zxc_decompress_block(&dctx, comp + ip, c_sz - ip, out + op, size - op);
+    zxc_cctx_free(&dctx);
+    if (op != len1 || ip + ZXC_BLOCK_HEADER_SIZE != frame1 || res != 0 ||
+        memcmp(out, src, len1) != 0) {
+        printf("Failed: sans-IO decoding up to the end of stream\n");
+        goto cleanup;
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+
+cleanup:
+    if (cs_init == 0) zxc_cstream_free(&cs);
+    free(src);
+    free(comp);
+    free(out);
+    return ok;
+}
+
+// Checks that the multithreaded buffer API round-trips and interoperates with
+// the single-threaded one.
+int test_buffer_api_mt() {
+    printf("=== TEST: Unit - Parallel Buffer API (zxc_compress_mt/zxc_decompress_mt) ===\n");
+
+    size_t src_size = 4 * 1024 * 1024 + 12345;  // Several blocks + partial tail
+    uint8_t* src = malloc(src_size);
+    size_t max_dst_size = zxc_compress_bound(src_size);
+    uint8_t* compressed = malloc(max_dst_size);
+    uint8_t* decompressed = malloc(src_size);
+    int ok = 0;
+    if (!src || !compressed || !decompressed) goto cleanup;
+
+    gen_lz_data(src, src_size / 2);
+    gen_random_data(src + src_size / 2, src_size - src_size / 2);
+
+    // 1. Parallel compress with dst sized by zxc_compress_bound (in-place compaction)
+    size_t c_sz = zxc_compress_mt(src, src_size, compressed, max_dst_size, 4, 3, 1);
+    if (c_sz == 0) {
+        printf("Failed: zxc_compress_mt returned 0\n");
+        goto cleanup;
+    }
+
+    // 2. Single-threaded decoder must accept the parallel output
+    if (zxc_decompress(compressed, c_sz, decompressed, src_size, 1) != src_size ||
+        memcmp(src, decompressed, src_size) != 0) {
+        printf("Failed: zxc_decompress could not read zxc_compress_mt output\n");
+        goto cleanup;
+    }
+
+    // 3. Parallel decompress
+    memset(decompressed, 0, src_size);
+    if (zxc_decompress_mt(compressed, c_sz, decompressed, src_size, 4, 1) != src_size ||
+        memcmp(src, decompressed, src_size) != 0) {
+        printf("Failed: zxc_decompress_mt round-trip mismatch\n");
+        goto cleanup;
+    }
+
+    // 4. Tight dst (below the bound) goes through the scratch path
+    uint8_t* tight = malloc(c_sz);
+    if (!tight) goto cleanup;
+    size_t c_sz2 = zxc_compress_mt(src, src_size, tight, c_sz, 0, 3, 1);
+    int tight_ok = (c_sz2 > 0 &&
+                    zxc_decompress_mt(tight, c_sz2, decompressed, src_size, 0, 1) == src_size &&
+                    memcmp(src, decompressed, src_size) == 0);
+    free(tight);
+    if (!tight_ok) {
+        printf("Failed: zxc_compress_mt with tight buffer (returned %zu)\n", c_sz2);
+        goto cleanup;
+    }
+
+    // 5. Destination too small must fail cleanly
+    if (zxc_decompress_mt(compressed, c_sz, decompressed, src_size - 1, 4, 1) != 0) {
+        printf("Failed: zxc_decompress_mt should fail with small buffer\n");
+        goto cleanup;
+    }
+
+    printf("PASS\n\n");
+    ok = 1;
+
+cleanup:
+    free(src);
+    free(compressed);
+    free(decompressed);
+    return ok;
+}
+
 /*
  * Test for zxc_br_init and zxc_br_ensure
  */
@@ -606,6 +3378,10 @@ int main() {
     if (!test_round_trip("Level 3", buffer, BUF_SIZE, 3, 1)) total_failures++;
     if (!test_round_trip("Level 4", buffer, BUF_SIZE, 4, 1)) total_failures++;
     if (!test_round_trip("Level 5", buffer, BUF_SIZE, 5, 1)) total_failures++;
+    if (!test_round_trip("Level 6", buffer, BUF_SIZE, 6, 1)) total_failures++;
+    if (!test_round_trip("Level 7", buffer, BUF_SIZE, 7, 1)) total_failures++;
+    if (!test_round_trip("Level 8", buffer, BUF_SIZE, 8, 1)) total_failures++;
+    if (!test_round_trip("Level 9", buffer, BUF_SIZE, 9, 1)) total_failures++;
 
     printf("\n--- Test Coverage: Binary Data Preservation ---\n");
     gen_binary_data(buffer, BUF_SIZE);
@@ -641,6 +3417,34 @@ int main() {
     // --- UNIT TESTS (ROBUSTNESS/API) ---
 
     if (!test_buffer_api()) total_failures++;
+    if (!test_buffer_api_mt()) total_failures++;
+    if (!test_seekable_range()) total_failures++;
+    if (!test_content_size()) total_failures++;
+    if (!test_reusable_context()) total_failures++;
+    if (!test_small_input_context()) total_failures++;
+    if (!test_block_size()) total_failures++;
+    if (!test_large_block_ratio()) total_failures++;
+    if (!test_decompress_exact_capacity()) total_failures++;
+    if (!test_stream_mapped_input()) total_failures++;
+    if (!test_stream_positional_decompress()) total_failures++;
+    if (!test_stream_callbacks()) total_failures++;
+    if (!test_stream_engine_flags()) total_failures++;
+    if (!test_thread_pool()) total_failures++;
+    if (!test_compress_batch()) total_failures++;
+    if (!test_perf_stats()) total_failures++;
+    if (!test_dictionary()) total_failures++;
+    if (!test_linked_blocks()) total_failures++;
+    if (!test_entropy_levels()) total_failures++;
+    if (!test_optimal_parser()) total_failures++;
+    if (!test_num_types()) total_failures++;
+    if (!test_byte_shuffle()) total_failures++;
+    if (!test_block_selection()) total_failures++;
+    if (!test_block_api()) total_failures++;
+    if (!test_isa_selection()) total_failures++;
+    if (!test_frame_digest()) total_failures++;
+    if (!test_static_dctx_in_place()) total_failures++;
+    if (!test_stream_adaptive_level()) total_failures++;
+    if (!test_cstream_flush()) total_failures++;
 
     if (!test_multithread_roundtrip()) total_failures++;
 
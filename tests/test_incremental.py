@@ -0,0 +1,71 @@
+import os
+import random
+import unittest
+
+import zxc
+
+
+def _sample(size, seed):
+    rnd = random.Random(seed)
+    words = [bytes(rnd.choices(b"abcdefghij", k=rnd.randint(3, 9))) for _ in range(64)]
+    out = bytearray()
+    while len(out) < size:
+        out += rnd.choice(words) + b" "
+        if rnd.random() < 0.01:
+            out += os.urandom(rnd.randint(1, 200))
+    return bytes(out[:size])
+
+
+def _feed(decompressor, data, step):
+    return b"".join(decompressor.decompress(data[i:i + step])
+                    for i in range(0, len(data), step))
+
+
+class IncrementalTest(unittest.TestCase):
+    def test_round_trip(self):
+        data = _sample(700_000, 1)
+        c = zxc.ZxcCompressor(block_size=64 * 1024)
+        frame = b"".join(c.compress(data[i:i + 10_000])
+                         for i in range(0, len(data), 10_000)) + c.flush()
+        self.assertEqual(zxc.decompress(frame), data)
+        d = zxc.ZxcDecompressor()
+        self.assertEqual(_feed(d, frame, 4093), data)
+        self.assertEqual(d.pending, 0)
+
+    def test_back_to_back_frames(self):
+        parts = [_sample(300_000, 2), _sample(5_000, 3), _sample(70_000, 4)]
+        c = zxc.ZxcCompressor(block_size=64 * 1024)
+        frames = [c.compress(p) + c.end() for p in parts]
+        for f, p in zip(frames, parts):
+            self.assertEqual(zxc.decompress(f), p)
+
+        stream = b"".join(frames)
+        for step in (1, 7, 4096, len(stream)):
+            d = zxc.ZxcDecompressor()
+            self.assertEqual(_feed(d, stream, step), b"".join(parts), step)
+            self.assertEqual(d.pending, 0)
+
+    def test_empty_frame(self):
+        c = zxc.ZxcCompressor()
+        frame = c.end()
+        self.assertEqual(zxc.decompress(frame), b"")
+        self.assertEqual(zxc.decompress(frame, stats=True)[0], b"")
+        self.assertEqual(zxc.ZxcDecompressor().decompress(frame), b"")
+        with self.assertRaises(ValueError):
+            zxc.decompress(frame[:-1])
+
+    def test_frames_of_other_block_sizes(self):
+        a, b = _sample(200_000, 5), _sample(200_000, 6)
+        small = zxc.ZxcCompressor(block_size=64 * 1024)
+        large = zxc.ZxcCompressor(block_size=1024 * 1024, checksum=True)
+        stream = small.compress(a) + small.end() + large.compress(b) + large.end()
+        d = zxc.ZxcDecompressor()
+        self.assertEqual(_feed(d, stream, 65_537), a + b)
+
+    def test_invalid_block_size(self):
+        with self.assertRaises(ValueError):
+            zxc.ZxcCompressor(block_size=1000)
+
+
+if __name__ == "__main__":
+    unittest.main()